@@ -470,18 +470,13 @@ sound_write_buf_pstereo( libspectrum_signed_word * out, int c )
 #define HZ_COMMON_DENOMINATOR 50
 #include "Log.h"
 
-void CAY8910::sound_ay_overlay( void )
+void CAY8910::sound_ay_overlay( int changes_due )
 {
-  int tone_level[3];
-  int mixer, envshape;
-  int f, g, level, count;
+  int f, g;
 //  libspectrum_signed_word *ptr;
   struct ay_change_tag *change_ptr = ay_change;
-  int changes_left = ay_change_count;
+  int changes_left = changes_due;	// [AppleWin] may be fewer than ay_change_count (see sound_frame_span())
   int reg, r;
-  int is_low;
-  int chan1, chan2, chan3;
-  unsigned int tone_count, noise_count;
   libspectrum_dword sfreq, cpufreq;
 
 ///* If no AY chip, don't produce any AY sound (!) */
@@ -494,7 +489,7 @@ void CAY8910::sound_ay_overlay( void )
 //  cpufreq = machine_current->timings.processor_speed / HZ_COMMON_DENOMINATOR;
   cpufreq = (libspectrum_dword) (m_fCurrentCLK_AY8910 / HZ_COMMON_DENOMINATOR);	// [TC]
   int dbgCount=0;
-  for( f = 0; f < ay_change_count; f++ )
+  for( f = 0; f < changes_due; f++ )
   {
     ay_change[f].ofs = (USHORT) (( ay_change[f].tstates * sfreq ) / cpufreq);	// [TC] Added cast
 
@@ -511,12 +506,14 @@ void CAY8910::sound_ay_overlay( void )
   }
 #endif
 
-  libspectrum_signed_word* pBuf1 = g_ppSoundBuffers[0];
-  libspectrum_signed_word* pBuf2 = g_ppSoundBuffers[1];
-  libspectrum_signed_word* pBuf3 = g_ppSoundBuffers[2];
+  libspectrum_signed_word* pBuf[3] = { g_ppSoundBuffers[0], g_ppSoundBuffers[1], g_ppSoundBuffers[2] };
 
+  /* [AppleWin] Render runs of samples between register changes.
+   * The registers are constant within a run, so the per-channel
+   * mixer/level decisions are made once per run (see sound_ay_run()).
+   */
 //  for( f = 0, ptr = sound_buf; f < sound_generator_framesiz; f++ ) {
-  for( f = 0; f < sound_generator_framesiz; f++ ) {
+  for( f = 0; f < sound_generator_framesiz; ) {
     /* update ay registers. All this sub-frame change stuff
      * is pretty hairy, but how else would you handle the
      * samples in Robocop? :-) It also clears up some other
@@ -567,17 +564,34 @@ void CAY8910::sound_ay_overlay( void )
       }
     }
 
-    /* the tone level if no enveloping is being used */
+    /* the run ends at the next change (all offsets are < framesiz) */
+    int run = ( changes_left ? change_ptr->ofs : sound_generator_framesiz ) - f;
+    if( run > AY_RUN_MAX )
+      run = AY_RUN_MAX;
+
+    sound_ay_run( pBuf, run );
     for( g = 0; g < 3; g++ )
-      tone_level[g] = ay_tone_levels[ sound_ay_registers[ 8 + g ] & 15 ];
+      pBuf[g] += run;
+    f += run;
+  }
+}
 
-    /* envelope */
-    envshape = sound_ay_registers[13];
-    level = ay_tone_levels[ env_counter ];
+/* [AppleWin] Generate 'run' samples for all 3 channels, with the registers unchanged.
+ * The per-sample envelope, tone-subcycle and noise recurrences are shared by all
+ * 3 channels, so they're generated first into arrays, then each channel is
+ * rendered from those arrays with its mixer/level decisions hoisted out of the loop.
+ * The output is identical to generating one sample (for all channels) at a time.
+ */
+void CAY8910::sound_ay_run( libspectrum_signed_word** ppBuf, int run )
+{
+  const int envshape = sound_ay_registers[13];
+  const int mixer = sound_ay_registers[7];
+  int i, g, level, count, is_low;
+  unsigned int tone_count, noise_count;
 
-    for( g = 0; g < 3; g++ )
-      if( sound_ay_registers[ 8 + g ] & 16 )
-	tone_level[g] = level;
+  for( i = 0; i < run; i++ ) {
+    /* envelope level is sampled before this sample's envelope update */
+    run_env_level[i] = ay_tone_levels[ env_counter ];
 
     /* envelope output counter gets incr'd every 16 AY cycles.
      * Has to be a while, as this is sub-output-sample res.
@@ -633,76 +647,12 @@ void CAY8910::sound_ay_overlay( void )
       }
     }
 
-    /* generate tone+noise... or neither.
-     * (if no tone/noise is selected, the chip just shoves the
-     * level out unmodified. This is used by some sample-playing
-     * stuff.)
-     */
-    chan1 = tone_level[0];
-    chan2 = tone_level[1];
-    chan3 = tone_level[2];
-    mixer = sound_ay_registers[7];
-
     ay_tone_subcycles += ay_tick_incr;
-    tone_count = ay_tone_subcycles >> ( 3 + 16 );
+    run_tone_count[i] = ay_tone_subcycles >> ( 3 + 16 );
     ay_tone_subcycles &= ( 8 << 16 ) - 1;
 
-    if( ( mixer & 1 ) == 0 ) {
-      level = chan1;
-      AY_DO_TONE( chan1, 0 );
-    }
-    if( ( mixer & 0x08 ) == 0 && noise_toggle )
-      chan1 = 0;
-
-    if( ( mixer & 2 ) == 0 ) {
-      level = chan2;
-      AY_DO_TONE( chan2, 1 );
-    }
-    if( ( mixer & 0x10 ) == 0 && noise_toggle )
-      chan2 = 0;
-
-    if( ( mixer & 4 ) == 0 ) {
-      level = chan3;
-      AY_DO_TONE( chan3, 2 );
-    }
-    if( ( mixer & 0x20 ) == 0 && noise_toggle )
-      chan3 = 0;
-
-    /* write the sample(s) */
-	*pBuf1++ = chan1;	// [TC]
-	*pBuf2++ = chan2;	// [TC]
-	*pBuf3++ = chan3;	// [TC]
-#if 0
-    if( !sound_stereo ) {
-      /* mono */
-      ( *ptr++ ) += chan1 + chan2 + chan3;
-    } else {
-      if( !sound_stereo_ay ) {
-	/* stereo output, but mono AY sound; still,
-	 * incr separately in case of beeper pseudostereo.
-	 */
-	( *ptr++ ) += chan1 + chan2 + chan3;
-	( *ptr++ ) += chan1 + chan2 + chan3;
-      } else {
-	/* stereo with ACB/ABC AY positioning.
-	 * Here we use real stereo positions for the channels.
-	 * Just because, y'know, it's cool and stuff. No, really. :-)
-	 * This is a little tricky, as it works by delaying sounds
-	 * on the left or right channels to model the delay you get
-	 * in the real world when sounds originate at different places.
-	 */
-	GEN_STEREO( rchan1pos, chan1 );
-	GEN_STEREO( rchan2pos, chan2 );
-	GEN_STEREO( rchan3pos, chan3 );
-	( *ptr++ ) += rstereobuf_l[ rstereopos ];
-	( *ptr++ ) += rstereobuf_r[ rstereopos ];
-	rstereobuf_l[ rstereopos ] = rstereobuf_r[ rstereopos ] = 0;
-	rstereopos++;
-	if( rstereopos >= STEREO_BUF_SIZE )
-	  rstereopos = 0;
-      }
-    }
-#endif
+    /* noise gate is sampled before this sample's noise update */
+    run_noise_toggle[i] = noise_toggle;
 
     /* update noise RNG/filter */
     ay_noise_tick += noise_count;
@@ -723,6 +673,57 @@ void CAY8910::sound_ay_overlay( void )
 	break;
     }
   }
+
+  /* generate tone+noise... or neither.
+   * (if no tone/noise is selected, the chip just shoves the
+   * level out unmodified. This is used by some sample-playing
+   * stuff.)
+   */
+  for( g = 0; g < 3; g++ ) {
+    libspectrum_signed_word* pBuf = ppBuf[g];
+    const bool bEnv = ( sound_ay_registers[ 8 + g ] & 16 ) != 0;
+    const int fixed_level = ay_tone_levels[ sound_ay_registers[ 8 + g ] & 15 ];
+    const bool bTone = ( mixer & ( 1 << g ) ) == 0;
+    const bool bNoise = ( mixer & ( 8 << g ) ) == 0;
+
+    if( !bTone ) {
+      if( !bEnv && !bNoise ) {
+	for( i = 0; i < run; i++ )
+	  pBuf[i] = fixed_level;
+      } else if( !bEnv ) {
+	for( i = 0; i < run; i++ )
+	  pBuf[i] = run_noise_toggle[i] ? 0 : fixed_level;
+      } else {
+	for( i = 0; i < run; i++ )
+	  pBuf[i] = ( bNoise && run_noise_toggle[i] ) ? 0 : run_env_level[i];
+      }
+    } else if( !bEnv && !fixed_level ) {
+      /* silent: only the tone counter needs to advance, and
+       * ((tick + sum) mod period) is the same as stepping it per sample.
+       */
+      unsigned int sum = 0;
+      for( i = 0; i < run; i++ ) {
+	sum += run_tone_count[i];
+	pBuf[i] = 0;
+      }
+      ay_tone_tick[g] += sum;
+      if( ay_tone_tick[g] >= ay_tone_period[g] ) {
+	const unsigned int toggles = ay_tone_tick[g] / ay_tone_period[g];
+	ay_tone_tick[g] -= toggles * ay_tone_period[g];
+	ay_tone_high[g] = ( toggles & 1 ) ? !ay_tone_high[g] : !!ay_tone_high[g];
+      }
+    } else {
+      int chan;
+      for( i = 0; i < run; i++ ) {
+	level = bEnv ? run_env_level[i] : fixed_level;
+	tone_count = run_tone_count[i];
+	AY_DO_TONE( chan, g );
+	if( bNoise && run_noise_toggle[i] )
+	  chan = 0;
+	pBuf[i] = chan;
+      }
+    }
+  }
 }
 
 BYTE CAY8910::sound_ay_read( int reg )
@@ -900,7 +901,7 @@ void CAY8910::sound_frame( void )
 #endif
 
 /* overlay AY sound */
-  sound_ay_overlay();
+  sound_ay_overlay( ay_change_count );
 
 #ifdef HAVE_SAMPLERATE
 /* resample from generated frequency down to output frequency if required */
@@ -921,6 +922,27 @@ void CAY8910::sound_frame( void )
   ay_change_count = 0;
 }
 
+/* [AppleWin] Generate a frame which covers exactly 'span' tstates.
+ * Only the AY writes made within the span are consumed; later ones are kept
+ * (rebased to the start of the next frame), so that consecutive frames form
+ * a continuous timeline, independent of how often they're generated.
+ */
+void CAY8910::sound_frame_span( libspectrum_dword span )
+{
+  int f, due = 0;
+
+  while( due < ay_change_count && ay_change[ due ].tstates < span )
+    due++;
+
+  sound_ay_overlay( due );
+
+  for( f = due; f < ay_change_count; f++ ) {
+    ay_change[ f - due ] = ay_change[ f ];
+    ay_change[ f - due ].tstates -= span;
+  }
+  ay_change_count -= due;
+}
+
 #if 0
 /* two beepers are supported - the real beeper (call with is_tape==0)
  * and a `fake' beeper which lets you hear when a tape is being played.
@@ -1234,6 +1256,22 @@ void AY8910Update(int chip, INT16** buffer, int nNumSamples)
 	g_AY8910[chip].sound_frame();
 }
 
+// Render a block of nNumSamples, for all chips, which covers exactly nCycles of emulated time.
+// . buffer[] has 3 voice buffers per chip
+// . AY writes made after this block are kept for the next block
+void AY8910UpdateBlock(INT16** buffer, int nNumChips, int nNumSamples, UINT nCycles)
+{
+	sound_generator_framesiz = nNumSamples;
+
+	for (int chip=0; chip<nNumChips; chip++)
+	{
+		g_ppSoundBuffers = &buffer[chip*3];
+		g_AY8910[chip].sound_frame_span(nCycles);
+	}
+
+	g_uLastCumulativeCycles += nCycles;
+}
+
 void AY8910_InitAll(int nClock, int nSampleRate)
 {
 	for (UINT i=0; i<MAX_8910; i++)
@@ -11,6 +11,7 @@ void _AYWriteReg(int chip, int r, int v);
 //void AY8910_write_ym(int chip, int addr, int data);
 void AY8910_reset(int chip);
 void AY8910Update(int chip, INT16** buffer, int nNumSamples);
+void AY8910UpdateBlock(INT16** buffer, int nNumChips, int nNumSamples, UINT nCycles);
 
 void AY8910_InitAll(int nClock, int nSampleRate);
 void AY8910_InitClock(int nClock);
@@ -34,6 +35,9 @@ typedef SHORT libspectrum_signed_word;
  */
 #define AY_CHANGE_MAX		8000
 
+/* max. number of samples rendered in one run (between register changes) */
+#define AY_RUN_MAX			256
+
 class CAY8910
 {
 public:
@@ -46,6 +50,7 @@ public:
 	void sound_ay_write( int reg, int val, libspectrum_dword now );
 	void sound_ay_reset( void );
 	void sound_frame( void );
+	void sound_frame_span( libspectrum_dword span );
 	BYTE* GetAYRegsPtr( void ) { return &sound_ay_registers[0]; }
 	static void SetCLK( double CLK ) { m_fCurrentCLK_AY8910 = CLK; }
 	void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper, const std::string& suffix);
@@ -54,7 +59,8 @@ public:
 private:
 	void init( void );
 	void sound_end( void );
-	void sound_ay_overlay( void );
+	void sound_ay_overlay( int changes_due );
+	void sound_ay_run( libspectrum_signed_word** ppBuf, int run );
 
 private:
 	/* foo_subcycles are fixed-point with low 16 bits as fractional part.
@@ -86,6 +92,11 @@ private:
 	int noise_toggle;
 	int env_first, env_rev, env_counter;
 
+	// Per-sample state shared by the 3 channels during a run (see sound_ay_run())
+	unsigned int run_tone_count[AY_RUN_MAX];
+	unsigned int run_env_level[AY_RUN_MAX];
+	int run_noise_toggle[AY_RUN_MAX];
+
 	// Vars shared between all AY's
 	static double m_fCurrentCLK_AY8910;
 };
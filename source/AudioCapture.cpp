@@ -0,0 +1,243 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Offline audio capture
+ *
+ * Whilst capturing, each sound source renders its samples from emulated time only (ie. no
+ * ring-buffer drift-correction, and no short-cuts at full-speed), and submits them here.
+ * The timeline is in 44.1kHz frames of emulated time (from g_nCumulativeCycles) since the capture
+ * started. Each source has its own position on the timeline, which starts at the emulated time
+ * of its first submission and then just advances by the number of frames it submits.
+ * Samples are summed into a ring, and frames are written to the .wav file once they're
+ * kLatencyFrames behind the current emulated time, by when all sources have submitted them.
+ * Nothing here depends on host time, so the .wav file is the same whatever the host speed.
+ * A source's nominal sample rate must be exact (eg. the speaker's is CLK/23, not 44.1kHz), else it drifts
+ * away from emulated time and gets resynced (a glitch): so each source's lag is checked for the whole capture.
+ */
+
+#include "StdAfx.h"
+
+#include "AudioCapture.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Log.h"
+#include "Riff.h"
+#include "SoundMixer.h"
+
+static const UINT kRingFrames = 1 << 16;		// ~1.5 sec
+static const UINT kLatencyFrames = 1 << 13;		// ~186ms: max lag of any source behind emulated time
+static const UINT kFlushFrames = 4096;
+static const UINT kMaxLagFrames = kLatencyFrames / 4;	// A source further than this from emulated time is drifting
+
+struct CaptureSource
+{
+	bool bStarted;
+	double fPos;			// Timeline position (in frames) of the source's next sample
+	double fMaxLag;			// Max distance (in frames) of fPos from emulated time, after a submission
+	UINT nResyncs;
+	bool bDriftLogged;
+};
+
+static std::string g_filename;
+static bool g_bOpen = false;
+static bool g_bOpenFailed = false;
+
+static UINT64 g_uLastCycle = 0;
+static double g_fNowFrame = 0.0;		// Current emulated time (in frames)
+static UINT64 g_uFlushedFrames = 0;		// Frames written to the .wav file
+
+static CaptureSource g_sources[AUDIOCAPTURE_NUM_SOURCES];
+static int g_mixRing[kRingFrames * AUDIOCAPTURE_NUM_CHANNELS];
+static short g_flushBuffer[kFlushFrames * AUDIOCAPTURE_NUM_CHANNELS];
+
+//-----------------------------------------------------------------------------
+
+void AudioCapture_SetFilename(const std::string& filename)
+{
+	g_filename = filename;
+}
+
+// NB. Also true before the file is opened (ie. the sources should already render exactly)
+bool AudioCapture_IsActive(void)
+{
+	return !g_filename.empty() && !g_bOpenFailed;
+}
+
+static bool AudioCapture_Open(void)
+{
+	if (SoundMixer_GetSinkType() == MIXER_SINK_WAV)	// There's only one Riff writer
+	{
+		LogFileOutput("AudioCapture: not supported with -audio-wav\n");
+		g_bOpenFailed = true;
+		return false;
+	}
+
+	if (RiffInitWriteFile(g_filename.c_str(), AUDIOCAPTURE_SAMPLE_RATE, AUDIOCAPTURE_NUM_CHANNELS) != 0)
+	{
+		LogFileOutput("AudioCapture: failed to create .wav file: %s\n", g_filename.c_str());
+		g_bOpenFailed = true;
+		return false;
+	}
+
+	g_uLastCycle = g_nCumulativeCycles;
+	g_fNowFrame = 0.0;
+	g_uFlushedFrames = 0;
+
+	memset(g_sources, 0, sizeof(g_sources));
+	memset(g_mixRing, 0, sizeof(g_mixRing));
+
+	g_bOpen = true;
+	return true;
+}
+
+static UINT64 AudioCapture_GetNowFrame(void)
+{
+	// NB. Cycles go backwards when a save-state is loaded: the timeline then just waits for them
+	if (g_nCumulativeCycles > g_uLastCycle)
+		g_fNowFrame += (double)(g_nCumulativeCycles - g_uLastCycle) * AUDIOCAPTURE_SAMPLE_RATE / g_fCurrentCLK6502;
+
+	g_uLastCycle = g_nCumulativeCycles;
+	return (UINT64)g_fNowFrame;
+}
+
+// Write (and clear) all mixed frames before uEndFrame
+static void AudioCapture_Flush(const UINT64 uEndFrame)
+{
+	while (g_uFlushedFrames < uEndFrame)
+	{
+		const UINT uRingPos = (UINT)(g_uFlushedFrames % kRingFrames);
+		UINT nNumFrames = kRingFrames - uRingPos;
+		if (nNumFrames > kFlushFrames)
+			nNumFrames = kFlushFrames;
+		if (nNumFrames > uEndFrame - g_uFlushedFrames)
+			nNumFrames = (UINT)(uEndFrame - g_uFlushedFrames);
+
+		int* pMix = &g_mixRing[uRingPos * AUDIOCAPTURE_NUM_CHANNELS];
+		for (UINT i=0; i<nNumFrames*AUDIOCAPTURE_NUM_CHANNELS; i++)
+		{
+			int nData = pMix[i];
+			if (nData < -32768)
+				nData = -32768;
+			else if (nData > 32767)
+				nData = 32767;
+			g_flushBuffer[i] = (short)nData;
+			pMix[i] = 0;
+		}
+
+		RiffPutSamples(g_flushBuffer, nNumFrames);
+		g_uFlushedFrames += nNumFrames;
+	}
+}
+
+void AudioCapture_Stop(void)
+{
+	if (!g_bOpen)
+		return;
+
+	// Write out everything that's been submitted
+	UINT64 uEndFrame = g_uFlushedFrames;
+	for (UINT i=0; i<AUDIOCAPTURE_NUM_SOURCES; i++)
+	{
+		if (g_sources[i].bStarted && (UINT64)g_sources[i].fPos > uEndFrame)
+			uEndFrame = (UINT64)g_sources[i].fPos;
+	}
+	if (uEndFrame > g_uFlushedFrames + kRingFrames)
+		uEndFrame = g_uFlushedFrames + kRingFrames;
+
+	AudioCapture_Flush(uEndFrame);
+
+	for (UINT i=0; i<AUDIOCAPTURE_NUM_SOURCES; i++)
+	{
+		if (g_sources[i].bStarted)
+			LogFileOutput("AudioCapture: source %u: max lag = %.0f frames, resyncs = %u\n", i, g_sources[i].fMaxLag, g_sources[i].nResyncs);
+	}
+
+	RiffFinishWriteFile();
+	g_bOpen = false;
+}
+
+//-----------------------------------------------------------------------------
+
+// Add nNumFrames (mono or stereo, at fSampleRate) to the timeline at the source's current position
+// . fSampleRate: the source's exact rate in emulated time
+void AudioCapture_Submit(UINT source, const short* pSamples, UINT nNumFrames, UINT nNumChannels, const double fSampleRate)
+{
+	if (!AudioCapture_IsActive() || nNumFrames == 0)
+		return;
+
+	if (!g_bOpen && !AudioCapture_Open())
+		return;
+
+	_ASSERT(source < AUDIOCAPTURE_NUM_SOURCES);
+	if (source >= AUDIOCAPTURE_NUM_SOURCES)
+		return;
+
+	CaptureSource& src = g_sources[source];
+
+	const UINT64 uNowFrame = AudioCapture_GetNowFrame();
+	const double fStep = (double)AUDIOCAPTURE_SAMPLE_RATE / fSampleRate;	// Timeline frames per source frame
+
+	// (Re)sync the source to emulated time: for its first submission, or if it's drifted outside the ring
+	// (eg. the source was reset, or a save-state was loaded)
+	if (!src.bStarted || src.fPos < (double)g_uFlushedFrames || src.fPos > (double)(uNowFrame + kLatencyFrames))
+	{
+		if (src.bStarted)
+			src.nResyncs++;
+
+		const double fStart = (double)uNowFrame - (double)nNumFrames * fStep;
+		src.fPos = (fStart > (double)g_uFlushedFrames) ? fStart : (double)g_uFlushedFrames;
+		src.bStarted = true;
+	}
+
+	// Zero-order hold: each source frame covers the timeline frames up to the next source frame
+	for (UINT i=0; i<nNumFrames; i++)
+	{
+		const int nDataL = pSamples[i*nNumChannels];
+		const int nDataR = pSamples[i*nNumChannels + nNumChannels-1];
+
+		const UINT64 uBegin = (UINT64)src.fPos;
+		src.fPos += fStep;
+		const UINT64 uEnd = (UINT64)src.fPos;
+
+		for (UINT64 f=uBegin; f<uEnd && f-g_uFlushedFrames < kRingFrames; f++)
+		{
+			int* pMix = &g_mixRing[(f % kRingFrames) * AUDIOCAPTURE_NUM_CHANNELS];
+			pMix[0] += nDataL;
+			pMix[1] += nDataR;
+		}
+	}
+
+	// Each source submits all its samples up to (about) now, so it should stay in step with emulated time
+	const double fLag = fabs((double)uNowFrame - src.fPos);
+	if (fLag > src.fMaxLag)
+		src.fMaxLag = fLag;
+
+	if (fLag > kMaxLagFrames && !src.bDriftLogged)
+	{
+		LogFileOutput("AudioCapture: source %u is %.0f frames from emulated time (sample rate = %.2f Hz)\n", source, (double)uNowFrame - src.fPos, fSampleRate);
+		src.bDriftLogged = true;
+	}
+
+	if (uNowFrame > kLatencyFrames)
+		AudioCapture_Flush(uNowFrame - kLatencyFrames);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Offline (non-real-time) audio capture to a .wav file (see AudioCapture.cpp):
+// . each sound source submits exactly the samples it generated for the emulated time that has elapsed
+// . sources are mixed by their position on a common timeline of emulated time, not host time
+// . so the capture is sample-exact, and the emulator can run at full-speed whilst capturing
+
+enum AudioCaptureSource_e
+{
+	AUDIOCAPTURE_SPEAKER = 0,
+	AUDIOCAPTURE_MOCKINGBOARD,
+	AUDIOCAPTURE_SSI263,			// + SSI263 device# (0..3)
+	AUDIOCAPTURE_NUM_SOURCES = AUDIOCAPTURE_SSI263 + 4
+};
+
+const UINT AUDIOCAPTURE_SAMPLE_RATE = 44100;
+const UINT AUDIOCAPTURE_NUM_CHANNELS = 2;
+
+void AudioCapture_SetFilename(const std::string& filename);
+bool AudioCapture_IsActive(void);
+void AudioCapture_Stop(void);
+
+void AudioCapture_Submit(UINT source, const short* pSamples, UINT nNumFrames, UINT nNumChannels, const double fSampleRate);
@@ -0,0 +1,641 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Headless benchmark suite
+ *
+ * Each scenario is a setup (untimed) and a run (timed), and before every run the machine is reset,
+ * so that all runs start from the same state. Nothing is presented to the screen and nothing waits
+ * on host time: the CPU, video, disk & sound are run through the headless core.
+ * The speaker & Mockingboard are in pull mode, so their samples are rendered (and then discarded) without DirectSound.
+ *
+ * Scenarios:
+ * . cpu          : CpuSetupBenchmark()'s opcode mix
+ * . cpu-paging   : CpuSetupBenchmarkPaging()'s bank-switching (//e or above)
+ * . text/hgr/dhgr: NTSC render of whole frames, changing half of the video memory each frame
+ * . disk-woz     : read nibbles from the WOZ image in S6D1 for 1 sec of emulated time
+ * . mockingboard : write the AY8910 registers of the slot 4 Mockingboard for 1 sec of emulated time
+ * . savestate    : save-state to a temp file and load it back
+ * . boot         : reset, and run until the keyboard is polled (ie. a prompt or "press any key")
+ *
+ * Allocations are counted with the debug CRT's alloc hook, so are only reported by debug builds.
+ */
+
+#include "StdAfx.h"
+
+#include "Benchmark.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Interface.h"
+#include "Keyboard.h"
+#include "Log.h"
+#include "Memory.h"
+#include "Mockingboard.h"
+#include "SaveState.h"
+#include "Speaker.h"
+#include "Utilities.h"
+
+static const UINT64 kCpuCycles = 10*1000*1000;
+static const UINT kRenderFrames = 120;
+static const UINT kBootMaxFrames = 20*60;
+static const UINT kPromptReadsPerFrame = 500;	// A program polling for a key reads $C000 1000+ times per frame
+
+static std::string g_scenarios;
+static bool g_bRequested = false;
+static UINT g_uRepeat = 5;
+static UINT g_uWarmup = 1;
+static std::string g_jsonFilename;
+
+//-----------------------------------------------------------------------------
+
+void Benchmark_SetScenarios(const std::string& scenarios)
+{
+	g_scenarios = scenarios;
+	g_bRequested = true;
+}
+
+void Benchmark_SetRepeat(UINT repeat)
+{
+	g_uRepeat = repeat ? repeat : 1;
+}
+
+void Benchmark_SetWarmup(UINT warmup)
+{
+	g_uWarmup = warmup;
+}
+
+void Benchmark_SetJsonFilename(const std::string& filename)
+{
+	g_jsonFilename = filename;
+}
+
+bool Benchmark_IsRequested(void)
+{
+	return g_bRequested;
+}
+
+//-----------------------------------------------------------------------------
+
+template <class T>
+static T GetMedian(std::vector<T> values)
+{
+	if (values.empty())
+		return 0;
+
+	std::sort(values.begin(), values.end());
+	return values[values.size() / 2];
+}
+
+double BenchmarkResult::GetMedianSecs(void) const
+{
+	return GetMedian(runSecs);
+}
+
+double BenchmarkResult::GetMedianMHz(void) const
+{
+	const double secs = GetMedianSecs();
+	return secs > 0.0 ? (double)uCycles / secs / 1.e6 : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Pull (and discard) the sound rendered so far, as a headless frontend would
+static void PullAudio(void)
+{
+	static short buffer[4096];
+
+	while (Spkr_PullSamples(buffer, sizeof(buffer) / sizeof(buffer[0])))
+		;
+	while (MB_PullSamples(buffer, sizeof(buffer) / sizeof(buffer[0]) / 2))	// stereo
+		;
+}
+
+// Run the headless core in the same 1ms slices as CoreRunFrame()
+static void RunCoreForCycles(BenchmarkResult& result, const UINT64 uCycles)
+{
+	const DWORD uSliceCycles = (DWORD) (g_fCurrentCLK6502 * 0.001);
+	const UINT uFrameCount = CoreGetFrameCount();
+
+	while (result.uCycles < uCycles)
+	{
+		result.uCycles += CoreRunCycles(uSliceCycles);
+		PullAudio();
+	}
+
+	result.uFrames = CoreGetFrameCount() - uFrameCount;
+}
+
+static void LoadProgram(const BYTE* pCode, UINT uLen)
+{
+	MemWriteBlock(0x300, pCode, uLen);
+
+	regs.a  = 0;
+	regs.x  = 0;
+	regs.y  = 0;
+	regs.pc = 0x300;
+	regs.sp = 0x1FF;
+}
+
+static std::string CheckAppleIIeOrAbove(void)
+{
+	return IsAppleIIeOrAbove(GetApple2Type()) ? "" : "needs aux memory";
+}
+
+//-----------------------------------------------------------------------------
+
+static std::string RunCpu(BenchmarkResult& result)
+{
+	while (result.uCycles < kCpuCycles)
+		result.uCycles += CpuExecute(100000, true);
+
+	// If the program counter isn't in the expected range, then an opcode has gone wrong
+	if ((regs.pc < 0x300) || (regs.pc > 0x400))
+	{
+		char szError[64];
+		StringCbPrintf(szError, sizeof(szError), "PC=$%04X is outside of the benchmark code", regs.pc);
+		return szError;
+	}
+
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+
+// Two different frame buffers at $4000 & $6000, each of which have half of the bytes set to 0x14 and the other half set to 0xAA
+static void SetupRender(void)
+{
+	LPDWORD mem32 = (LPDWORD)MemGetMainPtr(0);
+	for (int loop = 4096; loop < 6144; loop++)
+		*(mem32 + loop) = ((loop & 1) ^ ((loop & 0x40) >> 6)) ? 0x14141414 : 0xAAAAAAAA;
+	for (int loop = 6144; loop < 8192; loop++)
+		*(mem32 + loop) = ((loop & 1) ^ ((loop & 0x40) >> 6)) ? 0xAAAAAAAA : 0x14141414;
+
+	if (IsAppleIIeOrAbove(GetApple2Type()))
+		memcpy(MemGetAuxPtr(0) + 0x4000, MemGetMainPtr(0x4000), 0x4000);
+}
+
+// Change half of the bytes in the video buffer each frame, to simulate the activity of an average game
+static void RenderFrames(BenchmarkResult& result, const uint32_t videoMode, const WORD addr, const UINT size)
+{
+	const bool bAux = (videoMode & VF_80COL) != 0;
+	LPBYTE pMem[2] = { MemGetMainPtr(0), bAux ? MemGetAuxPtr(0) : NULL };
+
+	for (UINT frame = 0; frame < kRenderFrames; frame++)
+	{
+		for (UINT i = 0; i < 2 && pMem[i]; i++)
+		{
+			if (frame & 1)
+				memset(pMem[i] + addr, 0x14, size);
+			else
+				memcpy(pMem[i] + addr, pMem[i] + ((frame & 2) ? 0x4000 : 0x6000), size);
+		}
+
+		GetVideo().VideoRefreshBuffer(videoMode, true);
+	}
+
+	result.uFrames = kRenderFrames;
+}
+
+static std::string RunRenderText(BenchmarkResult& result)
+{
+	RenderFrames(result, VF_TEXT, 0x400, 0x400);
+	return "";
+}
+
+static std::string RunRenderHGR(BenchmarkResult& result)
+{
+	RenderFrames(result, VF_HIRES, 0x2000, 0x2000);
+	return "";
+}
+
+static std::string RunRenderDHGR(BenchmarkResult& result)
+{
+	RenderFrames(result, VF_DHIRES | VF_HIRES | VF_80COL, 0x2000, 0x2000);
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+
+static std::string CheckDiskWOZ(void)
+{
+	if (GetCardMgr().QuerySlot(SLOT6) != CT_Disk2)
+		return "no Disk II in slot 6";
+
+	Disk2InterfaceCard& disk2Card = dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(SLOT6));
+	if (disk2Card.IsDriveEmpty(DRIVE_1) || !disk2Card.IsWozImageInDrive(DRIVE_1))
+		return "no WOZ image in S6D1";
+
+	return "";
+}
+
+static void SetupDiskWOZ(void)
+{
+	static const BYTE code[] =
+	{
+		0xAD,0xE9,0xC0,		// 0300: LDA $C0E9		; motor on
+		0xAD,0xEA,0xC0,		// 0303: LDA $C0EA		; drive 1
+		0xAD,0xEE,0xC0,		// 0306: LDA $C0EE		; read mode
+		0xAD,0xEC,0xC0,		// 0309: LDA $C0EC		; read data latch
+		0x10,0xFB,			// 030C: BPL $0309
+		0x4C,0x09,0x03,		// 030E: JMP $0309
+	};
+
+	LoadProgram(code, sizeof(code));
+}
+
+static std::string RunDiskWOZ(BenchmarkResult& result)
+{
+	RunCoreForCycles(result, (UINT64)g_fCurrentCLK6502);
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+
+static std::string CheckMockingboard(void)
+{
+	if (GetCardMgr().QuerySlot(SLOT4) != CT_MockingboardC && GetCardMgr().QuerySlot(SLOT4) != CT_Phasor)
+		return "no Mockingboard in slot 4";
+
+	return "";
+}
+
+static void SetupMockingboard(void)
+{
+	// Cycle through AY8910 regs 0..13 (of the 1st AY8910 in slot 4), writing a new value each time
+	static const BYTE code[] =
+	{
+		0xA9,0xFF,			// 0300: LDA #$FF
+		0x8D,0x03,0xC4,		// 0302: STA $C403		; DDRA
+		0x8D,0x02,0xC4,		// 0305: STA $C402		; DDRB
+		0xA2,0x00,			// 0308: LDX #0			; value
+		0xA0,0x00,			// 030A: LDY #0			; reg
+		0x8C,0x01,0xC4,		// 030C: STY $C401		; ORA = reg
+		0xA9,0x07,			// 030F: LDA #7
+		0x8D,0x00,0xC4,		// 0311: STA $C400		; ORB = latch address
+		0xA9,0x04,			// 0314: LDA #4
+		0x8D,0x00,0xC4,		// 0316: STA $C400		; ORB = inactive
+		0x8E,0x01,0xC4,		// 0319: STX $C401		; ORA = value
+		0xA9,0x06,			// 031C: LDA #6
+		0x8D,0x00,0xC4,		// 031E: STA $C400		; ORB = write
+		0xA9,0x04,			// 0321: LDA #4
+		0x8D,0x00,0xC4,		// 0323: STA $C400		; ORB = inactive
+		0xE8,				// 0326: INX
+		0xC8,				// 0327: INY
+		0xC0,0x0E,			// 0328: CPY #14
+		0xD0,0xE0,			// 032A: BNE $030C
+		0xF0,0xDC,			// 032C: BEQ $030A
+	};
+
+	LoadProgram(code, sizeof(code));
+}
+
+static std::string RunMockingboard(BenchmarkResult& result)
+{
+	RunCoreForCycles(result, (UINT64)g_fCurrentCLK6502);
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+
+static std::string GetSaveStatePathname(void)
+{
+	char szPath[MAX_PATH];
+	if (!GetTempPath(MAX_PATH, szPath))
+		return "";
+
+	return std::string(szPath) + "AppleWin-benchmark.yaml";
+}
+
+static std::string RunSaveState(BenchmarkResult& result)
+{
+	const std::string pathname = GetSaveStatePathname();
+	if (pathname.empty())
+		return "no temp path";
+
+	const std::string oldPathname = Snapshot_GetPathname();
+	Snapshot_SetFilename(pathname);
+
+	Snapshot_SaveState();
+	const bool bSaved = GetFileAttributes(pathname.c_str()) != INVALID_FILE_ATTRIBUTES;
+	if (bSaved)
+		Snapshot_LoadState();
+
+	Snapshot_SetFilename(oldPathname);
+	DeleteFile(pathname.c_str());
+
+	return bSaved ? "" : "failed to save " + pathname;
+}
+
+//-----------------------------------------------------------------------------
+
+static std::string RunBoot(BenchmarkResult& result)
+{
+	for (UINT frame = 0; frame < kBootMaxFrames; frame++)
+	{
+		const UINT uReadCount = KeybGetReadDataCount();
+		result.uCycles += CoreRunFrame();
+		result.uFrames++;
+		PullAudio();
+
+		if (KeybGetReadDataCount() - uReadCount >= kPromptReadsPerFrame)
+		{
+			result.nPromptFrame = (int)result.uFrames;
+			break;
+		}
+	}
+
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+
+struct Scenario
+{
+	const char* name;
+	std::string (*pCheck)(void);					// Optional: returns why this machine can't run the scenario
+	void (*pSetup)(void);							// Optional: untimed, before each run
+	std::string (*pRun)(BenchmarkResult& result);	// Timed: returns an error
+};
+
+static const Scenario g_scenarioTable[] =
+{
+	{ "cpu",			NULL,					CpuSetupBenchmark,			RunCpu },
+	{ "cpu-paging",		CheckAppleIIeOrAbove,	CpuSetupBenchmarkPaging,	RunCpu },
+	{ "text",			NULL,					SetupRender,				RunRenderText },
+	{ "hgr",			NULL,					SetupRender,				RunRenderHGR },
+	{ "dhgr",			CheckAppleIIeOrAbove,	SetupRender,				RunRenderDHGR },
+	{ "disk-woz",		CheckDiskWOZ,			SetupDiskWOZ,				RunDiskWOZ },
+	{ "mockingboard",	CheckMockingboard,		SetupMockingboard,			RunMockingboard },
+	{ "savestate",		NULL,					NULL,						RunSaveState },
+	{ "boot",			NULL,					NULL,						RunBoot },
+};
+
+static const UINT kNumScenarios = sizeof(g_scenarioTable) / sizeof(g_scenarioTable[0]);
+
+#ifdef _DEBUG
+static volatile LONG g_nAllocCount = 0;
+
+static int __cdecl Benchmark_AllocHook(int allocType, void* pUserData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+{
+	if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)
+		InterlockedIncrement(&g_nAllocCount);
+	return TRUE;
+}
+#endif
+
+static void Benchmark_RunScenario(const Scenario& scenario, BenchmarkResult& result)
+{
+	if (scenario.pCheck)
+	{
+		const std::string reason = scenario.pCheck();
+		if (!reason.empty())
+		{
+			result.status = "skipped: " + reason;
+			return;
+		}
+	}
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+
+	for (UINT i = 0; i < g_uWarmup + g_uRepeat; i++)
+	{
+		ResetMachineState();
+		if (scenario.pSetup)
+			scenario.pSetup();
+
+		result.uCycles = 0;
+		result.uFrames = 0;
+		result.nPromptFrame = -1;
+
+#ifdef _DEBUG
+		g_nAllocCount = 0;
+		_CRT_ALLOC_HOOK pOldHook = _CrtSetAllocHook(Benchmark_AllocHook);
+#endif
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+
+		const std::string error = scenario.pRun(result);
+
+		QueryPerformanceCounter(&end);
+#ifdef _DEBUG
+		_CrtSetAllocHook(pOldHook);
+#endif
+
+		if (!error.empty())
+		{
+			result.status = "error: " + error;
+			return;
+		}
+
+		if (i < g_uWarmup)
+			continue;
+
+		result.runSecs.push_back((double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart);
+#ifdef _DEBUG
+		result.runAllocs.push_back((UINT64)g_nAllocCount);
+		result.bAllocsValid = true;
+#endif
+	}
+
+	result.status = "ok";
+}
+
+bool Benchmark_Run(std::vector<BenchmarkResult>& results)
+{
+	_ASSERT(g_nAppMode == MODE_BENCHMARK);
+
+	// Comma separated names (or "all")
+	std::vector<std::string> names;
+	if (g_scenarios.empty() || g_scenarios == "all")
+	{
+		for (UINT i = 0; i < kNumScenarios; i++)
+			names.push_back(g_scenarioTable[i].name);
+	}
+	else
+	{
+		size_t pos = 0;
+		while (pos != std::string::npos)
+		{
+			const size_t comma = g_scenarios.find(',', pos);
+			names.push_back(g_scenarios.substr(pos, comma == std::string::npos ? comma : comma - pos));
+			pos = comma == std::string::npos ? comma : comma + 1;
+		}
+	}
+
+	bool bOK = true;
+
+	Spkr_SetPullMode(true);
+	MB_SetPullMode(true);
+
+	for (UINT n = 0; n < names.size(); n++)
+	{
+		BenchmarkResult result;
+		result.name = names[n];
+		result.status = "error: unknown scenario";
+
+		for (UINT i = 0; i < kNumScenarios; i++)
+		{
+			if (names[n] == g_scenarioTable[i].name)
+			{
+				Benchmark_RunScenario(g_scenarioTable[i], result);
+				break;
+			}
+		}
+
+		if (result.IsOK())
+			LogFileOutput("Benchmark: %s: %.3f ms, %.2f MHz, %u frames\n", result.name.c_str(), result.GetMedianSecs() * 1.e3, result.GetMedianMHz(), result.uFrames);
+		else
+			LogFileOutput("Benchmark: %s: %s\n", result.name.c_str(), result.status.c_str());
+
+		if (result.status.find("error") == 0)
+			bOK = false;
+
+		results.push_back(result);
+	}
+
+	Spkr_SetPullMode(false);
+	MB_SetPullMode(false);
+
+	ResetMachineState();
+	return bOK;
+}
+
+//-----------------------------------------------------------------------------
+
+// Escape a string for use inside a JSON "..." value (scenario names come from the cmd-line)
+static std::string JsonEscape(const std::string& str)
+{
+	std::string out;
+	for (size_t i = 0; i < str.size(); i++)
+	{
+		const unsigned char c = str[i];
+		switch (c)
+		{
+		case '"':  out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (c < 0x20)
+			{
+				char hex[8];
+				StringCbPrintf(hex, sizeof(hex), "\\u%04X", c);
+				out += hex;
+			}
+			else
+			{
+				out += c;
+			}
+		}
+	}
+	return out;
+}
+
+static void WriteJsonStats(FILE* fp, const char* key, const std::vector<double>& values)
+{
+	if (values.empty())
+	{
+		fprintf(fp, "      \"%s\": null,\n", key);
+		return;
+	}
+
+	std::vector<double> sorted = values;
+	std::sort(sorted.begin(), sorted.end());
+	fprintf(fp, "      \"%s\": { \"min\": %.3f, \"median\": %.3f, \"max\": %.3f },\n", key, sorted.front(), sorted[sorted.size() / 2], sorted.back());
+}
+
+static bool Benchmark_WriteJson(const std::vector<BenchmarkResult>& results)
+{
+	FILE* fp = fopen(g_jsonFilename.c_str(), "w");
+	if (!fp)
+	{
+		LogFileOutput("Benchmark: failed to create JSON file: %s\n", g_jsonFilename.c_str());
+		return false;
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"version\": \"%s\",\n", JsonEscape(VERSIONSTRING).c_str());
+	fprintf(fp, "  \"apple2Type\": \"0x%04X\",\n", (UINT)GetApple2Type());
+	fprintf(fp, "  \"repeat\": %u,\n", g_uRepeat);
+	fprintf(fp, "  \"warmup\": %u,\n", g_uWarmup);
+	fprintf(fp, "  \"scenarios\": [\n");
+
+	for (UINT n = 0; n < results.size(); n++)
+	{
+		const BenchmarkResult& result = results[n];
+
+		std::vector<double> ms, mhz, nsPerFrame, allocs;
+		for (UINT i = 0; i < result.runSecs.size(); i++)
+		{
+			const double secs = result.runSecs[i];
+			ms.push_back(secs * 1.e3);
+			if (result.uCycles && secs > 0.0)
+				mhz.push_back((double)result.uCycles / secs / 1.e6);
+			if (result.uFrames)
+				nsPerFrame.push_back(secs * 1.e9 / result.uFrames);
+		}
+		for (UINT i = 0; i < result.runAllocs.size(); i++)
+			allocs.push_back((double)result.runAllocs[i]);
+
+		fprintf(fp, "    {\n");
+		fprintf(fp, "      \"name\": \"%s\",\n", JsonEscape(result.name).c_str());
+		fprintf(fp, "      \"status\": \"%s\",\n", JsonEscape(result.status).c_str());
+		fprintf(fp, "      \"cycles\": %llu,\n", result.uCycles);
+		fprintf(fp, "      \"frames\": %u,\n", result.uFrames);
+		WriteJsonStats(fp, "ms", ms);
+		WriteJsonStats(fp, "mhz", mhz);
+		WriteJsonStats(fp, "ns_per_frame", nsPerFrame);
+		WriteJsonStats(fp, "allocations", result.bAllocsValid ? allocs : std::vector<double>());
+		if (result.nPromptFrame >= 0)
+			fprintf(fp, "      \"prompt_frame\": %d\n", result.nPromptFrame);
+		else
+			fprintf(fp, "      \"prompt_frame\": null\n");
+		fprintf(fp, "    }%s\n", n+1 < results.size() ? "," : "");
+	}
+
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+
+	fclose(fp);
+	return true;
+}
+
+// For the -benchmark cmd line switch
+bool Benchmark_RunFromCmdLine(void)
+{
+	const AppMode_e oldAppMode = g_nAppMode;
+	g_nAppMode = MODE_BENCHMARK;
+
+	std::vector<BenchmarkResult> results;
+	bool bOK = Benchmark_Run(results);
+
+	g_nAppMode = oldAppMode;
+
+	if (!g_jsonFilename.empty())
+		bOK &= Benchmark_WriteJson(results);
+
+	return bOK;
+}
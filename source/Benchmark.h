@@ -0,0 +1,39 @@
+#pragma once
+
+// Headless benchmark suite (see Benchmark.cpp):
+// . named scenarios run on the headless core (CoreRunCycles/CoreRunFrame), timed with the performance counter
+// . each scenario is run 'warmup' times (discarded), then 'repeat' times (reported)
+// . results can be written as JSON, so runs can be diffed across releases
+
+struct BenchmarkResult
+{
+	BenchmarkResult(void)
+	{
+		uCycles = 0;
+		uFrames = 0;
+		nPromptFrame = -1;
+		bAllocsValid = false;
+	}
+
+	std::string name;
+	std::string status;				// "ok", or "skipped: <reason>", "error: <reason>"
+	UINT64 uCycles;					// Emulated cycles per run
+	UINT uFrames;					// Video frames per run
+	int nPromptFrame;				// boot: frame that the keyboard was first polled (or -1)
+	bool bAllocsValid;				// Allocation counts need the debug CRT
+	std::vector<double> runSecs;	// Host time of each (non-warmup) run
+	std::vector<UINT64> runAllocs;	// Heap allocations of each (non-warmup) run
+
+	bool IsOK(void) const { return status == "ok"; }
+	double GetMedianSecs(void) const;
+	double GetMedianMHz(void) const;
+};
+
+void Benchmark_SetScenarios(const std::string& scenarios);	// Comma separated, or "all"
+void Benchmark_SetRepeat(UINT repeat);
+void Benchmark_SetWarmup(UINT warmup);
+void Benchmark_SetJsonFilename(const std::string& filename);
+bool Benchmark_IsRequested(void);
+
+bool Benchmark_Run(std::vector<BenchmarkResult>& results);	// Pre: g_nAppMode == MODE_BENCHMARK
+bool Benchmark_RunFromCmdLine(void);
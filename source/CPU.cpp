@@ -98,6 +98,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "SynchronousEventManager.h"
 #include "NTSC.h"
 #include "Log.h"
+#include "Rewind.h"
+#include "Debugger/Debug.h"
 
 #include "z80emu.h"
 #include "Z80VICE/z80.h"
@@ -130,11 +132,10 @@ static ULONG g_nCyclesExecuted;	// # of cycles executed up to last IO access
 // Assume all interrupt sources assert until the device is told to stop:
 // - eg by r/w to device's register or a machine reset
 
-static bool g_bCritSectionValid = false;	// Deleting CritialSection when not valid causes crash on Win98
-static CRITICAL_SECTION g_CriticalSection;	// To guard /g_bmIRQ/ & /g_bmNMI/
-static volatile UINT32 g_bmIRQ = 0;
-static volatile UINT32 g_bmNMI = 0;
-static volatile BOOL g_bNmiFlank = FALSE; // Positive going flank on NMI line
+// NB. Only modified with Interlocked ops (see cpu_interrupts.inl)
+static volatile LONG g_bmIRQ = 0;
+static volatile LONG g_bmNMI = 0;
+static volatile LONG g_bNmiFlank = FALSE; // Positive going flank on NMI line
 
 static bool g_irqDefer1Opcode = false;
 static bool g_interruptInLastExecutionBatch = false;	// Last batch of executed cycles included an interrupt (IRQ/NMI)
@@ -208,6 +209,8 @@ bool IsInterruptInLastExecution(void)
 
 #include "CPU/cpu_general.inl"
 #include "CPU/cpu_instructions.inl"
+#include "CPU/cpu_blockcache.inl"
+#include "CPU/cpu_batch.inl"
 
 /****************************************************************************
 *
@@ -363,8 +366,9 @@ static __forceinline void Fetch(BYTE& iOpcode, ULONG uExecutedCycles)
 #endif
 
 	iOpcode = ((PC & 0xF000) == 0xC000)
-	    ? IORead[(PC>>4) & 0xFF](PC,PC,0,0,uExecutedCycles)	// Fetch opcode from I/O memory, but params are still from mem[]
-		: *(mem+PC);
+	    ? (Batch_OnIoAccess(uExecutedCycles),
+		   IORead[(PC>>4) & 0xFF](PC,PC,0,0,uExecutedCycles))	// Fetch opcode from I/O memory, but params are still from memread[]
+		: MemReadByte(PC);
 
 #ifdef USE_SPEECH_API
 	if ((PC == COUT1 || PC == BASICOUT) && g_Speech.IsEnabled() && !g_bFullSpeed)
@@ -382,16 +386,16 @@ static __forceinline bool NMI(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 		return false;
 
 	// NMI signals are only serviced once
-	g_bNmiFlank = FALSE;
+	InterlockedExchange(&g_bNmiFlank, FALSE);
 #ifdef _DEBUG
 	g_nCycleIrqStart = g_nCumulativeCycles + uExecutedCycles;
 #endif
-	PUSH(regs.pc >> 8)
-	PUSH(regs.pc & 0xFF)
+	_PUSH(regs.pc >> 8)
+	_PUSH(regs.pc & 0xFF)
 	EF_TO_AF
-	PUSH(regs.ps & ~AF_BREAK)
+	_PUSH(regs.ps & ~AF_BREAK)
 	regs.ps = regs.ps | AF_INTERRUPT & ~AF_DECIMAL;
-	regs.pc = * (WORD*) (mem+0xFFFA);
+	regs.pc = MemReadWord(0xFFFA);
 	UINT uExtraCycles = 0;	// Needed for CYC(a) macro
 	CYC(7);
 	g_interruptInLastExecutionBatch = true;
@@ -429,12 +433,12 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #ifdef _DEBUG
 		g_nCycleIrqStart = g_nCumulativeCycles + uExecutedCycles;
 #endif
-		PUSH(regs.pc >> 8)
-		PUSH(regs.pc & 0xFF)
+		_PUSH(regs.pc >> 8)
+		_PUSH(regs.pc & 0xFF)
 		EF_TO_AF
-		PUSH(regs.ps & ~AF_BREAK)
+		_PUSH(regs.ps & ~AF_BREAK)
 		regs.ps = (regs.ps | AF_INTERRUPT) & (~AF_DECIMAL);
-		regs.pc = * (WORD*) (mem+0xFFFE);
+		regs.pc = MemReadWord(0xFFFE);
 		UINT uExtraCycles = 0;	// Needed for CYC(a) macro
 		CYC(7);
 #if defined(_DEBUG) && LOG_IRQ_TAKEN_AND_RTI
@@ -459,6 +463,10 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #define READ _READ_WITH_IO_F8xx
 #define WRITE(value) _WRITE_WITH_IO_F8xx(value)
 #define HEATMAP_X(address)
+#define HEATMAP_R(address) ((void)0)
+#define HEATMAP_W(address) ((void)0)
+#define BATCH_X(cpu, uExecutedCycles, uTotalCycles, uBatchOpcodes) Batch_Begin(cpu, uExecutedCycles, uTotalCycles, uBatchOpcodes)
+#define BREAKPOINT_X() false
 
 #include "CPU/cpu6502.h"  // MOS 6502
 
@@ -475,6 +483,10 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef HEATMAP_R
+#undef HEATMAP_W
+#undef BATCH_X
+#undef BREAKPOINT_X
 
 //-----------------
 
@@ -482,6 +494,10 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #define WRITE(value) Heatmap_WriteByte_With_IO_F8xx(addr, value, uExecutedCycles);
 
 #define HEATMAP_X(address) Heatmap_X(address)
+#define HEATMAP_R(address) Heatmap_Access_R(address)	// stack & pointer accesses (see cpu_general.inl)
+#define HEATMAP_W(address) Heatmap_Access_W(address)
+#define BATCH_X(cpu, uExecutedCycles, uTotalCycles, uBatchOpcodes) (uExecutedCycles)	// debugger needs per-opcode breakpoint checks
+#define BREAKPOINT_X() Breakpoint_X(uExecutedCycles, flagc, flagn, flagv, flagz)	// ... which can end a batch early
 
 #include "CPU/cpu_heatmap.inl"
 
@@ -504,12 +520,25 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef HEATMAP_R
+#undef HEATMAP_W
+#undef BATCH_X
+#undef BREAKPOINT_X
 
 //===========================================================================
 
+// Set whilst the debugger's BACK re-executes from a rewind snapshot (in MODE_DEBUG):
+// the non-debug core is used, so the heatmap & breakpoints don't see the re-execution
+static bool g_bCpuReExecution = false;
+
+void CpuSetReExecution(const bool bReExecution)
+{
+	g_bCpuReExecution = bReExecution;
+}
+
 static DWORD InternalCpuExecute(const DWORD uTotalCycles, const bool bVideoUpdate)
 {
-	if (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK)
+	if (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK || g_bCpuReExecution)
 	{
 		if (GetMainCpu() == CPU_6502)
 			return Cpu6502(uTotalCycles, bVideoUpdate);		// Apple ][, ][+, //e, Clones
@@ -557,17 +586,6 @@ void CpuWrite(USHORT addr, BYTE value, ULONG uExecutedCycles)
 
 //===========================================================================
 
-void CpuDestroy ()
-{
-	if (g_bCritSectionValid)
-	{
-  		DeleteCriticalSection(&g_CriticalSection);
-		g_bCritSectionValid = false;
-	}
-}
-
-//===========================================================================
-
 // Description:
 //	Call this when an IO-reg is accessed & accurate cycle info is needed
 //  NB. Safe to call multiple times from the same IO function handler (as 'nExecutedCycles - g_nCyclesExecuted' will be zero the 2nd time)
@@ -645,13 +663,10 @@ DWORD CpuExecute(const DWORD uCycles, const bool bVideoUpdate)
 
 void CpuInitialize ()
 {
-	CpuDestroy();
 	regs.a = regs.x = regs.y = regs.ps = 0xFF;
 	regs.sp = 0x01FF;
 	CpuReset();	// Init's ps & pc. Updates sp
 
-	InitializeCriticalSection(&g_CriticalSection);
-	g_bCritSectionValid = true;
 	CpuIrqReset();
 	CpuNmiReset();
 
@@ -675,17 +690,18 @@ void CpuSetupBenchmark ()
 		int opcode = 0;
 		do
 		{
-			*(mem+addr++) = benchopcode[opcode];
-			*(mem+addr++) = benchopcode[opcode];
+			MemWriteByte(addr++, benchopcode[opcode]);
+			MemWriteByte(addr++, benchopcode[opcode]);
 
 			if (opcode >= SHORTOPCODES)
-				*(mem+addr++) = 0;
+				MemWriteByte(addr++, 0);
 
 			if ((++opcode >= BENCHOPCODES) || ((addr & 0x0F) >= 0x0B))
 			{
-				*(mem+addr++) = 0x4C;
-				*(mem+addr++) = (opcode >= BENCHOPCODES) ? 0x00 : ((addr >> 4)+1) << 4;
-				*(mem+addr++) = 0x03;
+				MemWriteByte(addr++, 0x4C);
+				const BYTE jmpLo = (opcode >= BENCHOPCODES) ? 0x00 : ((addr >> 4)+1) << 4;
+				MemWriteByte(addr++, jmpLo);
+				MemWriteByte(addr++, 0x03);
 				while (addr & 0x0F)
 					++addr;
 			}
@@ -695,57 +711,42 @@ void CpuSetupBenchmark ()
 
 //===========================================================================
 
-void CpuIrqReset()
+// Page-flipping workload, typical of double-hires games: bank-switch with 80STORE+PAGE2, RAMWRT & ALTZP between every store
+// . Requires aux memory (//e or above)
+// . Leaves the soft-switches in a mixed state, so caller must restore the memory & video modes
+void CpuSetupBenchmarkPaging ()
 {
-	_ASSERT(g_bCritSectionValid);
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	g_bmIRQ = 0;
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
-}
-
-void CpuIrqAssert(eIRQSRC Device)
-{
-	_ASSERT(g_bCritSectionValid);
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	g_bmIRQ |= 1<<Device;
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
-}
+	regs.a  = 0;
+	regs.x  = 0;
+	regs.y  = 0;
+	regs.pc = 0x300;
+	regs.sp = 0x1FF;
 
-void CpuIrqDeassert(eIRQSRC Device)
-{
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	g_bmIRQ &= ~(1<<Device);
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
+	static const BYTE code[] =
+	{
+		0x8D,0x01,0xC0,		// 0300: STA $C001		; 80STORE on
+		0x8D,0x57,0xC0,		// 0303: STA $C057		; HIRES on
+		0xA2,0x00,			// 0306: LDX #0
+		0x8D,0x55,0xC0,		// 0308: STA $C055		; PAGE2 on  (hires page1 = aux)
+		0x9D,0x00,0x20,		// 030B: STA $2000,X
+		0x8D,0x54,0xC0,		// 030E: STA $C054		; PAGE2 off (hires page1 = main)
+		0x9D,0x00,0x20,		// 0311: STA $2000,X
+		0x8D,0x05,0xC0,		// 0314: STA $C005		; RAMWRT on
+		0x9D,0x00,0x40,		// 0317: STA $4000,X
+		0x8D,0x04,0xC0,		// 031A: STA $C004		; RAMWRT off
+		0x8D,0x09,0xC0,		// 031D: STA $C009		; ALTZP on
+		0x95,0x80,			// 0320: STA $80,X
+		0x8D,0x08,0xC0,		// 0322: STA $C008		; ALTZP off
+		0xE8,				// 0325: INX
+		0x4C,0x08,0x03,		// 0326: JMP $0308
+	};
+
+	MemWriteBlock(0x300, code, sizeof(code));
 }
 
 //===========================================================================
 
-void CpuNmiReset()
-{
-	_ASSERT(g_bCritSectionValid);
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	g_bmNMI = 0;
-	g_bNmiFlank = FALSE;
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
-}
-
-void CpuNmiAssert(eIRQSRC Device)
-{
-	_ASSERT(g_bCritSectionValid);
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	if (g_bmNMI == 0) // NMI line is just becoming active
-	    g_bNmiFlank = TRUE;
-	g_bmNMI |= 1<<Device;
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
-}
-
-void CpuNmiDeassert(eIRQSRC Device)
-{
-	_ASSERT(g_bCritSectionValid);
-	if (g_bCritSectionValid) EnterCriticalSection(&g_CriticalSection);
-	g_bmNMI &= ~(1<<Device);
-	if (g_bCritSectionValid) LeaveCriticalSection(&g_CriticalSection);
-}
+#include "CPU/cpu_interrupts.inl"
 
 //===========================================================================
 
@@ -753,7 +754,7 @@ void CpuReset()
 {
 	// 7 cycles
 	regs.ps = (regs.ps | AF_INTERRUPT) & ~AF_DECIMAL;
-	regs.pc = * (WORD*) (mem+0xFFFC);
+	regs.pc = MemReadWord(0xFFFC);
 	regs.sp = 0x0100 | ((regs.sp - 3) & 0xFF);
 
 	regs.bJammed = 0;
@@ -829,3 +830,22 @@ void CpuLoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
 
 	yamlLoadHelper.PopMap();
 }
+
+//===========================================================================
+
+void CpuSaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(regs);
+	buffer.Save(g_nCumulativeCycles);
+	buffer.Save(g_irqDefer1Opcode);
+}
+
+// NB. IRQ/NMI lines are left as-is, since they're driven by the (non-rewound) cards
+void CpuLoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(regs);
+	buffer.Load(g_nCumulativeCycles);
+	buffer.Load(g_irqDefer1Opcode);
+
+	SetActiveCpu(GetMainCpu());
+}
@@ -28,12 +28,14 @@ enum {
 extern regsrec    regs;
 extern unsigned __int64 g_nCumulativeCycles;
 
-void    CpuDestroy ();
 void    CpuCalcCycles(ULONG nExecutedCycles);
 DWORD   CpuExecute(const DWORD uCycles, const bool bVideoUpdate);
 ULONG   CpuGetCyclesThisVideoFrame(ULONG nExecutedCycles);
 void    CpuInitialize ();
 void    CpuSetupBenchmark ();
+void    CpuSetupBenchmarkPaging ();
+void    CpuBlockCacheFlush(void);
+void    CpuSetReExecution(const bool bReExecution);
 void	CpuIrqReset();
 void	CpuIrqAssert(eIRQSRC Device);
 void	CpuIrqDeassert(eIRQSRC Device);
@@ -43,6 +45,8 @@ void	CpuNmiDeassert(eIRQSRC Device);
 void    CpuReset ();
 void    CpuSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    CpuLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
+void    CpuSaveRewind(class RewindBuffer& buffer);
+void    CpuLoadRewind(class RewindBuffer& buffer);
 
 BYTE	CpuRead(USHORT addr, ULONG uExecutedCycles);
 void	CpuWrite(USHORT addr, BYTE value, ULONG uExecutedCycles);
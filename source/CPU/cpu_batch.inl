@@ -0,0 +1,103 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: 6502/65C02 batched execution
+ *
+ * For full-speed (!bVideoUpdate) execution, opcodes are run back-to-back until the next sync-event
+ * is due, with only one call to CheckSynchronousInterruptSources() & IRQ() at the end of the batch.
+ *
+ * While an IRQ is asserted, the IRQ must be taken on the opcode after the one that unmasks it (CLI/PLP/RTI).
+ * So then a batch is only started if the IRQ is masked, and is limited to the block from the block cache
+ * (see cpu_blockcache.inl), which ends on those opcodes.
+ *
+ * A batch ends early (after the current opcode) when:
+ * . an I/O address is accessed - as the I/O handler may assert an IRQ, change paging, or (re)schedule a sync-event
+ * . CpuIrqAssert() or CpuNmiAssert() is called - eg. from the SSC's comms thread
+ * Before an I/O handler runs, the sync-events are brought up to the start of the opcode, so the
+ * emulated h/w sees exactly the same state & timing as when the checks are done after every opcode.
+ *
+ * Author: Various
+ */
+
+static bool g_bBatchActive = false;
+static volatile LONG g_bBatchExit = FALSE;	// Set by I/O access & CpuIrqAssert()/CpuNmiAssert()
+static ULONG g_uBatchSyncedCycles = 0;		// Sync-events have been updated up to this cycle
+
+// Returns the cycle at which the batch must end (if it returns uExecutedCycles, then just run 1 opcode)
+// . uBatchOpcodes: set to the max # of opcodes in the batch
+static __forceinline ULONG Batch_Begin(const eCpuType cpu, const ULONG uExecutedCycles, const ULONG uTotalCycles, UINT& uBatchOpcodes)
+{
+	// NB. Clear (with a full barrier) before reading g_bmIRQ, as CpuIrqAssert() on another thread sets g_bmIRQ then g_bBatchExit
+	InterlockedExchange(&g_bBatchExit, FALSE);
+
+	if (g_bNmiFlank)
+		return uExecutedCycles;
+
+	uBatchOpcodes = 0xFFFFFFFF;	// no limit
+
+	if (g_bmIRQ)
+	{
+		// Only a masked IRQ allows a batch, and then just of the block at PC (which can't unmask it)
+		if (!(regs.ps & AF_INTERRUPT))
+			return uExecutedCycles;
+
+		uBatchOpcodes = BlockCache_GetOpcodes(regs.pc, cpu);
+		if (uBatchOpcodes == 1)
+			return uExecutedCycles;
+	}
+
+	const int cyclesUntilEvent = g_SynchronousEventMgr.GetCyclesUntilNextEvent();
+	if (cyclesUntilEvent <= 0)
+		return uExecutedCycles;
+
+	g_bBatchActive = true;
+	g_uBatchSyncedCycles = uExecutedCycles;
+
+	// Stop the batch on the opcode that reaches the event (as it would have fired after that opcode)
+	if ((ULONG)cyclesUntilEvent < uTotalCycles - uExecutedCycles)
+		return uExecutedCycles + cyclesUntilEvent;
+
+	return uTotalCycles;
+}
+
+// Returns the cycle that the sync-events have been updated up to
+static __forceinline ULONG Batch_End(const ULONG uPreviousCycles)
+{
+	if (!g_bBatchActive)
+		return uPreviousCycles;
+
+	g_bBatchActive = false;
+	return g_uBatchSyncedCycles;
+}
+
+// Called by _READ & _WRITE before the I/O handler
+static __forceinline void Batch_OnIoAccess(const ULONG uExecutedCycles)
+{
+	if (!g_bBatchActive)
+		return;
+
+	// No event can be due yet, as the batch ends on the opcode that reaches the next event
+	g_SynchronousEventMgr.Update(uExecutedCycles - g_uBatchSyncedCycles, uExecutedCycles);
+	g_uBatchSyncedCycles = uExecutedCycles;
+	g_bBatchExit = TRUE;
+}
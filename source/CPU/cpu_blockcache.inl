@@ -0,0 +1,211 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: 6502/65C02 block cache
+ *
+ * Caches the # of opcodes in the straight-line basic-block that starts at each address.
+ * A block ends on flow control and on CLI/PLP/RTI, so no opcode in a block can unmask an IRQ.
+ *
+ * Used by Batch_Begin() when an IRQ is asserted but masked (eg. while a Mockingboard/mouse/SSC
+ * interrupt handler runs, before it acks the device): a full batch isn't possible then, as the
+ * IRQ must be taken on the opcode after the one that clears the I flag, but a block can still be
+ * run back-to-back with only one call to CheckSynchronousInterruptSources() & IRQ() at the end.
+ *
+ * Author: Various
+ */
+
+/****************************************************************************
+*
+*  BLOCK DECODE TABLES
+*
+***/
+
+// Opcode length (bits 1:0) and how the opcode affects the block
+enum
+{
+	BLOCK_LEN_MASK = 0x03,
+	BLOCK_END = 0x04,	// flow control (or may unmask IRQs, ie. CLI/PLP/RTI): the last opcode in a block
+	BLOCK_ABS = 0x08,	// abs: the operand mustn't be an I/O address
+	BLOCK_ABSXY = 0x10,	// abs,X or abs,Y: none of operand..operand+$FF can be an I/O address
+};
+
+// xx: may write anywhere (eg. indirect modes) or access I/O, or is BRK/invalid: never part of a block
+#define xx	0
+#define I1	(1)
+#define E1	(1|BLOCK_END)
+#define Z2	(2)
+#define E2	(2|BLOCK_END)
+#define A3	(3|BLOCK_ABS)
+#define X3	(3|BLOCK_ABSXY)
+#define E3	(3|BLOCK_END)
+
+static const BYTE g_aBlockInfo6502[256] =
+{
+//	x0 x1 x2 x3 x4 x5 x6 x7 x8 x9 xA xB xC xD xE xF
+	xx,xx,xx,xx,xx,Z2,Z2,xx,I1,Z2,I1,xx,xx,A3,A3,xx,	// 0x
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,xx,xx,xx,X3,X3,xx,	// 1x
+	E3,xx,xx,xx,Z2,Z2,Z2,xx,E1,Z2,I1,xx,A3,A3,A3,xx,	// 2x
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,xx,xx,xx,X3,X3,xx,	// 3x
+	E1,xx,xx,xx,xx,Z2,Z2,xx,I1,Z2,I1,xx,E3,A3,A3,xx,	// 4x
+	E2,xx,xx,xx,xx,Z2,Z2,xx,E1,X3,xx,xx,xx,X3,X3,xx,	// 5x
+	E1,xx,xx,xx,xx,Z2,Z2,xx,I1,Z2,I1,xx,E3,A3,A3,xx,	// 6x
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,xx,xx,xx,X3,X3,xx,	// 7x
+	xx,xx,xx,xx,Z2,Z2,Z2,xx,I1,xx,I1,xx,A3,A3,A3,xx,	// 8x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,xx,X3,xx,xx,	// 9x
+	Z2,xx,Z2,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Ax
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,X3,X3,X3,xx,	// Bx
+	Z2,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Cx
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,xx,xx,xx,X3,X3,xx,	// Dx
+	Z2,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Ex
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,xx,xx,xx,X3,X3,xx,	// Fx
+};
+
+static const BYTE g_aBlockInfo65C02[256] =
+{
+//	x0 x1 x2 x3 x4 x5 x6 x7 x8 x9 xA xB xC xD xE xF
+	xx,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// 0x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,A3,X3,X3,xx,	// 1x
+	E3,xx,xx,xx,Z2,Z2,Z2,xx,E1,Z2,I1,xx,A3,A3,A3,xx,	// 2x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,X3,X3,X3,xx,	// 3x
+	E1,xx,xx,xx,xx,Z2,Z2,xx,I1,Z2,I1,xx,E3,A3,A3,xx,	// 4x
+	E2,xx,xx,xx,xx,Z2,Z2,xx,E1,X3,I1,xx,xx,X3,X3,xx,	// 5x
+	E1,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,E3,A3,A3,xx,	// 6x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,E3,X3,X3,xx,	// 7x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// 8x
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,A3,X3,X3,xx,	// 9x
+	Z2,xx,Z2,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Ax
+	E2,xx,xx,xx,Z2,Z2,Z2,xx,I1,X3,I1,xx,X3,X3,X3,xx,	// Bx
+	Z2,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Cx
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,I1,xx,xx,X3,X3,xx,	// Dx
+	Z2,xx,xx,xx,Z2,Z2,Z2,xx,I1,Z2,I1,xx,A3,A3,A3,xx,	// Ex
+	E2,xx,xx,xx,xx,Z2,Z2,xx,I1,X3,I1,xx,xx,X3,X3,xx,	// Fx
+};
+
+#undef xx
+#undef I1
+#undef E1
+#undef Z2
+#undef E2
+#undef A3
+#undef X3
+#undef E3
+
+/****************************************************************************
+*
+*  BLOCK CACHE
+*
+***/
+
+static const UINT kMaxBlockOpcodes = 64;
+
+static BYTE g_blockOpcodes[0x10000];		// # opcodes in the block starting at this address
+static UINT g_blockTag[0x10000];			// block is valid when tag == g_blockPageTag[page]
+static UINT g_blockPageTag[256];
+static LPBYTE g_blockPageSrc[256];			// memread[page] when the page's blocks were decoded
+static eCpuType g_blockCacheCpu = CPU_UNKNOWN;	// NB. 1st lookup flushes, so all tags are then non-zero
+
+// Call after memory is modified without setting memdirty[] (eg. loading a save-state or rewind snapshot)
+void CpuBlockCacheFlush(void)
+{
+	for (UINT page = 0; page < 256; page++)
+		g_blockPageTag[page]++;
+}
+
+static __forceinline bool IsBlockIoPage(const BYTE page, const eCpuType cpu)
+{
+	return (page & 0xF0) == 0xC0 || (cpu == CPU_6502 && page >= 0xF8);	// 6502: $F800-FFFF can be IO_F8xx (GH#827)
+}
+
+static BYTE DecodeBlock(WORD pc, const eCpuType cpu)
+{
+	const BYTE page = pc >> 8;
+
+	// Page0 & page1 (stack) can be modified without going through _WRITE (eg. PUSH) or by any ZP opcode
+	if (page <= 1 || (page & 0xF0) == 0xC0)
+		return 1;
+
+	const BYTE* pPage = memread[page];
+	const BYTE* pInfo = (cpu == CPU_6502) ? g_aBlockInfo6502 : g_aBlockInfo65C02;
+	UINT uOpcodes = 0;
+
+	while (uOpcodes < kMaxBlockOpcodes)
+	{
+		const BYTE offset = pc & 0xFF;
+		const BYTE info = pInfo[pPage[offset]];
+		const UINT len = info & BLOCK_LEN_MASK;
+		if (len == 0 || offset + len > 0x100)
+			break;	// not part of a block, or opcode straddles the page
+
+		if (info & (BLOCK_ABS|BLOCK_ABSXY))
+		{
+			const WORD addr = pPage[offset+1] | (pPage[offset+2] << 8);
+			const BYTE page1 = addr >> 8;
+			const BYTE page2 = (info & BLOCK_ABSXY) ? (BYTE)((WORD)(addr+0xFF) >> 8) : page1;
+			if (IsBlockIoPage(page1, cpu) || IsBlockIoPage(page2, cpu))
+				break;
+
+			uOpcodes++;
+			if (page1 == page || page2 == page)
+				break;	// may be self-modifying code: end the block after this opcode
+		}
+		else
+		{
+			uOpcodes++;
+			if (info & BLOCK_END)
+				break;
+		}
+
+		pc += len;
+		if ((pc >> 8) != page)
+			break;	// opcode ended on the last byte of the page: pPage (and its invalidation) is only for this page
+	}
+
+	return uOpcodes ? uOpcodes : 1;
+}
+
+// Returns the # of opcodes that can be run back-to-back from pc (always >= 1)
+static __forceinline UINT BlockCache_GetOpcodes(const WORD pc, const eCpuType cpu)
+{
+	if (cpu != g_blockCacheCpu)
+	{
+		CpuBlockCacheFlush();
+		g_blockCacheCpu = cpu;
+	}
+
+	// Invalidate the page's blocks if it has been written to, or paged to different memory
+	const BYTE page = pc >> 8;
+	if ((memdirty[page] & MEMDIRTY_BLOCKCACHE) || memread[page] != g_blockPageSrc[page])
+	{
+		memdirty[page] &= ~MEMDIRTY_BLOCKCACHE;
+		g_blockPageSrc[page] = memread[page];
+		g_blockPageTag[page]++;
+	}
+
+	if (g_blockTag[pc] != g_blockPageTag[page])
+	{
+		g_blockTag[pc] = g_blockPageTag[page];
+		g_blockOpcodes[pc] = DecodeBlock(pc, cpu);
+	}
+
+	return g_blockOpcodes[pc];
+}
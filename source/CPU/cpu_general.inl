@@ -50,21 +50,27 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 			      | AF_RESERVED | AF_BREAK;
 // CYC(a): This can be optimised, as only certain opcodes will affect uExtraCycles
 #define CYC(a)	 uExecutedCycles += (a)+uExtraCycles;
-#define POP	 (*(mem+((regs.sp >= 0x1FF) ? (regs.sp = 0x100) : ++regs.sp)))
-#define PUSH(a)	 *(mem+regs.sp--) = (a);				    \
+// Stack & zero-page/indirect pointer accesses don't go through READ/WRITE, so the debug cores see them via HEATMAP_R/W
+// . _PUSH: for interrupts (outside of the cores)
+#define POP	 (regs.sp = (regs.sp >= 0x1FF) ? 0x100 : regs.sp+1, HEATMAP_R(regs.sp), *(memread[1]+(regs.sp & 0xFF)))
+#define _PUSH(a) *(memwrite[1]+(regs.sp-- & 0xFF)) = (a);				    \
 		 if (regs.sp < 0x100)					    \
 		   regs.sp = 0x1FF;
+#define PUSH(a)	 HEATMAP_W(regs.sp); _PUSH(a)
 #define _READ	(																\
 			((addr & 0xF000) == 0xC000)											\
-				? IORead[(addr>>4) & 0xFF](regs.pc,addr,0,0,uExecutedCycles)	\
-				: *(mem+addr)													\
+				? (Batch_OnIoAccess(uExecutedCycles),							\
+				   IORead[(addr>>4) & 0xFF](regs.pc,addr,0,0,uExecutedCycles))	\
+				: *(memread[addr >> 8]+(addr & 0xFF))							\
 		)
 #define _READ_WITH_IO_F8xx (										/* GH#827 */\
 			((addr & 0xF000) == 0xC000)											\
-				? IORead[(addr>>4) & 0xFF](regs.pc,addr,0,0,uExecutedCycles)	\
+				? (Batch_OnIoAccess(uExecutedCycles),							\
+				   IORead[(addr>>4) & 0xFF](regs.pc,addr,0,0,uExecutedCycles))	\
 				: (addr >= 0xF800)												\
-					? IO_F8xx(regs.pc,addr,0,0,uExecutedCycles)					\
-					: *(mem+addr)												\
+					? (Batch_OnIoAccess(uExecutedCycles),						\
+					   IO_F8xx(regs.pc,addr,0,0,uExecutedCycles))				\
+					: *(memread[addr >> 8]+(addr & 0xFF))						\
 		)
 #define SETNZ(a) {							    \
 		   flagn = ((a) & 0x80);				    \
@@ -77,20 +83,26 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 				LPBYTE page = memwrite[addr >> 8];										\
 				if (page)																\
 					*(page+(addr & 0xFF)) = (BYTE)(a);									\
-				else if ((addr & 0xF000) == 0xC000)										\
+				else if ((addr & 0xF000) == 0xC000) {									\
+					Batch_OnIoAccess(uExecutedCycles);									\
 					IOWrite[(addr>>4) & 0xFF](regs.pc,addr,1,(BYTE)(a),uExecutedCycles);\
+				}																		\
 			}																			\
 		}
 #define _WRITE_WITH_IO_F8xx(a) {											/* GH#827 */\
-			if (addr >= 0xF800)															\
+			if (addr >= 0xF800) {														\
+				Batch_OnIoAccess(uExecutedCycles);										\
 				IO_F8xx(regs.pc,addr,1,(BYTE)(a),uExecutedCycles);						\
+			}																			\
 			else {																		\
 				memdirty[addr >> 8] = 0xFF;												\
 				LPBYTE page = memwrite[addr >> 8];										\
 				if (page)																\
 					*(page+(addr & 0xFF)) = (BYTE)(a);									\
-				else if ((addr & 0xF000) == 0xC000)										\
+				else if ((addr & 0xF000) == 0xC000) {									\
+					Batch_OnIoAccess(uExecutedCycles);									\
 					IOWrite[(addr>>4) & 0xFF](regs.pc,addr,1,(BYTE)(a),uExecutedCycles);\
+				}																		\
 			}																			\
 		}
 
@@ -122,69 +134,77 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 *
 ***/
 
-#define ABS	 addr = *(LPWORD)(mem+regs.pc);	 regs.pc += 2;
-#define IABSX    addr = *(LPWORD)(mem+(*(LPWORD)(mem+regs.pc))+(WORD)regs.x); regs.pc += 2;
+#define ABS	 addr = MemReadWord(regs.pc);	 regs.pc += 2;
+#define IABSX    base = (WORD)(MemReadWord(regs.pc)+regs.x);	          \
+		 HEATMAP_R(base); HEATMAP_R((WORD)(base+1));		  \
+		 addr = MemReadWord(base); regs.pc += 2;
 
 // Optimised for page-cross
-#define ABSX_OPT base = *(LPWORD)(mem+regs.pc); addr = base+(WORD)regs.x; regs.pc += 2; CHECK_PAGE_CHANGE;
+#define ABSX_OPT base = MemReadWord(regs.pc); addr = base+(WORD)regs.x; regs.pc += 2; CHECK_PAGE_CHANGE;
 // Not optimised for page-cross
-#define ABSX_CONST base = *(LPWORD)(mem+regs.pc); addr = base+(WORD)regs.x; regs.pc += 2;
+#define ABSX_CONST base = MemReadWord(regs.pc); addr = base+(WORD)regs.x; regs.pc += 2;
 
 // Optimised for page-cross
-#define ABSY_OPT base = *(LPWORD)(mem+regs.pc); addr = base+(WORD)regs.y; regs.pc += 2; CHECK_PAGE_CHANGE;
+#define ABSY_OPT base = MemReadWord(regs.pc); addr = base+(WORD)regs.y; regs.pc += 2; CHECK_PAGE_CHANGE;
 // Not optimised for page-cross
-#define ABSY_CONST base = *(LPWORD)(mem+regs.pc); addr = base+(WORD)regs.y; regs.pc += 2;
+#define ABSY_CONST base = MemReadWord(regs.pc); addr = base+(WORD)regs.y; regs.pc += 2;
 
 // TODO Optimization Note (just for IABSCMOS): uExtraCycles = ((base & 0xFF) + 1) >> 8;
-#define IABS_CMOS base = *(LPWORD)(mem+regs.pc);	                          \
-		 addr = *(LPWORD)(mem+base);		                  \
+#define IABS_CMOS base = MemReadWord(regs.pc);	                          \
+		 HEATMAP_R(base); HEATMAP_R((WORD)(base+1));		  \
+		 addr = MemReadWord(base);		                  \
 		 if ((base & 0xFF) == 0xFF) uExtraCycles=1;		  \
 		 regs.pc += 2;
-#define IABS_NMOS base = *(LPWORD)(mem+regs.pc);	                          \
+#define IABS_NMOS base = MemReadWord(regs.pc);	                          \
+		 HEATMAP_R(base); HEATMAP_R((base & 0xFF00) | ((base+1) & 0xFF)); \
 		 if ((base & 0xFF) == 0xFF)				  \
-		       addr = *(mem+base)+((WORD)*(mem+(base&0xFF00))<<8);\
+		       addr = MemReadByte(base)+((WORD)MemReadByte(base&0xFF00)<<8);\
 		 else                                                   \
-		       addr = *(LPWORD)(mem+base);                        \
+		       addr = MemReadWord(base);                          \
 		 regs.pc += 2;
 
 #define IMM	 addr = regs.pc++;
 
-#define INDX	 base = ((*(mem+regs.pc++))+regs.x) & 0xFF;          \
+#define INDX	 base = (MemReadByte(regs.pc++)+regs.x) & 0xFF;       \
+		 HEATMAP_R(base); HEATMAP_R((base+1) & 0xFF);        \
 		 if (base == 0xFF)                                   \
-		     addr = *(mem+0xFF)+(((WORD)*mem)<<8);           \
+		     addr = *(memread[0]+0xFF)+(((WORD)*memread[0])<<8); \
 		 else                                                \
-		     addr = *(LPWORD)(mem+base);
+		     addr = *(LPWORD)(memread[0]+base);
 
 // Optimised for page-cross
-#define INDY_OPT	 if (*(mem+regs.pc) == 0xFF)             /*incurs an extra cycle for page-crossing*/ \
-		     base = *(mem+0xFF)+(((WORD)*mem)<<8);           \
+#define INDY_OPT	 HEATMAP_R(MemReadByte(regs.pc)); HEATMAP_R((MemReadByte(regs.pc)+1) & 0xFF); \
+		 if (MemReadByte(regs.pc) == 0xFF)       /*incurs an extra cycle for page-crossing*/ \
+		     base = *(memread[0]+0xFF)+(((WORD)*memread[0])<<8); \
 		 else                                                \
-		     base = *(LPWORD)(mem+*(mem+regs.pc));           \
+		     base = *(LPWORD)(memread[0]+MemReadByte(regs.pc)); \
 		 regs.pc++;                                          \
 		 addr = base+(WORD)regs.y;                           \
 		 CHECK_PAGE_CHANGE;
 // Not optimised for page-cross
-#define INDY_CONST	 if (*(mem+regs.pc) == 0xFF)             /*no extra cycle for page-crossing*/ \
-		     base = *(mem+0xFF)+(((WORD)*mem)<<8);           \
+#define INDY_CONST	 HEATMAP_R(MemReadByte(regs.pc)); HEATMAP_R((MemReadByte(regs.pc)+1) & 0xFF); \
+		 if (MemReadByte(regs.pc) == 0xFF)       /*no extra cycle for page-crossing*/ \
+		     base = *(memread[0]+0xFF)+(((WORD)*memread[0])<<8); \
 		 else                                                \
-		     base = *(LPWORD)(mem+*(mem+regs.pc));           \
+		     base = *(LPWORD)(memread[0]+MemReadByte(regs.pc)); \
 		 regs.pc++;                                          \
 		 addr = base+(WORD)regs.y;
 
-#define IZPG	 base = *(mem+regs.pc++);                            \
+#define IZPG	 base = MemReadByte(regs.pc++);                      \
+		 HEATMAP_R(base); HEATMAP_R((base+1) & 0xFF);        \
 		 if (base == 0xFF)                                   \
-		     addr = *(mem+0xFF)+(((WORD)*mem)<<8);           \
+		     addr = *(memread[0]+0xFF)+(((WORD)*memread[0])<<8); \
 		 else                                                \
-		     addr = *(LPWORD)(mem+base);
+		     addr = *(LPWORD)(memread[0]+base);
 
-#define REL	 addr = (signed char)*(mem+regs.pc++);
+#define REL	 addr = (signed char)MemReadByte(regs.pc++);
 
 // TODO Optimization Note:
 // . Opcodes that generate zero-page addresses can't be accessing $C000..$CFFF
 //   so they could be paired with special READZP/WRITEZP macros (instead of READ/WRITE)
-#define ZPG 	 addr =   *(mem+regs.pc++);
-#define ZPGX	 addr = ((*(mem+regs.pc++))+regs.x) & 0xFF;
-#define ZPGY	 addr = ((*(mem+regs.pc++))+regs.y) & 0xFF;
+#define ZPG 	 addr =   MemReadByte(regs.pc++);
+#define ZPGX	 addr = (MemReadByte(regs.pc++)+regs.x) & 0xFF;
+#define ZPGY	 addr = (MemReadByte(regs.pc++)+regs.y) & 0xFF;
 
 // Tidy 3 char addressing modes to keep the opcode table visually aligned, clean, and readable.
 #undef asl
@@ -32,41 +32,129 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 *
 ***/
 
+// Count each access in the debugger's heatmap, for the bank (main/aux) that's currently paged in
+// NB. No overflow check, as the counts are halved every ~1M cycles (see HeatmapDecay())
+
 inline void Heatmap_R(uint16_t address)
 {
-	// todo
+	g_aHeatmap[ memreadaux[address >> 8] ][ HEATMAP_READ ][ address ]++;
 }
 
 inline void Heatmap_W(uint16_t address)
 {
-	// todo
+	g_aHeatmap[ memwriteaux[address >> 8] ][ HEATMAP_WRITE ][ address ]++;
 }
 
 inline void Heatmap_X(uint16_t address)
 {
-	// todo
+	g_aHeatmap[ memreadaux[address >> 8] ][ HEATMAP_EXEC ][ address ]++;
+}
+
+/****************************************************************************
+*
+*  COMPILED BREAKPOINTS (built-in debugger mode)
+*
+***/
+
+inline void Breakpoint_R(uint16_t address)
+{
+	if (g_aBreakpointBitmap[address] & BP_BITMAP_READ)
+		DebugBreakOnMemoryAccess(address, BP_BITMAP_READ);
+}
+
+inline void Breakpoint_W(uint16_t address)
+{
+	if (g_aBreakpointBitmap[address] & BP_BITMAP_WRITE)
+		DebugBreakOnMemoryAccess(address, BP_BITMAP_WRITE);
+}
+
+// Called at each opcode boundary (and after an IRQ/NMI is taken)
+// Returns true to end the debugger's GO batch early, so that DebugContinueStepping() can stop (or single-step the opcode)
+// . A binary trace is recorded here for opcodes that stay in the batch (the others are recorded by DebugContinueStepping())
+inline bool Breakpoint_X(ULONG uExecutedCycles, BOOL flagc, BOOL flagn, BOOL flagv, BOOL flagz)
+{
+	if (!g_bDebugBatch)
+		return false;
+
+	if (regs.pc != g_uDebugBatchNextPC)
+		g_LBR = g_uDebugBatchPC;	// Branch taken, jump, or interrupt
+
+	if (g_nBreakpointMemoryHit || (g_aBreakpointBitmap[regs.pc] & BP_BITMAP_PC))
+		return true;
+
+	if (g_bDebugBreakOnInterrupt && g_interruptInLastExecutionBatch)
+		return true;
+
+	if (g_bBreakpointRegConditions &&
+		((g_aBreakpointRegBitmap[regs.a] & BP_BITMAP_REG_A) |
+		 (g_aBreakpointRegBitmap[regs.x] & BP_BITMAP_REG_X) |
+		 (g_aBreakpointRegBitmap[regs.y] & BP_BITMAP_REG_Y) |
+		 (g_aBreakpointRegBitmap[regs.sp & 0xFF] & BP_BITMAP_REG_S)))
+		return true;
+
+	if ((regs.pc & 0xF000) == 0xC000 && !MemIsAddrCodeMemory(regs.pc))
+		return true;
+
+	const BYTE iOpcode = MemReadByte(regs.pc);
+	if (g_aBreakpointOpcode[iOpcode])
+		return true;
+
+	g_uDebugBatchPC = regs.pc;
+	g_uDebugBatchNextPC = regs.pc + g_aOpmodes[ g_aOpcodes[iOpcode].nAddressMode ].m_nBytes;
+
+	if (g_bTraceBinary)
+	{
+		const BYTE nP = (regs.ps & ~(AF_CARRY | AF_SIGN | AF_OVERFLOW | AF_ZERO))	// See EF_TO_AF
+			| flagc
+			| flagn
+			| (flagv ? AF_OVERFLOW : 0)
+			| (flagz ? AF_ZERO     : 0)
+			| AF_RESERVED | AF_BREAK;
+		TraceBinaryRecord(g_nCumulativeCycles + (uExecutedCycles - g_nCyclesExecuted), nP);
+	}
+
+	return false;
+}
+
+//-----------------
+
+// Stack & pointer accesses, which don't go through READ/WRITE
+inline void Heatmap_Access_R(uint16_t addr)
+{
+	Heatmap_R(addr);
+	Breakpoint_R(addr);
+}
+
+inline void Heatmap_Access_W(uint16_t addr)
+{
+	Heatmap_W(addr);
+	Breakpoint_W(addr);
 }
 
 inline uint8_t Heatmap_ReadByte(uint16_t addr, int uExecutedCycles)
 {
 	Heatmap_R(addr);
+	Breakpoint_R(addr);
 	return _READ;
 }
 
 inline uint8_t Heatmap_ReadByte_With_IO_F8xx(uint16_t addr, int uExecutedCycles)
 {
 	Heatmap_R(addr);
+	Breakpoint_R(addr);
 	return _READ_WITH_IO_F8xx;
 }
 
 inline void Heatmap_WriteByte(uint16_t addr, uint16_t value, int uExecutedCycles)
 {
 	Heatmap_W(addr);
+	Breakpoint_W(addr);
 	_WRITE(value);
 }
 
 inline void Heatmap_WriteByte_With_IO_F8xx(uint16_t addr, uint16_t value, int uExecutedCycles)
 {
 	Heatmap_W(addr);
+	Breakpoint_W(addr);
 	_WRITE_WITH_IO_F8xx(value);
 }
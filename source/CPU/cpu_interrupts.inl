@@ -0,0 +1,67 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: IRQ & NMI lines
+ *
+ * Devices can assert & deassert from other threads (eg. the SSC's comms thread), so /g_bmIRQ/ & /g_bmNMI/
+ * are only modified by Interlocked ops (which are also full memory barriers) - there's no lock.
+ * The CPU thread just reads /g_bmIRQ/ (eg. in IRQ() after every opcode, or at the end of a batch).
+ *
+ * Author: Various
+ */
+
+void CpuIrqReset()
+{
+	InterlockedExchange(&g_bmIRQ, 0);
+}
+
+void CpuIrqAssert(eIRQSRC Device)
+{
+	InterlockedOr(&g_bmIRQ, 1<<Device);
+	g_bBatchExit = TRUE;	// NB. After g_bmIRQ is updated (see Batch_Begin())
+}
+
+void CpuIrqDeassert(eIRQSRC Device)
+{
+	InterlockedAnd(&g_bmIRQ, ~(1<<Device));
+}
+
+//===========================================================================
+
+void CpuNmiReset()
+{
+	InterlockedExchange(&g_bmNMI, 0);
+	InterlockedExchange(&g_bNmiFlank, FALSE);
+}
+
+void CpuNmiAssert(eIRQSRC Device)
+{
+	if (InterlockedOr(&g_bmNMI, 1<<Device) == 0)	// NMI line is just becoming active
+		InterlockedExchange(&g_bNmiFlank, TRUE);
+	g_bBatchExit = TRUE;
+}
+
+void CpuNmiDeassert(eIRQSRC Device)
+{
+	InterlockedAnd(&g_bmNMI, ~(1<<Device));
+}
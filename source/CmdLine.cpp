@@ -38,8 +38,16 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "SoundCore.h"
 #include "ParallelPrinter.h"
 #include "CardManager.h"
+#include "Disk.h"
 #include "SerialComms.h"
 #include "Interface.h"
+#include "NTSC.h"
+#include "SoundMixer.h"
+#include "AudioCapture.h"
+#include "Benchmark.h"
+#include "Speaker.h"
+#include "Mockingboard.h"
+#include "Rewind.h"
 
 CmdLine g_cmdLine;
 std::string g_sConfigFile; // INI file to use instead of Registry
@@ -246,6 +254,52 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 		{
 			g_bDisableDirectSoundMockingboard = true;
 		}
+		else if (strcmp(lpCmdLine, "-mb-fixed-blocks") == 0)	// Render Mockingboard audio in fixed-size blocks (instead of at the 6522 timer IRQ rate)
+		{
+			MB_SetFixedBlockUpdate(true);
+		}
+		else if (strcmp(lpCmdLine, "-no-hdd-mmap") == 0)	// Read & write hard disk image blocks with file I/O (instead of mapping the image file)
+		{
+			ImageSetHardDiskMappingEnabled(false);
+		}
+		else if (strcmp(lpCmdLine, "-disk-rng-seed") == 0)	// Seed for the Disk II weak-bit & jitter RNG
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Disk2InterfaceCard::SetRNGSeed(_strtoui64(lpCmdLine, NULL, 0));
+		}
+		else if (strcmp(lpCmdLine, "-no-disk-nibble-cache") == 0)	// Nibblize .do/.dsk/.po tracks each time they're read (instead of once, when the image is opened)
+		{
+			ImageSetNibbleCacheEnabled(false);
+		}
+		else if (strcmp(lpCmdLine, "-no-woz-lss-table") == 0)	// Run the WOZ logic state sequencer 1 bit-cell at a time (instead of a nibble at a time)
+		{
+			Disk2InterfaceCard::SetLSSTableEnabled(false);
+		}
+		else if (strcmp(lpCmdLine, "-no-spkr-blep") == 0)		// Use the original per-sample speaker synthesis (instead of band-limited)
+		{
+			Spkr_SetBandLimited(false);
+		}
+		else if (strcmp(lpCmdLine, "-audio-mixer") == 0)	// Mix all sound sources in software to a single DirectSound buffer
+		{
+			SoundMixer_SetSinkType(MIXER_SINK_DSOUND);
+		}
+		else if (strcmp(lpCmdLine, "-audio-null") == 0)		// Mix all sound sources, but output nothing (no sound device needed)
+		{
+			SoundMixer_SetSinkType(MIXER_SINK_NULL);
+		}
+		else if (strcmp(lpCmdLine, "-audio-wav") == 0)		// Mix all sound sources to a .wav file
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			SoundMixer_SetSinkType(MIXER_SINK_WAV, lpCmdLine);
+		}
+		else if (strcmp(lpCmdLine, "-capture-audio") == 0)	// Sample-exact capture of all sound sources to a .wav file (runs at full-speed)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			AudioCapture_SetFilename(lpCmdLine);
+		}
 		else if (strcmp(lpCmdLine, "-memclear") == 0)
 		{
 			lpCmdLine = GetCurrArg(lpNextArg);
@@ -436,6 +490,30 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 			g_cmdLine.szScreenshotFilename = GetCurrArg(lpNextArg);
 			lpNextArg = GetNextArg(lpNextArg);
 		}
+		else if (strcmp(lpCmdLine, "-benchmark") == 0)	// Run the headless benchmark suite then exit: "all" or comma separated scenario names
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Benchmark_SetScenarios(lpCmdLine);
+		}
+		else if (strcmp(lpCmdLine, "-benchmark-repeat") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Benchmark_SetRepeat(atoi(lpCmdLine));
+		}
+		else if (strcmp(lpCmdLine, "-benchmark-warmup") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Benchmark_SetWarmup(atoi(lpCmdLine));
+		}
+		else if (strcmp(lpCmdLine, "-benchmark-json") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Benchmark_SetJsonFilename(lpCmdLine);
+		}
 		else if (strcmp(lpCmdLine, "-clock-multiplier") == 0)
 		{
 			lpCmdLine = GetCurrArg(lpNextArg);
@@ -513,6 +591,26 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 		{
 			g_cmdLine.bRemoveNoSlotClock = true;
 		}
+		else if (strcmp(lpCmdLine, "-no-video-line-cache") == 0)	// Re-render every scanline, even if unchanged
+		{
+			NTSC_SetVideoLineCache(false);
+		}
+		else if (strcmp(lpCmdLine, "-video-render-thread") == 0)	// Render the video on a separate thread
+		{
+			NTSC_SetVideoRenderThread(true);
+		}
+		else if (strcmp(lpCmdLine, "-rewind-interval") == 0)	// Video frames between rewind snapshots (0 = disabled)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Rewind_SetInterval(atoi(lpCmdLine));
+		}
+		else if (strcmp(lpCmdLine, "-rewind-count") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			Rewind_SetCapacity(atoi(lpCmdLine));
+		}
 		else if (strcmp(lpCmdLine, "-snes-max-alt-joy1") == 0)
 		{
 			g_cmdLine.snesMaxAltControllerType[0] = true;
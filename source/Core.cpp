@@ -31,10 +31,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Core.h"
 #include "CardManager.h"
 #include "CPU.h"
+#include "DiskImage.h"
 #include "Interface.h"
+#include "Joystick.h"
 #include "Log.h"
 #include "Memory.h"
 #include "Mockingboard.h"
+#include "NTSC.h"
+#include "ParallelPrinter.h"
 #include "Pravets.h"
 #include "Speaker.h"
 #include "Registry.h"
@@ -99,15 +103,16 @@ UINT64 g_timeVideo = 0;			// part of timeCpu
 UINT64 g_timeMB_Timer = 0;		// part of timeCpu
 UINT64 g_timeMB_NoTimer = 0;
 UINT64 g_timeSpeaker = 0;
+UINT64 g_timeSpeakerToggle = 0;	// part of timeCpu
 static UINT64 g_timeVideoRefresh = 0;
 
 void LogPerfTimings(void)
 {
 	if (g_timeTotal)
 	{
-		UINT64 cpu = g_timeCpu - g_timeVideo - g_timeMB_Timer;
+		UINT64 cpu = g_timeCpu - g_timeVideo - g_timeMB_Timer - g_timeSpeakerToggle;
 		UINT64 video = g_timeVideo + g_timeVideoRefresh;
-		UINT64 spkr = g_timeSpeaker;
+		UINT64 spkr = g_timeSpeaker + g_timeSpeakerToggle;
 		UINT64 mb = g_timeMB_Timer + g_timeMB_NoTimer;
 		UINT64 audio = spkr + mb;
 		UINT64 other = g_timeTotal - g_timeCpu - g_timeSpeaker - g_timeMB_NoTimer - g_timeVideoRefresh;
@@ -122,6 +127,10 @@ void LogPerfTimings(void)
 		LogOutput("... MB %%       = %6.2f\n", (double)mb / (double)g_timeTotal * 100.0);
 		LogOutput(". Other %%      = %6.2f\n", (double)other / (double)g_timeTotal * 100.0);
 		LogOutput(". TOTAL %%      = %6.2f\n", (double)(cpu+video+audio+other) / (double)g_timeTotal * 100.0);
+
+		UINT64 linesSkipped, linesRendered;
+		NTSC_GetVideoLineCacheStats(linesSkipped, linesRendered);
+		LogOutput("Video scanlines: skipped = %llu, rendered = %llu\n", linesSkipped, linesRendered);
 	}
 }
 #endif
@@ -154,9 +163,9 @@ void LogFileTimeUntilFirstKeyRead(void)
 	if (!g_fh || bLogKeyReadDone)
 		return;
 
-	if ( (mem[regs.pc-3] != 0x2C)	// AZTEC: bit $c000
-		&& !((regs.pc-2) == 0xE797 && mem[regs.pc-2] == 0xB1 && mem[regs.pc-1] == 0x50)	// Phasor1: lda ($50),y
-		&& !((regs.pc-3) == 0x0895 && mem[regs.pc-3] == 0xAD)	// Rescue Raiders v1.3,v1.5: lda $c000
+	if ( (MemReadByte(regs.pc-3) != 0x2C)	// AZTEC: bit $c000
+		&& !((regs.pc-2) == 0xE797 && MemReadByte(regs.pc-2) == 0xB1 && MemReadByte(regs.pc-1) == 0x50)	// Phasor1: lda ($50),y
+		&& !((regs.pc-3) == 0x0895 && MemReadByte(regs.pc-3) == 0xAD)	// Rescue Raiders v1.3,v1.5: lda $c000
 		)
 		return;
 
@@ -302,3 +311,58 @@ Pravets& GetPravets(void)
 	static Pravets pravets;
 	return pravets;
 }
+
+//===========================================================================
+
+// Headless execution
+// . Same per-slice device updates as the frontend's ContinueExecution(), but without SysClk_WaitTimer() pacing,
+//   full-speed video fallbacks or VideoPresentScreen() - the caller decides what to do with the framebuffer.
+
+static UINT g_uHeadlessFrameCount = 0;
+
+DWORD CoreRunCycles(const DWORD uCycles)
+{
+	_ASSERT(g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK || g_nAppMode == MODE_DEBUG);	// MODE_DEBUG: re-execution for Rewind_StepBack()
+
+	const bool bVideoUpdate = true;
+	const DWORD uActualCyclesExecuted = CpuExecute(uCycles, bVideoUpdate);
+	g_dwCyclesThisFrame += uActualCyclesExecuted;
+
+	const UINT nExecutionPeriodUsec = (UINT) ((double)uActualCyclesExecuted * 1.e6 / g_fCurrentCLK6502);
+
+	GetCardMgr().GetDisk2CardMgr().UpdateDriveState(uActualCyclesExecuted);
+	JoyUpdateButtonLatch(nExecutionPeriodUsec);
+	PrintUpdate(uActualCyclesExecuted);
+	MB_PeriodicUpdate(uActualCyclesExecuted);
+	ImageUpdateDeferredWrites();
+	if (g_nAppMode != MODE_DEBUG)	// Re-executing 1 opcode at a time: a sound-buffer lock per opcode is too slow, so let the next SpkrUpdate() catch up
+		SpkrUpdate(uActualCyclesExecuted);
+
+	const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
+	if (g_dwCyclesThisFrame >= dwClksPerFrame && !GetVideo().VideoGetVblBarEx(g_dwCyclesThisFrame))
+	{
+		g_dwCyclesThisFrame -= dwClksPerFrame;
+		g_uHeadlessFrameCount++;
+	}
+
+	return uActualCyclesExecuted;
+}
+
+// Run until the next video frame boundary (ie. the framebuffer holds a complete frame)
+DWORD CoreRunFrame(void)
+{
+	// Use the same 1ms slice as ContinueExecution(), so that device update granularity is unchanged
+	const DWORD uSliceCycles = (DWORD) (g_fCurrentCLK6502 * 0.001);
+	const UINT uFrameCount = g_uHeadlessFrameCount;
+
+	DWORD uTotalCycles = 0;
+	while (g_uHeadlessFrameCount == uFrameCount)
+		uTotalCycles += CoreRunCycles(uSliceCycles);
+
+	return uTotalCycles;
+}
+
+UINT CoreGetFrameCount(void)
+{
+	return g_uHeadlessFrameCount;
+}
@@ -31,6 +31,16 @@ extern bool       g_bFullSpeed;
 
 //===========================================
 
+// Headless execution (no real-time pacing & no frontend message loop):
+// . run the emulated machine as fast as the host allows, eg. for automated regression runs
+// . video is rendered into GetVideo().GetFrameBuffer(); audio can be pulled via Spkr_PullSamples() & MB_PullSamples()
+//   (after Spkr_SetPullMode(true) & MB_SetPullMode(true))
+DWORD CoreRunCycles(const DWORD uCycles);
+DWORD CoreRunFrame(void);
+UINT CoreGetFrameCount(void);
+
+//===========================================
+
 extern AppMode_e g_nAppMode;
 
 extern std::string g_sStartDir;
@@ -44,6 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "../Keyboard.h"
 #include "../Memory.h"
 #include "../NTSC.h"
+#include "../Rewind.h"
 #include "../SoundCore.h"	// SoundCore_SetFade()
 
 //	#define DEBUG_COMMAND_HELP  1
@@ -74,6 +75,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	int  g_nBreakpoints          = 0;
 	Breakpoint_t g_aBreakpoints[ MAX_BREAKPOINTS ];
 
+	// Compiled breakpoints: see CompileBreakpoints()
+	BYTE g_aBreakpointBitmap   [ _6502_MEM_LEN ]; // BP_BITMAP_PC, BP_BITMAP_READ, BP_BITMAP_WRITE
+	BYTE g_aBreakpointRegBitmap[ 256 ]; // BP_BITMAP_REG_A/X/Y/S, indexed by the register's value
+	bool g_aBreakpointOpcode   [ 256 ];
+	bool g_bBreakpointRegConditions = false;
+	int  g_nBreakpointMemoryHit = BP_HIT_NONE;
+	static bool g_bBreakpointRegP = false;
+	static bool g_bBreakpointsCompiled = false;
+
+	// GO runs batches of opcodes, which the debug CPU variants end early on a compiled breakpoint
+	bool g_bDebugBatch       = false;
+	WORD g_uDebugBatchPC     = 0; // PC at the last opcode boundary
+	WORD g_uDebugBatchNextPC = 0; // PC after that opcode, if it doesn't branch
+
 	// NOTE: BreakpointSource_t and g_aBreakpointSource must match!
 	const char *g_aBreakpointSource[ NUM_BREAKPOINT_SOURCES ] =
 	{	// Used to be one char, since ArgsCook also uses // TODO/FIXME: Parser use Param[] ?
@@ -240,6 +255,23 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	char * ProfileLinePush ();
 	void ProfileLineReset  ();
 
+// Heatmap ________________________________________________________________________________________
+	// Reads/writes/executes of each address, counted by the debug CPU variants (see cpu_heatmap.inl)
+	// . halved every HEATMAP_DECAY_CYCLES of emulated time, so the counts show recent activity
+	UINT  g_aHeatmap[ NUM_HEATMAP_BANKS ][ NUM_HEATMAP_ACCESS ][ _6502_MEM_LEN ];
+	bool  g_bHeatmapView = false; // Mini memory dumps show the heat as the background colour
+
+	static const UINT HEATMAP_DECAY_CYCLES = 1 << 20; // ~1 sec
+	static const int  NUM_HEATMAP_LIST_LINES = 16;
+	static unsigned __int64 g_nHeatmapDecayCycle = 0;
+
+	const std::string g_FileNameHeatmap = TEXT("Heatmap.txt");
+
+	void HeatmapReset  ();
+	void HeatmapDecay  ();
+	void HeatmapList   ();
+	bool HeatmapSave   ();
+
 // Soft-switches __________________________________________________________________________________
 
 
@@ -316,7 +348,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 	static bool      g_bIgnoreNextKey = false;
 
-	static WORD g_LBR = 0x0000;	// Last Branch Record
+	WORD g_LBR = 0x0000;	// Last Branch Record
 
 // Private ________________________________________________________________________________________
 
@@ -831,6 +863,56 @@ _Help:
 }
 
 
+//===========================================================================
+Update_t CmdHeatmap (int nArgs)
+{
+	if (! nArgs)
+	{
+		sprintf( g_aArgs[ 1 ].sArg, "%s", g_aParameters[ PARAM_LIST ].m_sName );
+		nArgs = 1;
+	}
+
+	int iParam;
+	int nFound = (nArgs == 1) ? FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END ) : 0;
+
+	if (! nFound)
+		goto _Help;
+
+	TCHAR sText[ CONSOLE_WIDTH ];
+
+	if (iParam == PARAM_ON || iParam == PARAM_OFF)
+	{
+		g_bHeatmapView = (iParam == PARAM_ON);
+		ConsoleBufferPushFormat( sText, " Heatmap in mini memory dumps: %s", g_bHeatmapView ? "on" : "off" );
+		ConsoleUpdate();
+		return UPDATE_MEM_DUMP | UPDATE_CONSOLE_DISPLAY;
+	}
+	else if (iParam == PARAM_RESET)
+	{
+		HeatmapReset();
+		ConsoleBufferPush( TEXT(" Resetting heatmap data." ) );
+	}
+	else if (iParam == PARAM_LIST)
+	{
+		HeatmapList();
+	}
+	else if (iParam == PARAM_SAVE)
+	{
+		if (HeatmapSave())
+			ConsoleBufferPushFormat( sText, " Saved: %s", g_FileNameHeatmap.c_str() );
+		else
+			ConsoleBufferPush( TEXT(" ERROR: Couldn't save file. (In use?)" ) );
+	}
+	else
+		goto _Help;
+
+	return ConsoleUpdate(); // UPDATE_CONSOLE_DISPLAY;
+
+_Help:
+	return Help_Arg_1( CMD_HEATMAP );
+}
+
+
 // Breakpoints ____________________________________________________________________________________
 
 
@@ -1118,73 +1200,110 @@ bool _CheckBreakpointValue( Breakpoint_t *pBP, int nVal )
 }
 
 
+// Compile the enabled breakpoints into bitmaps, for the debug CPU variants to test inline (see cpu_heatmap.inl)
 //===========================================================================
-int CheckBreakpointsIO ()
+static void CompileBreakpoints ()
 {
-	const int NUM_TARGETS = 3;
+	memset( g_aBreakpointBitmap, 0, sizeof(g_aBreakpointBitmap) );
+	memset( g_aBreakpointRegBitmap, 0, sizeof(g_aBreakpointRegBitmap) );
+	g_bBreakpointRegConditions = false;
+	g_bBreakpointRegP = false;
 
-	int aTarget[ NUM_TARGETS ] =
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
 	{
-		NO_6502_TARGET,
-		NO_6502_TARGET,
-		NO_6502_TARGET
-	};
-	int  nBytes;
-	bool bBreakpointHit = 0;
-
-	int  iTarget;
-	int  nAddress;
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+		if (! _BreakpointValid( pBP ))
+			continue;
 
-	// bIncludeNextOpcodeAddress == false:
-	// . JSR addr16: ignore addr16 as a target
-	// . BRK/RTS/RTI: ignore return (or vector) addr16 as a target
-	_6502_GetTargets( regs.pc, &aTarget[0], &aTarget[1], &aTarget[2], &nBytes, true, false );
+		BYTE nMemBits = 0;	// BreakpointBitmap_t
+		BYTE nRegBits = 0;	// BreakpointRegBitmap_t
+		switch (pBP->eSource)
+		{
+			case BP_SRC_REG_PC:         nMemBits = BP_BITMAP_PC; break;
+			case BP_SRC_MEM_RW:         nMemBits = BP_BITMAP_READ | BP_BITMAP_WRITE; break;
+			case BP_SRC_MEM_READ_ONLY:  nMemBits = BP_BITMAP_READ; break;
+			case BP_SRC_MEM_WRITE_ONLY: nMemBits = BP_BITMAP_WRITE; break;
+			case BP_SRC_REG_A:          nRegBits = BP_BITMAP_REG_A; break;
+			case BP_SRC_REG_X:          nRegBits = BP_BITMAP_REG_X; break;
+			case BP_SRC_REG_Y:          nRegBits = BP_BITMAP_REG_Y; break;
+			case BP_SRC_REG_S:          nRegBits = BP_BITMAP_REG_S; break;
+			case BP_SRC_REG_P:          g_bBreakpointRegP = true; break;	// Flags are only in regs.ps between CpuExecute() calls
+			default:
+				break;
+		}
 
-	if (nBytes)
-	{
-		for (iTarget = 0; iTarget < NUM_TARGETS; iTarget++ )
+		if (nMemBits)
 		{
-			nAddress = aTarget[ iTarget ];
-			if (nAddress != NO_6502_TARGET)
+			for (UINT nAddress = 0; nAddress < _6502_MEM_LEN; nAddress++)
 			{
-				for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
-				{
-					Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
-					if (_BreakpointValid( pBP ))
-					{
-						if (pBP->eSource == BP_SRC_MEM_RW || pBP->eSource == BP_SRC_MEM_READ_ONLY || pBP->eSource == BP_SRC_MEM_WRITE_ONLY)
-						{
-							if (_CheckBreakpointValue( pBP, nAddress ))
-							{
-								g_uBreakMemoryAddress = (WORD) nAddress;
-								BYTE opcode = mem[regs.pc];
-
-								if (pBP->eSource == BP_SRC_MEM_RW)
-								{
-									return BP_HIT_MEM;
-								}
-								else if (pBP->eSource == BP_SRC_MEM_READ_ONLY)
-								{
-									if (g_aOpcodes[opcode].nMemoryAccess & (MEM_RI|MEM_R))
-										return BP_HIT_MEMR;
-								}
-								else if (pBP->eSource == BP_SRC_MEM_WRITE_ONLY)
-								{
-									if (g_aOpcodes[opcode].nMemoryAccess & (MEM_WI|MEM_W))
-										return BP_HIT_MEMW;
-								}
-								else
-								{
-									_ASSERT(0);
-								}
-							}
-						}
-					}
-				}
+				if (_CheckBreakpointValue( pBP, nAddress ))
+					g_aBreakpointBitmap[ nAddress ] |= nMemBits;
+			}
+		}
+		else if (nRegBits)
+		{
+			const int nBase = (pBP->eSource == BP_SRC_REG_S) ? 0x100 : 0;	// SP is $01xx
+			for (int iValue = 0; iValue < 256; iValue++)
+			{
+				if (_CheckBreakpointValue( pBP, nBase + iValue ))
+					g_aBreakpointRegBitmap[ iValue ] |= nRegBits;
 			}
+			g_bBreakpointRegConditions = true;
+		}
+	}
+
+	if (g_nDebugStepUntil >= 0)
+		g_aBreakpointBitmap[ (WORD) g_nDebugStepUntil ] |= BP_BITMAP_PC;
+
+	// Same as CheckBreakOpcode()
+	for (int iOpcode = 0; iOpcode < 256; iOpcode++)
+	{
+		bool bBreak = false;
+		if (iOpcode == 0x00)
+			bBreak = ((g_nDebugBreakOnInvalid >> AM_IMPLIED) & 1) != 0;
+		if (g_aOpcodes[iOpcode].sMnemonic[0] >= 'a')
+			bBreak |= ((g_nDebugBreakOnInvalid >> AM_1) & 1) != 0;
+		if (g_iDebugBreakOnOpcode && g_iDebugBreakOnOpcode == iOpcode)
+			bBreak = true;
+
+		g_aBreakpointOpcode[ iOpcode ] = bBreak;
+	}
+
+	g_bBreakpointsCompiled = true;
+}
+
+// Called by the debug CPU variants when an access hits the read/write bitmap
+// NB. The breakpoint triggers on the actual access, so it stops *after* the opcode that made it
+//===========================================================================
+void DebugBreakOnMemoryAccess ( WORD nAddress, BYTE nAccess )
+{
+	if (g_nBreakpointMemoryHit)
+		return;	// Report the opcode's 1st access
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+		if (! _BreakpointValid( pBP ))
+			continue;
+
+		if (! _CheckBreakpointValue( pBP, nAddress ))
+			continue;
+
+		int nHit = BP_HIT_NONE;
+		if (pBP->eSource == BP_SRC_MEM_RW)
+			nHit = BP_HIT_MEM;
+		else if (pBP->eSource == BP_SRC_MEM_READ_ONLY && (nAccess & BP_BITMAP_READ))
+			nHit = BP_HIT_MEMR;
+		else if (pBP->eSource == BP_SRC_MEM_WRITE_ONLY && (nAccess & BP_BITMAP_WRITE))
+			nHit = BP_HIT_MEMW;
+
+		if (nHit)
+		{
+			g_uBreakMemoryAddress = nAddress;
+			g_nBreakpointMemoryHit = nHit;
+			return;
 		}
 	}
-	return bBreakpointHit;
 }
 
 // Returns true if a register breakpoint is triggered
@@ -2017,7 +2136,7 @@ Update_t CmdStepOver (int nArgs)
 
 	while (nDebugSteps -- > 0)
 	{
-		int nOpcode = *(mem + regs.pc); // g_nDisasmCurAddress
+		int nOpcode = MemReadByte(regs.pc); // g_nDisasmCurAddress
 	//	int eMode = g_aOpcodes[ nOpcode ].addrmode;
 	//	int nByte = g_aOpmodes[eMode]._nBytes;
 	//	if ((eMode ==  AM_A) && 
@@ -2051,6 +2170,41 @@ Update_t CmdStepOut (int nArgs)
 	return UPDATE_ALL;
 }
 
+//===========================================================================
+Update_t CmdStepBack (int nArgs)
+{
+	if (nArgs > 1)
+		return Help_Arg_1( CMD_STEP_BACK );
+
+	if (g_bTraceBinary)
+	{
+		ConsoleBufferPush( "BACK not available while writing a binary trace file." );
+		return ConsoleUpdate();
+	}
+
+	// Each step back re-executes from a rewind snapshot, so limit how far back a single BACK can go
+	const UINT MAX_STEP_BACK = 0x4000;
+
+	const UINT nSteps = nArgs ? g_aArgs[1].nValue : 1;
+	if (nSteps > MAX_STEP_BACK)
+	{
+		TCHAR sText[ CONSOLE_WIDTH ];
+		ConsoleBufferPushFormat( sText, TEXT("  BACK is limited to %X instructions."), MAX_STEP_BACK );
+		return ConsoleUpdate();
+	}
+
+	if (!Rewind_StepBack( nSteps ))
+	{
+		ConsoleBufferPush( "No rewind snapshot before the current instruction." );
+		return ConsoleUpdate();
+	}
+
+	g_nDisasmCurAddress = regs.pc;
+	DisasmCalcTopBotAddress();
+
+	return UPDATE_ALL;
+}
+
 //===========================================================================
 Update_t CmdTrace (int nArgs)
 {
@@ -2077,6 +2231,13 @@ Update_t CmdTraceFile (int nArgs)
 
 		ConsoleBufferPush( "Trace stopped." );
 	}
+	else if (g_bTraceBinary)
+	{
+		if (TraceBinaryClose())
+			ConsoleBufferPush( "Trace stopped." );
+		else
+			ConsoleBufferPush( "Trace ERROR: not all of the trace was written" );
+	}
 	else
 	{
 		std::string sFileName;
@@ -2086,16 +2247,35 @@ Update_t CmdTraceFile (int nArgs)
 		else
 			sFileName = g_sFileNameTrace;
 
-		g_bTraceFileWithVideoScanner = (nArgs >= 2);
+		// TF "filename" [v] [bin]
+		bool bBinary = false;
+		g_bTraceFileWithVideoScanner = false;
+		for (int iArg = 2; iArg <= nArgs; iArg++)
+		{
+			if (_stricmp( g_aArgs[iArg].sArg, "bin" ) == 0)
+				bBinary = true;
+			else
+				g_bTraceFileWithVideoScanner = true;
+		}
 
 		const std::string sFilePath = g_sCurrentDir + sFileName;
 
-		g_hTraceFile = fopen( sFilePath.c_str(), "wt" );
+		bool bOK;
+		if (bBinary)
+		{
+			bOK = TraceBinaryOpen( sFilePath, g_bTraceFileWithVideoScanner );
+		}
+		else
+		{
+			g_hTraceFile = fopen( sFilePath.c_str(), "wt" );
+			bOK = (g_hTraceFile != NULL);
+		}
 
-		if (g_hTraceFile)
+		if (bOK)
 		{
-			const char* pTextHdr = g_bTraceFileWithVideoScanner ? "Trace (with video info) started: %s"
-																: "Trace started: %s";
+			const char* pTextHdr = bBinary
+				? (g_bTraceFileWithVideoScanner ? "Binary trace (with video info) started: %s" : "Binary trace started: %s")
+				: (g_bTraceFileWithVideoScanner ? "Trace (with video info) started: %s" : "Trace started: %s");
 			ConsoleBufferPushFormat( sText, pTextHdr, sFilePath.c_str() );
 			g_bTraceHeader = true;
 		}
@@ -2110,6 +2290,42 @@ Update_t CmdTraceFile (int nArgs)
 	return UPDATE_ALL; // TODO: Verify // 0
 }
 
+// TFC "binary-trace" ["text-trace"]
+//===========================================================================
+Update_t CmdTraceFileConvert (int nArgs)
+{
+	if (nArgs < 1 || nArgs > 2)
+		return Help_Arg_1( CMD_TRACE_FILE_CONVERT );
+
+	const std::string sFilePathIn = g_sCurrentDir + g_aArgs[1].sArg;
+
+	std::string sFilePathOut;
+	if (nArgs == 2)
+	{
+		sFilePathOut = g_sCurrentDir + g_aArgs[2].sArg;
+	}
+	else
+	{
+		sFilePathOut = sFilePathIn;
+		const size_t nDot = sFilePathOut.rfind( '.' );
+		if (nDot != std::string::npos && sFilePathOut.find_first_of( "\\/", nDot ) == std::string::npos)
+			sFilePathOut.erase( nDot );
+		sFilePathOut += ".txt";
+	}
+
+	char sText[ CONSOLE_WIDTH ] = "";
+
+	UINT64 nRecords = 0;
+	if (TraceBinaryConvert( sFilePathIn, sFilePathOut, nRecords ))
+		ConsoleBufferPushFormat( sText, "Converted %llu opcodes: %s", nRecords, sFilePathOut.c_str() );
+	else
+		ConsoleBufferPushFormat( sText, "Trace ERROR: couldn't convert: %s", sFilePathIn.c_str() );
+
+	ConsoleBufferToDisplay();
+
+	return UPDATE_CONSOLE_DISPLAY;
+}
+
 //===========================================================================
 Update_t CmdTraceLine (int nArgs)
 {
@@ -2175,14 +2391,11 @@ Update_t CmdJSR (int nArgs)
 
 	WORD nAddress = g_aArgs[1].nValue & _6502_MEM_END;
 
-	// Mark Stack Page as dirty
-	*(memdirty+(regs.sp >> 8)) = 1;
-
 	// Push PC onto stack
-	*(mem + regs.sp) = ((regs.pc >> 8) & 0xFF);
+	MemWriteByte(regs.sp, ((regs.pc >> 8) & 0xFF));
 	regs.sp--;
 
-	*(mem + regs.sp) = ((regs.pc >> 0) - 1) & 0xFF;
+	MemWriteByte(regs.sp, ((regs.pc >> 0) - 1) & 0xFF);
 	regs.sp--;
 
 
@@ -2202,11 +2415,15 @@ Update_t CmdNOP (int nArgs)
 
 	_6502_GetOpcodeOpmodeOpbyte( iOpcode, iOpmode, nOpbytes );
 
+	bool bWritten = true;
 	while (nOpbytes--)
 	{
-		*(mem+regs.pc + nOpbytes) = 0xEA;
+		bWritten &= MemWriteByte(regs.pc + nOpbytes, 0xEA);
 	}
 
+	if (!bWritten)
+		ConsoleBufferPush( TEXT(" ROM or I/O not modified") );
+
 	return UPDATE_ALL;
 }
 
@@ -3424,27 +3641,27 @@ bool MemoryDumpCheck (int nArgs, WORD * pAddress_ )
 #ifdef SUPPORT_Z80_EMU
 	else if(strcmp(g_aArgs[1].sArg, "*AF") == 0)
 	{
-		nAddress = *(WORD*)(mem + REG_AF);
+		nAddress = MemReadWord(REG_AF);
 		bUpdate = true;
 	}
 	else if(strcmp(g_aArgs[1].sArg, "*BC") == 0)
 	{
-		nAddress = *(WORD*)(mem + REG_BC);
+		nAddress = MemReadWord(REG_BC);
 		bUpdate = true;
 	}
 	else if(strcmp(g_aArgs[1].sArg, "*DE") == 0)
 	{
-		nAddress = *(WORD*)(mem + REG_DE);
+		nAddress = MemReadWord(REG_DE);
 		bUpdate = true;
 	}
 	else if(strcmp(g_aArgs[1].sArg, "*HL") == 0)
 	{
-		nAddress = *(WORD*)(mem + REG_HL);
+		nAddress = MemReadWord(REG_HL);
 		bUpdate = true;
 	}
 	else if(strcmp(g_aArgs[1].sArg, "*IX") == 0)
 	{
-		nAddress = *(WORD*)(mem + REG_IX);
+		nAddress = MemReadWord(REG_IX);
 		bUpdate = true;
 	}
 #endif
@@ -3594,22 +3811,25 @@ Update_t CmdMemoryEnterByte (int nArgs)
 	}
 	
 	WORD nAddress = g_aArgs[1].nValue;
+	bool bWritten = true;
 	while (nArgs >= 2)
 	{
 		WORD nData = g_aArgs[nArgs].nValue;
 		if( nData > 0xFF)
 		{
-			*(mem + nAddress + nArgs - 2)  = (BYTE)(nData >> 0);
-			*(mem + nAddress + nArgs - 1)  = (BYTE)(nData >> 8);
+			bWritten &= MemWriteByte(nAddress + nArgs - 2, (BYTE)(nData >> 0));
+			bWritten &= MemWriteByte(nAddress + nArgs - 1, (BYTE)(nData >> 8));
 		}
 		else
 		{
-			*(mem + nAddress+nArgs-2)  = (BYTE)nData;
+			bWritten &= MemWriteByte(nAddress+nArgs-2, (BYTE)nData);
 		}
-		*(memdirty+(nAddress >> 8)) = 1;
 		nArgs--;
 	}
 
+	if (!bWritten)
+		ConsoleBufferPush( TEXT(" ROM or I/O not modified") );
+
 	return UPDATE_ALL;
 }
 
@@ -3624,28 +3844,22 @@ Update_t CmdMemoryEnterWord (int nArgs)
 	}
 	
 	WORD nAddress = g_aArgs[1].nValue;
+	bool bWritten = true;
 	while (nArgs >= 2)
 	{
 		WORD nData = g_aArgs[nArgs].nValue;
 
 		// Little Endian
-		*(mem + nAddress + nArgs - 2)  = (BYTE)(nData >> 0);
-		*(mem + nAddress + nArgs - 1)  = (BYTE)(nData >> 8);
+		bWritten &= MemWriteByte(nAddress + nArgs - 2, (BYTE)(nData >> 0));
+		bWritten &= MemWriteByte(nAddress + nArgs - 1, (BYTE)(nData >> 8));
 
-		*(memdirty+(nAddress >> 8)) |= 1;
 		nArgs--;
 	}
 
-	return UPDATE_ALL;
-}
+	if (!bWritten)
+		ConsoleBufferPush( TEXT(" ROM or I/O not modified") );
 
-//===========================================================================
-void MemMarkDirty( WORD nAddressStart, WORD nAddressEnd )
-{
-	for( int iPage = (nAddressStart >> 8); iPage <= (nAddressEnd >> 8); iPage++ )
-	{
-		*(memdirty+iPage) = 1;
-	}
+	return UPDATE_ALL;
 }
 
 //===========================================================================
@@ -3683,15 +3897,13 @@ Update_t CmdMemoryFill (int nArgs)
 
 	if ((nAddressLen > 0) && (nAddressEnd <= _6502_MEM_END))
 	{
-		MemMarkDirty( nAddressStart, nAddressEnd );
-
 		nValue = g_aArgs[nArgs].nValue & 0xFF;
 		while( nAddressLen-- ) // v2.7.0.22
 		{
 			// TODO: Optimize - split into pre_io, and post_io
 			if ((nAddress2 < _6502_IO_BEGIN) || (nAddress2 > _6502_IO_END))
 			{
-				*(mem + nAddressStart) = nValue;
+				MemWriteByte(nAddressStart, nValue);
 			}
 			nAddressStart++;
 		}
@@ -3832,7 +4044,7 @@ Update_t CmdMemoryLoad (int nArgs)
 		}
 		
 		BYTE *pMemory = new BYTE [ _6502_MEM_END + 1 ]; // default 64K buffer
-		BYTE *pDst = mem + nAddressStart;
+		BYTE *pDst = MemGetMainPtr(nAddressStart);
 		BYTE *pSrc = pMemory;
 
 		if (bHaveFileName)
@@ -4030,8 +4242,8 @@ Update_t CmdMemoryLoad (int nArgs)
 	}
 	const std::string sLoadSaveFilePath = g_sCurrentDir + g_sMemoryLoadSaveFileName; // TODO: g_sDebugDir
 	
-	BYTE * const pMemBankBase = bBankSpecified ? MemGetBankPtr(nBank) : mem;
-	if (!pMemBankBase)
+	BYTE * const pMemBankBase = bBankSpecified ? MemGetBankPtr(nBank) : NULL;
+	if (bBankSpecified && !pMemBankBase)
 	{
 		ConsoleBufferPush( TEXT( "Error: Bank out of range." ) );
 		return ConsoleUpdate();
@@ -4051,7 +4263,10 @@ Update_t CmdMemoryLoad (int nArgs)
 			nAddressLen = nFileBytes;
 		}
 
-		size_t nRead = fread( pMemBankBase+nAddressStart, nAddressLen, 1, hFile );
+		// No bank specified: load into the 6502's current view of memory
+		BYTE * const pDst = bBankSpecified ? pMemBankBase+nAddressStart : new BYTE[nAddressLen];
+
+		size_t nRead = fread( pDst, nAddressLen, 1, hFile );
 		if (nRead == 1)
 		{
 			char text[ 128 ];
@@ -4069,10 +4284,9 @@ Update_t CmdMemoryLoad (int nArgs)
 		}
 		else
 		{
-			for (WORD i=(nAddressStart>>8); i!=((nAddressStart+(WORD)nAddressLen)>>8); i++)
-			{
-				memdirty[i] = 0xff;
-			}
+			if (nRead == 1)
+				MemWriteBlock(nAddressStart, pDst, nAddressLen);	// NB. Also sets memdirty[]
+			delete [] pDst;
 		}
 	}
 	else
@@ -4117,8 +4331,6 @@ Update_t CmdMemoryMove (int nArgs)
 
 	if ((nAddressLen > 0) && (nAddressEnd <= _6502_MEM_END))
 	{
-		MemMarkDirty( nAddressStart, nAddressEnd );
-
 //			BYTE *pSrc = mem + nAddressStart;
 //			BYTE *pDst = mem + nDst;
 //			BYTE *pEnd = pSrc + nAddressLen;
@@ -4128,7 +4340,7 @@ Update_t CmdMemoryMove (int nArgs)
 			// TODO: Optimize - split into pre_io, and post_io
 			if ((nDst < _6502_IO_BEGIN) || (nDst > _6502_IO_END))
 			{
-				*(mem + nDst) = *(mem + nAddressStart);
+				MemWriteByte(nDst, MemReadByte(nAddressStart));
 			}
 			nDst++;
 			nAddressStart++;
@@ -4224,7 +4436,7 @@ Update_t CmdMemorySave (int nArgs)
 			{
 				BYTE *pMemory = new BYTE [ nAddressLen ];
 				BYTE *pDst = pMemory;
-				BYTE *pSrc = mem + nAddressStart;
+				BYTE *pSrc = MemGetMainPtr(nAddressStart);
 				
 				// memcpy -- copy out of active memory bank
 				int iByte;
@@ -4377,8 +4589,8 @@ Update_t CmdMemorySave (int nArgs)
 			}
 			sLoadSaveFilePath += g_sMemoryLoadSaveFileName;
 
-			const BYTE * const pMemBankBase = bBankSpecified ? MemGetBankPtr(nBank) : mem;
-			if (!pMemBankBase)
+			const BYTE * const pMemBankBase = bBankSpecified ? MemGetBankPtr(nBank) : NULL;
+			if (bBankSpecified && !pMemBankBase)
 			{
 				ConsoleBufferPush( TEXT( "Error: Bank out of range." ) );
 				return ConsoleUpdate();
@@ -4395,7 +4607,15 @@ Update_t CmdMemorySave (int nArgs)
 			hFile = fopen( sLoadSaveFilePath.c_str(), "wb" );
 			if (hFile)
 			{
-				size_t nWrote = fwrite( pMemBankBase+nAddressStart, nAddressLen, 1, hFile );
+				// No bank specified: save the 6502's current view of memory
+				std::vector<BYTE> memory(nAddressLen + 1);
+				const BYTE* pSrc = &memory[0];
+				if (bBankSpecified)
+					pSrc = pMemBankBase+nAddressStart;
+				else
+					MemReadBlock(&memory[0], nAddressStart, nAddressLen);
+
+				size_t nWrote = fwrite( pSrc, nAddressLen, 1, hFile );
 				if (nWrote == 1)
 				{
 					ConsoleBufferPush( TEXT( "Saved." ) );
@@ -5271,7 +5491,7 @@ int _SearchMemoryFind(
 				(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
 				(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
 			{
-				BYTE nTarget = *(mem + nAddress2);
+				BYTE nTarget = MemReadByte(nAddress2);
 	
 				if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
 					nTarget &= 0x0F;
@@ -5309,7 +5529,7 @@ int _SearchMemoryFind(
 						(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
 						(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
 					{
-						BYTE nTarget = *(mem + nAddress3);
+						BYTE nTarget = MemReadByte(nAddress3);
 			
 						if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
 							nTarget &= 0x0F;
@@ -6202,7 +6422,7 @@ bool ParseAssemblyListing( bool bBytesToMemory, bool bAddSymbols )
 					if (TextIsHexByte( pStart ))
 					{
 						BYTE nByte = TextConvert2CharsToByte( pStart );
-						*(mem + ((WORD)nAddress) + iByte ) = nByte;
+						MemWriteByte(((WORD)nAddress) + iByte, nByte);
 					}
 				}
 				g_nSourceAssembleBytes += iByte;
@@ -7658,6 +7878,12 @@ Update_t ExecuteCommand (int nArgs)
 //===========================================================================
 void OutputTraceLine ()
 {
+	if (g_bTraceBinary)
+	{
+		TraceBinaryRecord( g_nCumulativeCycles, regs.ps );
+		return;
+	}
+
 	if (!g_hTraceFile)
 		return;
 
@@ -7667,80 +7893,26 @@ void OutputTraceLine ()
 	char sDisassembly[ CONSOLE_WIDTH ]; // DrawDisassemblyLine( 0,regs.pc, sDisassembly); // Get Disasm String
 	FormatDisassemblyLine( line, sDisassembly, CONSOLE_WIDTH );
 
-	char sFlags[] = "........";
-	WORD nRegFlags = regs.ps;
-	int nFlag = _6502_NUM_FLAGS;
-	while (nFlag--)
-	{
-		int iFlag = (_6502_NUM_FLAGS - nFlag - 1);
-		bool bSet = (nRegFlags & 1);
-		if (bSet)
-			sFlags[nFlag] = g_aBreakpointSource[BP_SRC_FLAG_C + iFlag][0];
-		nRegFlags >>= 1;
-	}
-
 	if (g_bTraceHeader)
 	{
 		g_bTraceHeader = false;
-
-		if (g_bTraceFileWithVideoScanner)
-		{
-			fprintf( g_hTraceFile,
-//				"0000 0000 0000 00   00 00 00 0000 --------  0000:90 90 90  NOP"
-				"Vert Horz Addr Data A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n");
-		}
-		else
-		{
-			fprintf( g_hTraceFile,
-//				"00000000 00 00 00 0000 --------  0000:90 90 90  NOP"
-				"Cycles   A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n");
-		}
-	}
-
-	char sTarget[ 16 ];
-	if (line.bTargetValue)
-	{
-		sprintf( sTarget, "%s:%s"
-			, line.sTargetPointer
-			, line.sTargetValue
-		);
+		fputs( TraceTextHeader( g_bTraceFileWithVideoScanner ), g_hTraceFile );
 	}
 
+	WORD nVideoVert = 0, nVideoHorz = 0, nScannerAddr = 0;
+	BYTE nScannerData = 0;
 	if (g_bTraceFileWithVideoScanner)
 	{
-		uint16_t addr = NTSC_VideoGetScannerAddressForDebugger();
-		BYTE data = mem[addr];
-
-		fprintf( g_hTraceFile,
-			"%04X %04X %04X   %02X %02X %02X %02X %04X %s  %s\n",
-			g_nVideoClockVert,
-			g_nVideoClockHorz,
-			addr,
-			data,
-			(unsigned)regs.a,
-			(unsigned)regs.x,
-			(unsigned)regs.y,
-			(unsigned)regs.sp,
-			(char*) sFlags
-			, sDisassembly
-			//, sTarget // TODO: Show target?
-		);
-	}
-	else
-	{
-		const UINT cycles = (UINT)g_nCumulativeCycles;
-		fprintf( g_hTraceFile,
-			"%08X %02X %02X %02X %04X %s  %s\n",
-			cycles,
-			(unsigned)regs.a,
-			(unsigned)regs.x,
-			(unsigned)regs.y,
-			(unsigned)regs.sp,
-			(char*) sFlags
-			, sDisassembly
-			//, sTarget // TODO: Show target?
-		);
+		nVideoVert = NTSC_GetVideoClockVert();
+		nVideoHorz = NTSC_GetVideoClockHorz();
+		nScannerAddr = NTSC_VideoGetScannerAddressForDebugger();
+		nScannerData = MemReadByte(nScannerAddr);
 	}
+
+	TraceTextLine( g_hTraceFile, g_bTraceFileWithVideoScanner
+		, g_nCumulativeCycles, regs.a, regs.x, regs.y, regs.sp, regs.ps
+		, nVideoVert, nVideoHorz, nScannerAddr, nScannerData
+		, sDisassembly );	// TODO: Show target?
 }
 
 //===========================================================================
@@ -8095,6 +8267,147 @@ bool ProfileSave()
 }
 
 
+// Heatmap ________________________________________________________________________________________
+
+//===========================================================================
+void HeatmapReset()
+{
+	memset( g_aHeatmap, 0, sizeof(g_aHeatmap) );
+	g_nHeatmapDecayCycle = g_nCumulativeCycles;
+}
+
+
+// Called after each step (or batch), so the decay follows emulated time
+//===========================================================================
+void HeatmapDecay()
+{
+	if (g_nCumulativeCycles < g_nHeatmapDecayCycle)	// eg. a save-state was loaded
+		g_nHeatmapDecayCycle = g_nCumulativeCycles;
+
+	if (g_nCumulativeCycles - g_nHeatmapDecayCycle < HEATMAP_DECAY_CYCLES)
+		return;
+
+	g_nHeatmapDecayCycle = g_nCumulativeCycles;
+
+	UINT *pCount = &g_aHeatmap[0][0][0];
+	const UINT nCounts = sizeof(g_aHeatmap) / sizeof(g_aHeatmap[0][0][0]);
+	for (UINT i = 0; i < nCounts; i++)
+		pCount[i] >>= 1;
+}
+
+
+// List the hottest addresses (by reads+writes+executes)
+//===========================================================================
+void HeatmapList()
+{
+	std::vector< std::pair<UINT,UINT> > vHot;	// (total, bank:address)
+
+	for (UINT iBank = 0; iBank < NUM_HEATMAP_BANKS; iBank++)
+	{
+		for (UINT nAddress = 0; nAddress < _6502_MEM_LEN; nAddress++)
+		{
+			const UINT nTotal = g_aHeatmap[ iBank ][ HEATMAP_READ  ][ nAddress ]
+							  + g_aHeatmap[ iBank ][ HEATMAP_WRITE ][ nAddress ]
+							  + g_aHeatmap[ iBank ][ HEATMAP_EXEC  ][ nAddress ];
+			if (nTotal)
+				vHot.push_back( std::make_pair( nTotal, (iBank << 16) | nAddress ) );
+		}
+	}
+
+	const size_t nLines = (vHot.size() < NUM_HEATMAP_LIST_LINES) ? vHot.size() : NUM_HEATMAP_LIST_LINES;
+	std::partial_sort( vHot.begin(), vHot.begin() + nLines, vHot.end(), std::greater< std::pair<UINT,UINT> >() );
+
+	TCHAR sText[ CONSOLE_WIDTH ];
+
+	if (! nLines)
+	{
+		ConsoleBufferPush( TEXT(" Heatmap is empty." ) );
+		return;
+	}
+
+	ConsoleBufferPushFormat( sText, " %-4s  %-5s  %10s  %10s  %10s", "Bank", "Addr", "Read", "Write", "Exec" );
+
+	for (size_t iLine = 0; iLine < nLines; iLine++)
+	{
+		const UINT iBank    = vHot[ iLine ].second >> 16;
+		const UINT nAddress = vHot[ iLine ].second & 0xFFFF;
+
+		ConsoleBufferPushFormat( sText, " %-4s  $%04X  %10u  %10u  %10u"
+			, iBank ? "Aux" : "Main"
+			, nAddress
+			, g_aHeatmap[ iBank ][ HEATMAP_READ  ][ nAddress ]
+			, g_aHeatmap[ iBank ][ HEATMAP_WRITE ][ nAddress ]
+			, g_aHeatmap[ iBank ][ HEATMAP_EXEC  ][ nAddress ]
+		);
+	}
+}
+
+
+// Dump every non-zero address (tab separated)
+//===========================================================================
+bool HeatmapSave()
+{
+	const std::string sFilename = g_sProgramDir + g_FileNameHeatmap;
+
+	FILE *hFile = fopen( sFilename.c_str(), "wt" );
+
+	if (! hFile)
+		return false;
+
+	fprintf( hFile, "Bank\tAddress\tRead\tWrite\tExec\n" );
+
+	for (UINT iBank = 0; iBank < NUM_HEATMAP_BANKS; iBank++)
+	{
+		for (UINT nAddress = 0; nAddress < _6502_MEM_LEN; nAddress++)
+		{
+			const UINT nRead  = g_aHeatmap[ iBank ][ HEATMAP_READ  ][ nAddress ];
+			const UINT nWrite = g_aHeatmap[ iBank ][ HEATMAP_WRITE ][ nAddress ];
+			const UINT nExec  = g_aHeatmap[ iBank ][ HEATMAP_EXEC  ][ nAddress ];
+
+			if (nRead | nWrite | nExec)
+				fprintf( hFile, "%s\t$%04X\t%u\t%u\t%u\n", iBank ? "Aux" : "Main", nAddress, nRead, nWrite, nExec );
+		}
+	}
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Background colour for the mini memory dump: R=writes, G=reads, B=executes (log scale)
+// Returns false if the address (as currently paged in) has no heat
+//===========================================================================
+bool HeatmapGetColor( WORD nAddress, COLORREF & rgb_ )
+{
+	const UINT iReadBank  = memreadaux [ nAddress >> 8 ];
+	const UINT iWriteBank = memwriteaux[ nAddress >> 8 ];
+
+	const UINT aCount[ NUM_HEATMAP_ACCESS ] =
+	{
+		g_aHeatmap[ iReadBank  ][ HEATMAP_READ  ][ nAddress ],
+		g_aHeatmap[ iWriteBank ][ HEATMAP_WRITE ][ nAddress ],
+		g_aHeatmap[ iReadBank  ][ HEATMAP_EXEC  ][ nAddress ]
+	};
+
+	if (! (aCount[ HEATMAP_READ ] | aCount[ HEATMAP_WRITE ] | aCount[ HEATMAP_EXEC ]))
+		return false;
+
+	BYTE aLevel[ NUM_HEATMAP_ACCESS ];
+	for (int iAccess = 0; iAccess < NUM_HEATMAP_ACCESS; iAccess++)
+	{
+		int nLog2 = 0;
+		for (UINT nCount = aCount[ iAccess ]; nCount > 1; nCount >>= 1)
+			nLog2++;
+
+		int nLevel = aCount[ iAccess ] ? (0x30 + nLog2 * 8) : 0;	// Capped, so that the text stays readable
+		aLevel[ iAccess ] = (BYTE) ((nLevel > 0xC0) ? 0xC0 : nLevel);
+	}
+
+	rgb_ = RGB( aLevel[ HEATMAP_WRITE ], aLevel[ HEATMAP_READ ], aLevel[ HEATMAP_EXEC ] );
+	return true;
+}
+
+
 static void InitDisasm(void)
 {
 	g_nDisasmCurAddress = regs.pc;
@@ -8116,6 +8429,7 @@ void DebugBegin ()
 
 	g_nAppMode = MODE_DEBUG;
 	GetFrame().FrameRefreshStatus(DRAW_TITLE | DRAW_DISK_STATUS);
+	ImageUpdateDeferredWrites(true);	// Emulation has stopped, so write any gzip/zip images now
 
 	if (GetMainCpu() == CPU_6502)
 	{
@@ -8163,7 +8477,7 @@ void DebugBegin ()
 //===========================================================================
 void DebugExitDebugger ()
 {
-	if (g_nBreakpoints == 0 && g_hTraceFile == NULL)
+	if (g_nBreakpoints == 0 && g_hTraceFile == NULL && !g_bTraceBinary)
 	{
 		DebugEnd();
 		return;
@@ -8197,7 +8511,7 @@ static void CheckBreakOpcode( int iOpcode )
 
 static void UpdateLBR(void)
 {
-	const BYTE nOpcode = *(mem + regs.pc);
+	const BYTE nOpcode = MemReadByte(regs.pc);
 
 	bool isControlFlowOpcode =
 		nOpcode == OPCODE_BRK ||
@@ -8228,6 +8542,18 @@ static void UpdateLBR(void)
 		g_LBR = regs.pc;
 }
 
+// GO runs batches of opcodes at (near) full emulation speed, with the compiled breakpoints tested inline by the CPU.
+// Otherwise single-step, where something needs to be done between each opcode.
+static bool CanDebugStepInBatches(void)
+{
+	return g_nDebugSteps < 0 &&			// GO (not trace/step)
+		g_nDebugSkipLen <= 0 &&
+		!g_hTraceFile &&
+		!g_bProfiling &&				// profiling counts each opcode
+		!g_bBreakpointRegP &&
+		GetActiveCpu() != CPU_Z80;
+}
+
 void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 {
 	static bool bForceSingleStepNext = false; // Allow at least one instruction to execute so we don't trigger on the same invalid opcode
@@ -8248,6 +8574,9 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 		}
 	}
 
+	if (g_nDebugSteps && !g_bBreakpointsCompiled)
+		CompileBreakpoints();
+
 	if (g_nDebugSteps)
 	{
 		bool bDoSingleStep = true;
@@ -8259,14 +8588,14 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 		}
 		else if (GetActiveCpu() != CPU_Z80)
 		{
-			if (g_hTraceFile)
+			if (g_hTraceFile || g_bTraceBinary)
 				OutputTraceLine();
 
 			g_bDebugBreakpointHit = BP_HIT_NONE;
 
 			if ( MemIsAddrCodeMemory(regs.pc) )
 			{
-				BYTE nOpcode = *(mem+regs.pc);
+				BYTE nOpcode = MemReadByte(regs.pc);
 
 				// Update profiling stats
 				int nOpmode = g_aOpcodes[ nOpcode ].nAddressMode;
@@ -8289,20 +8618,36 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 
 		if (bDoSingleStep)
 		{
-			UpdateLBR();
+			const bool bBatch = CanDebugStepInBatches();
 			const WORD oldPC = regs.pc;
 
-			SingleStep(g_bGoCmd_ReinitFlag);
+			if (bBatch)
+			{
+				g_uDebugBatchPC = regs.pc;
+				g_uDebugBatchNextPC = regs.pc + g_aOpmodes[ g_aOpcodes[ MemReadByte(regs.pc) ].nAddressMode ].m_nBytes;
+			}
+			else
+			{
+				UpdateLBR();
+			}
+
+			g_nBreakpointMemoryHit = BP_HIT_NONE;
+			g_bDebugBatch = bBatch;
+			SingleStep(g_bGoCmd_ReinitFlag);	// Batch: ends at uTotalCycles, or early on a compiled breakpoint
+			g_bDebugBatch = false;
 			g_bGoCmd_ReinitFlag = false;
 
 			if (IsInterruptInLastExecution())
 			{
-				g_LBR = oldPC;
+				if (!bBatch)
+					g_LBR = oldPC;	// NB. Batch: the CPU has already updated the LBR
 				if (g_bDebugBreakOnInterrupt)
 					g_bDebugBreakpointHit |= BP_HIT_INTERRUPT;
 			}
 
-			g_bDebugBreakpointHit |= CheckBreakpointsIO() | CheckBreakpointsReg();
+			g_bDebugBreakpointHit |= g_nBreakpointMemoryHit | CheckBreakpointsReg();
+
+			HeatmapDecay();
 		}
 
 		if (regs.pc == g_nDebugStepUntil || g_bDebugBreakpointHit)
@@ -8344,10 +8689,13 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 
 	if (!g_nDebugSteps)
 	{
+		g_bBreakpointsCompiled = false;	// Recompile on the next GO/step, as breakpoints may be changed in MODE_DEBUG
+
 		SoundCore_SetFade(FADE_OUT);	// NB. Call when MODE_STEPPING (not MODE_DEBUG) - see function
 
 		g_nAppMode = MODE_DEBUG;
 		GetFrame().FrameRefreshStatus(DRAW_TITLE | DRAW_DISK_STATUS);
+		ImageUpdateDeferredWrites(true);	// See DebugBegin()
 // BUG: PageUp, Trace - doesn't center cursor
 
 		g_nDisasmCurAddress = regs.pc;
@@ -8409,6 +8757,8 @@ static void DebugEnd ()
 		g_hTraceFile = NULL;
 	}
 
+	TraceBinaryClose();
+
 	g_vMemorySearchResults.erase( g_vMemorySearchResults.begin(), g_vMemorySearchResults.end() );
 
 	g_nAppMode = MODE_RUNNING;
@@ -9181,3 +9531,9 @@ bool IsDebugSteppingAtFullSpeed(void)
 {
 	return (g_nAppMode == MODE_STEPPING) && g_bDebugFullSpeed;
 }
+
+//===========================================================================
+bool IsDebugSteppingBatched(void)
+{
+	return (g_nAppMode == MODE_STEPPING) && g_bDebugBatch;
+}
@@ -13,6 +13,7 @@
 #include "Debugger_Help.h"
 #include "Debugger_Display.h"
 #include "Debugger_Symbols.h"
+#include "Debugger_Trace.h"
 #include "Util_MemoryTextFile.h"
 
 // Globals __________________________________________________________________
@@ -49,6 +50,50 @@
 
 	extern int  g_nDebugBreakOnInvalid ;
 	extern int  g_iDebugBreakOnOpcode  ;
+	extern bool g_bDebugBreakOnInterrupt;
+
+	// Compiled breakpoints, tested inline by the debug CPU variants (see cpu_heatmap.inl)
+	enum BreakpointBitmap_t
+	{
+		  BP_BITMAP_PC    = (1 << 0)
+		, BP_BITMAP_READ  = (1 << 1)
+		, BP_BITMAP_WRITE = (1 << 2)
+	};
+
+	enum BreakpointRegBitmap_t
+	{
+		  BP_BITMAP_REG_A = (1 << 0)
+		, BP_BITMAP_REG_X = (1 << 1)
+		, BP_BITMAP_REG_Y = (1 << 2)
+		, BP_BITMAP_REG_S = (1 << 3)
+	};
+
+	extern BYTE g_aBreakpointBitmap   [];
+	extern BYTE g_aBreakpointRegBitmap[];
+	extern bool g_aBreakpointOpcode   [];
+	extern bool g_bBreakpointRegConditions;
+	extern int  g_nBreakpointMemoryHit;
+
+	extern bool g_bDebugBatch;
+	extern WORD g_uDebugBatchPC;
+	extern WORD g_uDebugBatchNextPC;
+	extern WORD g_LBR;
+
+// Heatmap
+	enum HeatmapAccess_e
+	{
+		  HEATMAP_READ
+		, HEATMAP_WRITE
+		, HEATMAP_EXEC
+		, NUM_HEATMAP_ACCESS
+	};
+
+	const int NUM_HEATMAP_BANKS = 2; // Main, Aux (all RamWorks banks count as aux)
+
+	extern UINT g_aHeatmap[ NUM_HEATMAP_BANKS ][ NUM_HEATMAP_ACCESS ][ 0x10000 ];
+	extern bool g_bHeatmapView;
+
+	bool HeatmapGetColor( WORD nAddress, COLORREF & rgb_ );
 
 // Commands
 	void VerifyDebuggerCommandTable();
@@ -144,8 +189,8 @@
 	int Bookmark_Find( const WORD nAddress );
 
 // Breakpoints
-	int CheckBreakpointsIO ();
 	int CheckBreakpointsReg ();
+	void DebugBreakOnMemoryAccess ( WORD nAddress, BYTE nAccess );
 
 	bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakpointEnable_ );
 
@@ -181,3 +226,4 @@
 	void	DebuggerMouseClick( int x, int y );
 
 	bool	IsDebugSteppingAtFullSpeed(void);
+	bool	IsDebugSteppingBatched(void);
@@ -54,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		{TEXT("OUT")         , CmdOut               , CMD_OUT                  , "Output byte to IO $C0xx"    },
 		{TEXT("LBR")         , CmdLBR               , CMD_LBR                  , "Show Last Branch Record"    },
 	// CPU - Meta Info
+		{TEXT("HEATMAP")     , CmdHeatmap           , CMD_HEATMAP              , "List/Save/Show memory access heatmap" },
 		{TEXT("PROFILE")     , CmdProfile           , CMD_PROFILE              , "List/Save 6502 profiling" },
 		{TEXT("R")           , CmdRegisterSet       , CMD_REGISTER_SET         , "Set register" },
 	// CPU - Stack
@@ -63,9 +64,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //		{TEXT("RTS")         , CmdStackReturn       , CMD_STACK_RETURN         },
 		{TEXT("P")           , CmdStepOver          , CMD_STEP_OVER            , "Step current instruction"   },
 		{TEXT("RTS")         , CmdStepOut           , CMD_STEP_OUT             , "Step out of subroutine"     }, 
+		{TEXT("BACK")        , CmdStepBack          , CMD_STEP_BACK            , "Reverse-step # instructions (via rewind snapshots)" },
 	// CPU - Meta Info
 		{TEXT("T")           , CmdTrace             , CMD_TRACE                , "Trace current instruction"  },
-		{TEXT("TF")          , CmdTraceFile         , CMD_TRACE_FILE           , "Save trace to filename [with video scanner info]" },
+		{TEXT("TF")          , CmdTraceFile         , CMD_TRACE_FILE           , "Save trace to filename [with video scanner info] [binary]" },
+		{TEXT("TFC")         , CmdTraceFileConvert  , CMD_TRACE_FILE_CONVERT   , "Convert binary trace file to text" },
 		{TEXT("TL")          , CmdTraceLine         , CMD_TRACE_LINE           , "Trace (with cycle counting)" },
 		{TEXT("U")           , CmdUnassemble        , CMD_UNASSEMBLE           , "Disassemble instructions"   },
 //		{TEXT("WAIT")        , CmdWait              , CMD_WAIT                 , "Run until
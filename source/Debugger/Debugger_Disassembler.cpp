@@ -225,7 +225,7 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 			nTarget = pData->nTargetAddress;
 		}
 		else {
-			nTarget = mem[(nBaseAddress + 1) & 0xFFFF] | (mem[(nBaseAddress + 2) & 0xFFFF] << 8);
+			nTarget = MemReadByte((nBaseAddress + 1) & 0xFFFF) | (MemReadByte((nBaseAddress + 2) & 0xFFFF) << 8);
 			if (nOpbyte == 2)
 				nTarget &= 0xFF;
 		}
@@ -350,7 +350,7 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 			{
 				bDisasmFormatFlags |= DISASM_FORMAT_TARGET_POINTER;
 
-				nTargetValue = *(mem + nTargetPointer) | (*(mem + ((nTargetPointer + 1) & 0xffff)) << 8);
+				nTargetValue = MemReadByte(nTargetPointer) | (MemReadByte((nTargetPointer + 1) & 0xffff) << 8);
 
 				//				if (((iOpmode >= AM_A) && (iOpmode <= AM_NZ)) && (iOpmode != AM_R))
 				//					sprintf( sTargetValue_, "%04X", nTargetValue ); // & 0xFFFF
@@ -437,6 +437,79 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 	return bDisasmFormatFlags;
 }
 
+// Disassemble from captured opcode bytes, instead of memory (eg. a binary trace file)
+// . Only sets the fields used by FormatDisassemblyLine(): no symbols, targets or data disassembly
+//===========================================================================
+void GetDisassemblyLineFromBytes(const WORD nBaseAddress, const BYTE aOpcode[3], DisasmLine_t& line_)
+{
+	line_.Clear();
+
+	const int iOpcode = aOpcode[0];
+	const int iOpmode = g_aOpcodes[iOpcode].nAddressMode;
+	const int nOpbyte = g_aOpmodes[iOpmode].m_nBytes;
+
+	line_.iOpcode = iOpcode;
+	line_.iOpmode = iOpmode;
+	line_.nOpbyte = nOpbyte;
+
+	if (iOpmode == AM_M)
+		line_.bTargetImmediate = true;
+
+	if ((iOpmode >= AM_IZX) && (iOpmode <= AM_NA))
+		line_.bTargetIndirect = true;
+
+	if (((iOpmode >= AM_A) && (iOpmode <= AM_ZY)) || line_.bTargetIndirect)
+		line_.bTargetValue = true;
+
+	if ((iOpmode != AM_IMPLIED) &&
+		(iOpmode != AM_1) &&
+		(iOpmode != AM_2) &&
+		(iOpmode != AM_3))
+	{
+		WORD nTarget = aOpcode[1] | (aOpcode[2] << 8);
+		if (nOpbyte == 2)
+			nTarget &= 0xFF;
+
+		if (iOpmode == AM_R)
+		{
+			line_.bTargetRelative = true;
+			nTarget = nBaseAddress + 2 + (int)(signed char)nTarget;
+			sprintf(line_.sTargetValue, "%04X", nTarget & 0xFFFF);
+		}
+		else if (iOpmode == AM_M)
+		{
+			sprintf(line_.sTarget, "%02X", (unsigned)nTarget);
+		}
+
+		line_.nTarget = nTarget;
+	}
+
+	sprintf(line_.sAddress, "%04X", nBaseAddress);
+
+	char* pDst = line_.sOpCodes;
+	for (int iByte = 0; iByte < nOpbyte && iByte < MAX_OPCODES; iByte++)
+	{
+		sprintf(pDst, "%02X", aOpcode[iByte]);
+		pDst += 2;
+
+		if (g_bConfigDisasmOpcodeSpaces)
+		{
+			strcat(pDst, " ");
+			pDst++;
+		}
+	}
+
+	const int nMinBytesLen = (MAX_OPCODES * (2 + g_bConfigDisasmOpcodeSpaces));
+	int nSpaces = strlen(line_.sOpCodes);
+	while (nSpaces < nMinBytesLen)
+	{
+		strcat(line_.sOpCodes, " ");
+		nSpaces++;
+	}
+
+	strcpy(line_.sMnemonic, g_aOpcodes[iOpcode].sMnemonic);
+}
+
 //===========================================================================
 void FormatOpcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 {
@@ -449,7 +522,7 @@ void FormatOpcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 
 	for (int iByte = 0; iByte < nMaxOpBytes; iByte++)
 	{
-		BYTE nMem = mem[(nBaseAddress + iByte) & 0xFFFF];
+		BYTE nMem = MemReadByte((nBaseAddress + iByte) & 0xFFFF);
 		sprintf(pDst, "%02X", nMem); // sBytes+strlen(sBytes)
 		pDst += 2;
 
@@ -468,6 +541,7 @@ void FormatNopcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 {
 	char* pDst = line_.sTarget;
 	const	char* pSrc = 0;
+	char	sText[MAX_IMMEDIATE_LEN];	// copy of the text bytes, read via MemReadBlock()
 	DWORD nStartAddress = line_.pDisasmData->nStartAddress;
 	DWORD nEndAddress = line_.pDisasmData->nEndAddress;
 	//		int   nDataLen      = nEndAddress - nStartAddress + 1 ;
@@ -476,8 +550,8 @@ void FormatNopcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 
 	for (int iByte = 0; iByte < line_.nOpbyte; )
 	{
-		BYTE nTarget8 = *(LPBYTE)(mem + nBaseAddress + iByte);
-		WORD nTarget16 = *(LPWORD)(mem + nBaseAddress + iByte);
+		BYTE nTarget8 = MemReadByte(nBaseAddress + iByte);
+		WORD nTarget16 = MemReadWord(nBaseAddress + iByte);
 
 		switch (line_.iNoptype)
 		{
@@ -511,12 +585,13 @@ void FormatNopcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 			break;
 		case NOP_STRING_APPLESOFT:
 			iByte = line_.nOpbyte;
-			strncpy(pDst, (const char*)(mem + nBaseAddress), iByte);
+			MemReadBlock((LPBYTE)pDst, nBaseAddress, iByte);
 			pDst += iByte;
 			*pDst = 0;
 		case NOP_STRING_APPLE:
 			iByte = line_.nOpbyte; // handle all bytes of text
-			pSrc = (const char*)mem + nStartAddress;
+			MemReadBlock((LPBYTE)sText, (WORD)nStartAddress, (len < MAX_IMMEDIATE_LEN) ? len : MAX_IMMEDIATE_LEN);
+			pSrc = sText;
 
 			if (len > (MAX_IMMEDIATE_LEN - 2)) // does "text" fit?
 			{
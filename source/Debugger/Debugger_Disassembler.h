@@ -5,6 +5,7 @@ int GetDisassemblyLine(const WORD nOffset, DisasmLine_t& line_);
 //		char *sAddress_, char *sOpCodes_,
 //		char *sTarget_, char *sTargetOffset_, int & nTargetOffset_, char *sTargetValue_,
 //		char * sImmediate_, char & nImmediate_, char *sBranch_ );
+void GetDisassemblyLineFromBytes(const WORD nBaseAddress, const BYTE aOpcode[3], DisasmLine_t& line_);
 void FormatDisassemblyLine(const DisasmLine_t& line, char* sDisassembly_, const int nBufferSize);
 void FormatOpcodeBytes(WORD nBaseAddress, DisasmLine_t& line_);
 void FormatNopcodeBytes(WORD nBaseAddress, DisasmLine_t& line_);
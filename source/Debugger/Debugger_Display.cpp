@@ -2078,7 +2078,7 @@ void DrawMemory ( int line, int iMemDump )
 			}
 			else
 			{
-				BYTE nData = (unsigned)*(LPBYTE)(mem+iAddress);
+				BYTE nData = (unsigned)MemReadByte(iAddress);
 				sText[0] = 0;
 
 				if (iView == MEM_VIEW_HEX)
@@ -2088,6 +2088,10 @@ void DrawMemory ( int line, int iMemDump )
 						DebuggerSetColorFG( DebuggerGetColor( FG_INFO_IO_BYTE ));
 					}
 
+					COLORREF nHeat;
+					if (g_bHeatmapView && HeatmapGetColor( iAddress, nHeat ))
+						DebuggerSetColorBG( nHeat );
+
 					sprintf(sText, "%02X ", nData );
 				}
 				else
@@ -2682,7 +2686,7 @@ void DrawStack ( int line)
 		if (nAddress <= _6502_STACK_END)
 		{
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPCODE )); // COLOR_FG_DATA_TEXT
-			sprintf(sText, "  %02X",(unsigned)*(LPBYTE)(mem+nAddress));
+			sprintf(sText, "  %02X",(unsigned)MemReadByte(nAddress));
 			PrintTextCursorX( sText, rect );
 		}
 		iStack++;
@@ -2698,7 +2702,7 @@ void DrawTargets ( int line)
 
 	int aTarget[3];
 	_6502_GetTargets( regs.pc, &aTarget[0],&aTarget[1],&aTarget[2], NULL );
-	GetTargets_IgnoreDirectJSRJMP(mem[regs.pc], aTarget[2]);
+	GetTargets_IgnoreDirectJSRJMP(MemReadByte(regs.pc), aTarget[2]);
 
 	aTarget[1] = aTarget[2];	// Move down as we only have 2 lines
 
@@ -2723,9 +2727,9 @@ void DrawTargets ( int line)
 		{
 			sprintf(sAddress,"%04X",aTarget[iAddress]);
 			if (iAddress)
-				sprintf(sData,"%02X",*(LPBYTE)(mem+aTarget[iAddress]));
+				sprintf(sData,"%02X",MemReadByte(aTarget[iAddress]));
 			else
-				sprintf(sData,"%04X",*(LPWORD)(mem+aTarget[iAddress]));
+				sprintf(sData,"%04X",MemReadWord(aTarget[iAddress]));
 		}
 
 		rect.left   = DISPLAY_TARGETS_COLUMN;
@@ -2806,12 +2810,12 @@ void DrawWatches (int line)
 
 			BYTE nTarget8 = 0;
 
-			nTarget8 = (unsigned)*(LPBYTE)(mem+g_aWatches[iWatch].nAddress);
+			nTarget8 = (unsigned)MemReadByte(g_aWatches[iWatch].nAddress);
 			sprintf(sText,"%02X", nTarget8 );
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPCODE ));
 			PrintTextCursorX( sText, rect2 );
 
-			nTarget8 = (unsigned)*(LPBYTE)(mem+g_aWatches[iWatch].nAddress + 1);
+			nTarget8 = (unsigned)MemReadByte(g_aWatches[iWatch].nAddress + 1);
 			sprintf(sText,"%02X", nTarget8 );
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPCODE ));
 			PrintTextCursorX( sText, rect2 );
@@ -2820,7 +2824,7 @@ void DrawWatches (int line)
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPERATOR ));
 			PrintTextCursorX( sText, rect2 );
 
-			WORD nTarget16 = (unsigned)*(LPWORD)(mem+g_aWatches[iWatch].nAddress);
+			WORD nTarget16 = (unsigned)MemReadWord(g_aWatches[iWatch].nAddress);
 			sprintf( sText,"%04X", nTarget16 );
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_ADDRESS ));
 			PrintTextCursorX( sText, rect2 );
@@ -2829,7 +2833,7 @@ void DrawWatches (int line)
 //			PrintTextCursorX( ":", rect2 );
 			PrintTextCursorX( ")", rect2 );
 
-//			BYTE nValue8 = (unsigned)*(LPBYTE)(mem + nTarget16);
+//			BYTE nValue8 = (unsigned)MemReadByte(nTarget16);
 //			sprintf(sText,"%02X", nValue8 );
 //			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPCODE ));
 //			PrintTextCursorX( sText, rect2 );
@@ -2853,7 +2857,7 @@ void DrawWatches (int line)
 				else
 					DebuggerSetColorBG( DebuggerGetColor( BG_DATA_2 ));
 
-				BYTE nValue8 = mem[ (nTarget16 + iByte) & 0xffff ];
+				BYTE nValue8 = MemReadByte((nTarget16 + iByte) & 0xffff);
 				sprintf(sText,"%02X", nValue8 );
 				PrintTextCursorX( sText, rect2 );
 			}
@@ -2961,7 +2965,7 @@ void DrawZeroPagePointers ( int line )
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPERATOR ));
 			PrintTextCursorX( ":", rect2 );
 
-			WORD nTarget16 = (WORD)mem[ nZPAddr1 ] | ((WORD)mem[ nZPAddr2 ]<< 8);
+			WORD nTarget16 = (WORD)MemReadByte(nZPAddr1) | ((WORD)MemReadByte(nZPAddr2)<< 8);
 			sprintf( sText, "%04X", nTarget16 );
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_ADDRESS ));
 			PrintTextCursorX( sText, rect2 );
@@ -2969,7 +2973,7 @@ void DrawZeroPagePointers ( int line )
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPERATOR ));
 			PrintTextCursorX( ":", rect2 );
 
-			BYTE nValue8 = (unsigned)*(LPBYTE)(mem + nTarget16);
+			BYTE nValue8 = (unsigned)MemReadByte(nTarget16);
 			sprintf(sText, "%02X", nValue8 );
 			DebuggerSetColorFG( DebuggerGetColor( FG_INFO_OPCODE ));
 			PrintTextCursorX( sText, rect2 );
@@ -3072,7 +3076,7 @@ void DrawSubWindow_Data (Update_t bUpdate)
 		sOpcodes[0] = 0;
 		for ( iByte = 0; iByte < nMaxOpcodes; iByte++ )
 		{
-			BYTE nData = (unsigned)*(LPBYTE)(mem + iAddress + iByte);
+			BYTE nData = (unsigned)MemReadByte(iAddress + iByte);
 			sprintf( &sOpcodes[ iByte * 3 ], "%02X ", nData );
 		}
 		sOpcodes[ nMaxOpcodes * 3 ] = 0;
@@ -3123,7 +3127,7 @@ void DrawSubWindow_Data (Update_t bUpdate)
 		iAddress = nAddress;
 		for (iByte = 0; iByte < nMaxOpcodes; iByte++ )
 		{
-			BYTE nImmediate = (unsigned)*(LPBYTE)(mem + iAddress);
+			BYTE nImmediate = (unsigned)MemReadByte(iAddress);
 			/*int iTextBackground = iBackground;
 			if ((iAddress >= _6502_IO_BEGIN) && (iAddress <= _6502_IO_END))
 			{
@@ -3240,10 +3244,10 @@ static void DrawVideoScannerValue(int line, int vert, int horz, bool isVisible)
 //===========================================================================
 static void DrawVideoScannerInfo(int line)
 {
-	NTSC_VideoGetScannerAddressForDebugger();		// update g_nVideoClockHorz/g_nVideoClockVert
+	NTSC_VideoGetScannerAddressForDebugger();		// update the video clock (if stale)
 
-	int v = g_nVideoClockVert;
-	int h = g_nVideoClockHorz;
+	int v = NTSC_GetVideoClockVert();
+	int h = NTSC_GetVideoClockHorz();
 
 	if (g_videoScannerDisplayInfo.isHorzReal)
 	{
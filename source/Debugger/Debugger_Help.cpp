@@ -908,6 +908,18 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleColorizePrint( sText, " Usage: [address8 | address16 | symbol] ## [##]" );
 			ConsoleBufferPush( TEXT("  Output a byte or word to the IO address $C0xx" ) );
 			break;
+		case CMD_HEATMAP:
+			ConsoleColorizePrintFormat( sTemp, sText, " Usage: [%s | %s | %s | %s | %s]"
+				, g_aParameters[ PARAM_LIST  ].m_sName
+				, g_aParameters[ PARAM_SAVE  ].m_sName
+				, g_aParameters[ PARAM_RESET ].m_sName
+				, g_aParameters[ PARAM_ON    ].m_sName
+				, g_aParameters[ PARAM_OFF   ].m_sName
+			);
+			ConsoleBufferPush( " Counts reads/writes/executes of each address (main & aux) whilst debugging." );
+			ConsoleBufferPush( " Counts halve every ~1M cycles. No arguments lists the hottest addresses." );
+			ConsoleBufferPush( " On/Off: colour the mini memory dumps by heat (R=write, G=read, B=exec)." );
+			break;
 		case CMD_PROFILE:
 			ConsoleColorizePrintFormat( sTemp, sText, " Usage: [%s | %s | %s]"
 				, g_aParameters[ PARAM_RESET ].m_sName
@@ -947,6 +959,15 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleBufferPush( "  JSR will be stepped into AND out of." );
 			ConsoleBufferPush( "  Hotkey: Ctrl-Space" ); // TODO: FIXME
 			break;
+		case CMD_STEP_BACK:
+			ConsoleColorizePrint( sText, " Usage: [#]" );
+			ConsoleBufferPush( "  Reverse-steps, # times, to the previous instruction(s)" );
+			ConsoleBufferPush( "  Restores the nearest rewind snapshot, then re-executes forward." );
+			ConsoleBufferPush( "  Cards other than Disk II aren't rewound (eg. Mockingboard)." );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s", CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( sText, "%s   %s 10", CHC_EXAMPLE, pCommand->m_sName );
+			break;
 		case CMD_TRACE:
 			ConsoleColorizePrint( sText, " Usage: [#]" );
 			ConsoleBufferPush( "  Traces, # times, current instruction(s)" );
@@ -954,7 +975,17 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleBufferPush( "  Hotkey: Shift-Space" );
 			break;
 		case CMD_TRACE_FILE:
-			ConsoleColorizePrint( sText, " Usage: \"[filename]\" [v]" );
+			ConsoleColorizePrint( sText, " Usage: \"[filename]\" [v] [bin]" );
+			ConsoleBufferPush( "  v   : include video scanner info" );
+			ConsoleBufferPush( "  bin : binary trace; faster & smaller. Convert with TFC" );
+			break;
+		case CMD_TRACE_FILE_CONVERT:
+			ConsoleColorizePrint( sText, " Usage: \"binary-trace\" [\"text-trace\"]" );
+			ConsoleBufferPush( "  Converts a binary trace (TF ... bin) to a text trace" );
+			ConsoleBufferPush( "  Default text-trace is binary-trace with a .txt extension" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   TF \"Trace.bin\" bin", CHC_EXAMPLE );
+			ConsolePrintFormat( sText, "%s   TFC \"Trace.bin\"", CHC_EXAMPLE );
 			break;
 		case CMD_TRACE_LINE:
 			ConsoleColorizePrint( sText, " Usage: [#]" );
@@ -0,0 +1,349 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger trace file (text & binary)
+ *
+ * A text trace disassembles and formats every opcode as it's executed, which is slow and the files are huge.
+ * A binary trace just captures a fixed-size record per opcode (TraceBinaryRecord_t). The emulation thread
+ * copies each record into a ring, and a background thread writes the ring to the file.
+ * So a binary trace doesn't stop the debugger's GO from running in batches (see Breakpoint_X()).
+ * TraceBinaryConvert() renders a binary trace to the same text format, offline.
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../CPU.h"
+#include "../Memory.h"
+#include "../NTSC.h"
+#include "../Log.h"
+
+// Binary trace _______________________________________________________________
+
+	bool g_bTraceBinary = false;
+
+	static const UINT kRingRecords = 1 << 19;		// 16MB
+	static const UINT kWritePeriodMs = 10;
+
+	static TraceBinaryRecord_t* g_pRing = NULL;
+	static volatile LONG g_nRingHead = 0;			// Records put in the ring (written by emulation thread only)
+	static volatile LONG g_nRingTail = 0;			// Records written to the file (written by writer thread only)
+	static volatile LONG g_bWriteError = FALSE;
+
+	static FILE*  g_hFile = NULL;
+	static HANDLE g_hWriterThread = NULL;
+	static HANDLE g_hWriterStopEvent = NULL;
+	static bool   g_bWithVideoScanner = false;
+
+
+// Writer thread: write everything that's in the ring
+//===========================================================================
+static void TraceBinaryFlush ()
+{
+	const LONG nHead = g_nRingHead;
+	LONG nTail = g_nRingTail;
+
+	while (nTail != nHead)
+	{
+		const UINT uPos = (UINT)nTail & (kRingRecords - 1);
+		UINT uNum = (UINT)(nHead - nTail);
+		if (uNum > kRingRecords - uPos)
+			uNum = kRingRecords - uPos;		// Up to the end of the ring
+
+		if (fwrite( &g_pRing[uPos], sizeof(TraceBinaryRecord_t), uNum, g_hFile ) != uNum)
+			InterlockedExchange( &g_bWriteError, TRUE );	// Keep going, so the emulation thread never blocks
+
+		nTail += uNum;
+		InterlockedExchange( &g_nRingTail, nTail );
+	}
+}
+
+//===========================================================================
+static DWORD WINAPI TraceBinaryWriterThread (LPVOID)
+{
+	for (;;)
+	{
+		const bool bStop = WaitForSingleObject( g_hWriterStopEvent, kWritePeriodMs ) == WAIT_OBJECT_0;
+		TraceBinaryFlush();
+		if (bStop)
+			break;
+	}
+
+	return 0;
+}
+
+//===========================================================================
+bool TraceBinaryOpen ( const std::string & sFilePath, const bool bWithVideoScanner )
+{
+	_ASSERT(!g_bTraceBinary);
+	if (g_bTraceBinary)
+		return false;
+
+	g_hFile = fopen( sFilePath.c_str(), "wb" );
+	if (!g_hFile)
+		return false;
+
+	g_bWithVideoScanner = bWithVideoScanner;
+
+	TraceBinaryHeader_t header;
+	memset( &header, 0, sizeof(header) );
+	memcpy( header.sMagic, TRACE_BINARY_MAGIC, sizeof(header.sMagic) );
+	header.nVersion = TRACE_BINARY_VERSION;
+	header.nRecordSize = sizeof(TraceBinaryRecord_t);
+	header.nFlags = bWithVideoScanner ? TRACE_BINARY_FILE_VIDEO_SCANNER : 0;
+	header.nCpu = (BYTE) GetMainCpu();
+
+	if (!g_pRing)
+		g_pRing = new TraceBinaryRecord_t[kRingRecords];
+
+	g_nRingHead = 0;
+	g_nRingTail = 0;
+	g_bWriteError = FALSE;
+
+	DWORD dwThreadId;
+	g_hWriterStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);	// Manual-reset, initially non-signaled
+	if (g_hWriterStopEvent)
+		g_hWriterThread = CreateThread(NULL,			// lpThreadAttributes
+										0,				// dwStackSize
+										TraceBinaryWriterThread,
+										NULL,			// lpParameter
+										0,				// dwCreationFlags : 0 = Run immediately
+										&dwThreadId);	// lpThreadId
+
+	if (fwrite( &header, sizeof(header), 1, g_hFile ) != 1 || g_hWriterThread == NULL)
+	{
+		LogFileOutput("TraceBinaryOpen: failed to start trace: %s\n", sFilePath.c_str());
+		g_bTraceBinary = true;	// So TraceBinaryClose() tidies up
+		TraceBinaryClose();
+		return false;
+	}
+
+	g_bTraceBinary = true;
+	return true;
+}
+
+// Returns false if any records couldn't be written (eg. disk full)
+//===========================================================================
+bool TraceBinaryClose ()
+{
+	if (!g_bTraceBinary)
+		return true;
+
+	g_bTraceBinary = false;
+
+	if (g_hWriterThread)
+	{
+		SetEvent( g_hWriterStopEvent );		// Thread does a final flush
+		WaitForSingleObject( g_hWriterThread, INFINITE );
+		CloseHandle( g_hWriterThread );
+		g_hWriterThread = NULL;
+	}
+
+	if (g_hWriterStopEvent)
+	{
+		CloseHandle( g_hWriterStopEvent );
+		g_hWriterStopEvent = NULL;
+	}
+
+	if (fclose( g_hFile ) != 0)
+		g_bWriteError = TRUE;
+	g_hFile = NULL;
+
+	return !g_bWriteError;
+}
+
+// Emulation thread: record the state before the opcode at regs.pc is executed
+// . nCycles & nP are passed in, as mid-batch the CPU has these in locals
+//===========================================================================
+void TraceBinaryRecord ( const UINT64 nCycles, const BYTE nP )
+{
+	const LONG nHead = g_nRingHead;
+	while ((UINT)(nHead - g_nRingTail) >= kRingRecords)
+		Sleep(1);	// Ring is full: wait for the writer thread
+
+	TraceBinaryRecord_t& rec = g_pRing[(UINT)nHead & (kRingRecords - 1)];
+
+	rec.nCycles = nCycles;
+	rec.nPC = regs.pc;
+	rec.nA = regs.a;
+	rec.nX = regs.x;
+	rec.nY = regs.y;
+	rec.nSP = (BYTE) regs.sp;
+	rec.nP = nP;
+	rec.nFlags = memreadaux[regs.pc >> 8] ? TRACE_BINARY_RECORD_PC_AUX : 0;
+	rec.aOpcode[0] = MemReadByte( regs.pc );
+	rec.aOpcode[1] = MemReadByte( (regs.pc + 1) & 0xFFFF );
+	rec.aOpcode[2] = MemReadByte( (regs.pc + 2) & 0xFFFF );
+
+	if (g_bWithVideoScanner)
+	{
+		rec.nVideoVert = NTSC_GetVideoClockVert();
+		rec.nVideoHorz = NTSC_GetVideoClockHorz();
+		rec.nScannerAddr = NTSC_VideoGetScannerAddressForDebugger();
+		rec.nScannerData = MemReadByte( rec.nScannerAddr );
+	}
+	else
+	{
+		rec.nVideoVert = rec.nVideoHorz = rec.nScannerAddr = 0;
+		rec.nScannerData = 0;
+	}
+
+	memset( rec.aReserved, 0, sizeof(rec.aReserved) );
+
+	InterlockedExchange( &g_nRingHead, nHead + 1 );	// Publish the record to the writer thread
+}
+
+
+// Text trace _________________________________________________________________
+
+//===========================================================================
+const char* TraceTextHeader ( const bool bWithVideoScanner )
+{
+	return bWithVideoScanner
+//		? "0000 0000 0000 00   00 00 00 0000 --------  0000:90 90 90  NOP"
+		? "Vert Horz Addr Data A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n"
+//		: "00000000 00 00 00 0000 --------  0000:90 90 90  NOP"
+		: "Cycles   A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n";
+}
+
+//===========================================================================
+void TraceTextLine ( FILE* hFile, const bool bWithVideoScanner
+	, const UINT64 nCycles, const BYTE nA, const BYTE nX, const BYTE nY, const WORD nSP, const BYTE nP
+	, const WORD nVideoVert, const WORD nVideoHorz, const WORD nScannerAddr, const BYTE nScannerData
+	, const char* sDisassembly )
+{
+	char sFlags[] = "........";
+	WORD nRegFlags = nP;
+	int nFlag = _6502_NUM_FLAGS;
+	while (nFlag--)
+	{
+		int iFlag = (_6502_NUM_FLAGS - nFlag - 1);
+		bool bSet = (nRegFlags & 1);
+		if (bSet)
+			sFlags[nFlag] = g_aBreakpointSource[BP_SRC_FLAG_C + iFlag][0];
+		nRegFlags >>= 1;
+	}
+
+	if (bWithVideoScanner)
+	{
+		fprintf( hFile,
+			"%04X %04X %04X   %02X %02X %02X %02X %04X %s  %s\n",
+			nVideoVert,
+			nVideoHorz,
+			nScannerAddr,
+			nScannerData,
+			(unsigned)nA,
+			(unsigned)nX,
+			(unsigned)nY,
+			(unsigned)nSP,
+			(char*) sFlags
+			, sDisassembly
+		);
+	}
+	else
+	{
+		const UINT cycles = (UINT)nCycles;
+		fprintf( hFile,
+			"%08X %02X %02X %02X %04X %s  %s\n",
+			cycles,
+			(unsigned)nA,
+			(unsigned)nX,
+			(unsigned)nY,
+			(unsigned)nSP,
+			(char*) sFlags
+			, sDisassembly
+		);
+	}
+}
+
+
+// Converter __________________________________________________________________
+
+//===========================================================================
+bool TraceBinaryConvert ( const std::string & sFilePathIn, const std::string & sFilePathOut, UINT64 & nRecords_ )
+{
+	nRecords_ = 0;
+
+	FILE* hIn = fopen( sFilePathIn.c_str(), "rb" );
+	if (!hIn)
+		return false;
+
+	TraceBinaryHeader_t header;
+	if (fread( &header, sizeof(header), 1, hIn ) != 1 ||
+		memcmp( header.sMagic, TRACE_BINARY_MAGIC, sizeof(header.sMagic) ) != 0 ||
+		header.nVersion != TRACE_BINARY_VERSION ||
+		header.nRecordSize != sizeof(TraceBinaryRecord_t))
+	{
+		fclose( hIn );
+		return false;
+	}
+
+	FILE* hOut = fopen( sFilePathOut.c_str(), "wt" );
+	if (!hOut)
+	{
+		fclose( hIn );
+		return false;
+	}
+
+	// Disassemble with the traced CPU's opcode table
+	const Opcodes_t* pOpcodesOld = g_aOpcodes;
+	g_aOpcodes = (header.nCpu == CPU_6502) ? &g_aOpcodes6502[0] : &g_aOpcodes65C02[0];
+
+	const bool bWithVideoScanner = (header.nFlags & TRACE_BINARY_FILE_VIDEO_SCANNER) != 0;
+	fputs( TraceTextHeader( bWithVideoScanner ), hOut );
+
+	const UINT kReadRecords = 4096;
+	std::vector<TraceBinaryRecord_t> vRecords( kReadRecords );
+
+	size_t nRead;
+	while ((nRead = fread( &vRecords[0], sizeof(TraceBinaryRecord_t), kReadRecords, hIn )) > 0)
+	{
+		for (size_t i = 0; i < nRead; i++)
+		{
+			const TraceBinaryRecord_t& rec = vRecords[i];
+
+			DisasmLine_t line;
+			GetDisassemblyLineFromBytes( rec.nPC, rec.aOpcode, line );
+
+			char sDisassembly[ CONSOLE_WIDTH ];
+			FormatDisassemblyLine( line, sDisassembly, CONSOLE_WIDTH );
+
+			TraceTextLine( hOut, bWithVideoScanner
+				, rec.nCycles, rec.nA, rec.nX, rec.nY, 0x100 | rec.nSP, rec.nP
+				, rec.nVideoVert, rec.nVideoHorz, rec.nScannerAddr, rec.nScannerData
+				, sDisassembly );
+		}
+
+		nRecords_ += nRead;
+	}
+
+	g_aOpcodes = pOpcodesOld;
+
+	const bool bOK = !ferror( hIn ) && !ferror( hOut );
+	fclose( hIn );
+	if (fclose( hOut ) != 0)
+		return false;
+
+	return bOK;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Binary trace file (see Debugger_Trace.cpp):
+// . one fixed-size record per opcode, written via a ring buffer by a background thread
+// . converted offline to the same text format as a "TF" text trace
+
+	const char  TRACE_BINARY_MAGIC[8] = "AWTRACE";
+	const DWORD TRACE_BINARY_VERSION  = 1;
+
+	enum TraceBinaryFileFlags_e
+	{
+		TRACE_BINARY_FILE_VIDEO_SCANNER = (1 << 0)	// nVideoVert, nVideoHorz, nScannerAddr & nScannerData are valid
+	};
+
+	enum TraceBinaryRecordFlags_e
+	{
+		TRACE_BINARY_RECORD_PC_AUX = (1 << 0)		// Opcode was fetched from aux memory
+	};
+
+#pragma pack(push, 1)
+	struct TraceBinaryHeader_t
+	{
+		char  sMagic[8];
+		DWORD nVersion;
+		WORD  nRecordSize;
+		BYTE  nFlags;		// TraceBinaryFileFlags_e
+		BYTE  nCpu;			// eCpuType: for the opcode table when disassembling
+	};
+
+	struct TraceBinaryRecord_t	// State before the opcode is executed
+	{
+		UINT64 nCycles;
+		WORD   nPC;
+		BYTE   nA;
+		BYTE   nX;
+		BYTE   nY;
+		BYTE   nSP;			// $01xx
+		BYTE   nP;
+		BYTE   nFlags;		// TraceBinaryRecordFlags_e
+		BYTE   aOpcode[3];	// Only the opcode's length is used
+		BYTE   nScannerData;
+		WORD   nVideoVert;
+		WORD   nVideoHorz;
+		WORD   nScannerAddr;
+		BYTE   aReserved[6];
+	};
+#pragma pack(pop)
+
+	extern bool g_bTraceBinary; // File is open
+
+	bool TraceBinaryOpen   ( const std::string & sFilePath, const bool bWithVideoScanner );
+	bool TraceBinaryClose  ();
+	void TraceBinaryRecord ( const UINT64 nCycles, const BYTE nP );
+	bool TraceBinaryConvert( const std::string & sFilePathIn, const std::string & sFilePathOut, UINT64 & nRecords_ );
+
+	// Text trace format, shared by "TF" and the binary trace converter
+	const char* TraceTextHeader ( const bool bWithVideoScanner );
+	void        TraceTextLine   ( FILE* hFile, const bool bWithVideoScanner
+		, const UINT64 nCycles, const BYTE nA, const BYTE nX, const BYTE nY, const WORD nSP, const BYTE nP
+		, const WORD nVideoVert, const WORD nVideoHorz, const WORD nScannerAddr, const BYTE nScannerData
+		, const char* sDisassembly );
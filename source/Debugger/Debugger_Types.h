@@ -297,6 +297,7 @@
 		, CMD_OUT
 		, CMD_LBR
 // CPU - Meta Info
+		, CMD_HEATMAP
 		, CMD_PROFILE
 		, CMD_REGISTER_SET
 // CPU - Stack
@@ -307,9 +308,11 @@
 //		, CMD_STACK_RETURN
 		, CMD_STEP_OVER
 		, CMD_STEP_OUT
+		, CMD_STEP_BACK
 // CPU - Meta Info
 		, CMD_TRACE
 		, CMD_TRACE_FILE
+		, CMD_TRACE_FILE_CONVERT
 		, CMD_TRACE_LINE
 		, CMD_UNASSEMBLE
 // Bookmarks
@@ -611,8 +614,10 @@
 	Update_t CmdLBR                (int nArgs);
 	Update_t CmdStepOver           (int nArgs);
 	Update_t CmdStepOut            (int nArgs);
+	Update_t CmdStepBack           (int nArgs);
 	Update_t CmdTrace              (int nArgs);  // alias for CmdStepIn
 	Update_t CmdTraceFile          (int nArgs);
+	Update_t CmdTraceFileConvert   (int nArgs);
 	Update_t CmdTraceLine          (int nArgs);
 	Update_t CmdUnassemble         (int nArgs); // code dump, aka, Unassemble
 // Bookmarks
@@ -644,6 +649,7 @@
 	Update_t CmdBenchmark          (int nArgs);
 	Update_t CmdBenchmarkStart     (int nArgs); //Update_t CmdSetupBenchmark (int nArgs);
 	Update_t CmdBenchmarkStop      (int nArgs); //Update_t CmdExtBenchmark (int nArgs);
+	Update_t CmdHeatmap            (int nArgs);
 	Update_t CmdProfile            (int nArgs);
 	Update_t CmdProfileStart       (int nArgs);
 	Update_t CmdProfileStop        (int nArgs);
@@ -41,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Log.h"
 #include "Memory.h"
 #include "Registry.h"
+#include "Rewind.h"
 #include "SaveState.h"
 #include "YamlHelper.h"
 
@@ -57,6 +58,100 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // NB. Non-standard 4&4, with Vol=0x00 and Chk=0x00 (only a few match, eg. Wasteland, Legacy of the Ancients, Planetfall, Border Zone & Wizardry). [*1]
 const BYTE Disk2InterfaceCard::m_T00S00Pattern[] = {0xD5,0xAA,0x96,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xDE};
 
+bool Disk2InterfaceCard::m_useLSSTable = true;
+UINT64 Disk2InterfaceCard::m_rngSeed = 0;
+
+// LSS read-sequencing for 4 bit-cells at a time (used by DataLatchReadWOZNibble()):
+// . indexed by {shiftReg, latchDelay, the 4 output bits}, each entry is the LSS state after those 4 bit-cells
+// . m_latchDelay is only ever 0, 3, 4 or 7 (see DataLatchReadWOZ()), so it's stored as an index into g_lssLatchDelay[]
+struct LSSNibbleStep
+{
+	BYTE shiftReg;
+	BYTE latch;
+	BYTE latchDelayIdx;
+	bool latchUpdated;
+	bool dbgCntReset;		// m_dbgLatchDelayedCnt was reset to 0
+	BYTE dbgCntInc;			// then incremented this many times
+};
+
+static const int g_lssLatchDelay[4] = {0, 3, 4, 7};
+static LSSNibbleStep g_lssNibbleTable[256 * 4 * 16];
+static bool g_lssNibbleTableInit = false;
+
+static int LSSLatchDelayToIdx(const int latchDelay)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (g_lssLatchDelay[i] == latchDelay)
+			return i;
+	}
+	return -1;
+}
+
+// Each entry is the result of running the per bit-cell LSS in DataLatchReadWOZ() for 4 bit-cells
+static void InitLSSNibbleTable(void)
+{
+	if (g_lssNibbleTableInit)
+		return;
+
+	for (UINT shiftReg = 0; shiftReg < 256; shiftReg++)
+	{
+		for (UINT delayIdx = 0; delayIdx < 4; delayIdx++)
+		{
+			for (UINT bits = 0; bits < 16; bits++)
+			{
+				LSSNibbleStep& step = g_lssNibbleTable[(shiftReg << 6) | (delayIdx << 4) | bits];
+				memset(&step, 0, sizeof(step));
+
+				BYTE reg = (BYTE)shiftReg;
+				int latchDelay = g_lssLatchDelay[delayIdx];
+
+				for (int b = 3; b >= 0; b--)
+				{
+					reg <<= 1;
+					reg |= (bits >> b) & 1;
+
+					if (latchDelay)
+					{
+						latchDelay -= 4;
+						if (latchDelay < 0)
+							latchDelay = 0;
+
+						if (reg)
+						{
+							step.dbgCntReset = true;
+							step.dbgCntInc = 0;
+						}
+						else
+						{
+							latchDelay += 4;
+							step.dbgCntInc++;
+						}
+					}
+
+					if (!latchDelay)
+					{
+						step.latch = reg;
+						step.latchUpdated = true;
+
+						if (reg & 0x80)
+						{
+							latchDelay = 7;
+							reg = 0;
+						}
+					}
+				}
+
+				step.shiftReg = reg;
+				step.latchDelayIdx = (BYTE)LSSLatchDelayToIdx(latchDelay);
+				_ASSERT(LSSLatchDelayToIdx(latchDelay) >= 0);
+			}
+		}
+	}
+
+	g_lssNibbleTableInit = true;
+}
+
 Disk2InterfaceCard::Disk2InterfaceCard(UINT slot) :
 	Card(CT_Disk2, slot)
 {
@@ -70,6 +165,8 @@ Disk2InterfaceCard::Disk2InterfaceCard(UINT slot) :
 	m_is13SectorFirmware = false;
 
 	ResetLogicStateSequencer();
+	InitLSSNibbleTable();
+	SeedRNGs();
 
 	// if created by user in Config->Disk, then MemInitializeIO() won't be called
 	if (GetCxRomPeripheral())
@@ -94,6 +191,13 @@ Disk2InterfaceCard::~Disk2InterfaceCard(void)
 	UnregisterIoHandler(m_slot);
 }
 
+// Each drive has its own sequence, so they don't depend on the order the drives are accessed
+void Disk2InterfaceCard::SeedRNGs(void)
+{
+	for (UINT i=0; i<NUM_DRIVES; i++)
+		m_floppyDrive[i].m_rng.Seed(m_rngSeed + i);
+}
+
 bool Disk2InterfaceCard::GetEnhanceDisk(void) { return m_enhanceDisk; }
 void Disk2InterfaceCard::SetEnhanceDisk(bool bEnhanceDisk) { m_enhanceDisk = bEnhanceDisk; }
 
@@ -933,7 +1037,7 @@ void Disk2InterfaceCard::UpdateLatchForEmptyDrive(FloppyDrive* pDrive)
 	if ((g_nCumulativeCycles - pDrive->m_motorOnCycle) < MOTOR_ON_UNTIL_LSS_STABLE_CYCLES)
 		m_floppyLatch = 0x80;	// GH#864
 	else
-		m_floppyLatch = rand() & 0xFF;	// GH#748
+		m_floppyLatch = pDrive->m_rng.Next() & 0xFF;	// GH#748
 }
 
 void __stdcall Disk2InterfaceCard::ReadWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG uExecutedCycles)
@@ -1157,14 +1261,14 @@ void Disk2InterfaceCard::PreJitterCheck(int phase, BYTE latch)
 // . NB. This is likely to be the transition from DiskII firmware ($C6xx) to user-code ($801),
 //   so skipping 1 bit-cell here shouldn't matter.
 // . And (see comment [*1]) the T00S00 pattern only matches a handful of titles.
-void Disk2InterfaceCard::AddJitter(int phase, FloppyDisk& floppy)
+void Disk2InterfaceCard::AddJitter(FloppyDrive& drive)
 {
-	if (phase == 0 && m_foundT00S00Pattern)
+	if (drive.m_phase == 0 && m_foundT00S00Pattern)
 	{
-		if (rand() < RAND_THRESHOLD(1, 10))
+		if (drive.m_rng.Next() < DISK_RNG_THRESHOLD(1, 10))
 		{
 			LogOutput("Disk: T$00 jitter - slip 1 bitcell (PC=%04X)\n", regs.pc);
-			IncBitStream(floppy);
+			IncBitStream(drive.m_disk);
 		}
 		else
 		{
@@ -1220,7 +1324,7 @@ void __stdcall Disk2InterfaceCard::DataLatchReadWriteWOZ(WORD pc, WORD addr, BYT
 		m_latchDelay = 0;
 		drive.m_headWindow = 0;
 
-		AddJitter(drive.m_phase, floppy);	// Only call when skipping a big number of bit-cells (ie. >significantBitCells)
+		AddJitter(drive);	// Only call when skipping a big number of bit-cells (ie. >significantBitCells)
 	}
 
 	if (!bWrite)
@@ -1247,6 +1351,59 @@ void __stdcall Disk2InterfaceCard::DataLatchReadWriteWOZ(WORD pc, WORD addr, BYT
 		GetFrame().FrameDrawDiskStatus();
 }
 
+// Fast-path for DataLatchReadWOZ(): read the next 4 bit-cells using g_lssNibbleTable[]
+// . only when they're a nibble in the track's bitstream, and none of them is a weak bit (as the RNG is needed per weak bit)
+// . otherwise returns false, and the caller reads 1 bit-cell at a time
+__forceinline bool Disk2InterfaceCard::DataLatchReadWOZNibble(FloppyDrive& drive, FloppyDisk& floppy)
+{
+	if (!m_useLSSTable || m_resetSequencer)
+		return false;
+
+	if ((floppy.m_bitMask & 0x88) == 0 || floppy.m_bitOffset + 4 > floppy.m_bitCount)
+		return false;
+
+	const int latchDelayIdx = LSSLatchDelayToIdx(m_latchDelay);
+	if (latchDelayIdx < 0)
+		return false;
+
+	const BYTE n = floppy.m_trackimage[floppy.m_byte];
+	const UINT bits = (floppy.m_bitMask == 0x80) ? (n >> 4) : (n & 0xf);
+
+	// Head window for each of the 4 bit-cells is a 4-bit slice of this
+	const UINT window = ((drive.m_headWindow & 0xf) << 4) | bits;
+	if ((window & 0x78) == 0 || (window & 0x3c) == 0 || (window & 0x1e) == 0 || (window & 0x0f) == 0)
+		return false;	// weak bit
+
+	// Output bit is the head window's bit-1, ie. each bit-cell is output 1 bit-cell later
+	const LSSNibbleStep& step = g_lssNibbleTable[(m_shiftReg << 6) | (latchDelayIdx << 4) | ((window >> 1) & 0xf)];
+
+	drive.m_headWindow = (BYTE)((drive.m_headWindow << 4) | bits);
+
+	m_shiftReg = step.shiftReg;
+	m_latchDelay = g_lssLatchDelay[step.latchDelayIdx];
+	if (step.latchUpdated)
+		m_floppyLatch = step.latch;
+	m_dbgLatchDelayedCnt = (step.dbgCntReset ? 0 : m_dbgLatchDelayedCnt) + step.dbgCntInc;
+
+	// Same as 4x IncBitStream()
+	floppy.m_bitMask >>= 4;
+	if (!floppy.m_bitMask)
+	{
+		floppy.m_bitMask = 1 << 7;
+		floppy.m_byte++;
+	}
+
+	floppy.m_bitOffset += 4;
+	if (floppy.m_bitOffset == floppy.m_bitCount)
+	{
+		floppy.m_bitMask = 1 << 7;
+		floppy.m_bitOffset = 0;
+		floppy.m_byte = 0;
+	}
+
+	return true;
+}
+
 void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemainder)
 {
 	// m_diskLastReadLatchCycle = g_nCumulativeCycles;	// Not used by WOZ (only by NIB)
@@ -1269,12 +1426,20 @@ void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemain
 
 	for (UINT i = 0; i < bitCellRemainder; i++)
 	{
+#if !LOG_DISK_NIBBLES_READ	// Nibble logging needs every latch update
+		if (bitCellRemainder - i >= 4 && DataLatchReadWOZNibble(drive, floppy))
+		{
+			i += 4 - 1;
+			continue;
+		}
+#endif
+
 		BYTE n = floppy.m_trackimage[floppy.m_byte];
 
 		drive.m_headWindow <<= 1;
 		drive.m_headWindow |= (n & floppy.m_bitMask) ? 1 : 0;
 		BYTE outputBit = (drive.m_headWindow & 0xf)	? (drive.m_headWindow >> 1) & 1
-													: (rand() < RAND_THRESHOLD(3, 10)) ? 1 : 0;	// ~30% chance of a 1 bit (Ref: WOZ-2.0)
+													: (drive.m_rng.Next() < DISK_RNG_THRESHOLD(3, 10)) ? 1 : 0;	// ~30% chance of a 1 bit (Ref: WOZ-2.0)
 
 		IncBitStream(floppy);
 
@@ -1538,6 +1703,8 @@ void Disk2InterfaceCard::Reset(const bool bIsPowerCycle)
 		m_floppyDrive[DRIVE_2].m_spinning   = 0;
 		m_floppyDrive[DRIVE_2].m_writelight = 0;
 
+		SeedRNGs();
+
 		GetFrame().FrameRefreshStatus(DRAW_LEDS);
 	}
 
@@ -1939,7 +2106,8 @@ BYTE __stdcall Disk2InterfaceCard::IOWrite(WORD pc, WORD addr, BYTE bWrite, BYTE
 //    Split up 'Unit' putting some state into a new 'Floppy'
 // 5: Added: Sequencer Function
 // 6: Added: Drive Connected & Motor On Cycle
-static const UINT kUNIT_VERSION = 6;
+// 7: Added: RNG State
+static const UINT kUNIT_VERSION = 7;
 
 #define SS_YAML_VALUE_CARD_DISK2 "Disk]["
 
@@ -1965,6 +2133,7 @@ static const UINT kUNIT_VERSION = 6;
 #define SS_YAML_KEY_HEAD_WINDOW "Head Window"
 #define SS_YAML_KEY_LAST_STEPPER_CYCLE "Last Stepper Cycle"
 #define SS_YAML_KEY_MOTOR_ON_CYCLE "Motor On Cycle"
+#define SS_YAML_KEY_RNG_STATE "RNG State"
 
 #define SS_YAML_KEY_FLOPPY "Floppy"
 #define SS_YAML_KEY_FILENAME "Filename"
@@ -2015,6 +2184,7 @@ void Disk2InterfaceCard::SaveSnapshotDriveUnit(YamlSaveHelper& yamlSaveHelper, U
 	yamlSaveHelper.SaveHexUint4(SS_YAML_KEY_HEAD_WINDOW, m_floppyDrive[unit].m_headWindow);		// v4
 	yamlSaveHelper.SaveHexUint64(SS_YAML_KEY_LAST_STEPPER_CYCLE, m_floppyDrive[unit].m_lastStepperCycle);	// v4
 	yamlSaveHelper.SaveHexUint64(SS_YAML_KEY_MOTOR_ON_CYCLE, m_floppyDrive[unit].m_motorOnCycle);	// v6
+	yamlSaveHelper.SaveHexUint64(SS_YAML_KEY_RNG_STATE, m_floppyDrive[unit].m_rng.GetState());	// v7
 	yamlSaveHelper.SaveUint(SS_YAML_KEY_SPINNING, m_floppyDrive[unit].m_spinning);
 	yamlSaveHelper.SaveUint(SS_YAML_KEY_WRITE_LIGHT, m_floppyDrive[unit].m_writelight);
 
@@ -2152,6 +2322,11 @@ bool Disk2InterfaceCard::LoadSnapshotDriveUnitv4(YamlLoadHelper& yamlLoadHelper,
 		m_floppyDrive[unit].m_motorOnCycle = yamlLoadHelper.LoadUint64(SS_YAML_KEY_MOTOR_ON_CYCLE);
 	}
 
+	if (version >= 7)
+		m_floppyDrive[unit].m_rng.SetState(yamlLoadHelper.LoadUint64(SS_YAML_KEY_RNG_STATE));
+	else
+		m_floppyDrive[unit].m_rng.Seed(m_rngSeed + unit);
+
 	yamlLoadHelper.PopMap();
 
 	return bImageError;
@@ -2244,3 +2419,108 @@ bool Disk2InterfaceCard::LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT
 
 	return true;
 }
+
+//===========================================================================
+
+// Controller, LSS & head positions only: the track data isn't rewound (see Rewind.cpp)
+void Disk2InterfaceCard::SaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(m_currDrive);
+	buffer.Save(m_magnetStates);
+	buffer.Save(m_floppyLatch);
+	buffer.Save(m_floppyMotorOn);
+	buffer.Save(m_diskLastCycle);
+	buffer.Save(m_diskLastReadLatchCycle);
+	buffer.Save(m_shiftReg);
+	buffer.Save(m_latchDelay);
+	buffer.Save(m_resetSequencer);
+	buffer.Save(m_writeStarted);
+	buffer.Save(m_seqFunc);
+
+	for (UINT i=0; i<NUM_DRIVES; i++)
+	{
+		const FloppyDrive& drive = m_floppyDrive[i];
+		const FloppyDisk& floppy = drive.m_disk;
+
+		buffer.Save(floppy.m_imagehandle);
+		buffer.Save(drive.m_phasePrecise);
+		buffer.Save(drive.m_phase);
+		buffer.Save(drive.m_lastStepperCycle);
+		buffer.Save(drive.m_motorOnCycle);
+		buffer.Save(drive.m_headWindow);
+		buffer.Save(drive.m_spinning);
+		buffer.Save(drive.m_writelight);
+		buffer.Save(drive.m_rng.GetState());
+		buffer.Save(floppy.m_byte);
+		buffer.Save(floppy.m_bitOffset);
+		buffer.Save(floppy.m_bitMask);
+		buffer.Save(floppy.m_extraCycles);
+	}
+}
+
+void Disk2InterfaceCard::LoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(m_currDrive);
+	buffer.Load(m_magnetStates);
+	buffer.Load(m_floppyLatch);
+	buffer.Load(m_floppyMotorOn);
+	buffer.Load(m_diskLastCycle);
+	buffer.Load(m_diskLastReadLatchCycle);
+	buffer.Load(m_shiftReg);
+	buffer.Load(m_latchDelay);
+	buffer.Load(m_resetSequencer);
+	buffer.Load(m_writeStarted);
+	buffer.Load(m_seqFunc);
+
+	for (UINT i=0; i<NUM_DRIVES; i++)
+	{
+		FloppyDrive& drive = m_floppyDrive[i];
+		FloppyDisk& floppy = drive.m_disk;
+
+		ImageInfo* imagehandle;
+		float phasePrecise;
+		UINT64 rngState;
+		FloppyDrive savedDrive;
+		FloppyDisk savedFloppy;
+
+		buffer.Load(imagehandle);
+		buffer.Load(phasePrecise);
+		buffer.Load(savedDrive.m_phase);
+		buffer.Load(savedDrive.m_lastStepperCycle);
+		buffer.Load(savedDrive.m_motorOnCycle);
+		buffer.Load(savedDrive.m_headWindow);
+		buffer.Load(savedDrive.m_spinning);
+		buffer.Load(savedDrive.m_writelight);
+		buffer.Load(rngState);
+		buffer.Load(savedFloppy.m_byte);
+		buffer.Load(savedFloppy.m_bitOffset);
+		buffer.Load(savedFloppy.m_bitMask);
+		buffer.Load(savedFloppy.m_extraCycles);
+
+		drive.m_lastStepperCycle = savedDrive.m_lastStepperCycle;
+		drive.m_motorOnCycle = savedDrive.m_motorOnCycle;
+		drive.m_spinning = savedDrive.m_spinning;
+		drive.m_writelight = savedDrive.m_writelight;
+		drive.m_rng.SetState(rngState);
+
+		if (imagehandle != floppy.m_imagehandle)
+			continue;	// Disk was swapped since the snapshot: leave its head where it is
+
+		if (phasePrecise != drive.m_phasePrecise)
+		{
+			// Different track: write back the current one, and re-read on the next access
+			FlushCurrentTrack(i);
+			floppy.m_trackimagedata = false;
+		}
+
+		drive.m_phasePrecise = phasePrecise;
+		drive.m_phase = savedDrive.m_phase;
+		drive.m_headWindow = savedDrive.m_headWindow;
+		floppy.m_byte = savedFloppy.m_byte;
+		floppy.m_bitOffset = savedFloppy.m_bitOffset;
+		floppy.m_bitMask = savedFloppy.m_bitMask;
+		floppy.m_extraCycles = savedFloppy.m_extraCycles;
+	}
+
+	GetFrame().FrameRefreshStatus(DRAW_LEDS | DRAW_DISK_STATUS);
+}
@@ -40,6 +40,41 @@ const bool IMAGE_FORCE_WRITE_PROTECTED = true;
 const bool IMAGE_DONT_CREATE = false;
 const bool IMAGE_CREATE = true;
 
+// Per-drive PRNG for weak bits & jitter (instead of the CRT's rand(), which is slower, global, and differs between hosts)
+// . xorshift64*, and its state is persisted to the save-state, so disk emulation is reproducible
+class DiskRNG
+{
+public:
+	DiskRNG()
+	{
+		Seed(0);
+	}
+
+	void Seed(UINT64 seed)
+	{
+		m_state = seed + 0x9E3779B97F4A7C15ULL;	// Any non-zero state
+		if (m_state == 0)
+			m_state = 1;
+	}
+
+	UINT Next(void)
+	{
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		return (UINT)((m_state * 0x2545F4914F6CDD1DULL) >> 32);
+	}
+
+	UINT64 GetState(void) { return m_state; }
+	void SetState(UINT64 state) { m_state = state ? state : 1; }
+
+private:
+	UINT64 m_state;
+};
+
+// Probability of (num/den) for DiskRNG::Next()
+#define DISK_RNG_THRESHOLD(num, den) ((UINT)((0x100000000ULL * (num)) / (den)))
+
 class FloppyDisk
 {
 public:
@@ -118,6 +153,7 @@ public:
 	BYTE m_headWindow;
 	DWORD m_spinning;
 	DWORD m_writelight;
+	DiskRNG m_rng;			// Not cleared: seeded by Disk2InterfaceCard
 	FloppyDisk m_disk;
 };
 
@@ -167,6 +203,8 @@ public:
 	static std::string GetSnapshotCardName(void);
 	void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 	bool LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version);
+	void SaveRewind(class RewindBuffer& buffer);
+	void LoadRewind(class RewindBuffer& buffer);
 
 	void LoadLastDiskImage(const int drive);
 	void SaveLastDiskImage(const int drive);
@@ -179,6 +217,9 @@ public:
 	bool GetEnhanceDisk(void);
 	void SetEnhanceDisk(bool bEnhanceDisk);
 
+	static void SetLSSTableEnabled(bool enable) { m_useLSSTable = enable; }
+	static void SetRNGSeed(UINT64 seed) { m_rngSeed = seed; }
+
 	static BYTE __stdcall IORead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 	static BYTE __stdcall IOWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 
@@ -198,6 +239,7 @@ private:
 	void UpdateBitStreamOffsets(FloppyDisk& floppy);
 	__forceinline void IncBitStream(FloppyDisk& floppy);
 	void DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemainder);
+	__forceinline bool DataLatchReadWOZNibble(FloppyDrive& drive, FloppyDisk& floppy);
 	void DataLoadWriteWOZ(WORD pc, WORD addr, UINT bitCellRemainder);
 	void DataShiftWriteWOZ(WORD pc, WORD addr, ULONG uExecutedCycles);
 	void SetSequencerFunction(WORD addr);
@@ -207,7 +249,8 @@ private:
 	void UpdateLatchForEmptyDrive(FloppyDrive* pDrive);
 
 	void PreJitterCheck(int phase, BYTE latch);
-	void AddJitter(int phase, FloppyDisk& floppy);
+	void AddJitter(FloppyDrive& drive);
+	void SeedRNGs(void);
 
 	void SaveSnapshotFloppy(YamlSaveHelper& yamlSaveHelper, UINT unit);
 	void SaveSnapshotDriveUnit(YamlSaveHelper& yamlSaveHelper, UINT unit);
@@ -275,6 +318,9 @@ private:
 	SEQUENCER_FUNCTION m_seqFunc;
 	UINT m_dbgLatchDelayedCnt;
 
+	static bool m_useLSSTable;	// Read WOZ bit-cells a nibble at a time (see DataLatchReadWOZNibble())
+	static UINT64 m_rngSeed;	// For each drive's DiskRNG
+
 	// Jitter (GH#930)
 	static const BYTE m_T00S00Pattern[];
 	UINT m_T00S00PatternIdx;
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Core.h"
 #include "CardManager.h"
 #include "Disk.h"
+#include "Rewind.h"
 
 bool Disk2CardManager::IsConditionForFullSpeed(void)
 {
@@ -143,3 +144,26 @@ void Disk2CardManager::GetFilenameAndPathForSaveState(std::string& filename, std
 		}
 	}
 }
+
+// NB. The slot configuration can't change between saving & loading, as a h/w config change does Rewind_Reset()
+void Disk2CardManager::SaveRewind(RewindBuffer& buffer)
+{
+	for (UINT i = 0; i < NUM_SLOTS; i++)
+	{
+		if (GetCardMgr().QuerySlot(i) == CT_Disk2)
+		{
+			dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(i)).SaveRewind(buffer);
+		}
+	}
+}
+
+void Disk2CardManager::LoadRewind(RewindBuffer& buffer)
+{
+	for (UINT i = 0; i < NUM_SLOTS; i++)
+	{
+		if (GetCardMgr().QuerySlot(i) == CT_Disk2)
+		{
+			dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(i)).LoadRewind(buffer);
+		}
+	}
+}
@@ -15,4 +15,6 @@ public:
 	void Destroy(void);
 	bool IsAnyFirmware13Sector(void);
 	void GetFilenameAndPathForSaveState(std::string& filename, std::string& path);
+	void SaveRewind(class RewindBuffer& buffer);
+	void LoadRewind(class RewindBuffer& buffer);
 };
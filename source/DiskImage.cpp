@@ -82,6 +82,8 @@ ImageError_e ImageOpen(	const std::string & pszImageFilename,
 
 	*pWriteProtected = pImageInfo->bWriteProtected;
 
+	pImageInfo->pImageType->InitNibbleCache(pImageInfo);
+
 	return eIMAGE_ERROR_NONE;
 }
 
@@ -165,6 +167,25 @@ void ImageWriteTrack(	ImageInfo* const pImageInfo,
 
 //===========================================================================
 
+void ImageSetNibbleCacheEnabled(const bool enable)
+{
+	CImageBase::SetNibbleCacheEnabled(enable);
+}
+
+void ImageSetHardDiskMappingEnabled(const bool enable)
+{
+	CImageBase::SetHardDiskMappingEnabled(enable);
+}
+
+// gzip & zip images are written in the background, once they've not been written to for a while
+// . or when the image is closed (eg. ejected, or on shutdown)
+void ImageUpdateDeferredWrites(const bool bForce /*=false*/)
+{
+	CImageBase::UpdateDeferredWrites(bForce);
+}
+
+//===========================================================================
+
 bool ImageReadBlock(	ImageInfo* const pImageInfo,
 						UINT nBlock,
 						LPBYTE pBlockBuffer)
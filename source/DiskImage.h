@@ -95,4 +95,8 @@ UINT ImagePhaseToTrack(ImageInfo* const pImageInfo, const float phase, const boo
 UINT ImageGetMaxNibblesPerTrack(ImageInfo* const pImageInfo);
 bool ImageIsBootSectorFormatSector13(ImageInfo* const pImageInfo);
 
+void ImageSetNibbleCacheEnabled(const bool enable);
+void ImageSetHardDiskMappingEnabled(const bool enable);
+void ImageUpdateDeferredWrites(const bool bForce=false);
+
 void GetImageTitle(LPCTSTR pPathname, std::string & pImageName, std::string & pFullName);
@@ -62,6 +62,17 @@ ImageInfo::ImageInfo()
 	optimalBitTiming = 0;
 	bootSectorFormat = CWOZHelper::bootUnknown;
 	maxNibblesPerTrack = 0;
+	pNibbleCache = NULL;
+	nibbleCacheValid = 0;
+	bDeferredWrite = false;
+	dwLastWriteTick = 0;
+	hDeferredWriteThread = NULL;
+	pDeferredWriteBuffer = NULL;
+	uDeferredWriteSize = 0;
+	bDeferredWriteOK = false;
+	hFileMapping = NULL;
+	pMappedView = NULL;
+	uMappedSize = 0;
 }
 
 CImageBase::CImageBase()
@@ -103,6 +114,10 @@ BYTE CImageBase::ms_SectorNumber[NUM_SECTOR_ORDERS][0x10] =
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}
 };
 
+bool CImageBase::ms_bNibbleCache = true;
+bool CImageBase::ms_bMapHardDiskImages = true;
+std::vector<ImageInfo*> CImageBase::ms_deferredWriteImages;
+
 //-----------------------------------------------------------------------------
 
 bool CImageBase::WriteImageHeader(ImageInfo* pImageInfo, LPBYTE pHdr, const UINT hdrSize)
@@ -132,12 +147,69 @@ bool CImageBase::WriteTrack(ImageInfo* pImageInfo, const int nTrack, LPBYTE pTra
 
 //-----------------------------------------------------------------------------
 
+// Uncompressed hard disk images: map the whole file, so that block reads & writes are just a memcpy
+// . the view is flushed once there have been no writes for a while (see UpdateDeferredWrites()), and unmapped on close
+// . NB. page faults on a mapped file are serviced by clustered reads, so sequential blocks are effectively read-ahead
+bool CImageBase::MapImageFile(ImageInfo* pImageInfo)
+{
+	if (pImageInfo->pMappedView)
+		return true;
+
+	if (!ms_bMapHardDiskImages || pImageInfo->FileType != eFileNormal || pImageInfo->hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	const DWORD dwSize = GetFileSize(pImageInfo->hFile, NULL);
+	if (dwSize == 0 || dwSize == INVALID_FILE_SIZE)
+		return false;
+
+	pImageInfo->hFileMapping = CreateFileMapping(pImageInfo->hFile, NULL, pImageInfo->bWriteProtected ? PAGE_READONLY : PAGE_READWRITE, 0, 0, NULL);
+	if (pImageInfo->hFileMapping == NULL)
+		return false;
+
+	pImageInfo->pMappedView = (BYTE*) MapViewOfFile(pImageInfo->hFileMapping, pImageInfo->bWriteProtected ? FILE_MAP_READ : FILE_MAP_WRITE, 0, 0, 0);
+	if (pImageInfo->pMappedView == NULL)
+	{
+		LogFileOutput("DiskImage: failed to map image file: %s\n", pImageInfo->szFilename.c_str());
+		CloseHandle(pImageInfo->hFileMapping);
+		pImageInfo->hFileMapping = NULL;
+		return false;
+	}
+
+	pImageInfo->uMappedSize = dwSize;
+	return true;
+}
+
+void CImageBase::UnmapImageFile(ImageInfo* pImageInfo)
+{
+	if (pImageInfo->pMappedView)
+	{
+		FlushViewOfFile(pImageInfo->pMappedView, 0);
+		UnmapViewOfFile(pImageInfo->pMappedView);
+		pImageInfo->pMappedView = NULL;
+		pImageInfo->uMappedSize = 0;
+	}
+
+	if (pImageInfo->hFileMapping)
+	{
+		CloseHandle(pImageInfo->hFileMapping);
+		pImageInfo->hFileMapping = NULL;
+	}
+}
+
+//-------------------------------------
+
 bool CImageBase::ReadBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlockBuffer)
 {
 	long Offset = pImageInfo->uOffset + nBlock * HD_BLOCK_SIZE;
 
 	if (pImageInfo->FileType == eFileNormal)
 	{
+		if (MapImageFile(pImageInfo) && (UINT)Offset + HD_BLOCK_SIZE <= pImageInfo->uMappedSize)
+		{
+			memcpy(pBlockBuffer, &pImageInfo->pMappedView[Offset], HD_BLOCK_SIZE);
+			return true;
+		}
+
 		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
 			return false;
 
@@ -186,6 +258,17 @@ bool CImageBase::WriteBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlo
 
 		memcpy(&pImageInfo->pImageBuffer[offset], pBlockBuffer, HD_BLOCK_SIZE);
 	}
+	else if (pImageInfo->FileType == eFileNormal && !pImageInfo->bWriteProtected)
+	{
+		if (MapImageFile(pImageInfo) && (UINT)offset + HD_BLOCK_SIZE <= pImageInfo->uMappedSize)
+		{
+			memcpy(&pImageInfo->pMappedView[offset], pBlockBuffer, HD_BLOCK_SIZE);
+			MarkDeferredWrite(pImageInfo);
+			return true;
+		}
+
+		UnmapImageFile(pImageInfo);	// Appending to the file: it'll be re-mapped (at the new size) on the next access
+	}
 
 	if (!WriteImageData(pImageInfo, pBlockBuffer, HD_BLOCK_SIZE, offset))
 	{
@@ -223,18 +306,43 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 		if (!bRes || dwBytesWritten != uSrcSize)
 			return false;
 	}
-	else if (pImageInfo->FileType == eFileGZip)
+	else if (pImageInfo->FileType == eFileGZip || pImageInfo->FileType == eFileZip)
+	{
+		// NB. Only support Zip archives with a single file
+		// - there is no delete in a zipfile, so would need to copy files from old to new zip file!
+		_ASSERT(pImageInfo->uNumEntriesInZip <= 1);	// Should never occur, since image will be write-protected in CheckZipFile()
+		if (pImageInfo->FileType == eFileZip && pImageInfo->uNumEntriesInZip > 1)
+			return false;
+
+		// pImageBuffer is already up-to-date, so defer writing the entire compressed image (see UpdateDeferredWrites())
+		MarkDeferredWrite(pImageInfo);
+	}
+	else
+	{
+		_ASSERT(0);
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------
+
+// Write the entire compressed image (gzip or single-file zip) from pBuffer
+// . NB. Can be called from the deferred-write thread, so mustn't touch pImageInfo->pImageBuffer
+bool CImageBase::WriteCompressedImage(const ImageInfo* pImageInfo, const BYTE* pBuffer, const UINT uSize)
+{
+	if (pImageInfo->FileType == eFileGZip)
 	{
-		// Write entire compressed image each time (dirty track change or dirty disk removal or a HDD block is written)
 		gzFile hGZFile = gzopen(pImageInfo->szFilename.c_str(), "wb");
 		if (hGZFile == NULL)
 			return false;
 
-		int nLen = gzwrite(hGZFile, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+		int nLen = gzwrite(hGZFile, pBuffer, uSize);
 		int nRes = gzclose(hGZFile);	// close before returning (due to error) to avoid resource leak
 		hGZFile = NULL;
 
-		if (nLen != pImageInfo->uImageSize)
+		if (nLen != uSize)
 			return false;
 
 		if (nRes != Z_OK)
@@ -242,13 +350,6 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 	}
 	else if (pImageInfo->FileType == eFileZip)
 	{
-		// Write entire compressed image each time (dirty track change or dirty disk removal or a HDD block is written)
-		// NB. Only support Zip archives with a single file
-		// - there is no delete in a zipfile, so would need to copy files from old to new zip file!
-		_ASSERT(pImageInfo->uNumEntriesInZip == 1);	// Should never occur, since image will be write-protected in CheckZipFile()
-		if (pImageInfo->uNumEntriesInZip > 1)
-			return false;
-
 		zipFile hZipFile = zipOpen(pImageInfo->szFilename.c_str(), APPEND_STATUS_CREATE);
 		if (hZipFile == NULL)
 			return false;
@@ -261,7 +362,7 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 			if (nOpenedFileInZip != ZIP_OK)
 				throw false;
 
-			int nRes = zipWriteInFileInZip(hZipFile, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+			int nRes = zipWriteInFileInZip(hZipFile, pBuffer, uSize);
 			if (nRes != ZIP_OK)
 				throw false;
 
@@ -284,13 +385,111 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 		if (nRes != ZIP_OK)
 			return false;
 	}
-	else
+
+	return true;
+}
+
+DWORD WINAPI CImageBase::DeferredWriteThread(LPVOID lpParameter)
+{
+	ImageInfo* pImageInfo = (ImageInfo*) lpParameter;
+	pImageInfo->bDeferredWriteOK = WriteCompressedImage(pImageInfo, pImageInfo->pDeferredWriteBuffer, pImageInfo->uDeferredWriteSize);
+	return 0;
+}
+
+void CImageBase::MarkDeferredWrite(ImageInfo* pImageInfo)
+{
+	pImageInfo->bDeferredWrite = true;
+	pImageInfo->dwLastWriteTick = GetTickCount();
+
+	if (std::find(ms_deferredWriteImages.begin(), ms_deferredWriteImages.end(), pImageInfo) == ms_deferredWriteImages.end())
+		ms_deferredWriteImages.push_back(pImageInfo);
+}
+
+// Wait for (and clean-up after) any in-progress deferred write
+void CImageBase::WaitForDeferredWrite(ImageInfo* pImageInfo)
+{
+	if (pImageInfo->hDeferredWriteThread)
 	{
-		_ASSERT(0);
-		return false;
+		WaitForSingleObject(pImageInfo->hDeferredWriteThread, INFINITE);
+		CloseHandle(pImageInfo->hDeferredWriteThread);
+		pImageInfo->hDeferredWriteThread = NULL;
 	}
 
-	return true;
+	if (pImageInfo->pDeferredWriteBuffer)
+	{
+		if (!pImageInfo->bDeferredWriteOK)
+			LogFileOutput("DiskImage: failed to write compressed image: %s\n", pImageInfo->szFilename.c_str());
+
+		delete [] pImageInfo->pDeferredWriteBuffer;
+		pImageInfo->pDeferredWriteBuffer = NULL;
+	}
+}
+
+// Write a copy of the dirty image, either on a separate thread or (if bWait) synchronously
+void CImageBase::FlushDeferredWrite(ImageInfo* pImageInfo, const bool bWait)
+{
+	WaitForDeferredWrite(pImageInfo);
+
+	if (!pImageInfo->bDeferredWrite)
+		return;
+
+	pImageInfo->bDeferredWrite = false;
+
+	if (pImageInfo->FileType == eFileNormal)	// Mapped hard disk image
+	{
+		if (pImageInfo->pMappedView)
+			FlushViewOfFile(pImageInfo->pMappedView, 0);
+		return;
+	}
+
+	pImageInfo->uDeferredWriteSize = pImageInfo->uImageSize;
+	pImageInfo->pDeferredWriteBuffer = new BYTE[pImageInfo->uImageSize];
+	memcpy(pImageInfo->pDeferredWriteBuffer, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+	pImageInfo->bDeferredWriteOK = false;
+
+	if (!bWait)
+	{
+		DWORD dwThreadId;
+		pImageInfo->hDeferredWriteThread = CreateThread(NULL,			// lpThreadAttributes
+														0,				// dwStackSize
+														DeferredWriteThread,
+														pImageInfo,		// lpParameter
+														0,				// dwCreationFlags : 0 = Run immediately
+														&dwThreadId);	// lpThreadId
+		if (pImageInfo->hDeferredWriteThread)
+			return;
+	}
+
+	DeferredWriteThread(pImageInfo);
+	WaitForDeferredWrite(pImageInfo);
+}
+
+// Called periodically: write each dirty compressed image (or flush each mapped image) once it hasn't been written to for a while (or if bForce)
+void CImageBase::UpdateDeferredWrites(const bool bForce)
+{
+	const UINT kQuietPeriodMs = 1000;
+	const DWORD dwNow = GetTickCount();
+
+	for (UINT i=0; i<ms_deferredWriteImages.size(); i++)
+	{
+		ImageInfo* pImageInfo = ms_deferredWriteImages[i];
+
+		if (pImageInfo->hDeferredWriteThread && WaitForSingleObject(pImageInfo->hDeferredWriteThread, 0) == WAIT_OBJECT_0)
+			WaitForDeferredWrite(pImageInfo);
+
+		if (pImageInfo->bDeferredWrite && (bForce || (dwNow - pImageInfo->dwLastWriteTick) >= kQuietPeriodMs))
+			FlushDeferredWrite(pImageInfo, bForce);
+	}
+}
+
+// Pre: Image is being closed (eg. ejected, or on shutdown)
+void CImageBase::FinishDeferredWrite(ImageInfo* pImageInfo)
+{
+	FlushDeferredWrite(pImageInfo, true);
+
+	std::vector<ImageInfo*>::iterator it = std::find(ms_deferredWriteImages.begin(), ms_deferredWriteImages.end(), pImageInfo);
+	if (it != ms_deferredWriteImages.end())
+		ms_deferredWriteImages.erase(it);
 }
 
 //-----------------------------------------------------------------------------
@@ -583,6 +782,67 @@ void CImageBase::SkewTrack(const int nTrack, const int nNumNibbles, const LPBYTE
 
 //-------------------------------------
 
+// DO & PO: Nibblize each track once (when the image is opened), rather than each time the track is read
+void CImageBase::NibblizeAllTracks(ImageInfo* pImageInfo, SectorOrder_e SectorOrder)
+{
+	if (!ms_bNibbleCache || pImageInfo->uNumTracks > 64)
+		return;
+
+	_ASSERT(pImageInfo->pNibbleCache == NULL);
+	pImageInfo->pNibbleCache = new BYTE[pImageInfo->uNumTracks * NIBBLIZED_TRACK_SIZE];
+	pImageInfo->nibbleCacheValid = 0;
+
+	for (UINT track = 0; track < pImageInfo->uNumTracks; track++)
+	{
+		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		const DWORD nibbles = NibblizeTrack(&pImageInfo->pNibbleCache[track * NIBBLIZED_TRACK_SIZE], SectorOrder, track);
+		_ASSERT(nibbles == NIBBLIZED_TRACK_SIZE);
+		pImageInfo->nibbleCacheValid |= (UINT64)1 << track;
+	}
+}
+
+int CImageBase::ReadNibblizedTrack(ImageInfo* pImageInfo, SectorOrder_e SectorOrder, const UINT track, LPBYTE pTrackImageBuffer)
+{
+	if (pImageInfo->pNibbleCache == NULL || track >= pImageInfo->uNumTracks || !(pImageInfo->nibbleCacheValid & ((UINT64)1 << track)))
+	{
+		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		return NibblizeTrack(pTrackImageBuffer, SectorOrder, track);
+	}
+
+	memcpy(pTrackImageBuffer, &pImageInfo->pNibbleCache[track * NIBBLIZED_TRACK_SIZE], NIBBLIZED_TRACK_SIZE);
+	return NIBBLIZED_TRACK_SIZE;
+}
+
+// Pre: DenibblizeTrack() has just decoded the track into m_pWorkBuffer
+// . If the nibblized track is cached, then only re-encode the changed sectors, and don't write the track if none changed
+void CImageBase::WriteDenibblizedTrack(ImageInfo* pImageInfo, SectorOrder_e SectorOrder, const UINT track)
+{
+	if (pImageInfo->pNibbleCache && track < pImageInfo->uNumTracks && (pImageInfo->nibbleCacheValid & ((UINT64)1 << track)))
+	{
+		const LPBYTE pImageTrack = &pImageInfo->pImageBuffer[pImageInfo->uOffset + track * TRACK_DENIBBLIZED_SIZE];
+		const LPBYTE pCachedTrack = &pImageInfo->pNibbleCache[track * NIBBLIZED_TRACK_SIZE];
+		bool bChanged = false;
+
+		for (UINT sector = 0; sector < NUM_SECTORS; sector++)
+		{
+			const UINT offset = ms_SectorNumber[SectorOrder][sector] << 8;
+			if (memcmp(m_pWorkBuffer + offset, pImageTrack + offset, 256) == 0)
+				continue;
+
+			// Code62() only uses the work buffer above TRACK_DENIBBLIZED_SIZE, so the decoded track is preserved
+			memcpy(pCachedTrack + NIBBLIZED_DATA_FIELD_OFFSET + sector * (NIBBLIZED_TRACK_SIZE-48)/NUM_SECTORS, Code62(ms_SectorNumber[SectorOrder][sector]), 343);
+			bChanged = true;
+		}
+
+		if (!bChanged)
+			return;
+	}
+
+	WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+}
+
+//-------------------------------------
+
 bool CImageBase::IsValidImageSize(const DWORD uImageSize)
 {
 	m_uNumTracksInImage = 0;
@@ -660,8 +920,7 @@ public:
 	virtual void Read(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int* pNibbles, UINT* pBitCount, bool enhanceDisk)
 	{
 		const UINT track = PhaseToTrack(phase);
-		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
-		*pNibbles = NibblizeTrack(pTrackImageBuffer, eDOSOrder, track);
+		*pNibbles = ReadNibblizedTrack(pImageInfo, eDOSOrder, track, pTrackImageBuffer);
 		if (!enhanceDisk)
 			SkewTrack(track, *pNibbles, pTrackImageBuffer);
 	}
@@ -670,9 +929,11 @@ public:
 	{
 		const UINT track = PhaseToTrack(phase);
 		DenibblizeTrack(pTrackImageBuffer, eDOSOrder, nNibbles);
-		WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		WriteDenibblizedTrack(pImageInfo, eDOSOrder, track);
 	}
 
+	virtual void InitNibbleCache(ImageInfo* pImageInfo) { NibblizeAllTracks(pImageInfo, eDOSOrder); }
+
 	virtual bool AllowCreate(void) { return true; }
 	virtual UINT GetImageSizeForCreate(void) { m_uNumTracksInImage = TRACKS_STANDARD; return TRACK_DENIBBLIZED_SIZE * TRACKS_STANDARD; }
 
@@ -728,8 +989,7 @@ public:
 	virtual void Read(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int* pNibbles, UINT* pBitCount, bool enhanceDisk)
 	{
 		const UINT track = PhaseToTrack(phase);
-		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
-		*pNibbles = NibblizeTrack(pTrackImageBuffer, eProDOSOrder, track);
+		*pNibbles = ReadNibblizedTrack(pImageInfo, eProDOSOrder, track, pTrackImageBuffer);
 		if (!enhanceDisk)
 			SkewTrack(track, *pNibbles, pTrackImageBuffer);
 	}
@@ -738,9 +998,11 @@ public:
 	{
 		const UINT track = PhaseToTrack(phase);
 		DenibblizeTrack(pTrackImageBuffer, eProDOSOrder, nNibbles);
-		WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		WriteDenibblizedTrack(pImageInfo, eProDOSOrder, track);
 	}
 
+	virtual void InitNibbleCache(ImageInfo* pImageInfo) { NibblizeAllTracks(pImageInfo, eProDOSOrder); }
+
 	virtual eImageType GetType(void) { return eImagePO; }
 	virtual const char* GetCreateExtensions(void) { return ".po"; }
 	virtual const char* GetRejectExtensions(void) { return ".do;.iie;.nib;.prg;.woz"; }
@@ -1007,10 +1269,10 @@ public:
 			return false;
 		}
 
-		ReadFile(ptr->hFile, mem+address, length, &bytesread, NULL);
-		int loop = 192;
-		while (loop--)
-			*(memdirty+loop) = 0xFF;
+		BYTE* pBuffer = new BYTE[length];
+		ReadFile(ptr->hFile, pBuffer, length, &bytesread, NULL);
+		MemWriteBlock(address, pBuffer, length);	// NB. Also sets memdirty[]
+		delete [] pBuffer;
 
 		regs.pc = address;
 		return true;
@@ -1061,11 +1323,10 @@ public:
 		}
 
 		SetFilePointer(pImageInfo->hFile,128,NULL,FILE_BEGIN);
-		ReadFile(pImageInfo->hFile, mem+address, length, &bytesread, NULL);
-
-		int loop = 192;
-		while (loop--)
-			*(memdirty+loop) = 0xFF;
+		BYTE* pBuffer = new BYTE[length];
+		ReadFile(pImageInfo->hFile, pBuffer, length, &bytesread, NULL);
+		MemWriteBlock(address, pBuffer, length);	// NB. Also sets memdirty[]
+		delete [] pBuffer;
 
 		regs.pc = address;
 		return true;
@@ -1948,6 +2209,9 @@ ImageError_e CImageHelperBase::Open(	LPCTSTR pszImageFilename,
 
 void CImageHelperBase::Close(ImageInfo* pImageInfo)
 {
+	CImageBase::FinishDeferredWrite(pImageInfo);
+	CImageBase::UnmapImageFile(pImageInfo);
+
 	if (pImageInfo->hFile != INVALID_HANDLE_VALUE)
 	{
 		CloseHandle(pImageInfo->hFile);
@@ -1958,6 +2222,10 @@ void CImageHelperBase::Close(ImageInfo* pImageInfo)
 
 	delete [] pImageInfo->pImageBuffer;
 	pImageInfo->pImageBuffer = NULL;
+
+	delete [] pImageInfo->pNibbleCache;
+	pImageInfo->pNibbleCache = NULL;
+	pImageInfo->nibbleCacheValid = 0;
 }
 
 //-------------------------------------
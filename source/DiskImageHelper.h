@@ -40,6 +40,19 @@ struct ImageInfo
 	BYTE			optimalBitTiming;	// WOZ only
 	BYTE			bootSectorFormat;	// WOZ only
 	UINT			maxNibblesPerTrack;
+	BYTE*			pNibbleCache;		// DO & PO only: uNumTracks nibblized tracks (see CImageBase::ReadNibblizedTrack())
+	UINT64			nibbleCacheValid;	// DO & PO only: bitmap of tracks in pNibbleCache
+	// gzip & zip only: deferred write-back of pImageBuffer (see CImageBase::UpdateDeferredWrites())
+	bool			bDeferredWrite;
+	DWORD			dwLastWriteTick;
+	HANDLE			hDeferredWriteThread;
+	BYTE*			pDeferredWriteBuffer;
+	UINT			uDeferredWriteSize;
+	bool			bDeferredWriteOK;
+	// Hard disk (uncompressed) only: file mapping (see CImageBase::MapImageFile())
+	HANDLE			hFileMapping;
+	BYTE*			pMappedView;
+	UINT			uMappedSize;
 
 	ImageInfo();
 };
@@ -66,6 +79,8 @@ public:
 	virtual void Write(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int nNibbles) { }
 	virtual bool Write(ImageInfo* pImageInfo, UINT nBlock, LPBYTE pBlockBuffer) { return false; }
 
+	virtual void InitNibbleCache(ImageInfo* pImageInfo) { }	// Only:    DO and PO
+
 	virtual bool AllowBoot(void) { return false; }		// Only:    APL and PRG
 	virtual bool AllowRW(void) { return true; }			// All but: APL and PRG
 	virtual bool AllowCreate(void) { return false; }	// WE CREATE ONLY DOS ORDER (DO) OR 6656-NIBBLE (NIB) FORMAT FILES
@@ -84,6 +99,14 @@ public:
 	// . phase=4,-1 half phase = phase 3.5 => ceil(3.5)/2 = track 2 (OK)
 	UINT PhaseToTrack(const float phase) { return ((UINT)ceil(phase)) >> 1; }
 
+	static void SetNibbleCacheEnabled(const bool enable) { ms_bNibbleCache = enable; }
+
+	static void SetHardDiskMappingEnabled(const bool enable) { ms_bMapHardDiskImages = enable; }
+	static void UnmapImageFile(ImageInfo* pImageInfo);
+
+	static void UpdateDeferredWrites(const bool bForce);
+	static void FinishDeferredWrite(ImageInfo* pImageInfo);
+
 	enum SectorOrder_e {eProDOSOrder, eDOSOrder, eSIMSYSTEMOrder, NUM_SECTOR_ORDERS};
 
 protected:
@@ -93,18 +116,35 @@ protected:
 	bool WriteBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlockBuffer);
 	bool WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const UINT uSrcSize, const long offset);
 
+	bool MapImageFile(ImageInfo* pImageInfo);
+	static bool WriteCompressedImage(const ImageInfo* pImageInfo, const BYTE* pBuffer, const UINT uSize);
+	static DWORD WINAPI DeferredWriteThread(LPVOID lpParameter);
+	static void WaitForDeferredWrite(ImageInfo* pImageInfo);
+	static void FlushDeferredWrite(ImageInfo* pImageInfo, const bool bWait);
+	static void MarkDeferredWrite(ImageInfo* pImageInfo);
+
 	LPBYTE Code62(int sector);
 	void Decode62(LPBYTE imageptr);
 	void DenibblizeTrack (LPBYTE trackimage, SectorOrder_e SectorOrder, int nibbles);
 	DWORD NibblizeTrack (LPBYTE trackimagebuffer, SectorOrder_e SectorOrder, int track);
 	void SkewTrack (const int nTrack, const int nNumNibbles, const LPBYTE pTrackImageBuffer);
 
+	void NibblizeAllTracks(ImageInfo* pImageInfo, SectorOrder_e SectorOrder);
+	int ReadNibblizedTrack(ImageInfo* pImageInfo, SectorOrder_e SectorOrder, const UINT track, LPBYTE pTrackImageBuffer);
+	void WriteDenibblizedTrack(ImageInfo* pImageInfo, SectorOrder_e SectorOrder, const UINT track);
+
+	static const UINT NIBBLIZED_TRACK_SIZE = 48 + NUM_SECTORS*(14+6+3+343+3+27);	// See NibblizeTrack()
+	static const UINT NIBBLIZED_DATA_FIELD_OFFSET = 48 + 14+6+3;	// For sector 0, then +(NIBBLIZED_TRACK_SIZE-48)/NUM_SECTORS per sector
+
 public:
 	UINT m_uNumTracksInImage;	// Init'd by CDiskImageHelper.Detect()/GetImageForCreation() & possibly updated by IsValidImageSize()
 
 protected:
 	static BYTE ms_DiskByte[0x40];
 	static BYTE ms_SectorNumber[NUM_SECTOR_ORDERS][NUM_SECTORS];
+	static bool ms_bNibbleCache;
+	static bool ms_bMapHardDiskImages;
+	static std::vector<ImageInfo*> ms_deferredWriteImages;	// gzip & zip images with a pending or in-progress write
 	BYTE m_uVolumeNumber;
 	LPBYTE m_pWorkBuffer;
 };
@@ -52,7 +52,10 @@ void FrameBase::VideoRedrawScreenDuringFullSpeed(DWORD dwCyclesThisFrame, bool b
 
 	dwFullSpeedStartTime += dwFullSpeedDuration;
 
-	VideoRedrawScreenAfterFullSpeed(dwCyclesThisFrame);
+	if (NTSC_IsVideoRenderThread())
+		VideoPresentScreen();	// Just present the last captured video frame (see NTSC_VideoCaptureAtFullSpeed())
+	else
+		VideoRedrawScreenAfterFullSpeed(dwCyclesThisFrame);
 }
 
 void FrameBase::VideoRedrawScreenAfterFullSpeed(DWORD dwCyclesThisFrame)
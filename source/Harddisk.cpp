@@ -490,7 +490,7 @@ BYTE __stdcall HarddiskInterfaceCard::IORead(WORD pc, WORD addr, BYTE bWrite, BY
 							{
 								memset(pHDD->m_buf, 0, HD_BLOCK_SIZE);
 
-								// Inefficient (especially for gzip/zip files!)
+								// Inefficient (for gzip/zip files the image buffer is re-allocated per block, although writing the compressed image is deferred)
 								UINT uBlock = ImageGetImageSize(pHDD->m_imagehandle) / HD_BLOCK_SIZE;
 								while (uBlock < pHDD->m_diskblock)
 								{
@@ -501,7 +501,7 @@ BYTE __stdcall HarddiskInterfaceCard::IORead(WORD pc, WORD addr, BYTE bWrite, BY
 								}
 							}
 
-							memmove(pHDD->m_buf, mem+pHDD->m_memblock, HD_BLOCK_SIZE);
+							MemReadBlock(pHDD->m_buf, pHDD->m_memblock, HD_BLOCK_SIZE);
 
 							if (bRes)
 								bRes = ImageWriteBlock(pHDD->m_imagehandle, pHDD->m_diskblock, pHDD->m_buf);
@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Memory.h"
 #include "YamlHelper.h"
 #include "Interface.h"
+#include "Rewind.h"
 
 #include "Configuration/PropertySheet.h"
 
@@ -1050,3 +1051,15 @@ void JoyLoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
 
 	yamlLoadHelper.PopMap();
 }
+
+//===========================================================================
+
+void JoySaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(g_paddleInactiveCycle);
+}
+
+void JoyLoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(g_paddleInactiveCycle);
+}
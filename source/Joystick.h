@@ -29,6 +29,8 @@ void	JoySetHookAltKeys(bool hook);
 void	JoySetButtonVirtualKey(UINT button, UINT virtKey);
 void    JoySaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    JoyLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
+void    JoySaveRewind(class RewindBuffer& buffer);
+void    JoyLoadRewind(class RewindBuffer& buffer);
 
 BYTE __stdcall JoyReadButton(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 BYTE __stdcall JoyReadPosition(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Tape.h"
 #include "YamlHelper.h"
 #include "Log.h"
+#include "Rewind.h"
 
 static BYTE asciicode[3][10] = {
 	// VK_LEFT/UP/RIGHT/DOWN/SELECT, VK_PRINT/EXECUTE/SNAPSHOT/INSERT/DELETE
@@ -55,6 +56,7 @@ static bool  g_bCapsLock = true; //Caps lock key for Apple2 and Lat/Cyr lock for
 static BYTE  keycode         = 0;	// Current Apple keycode
 static BOOL  keywaiting      = 0;
 static bool  g_bAltGrSendsWM_CHAR = false;
+static UINT  g_uReadDataCount = 0;	// Number of $C000-$C00F reads, eg. to detect a program polling for a key
 
 //
 // ----- ALL GLOBALLY ACCESSIBLE FUNCTIONS ARE BELOW THIS LINE -----
@@ -111,6 +113,12 @@ BYTE KeybGetKeycode ()		// Used by IORead_C01x() and TapeRead() for Pravets8A
 	return keycode;
 }
 
+//===========================================================================
+UINT KeybGetReadDataCount ()	// Used by the boot benchmark
+{
+	return g_uReadDataCount;
+}
+
 //===========================================================================
 
 static bool IsVirtualKeyAnAppleIIKey(WPARAM wparam);
@@ -398,6 +406,7 @@ static bool IsAKD(void)
 BYTE KeybReadData (void)
 {
 	LogFileTimeUntilFirstKeyRead();
+	g_uReadDataCount++;
 
 	if (g_bPasteFromClipboard)
 		ClipboardInit();
@@ -482,3 +491,17 @@ void KeybLoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
 
 	yamlLoadHelper.PopMap();
 }
+
+//===========================================================================
+
+void KeybSaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(keycode);
+	buffer.Save(keywaiting);
+}
+
+void KeybLoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(keycode);
+	buffer.Load(keywaiting);
+}
@@ -12,6 +12,7 @@ bool    KeybGetCtrlStatus();
 bool    KeybGetShiftStatus();
 void    KeybUpdateCtrlShiftStatus();
 BYTE    KeybGetKeycode ();
+UINT    KeybGetReadDataCount ();
 void    KeybQueueKeypress(WPARAM key, Keystroke_e bASCII);
 void    KeybToggleCapsLock ();
 void    KeybToggleP8ACapsLock ();
@@ -20,3 +21,5 @@ BYTE    KeybReadData (void);
 BYTE    KeybReadFlag (void);
 void    KeybSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    KeybLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
+void    KeybSaveRewind(class RewindBuffer& buffer);
+void    KeybLoadRewind(class RewindBuffer& buffer);
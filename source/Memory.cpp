@@ -56,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Tape.h"
 #include "Tfe/tfe.h"
 #include "RGBMonitor.h"
+#include "Rewind.h"
 
 #include "z80emu.h"
 #include "Z80VICE/z80.h"
@@ -161,59 +162,43 @@ SOFT SWITCH STATUS FLAGS
 // Notes
 // -----
 //
-// memimage
-// - 64KB
-//
-// mem
-// (a pointer to memimage 64KB)
-// - a 64KB r/w memory cache
-// - reflects the current readable memory in the 6502's 64K address space
-//		. excludes $Cxxx I/O memory
-//		. could be a mix of RAM/ROM, main/aux, etc
-// - may also reflect the current writeable memory (on a 256-page granularity) if the write page addr == read page addr
-//		. for this case, the memdirty flag(s) are valid
-//		. when writes instead occur to backing-store, then memdirty flag(s) can be ignored
-//
 // memmain, memaux
 // - physical contiguous 64KB "backing-store" for main & aux respectively
 // - NB. 4K bank1 BSR is at $C000-$CFFF
+// - always up-to-date, as the 6502 reads & writes them directly (via memread & memwrite)
+//
+// memread
+// - 1 pointer entry per 256-byte page
+// - reflects the current readable memory in the 6502's 64K address space (at a 256-byte granularity)
+//		. could be a mix of RAM/ROM, main/aux, etc
+//		. $Cxxx points to the internal or peripheral ROMs (but the 6502 reads $Cxxx via the I/O handlers)
+//		. EG: if ALTZP=1, then:
+//			. memread[0] = &memaux[0x0000]
+//			. memread[1] = &memaux[0x0100]
+// - a paging change just updates the pointers, so no memory is copied
 //
 // memwrite
 // - 1 pointer entry per 256-byte page
 // - used to write to a page
-// - if RD & WR point to the same 256-byte RAM page, then memwrite will point to the page in 'mem'
-//		. ie. when SW_AUXREAD==SW_AUXWRITE, or 4K-BSR is r/w, or 8K BSR is r/w, or SW_80STORE=1
-//		. So 'mem' remains correct for both r&w operations, but the physical 64K mem block becomes stale
-// - if RD & WR point to different 256-byte pages, then memwrite will point to the page in the physical 64K mem block
-//		. writes will still set the dirty flag (but can be ignored)
-//		. UpdatePaging() ignores this, as it only copies back to the physical 64K mem block when memshadow changes (for that 256-byte page)
+//		. ie. when SW_AUXREAD==SW_AUXWRITE, or 4K-BSR is r/w, or 8K BSR is r/w, or SW_80STORE=1, then memwrite == memread
+// - NULL for ROM (and $Cxxx I/O memory)
 //
 // memdirty
 // - 1 byte entry per 256-byte page
 // - set when a write occurs to a 256-byte page
-// - indicates that 'mem' (ie. the cache) is out-of-sync with the "physical" 64K backing-store memory
-// - NB. a page's dirty flag is only useful(valid) when 'mem' is used for both read & write for the corresponding page
-//   When they differ, then writes go directly to the backing-store.
-//   . In this case, the dirty flag will just force a memcpy() to the same address in backing-store.
-//
-// memshadow
-// - 1 pointer entry per 256-byte page
-// - reflects how 'mem' is setup for read operations (at a 256-byte granularity)
-//		. EG: if ALTZP=1, then:
-//			. mem will have copies of memaux's ZP & stack
-//			. memshadow[0] = &memaux[0x0000]
-//			. memshadow[1] = &memaux[0x0100]
+// - bit0 is cleared by the NTSC scanline cache, bit1 by the CPU's block cache (see MEMDIRTY_xxx)
 //
 
-static LPBYTE  memshadow[0x100];
+LPBYTE         memread[0x100];
 LPBYTE         memwrite[0x100];
+BYTE           memreadaux[0x100];	// 1 if memread[] page is aux memory (for the debugger's heatmap)
+BYTE           memwriteaux[0x100];
+BYTE           memreadram[0x100];	// 1 if memread[] page is RAM (ie. not ROM or I/O), so MemWriteByte() can modify it
 
 iofunction		IORead[256];
 iofunction		IOWrite[256];
 static LPVOID	SlotParameters[NUM_SLOTS];
 
-LPBYTE         mem          = NULL;
-
 //
 
 static LPBYTE  memaux       = NULL;
@@ -222,15 +207,12 @@ static LPBYTE  memmain      = NULL;
 LPBYTE         memdirty     = NULL;
 static LPBYTE  memrom       = NULL;
 
-static LPBYTE  memimage     = NULL;
-
 static LPBYTE	pCxRomInternal		= NULL;
 static LPBYTE	pCxRomPeripheral	= NULL;
 
 static LPBYTE g_pMemMainLanguageCard = NULL;
 
 static DWORD   memmode      = LanguageCardUnit::kMemModeInitialState;
-static BOOL    modechanging = 0;				// An Optimisation: means delay calling UpdatePaging() for 1 instruction
 
 static UINT    memrompages = 1;
 
@@ -778,6 +760,17 @@ static bool IsCardInSlot(const UINT uSlot);
 // . Reset: On access to $CFFF or an MMU reset
 //
 
+// Update the read pointers for $C800-$CFFF, eg. after INTC8ROM has changed
+static void UpdatePagingForExpansionRom(void)
+{
+	for (UINT loop = 0xC8; loop < 0xD0; loop++)
+	{
+		const UINT uRomOffset = (loop & 0x0f) * 0x100;
+		memread[loop] = (!SW_INTCXROM && !INTC8ROM)	? pCxRomPeripheral+uRomOffset			// C800..CFFF - Peripheral ROM (GH#486)
+													: pCxRomInternal+uRomOffset;			// C800..CFFF - Internal ROM
+	}
+}
+
 static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nExecutedCycles)
 {
 	if (address == 0xCFFF)
@@ -792,10 +785,11 @@ static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYT
 		{
 			// NB. SW_INTCXROM==1 ensures that internal rom stays switched in
 			memset(pCxRomPeripheral+0x800, 0, FIRMWARE_EXPANSION_SIZE);
-			memset(mem+FIRMWARE_EXPANSION_BEGIN, 0, FIRMWARE_EXPANSION_SIZE);
 			g_eExpansionRomType = eExpRomNull;
 		}
 
+		UpdatePagingForExpansionRom();
+
 		// NB. IO_SELECT won't get set, so ROM won't be switched back in...
 	}
 
@@ -847,7 +841,6 @@ static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYT
 			if (ExpansionRom[uSlot] && (g_uPeripheralRomSlot != uSlot))
 			{
 				memcpy(pCxRomPeripheral+0x800, ExpansionRom[uSlot], FIRMWARE_EXPANSION_SIZE);
-				memcpy(mem+FIRMWARE_EXPANSION_BEGIN, ExpansionRom[uSlot], FIRMWARE_EXPANSION_SIZE);
 				g_eExpansionRomType = eExpRomPeripheral;
 				g_uPeripheralRomSlot = uSlot;
 			}
@@ -856,9 +849,9 @@ static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYT
 		{
 			// Enable Internal ROM
 			// . Get this for PR#3
-			memcpy(mem+FIRMWARE_EXPANSION_BEGIN, pCxRomInternal+0x800, FIRMWARE_EXPANSION_SIZE);
 			g_eExpansionRomType = eExpRomInternal;
 			g_uPeripheralRomSlot = 0;
+			UpdatePagingForExpansionRom();
 		}
 	}
 
@@ -888,9 +881,9 @@ static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYT
 		if (INTC8ROM && (g_eExpansionRomType != eExpRomInternal))
 		{
 			// Enable Internal ROM
-			memcpy(mem+FIRMWARE_EXPANSION_BEGIN, pCxRomInternal+0x800, FIRMWARE_EXPANSION_SIZE);
 			g_eExpansionRomType = eExpRomInternal;
 			g_uPeripheralRomSlot = 0;
+			UpdatePagingForExpansionRom();
 		}
 	}
 
@@ -912,7 +905,7 @@ static BYTE __stdcall IO_Cxxx(WORD programcounter, WORD address, BYTE write, BYT
 	if ((g_eExpansionRomType == eExpRomNull) && (address >= FIRMWARE_EXPANSION_BEGIN))
 		return IO_Null(programcounter, address, write, value, nExecutedCycles);
 
-	return mem[address];
+	return MemReadByte(address);
 }
 
 BYTE __stdcall IO_F8xx(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nCycles)	// NSC for Apple II/II+ (GH#827)
@@ -927,7 +920,7 @@ BYTE __stdcall IO_F8xx(WORD programcounter, WORD address, BYTE write, BYTE value
 
 	if (!write)
 	{
-		return *(mem+address);
+		return MemReadByte(address);
 	}
 	else
 	{
@@ -1132,57 +1125,42 @@ void MemUpdatePaging(BOOL initialize)
 
 static void UpdatePaging(BOOL initialize)
 {
-	modechanging = 0;
-
-	// SAVE THE CURRENT PAGING SHADOW TABLE
-	LPBYTE oldshadow[256];
-	if (!initialize)
-		memcpy(oldshadow,memshadow,256*sizeof(LPBYTE));
+	if (initialize)
+		CpuBlockCacheFlush();	// memory has been reset or loaded (eg. from a save-state) without setting memdirty[]
 
 	// UPDATE THE PAGING TABLES BASED ON THE NEW PAGING SWITCH VALUES
 	UINT loop;
-	if (initialize)
+	for (loop = 0x00; loop < 0x02; loop++)
 	{
-		for (loop = 0x00; loop < 0xC0; loop++)
-			memwrite[loop] = mem+(loop << 8);
-
-		for (loop = 0xC0; loop < 0xD0; loop++)
-			memwrite[loop] = NULL;
+		memread[loop]  = SW_ALTZP ? memaux+(loop << 8) : memmain+(loop << 8);
+		memwrite[loop] = memread[loop];
 	}
 
-	for (loop = 0x00; loop < 0x02; loop++)
-		memshadow[loop] = SW_ALTZP ? memaux+(loop << 8) : memmain+(loop << 8);
-
 	for (loop = 0x02; loop < 0xC0; loop++)
 	{
-		memshadow[loop] = SW_AUXREAD ? memaux+(loop << 8)
+		memread[loop]  = SW_AUXREAD ? memaux+(loop << 8)
 			: memmain+(loop << 8);
 
-		memwrite[loop]  = ((SW_AUXREAD != 0) == (SW_AUXWRITE != 0))
-			? mem+(loop << 8)
-			: SW_AUXWRITE	? memaux+(loop << 8)
-							: memmain+(loop << 8);
+		memwrite[loop] = SW_AUXWRITE ? memaux+(loop << 8)
+			: memmain+(loop << 8);
 	}
 
 	for (loop = 0xC0; loop < 0xC8; loop++)
 	{
-		memdirty[loop] = 0;	// mem(cache) can't be dirty for ROM (but STA $Csnn will set the dirty flag)
+		memwrite[loop] = NULL;	// STA $Csnn still sets the dirty flag, but never writes to the ROM
 		const UINT uSlotOffset = (loop & 0x0f) * 0x100;
 		if (loop == 0xC3)
-			memshadow[loop] = (SW_SLOTC3ROM && !SW_INTCXROM)	? pCxRomPeripheral+uSlotOffset	// C300..C3FF - Slot 3 ROM (all 0x00's)
-																: pCxRomInternal+uSlotOffset;	// C300..C3FF - Internal ROM
+			memread[loop] = (SW_SLOTC3ROM && !SW_INTCXROM)	? pCxRomPeripheral+uSlotOffset	// C300..C3FF - Slot 3 ROM (all 0x00's)
+															: pCxRomInternal+uSlotOffset;	// C300..C3FF - Internal ROM
 		else
-			memshadow[loop] = !SW_INTCXROM	? pCxRomPeripheral+uSlotOffset						// C000..C7FF - SSC/Disk][/etc
+			memread[loop] = !SW_INTCXROM	? pCxRomPeripheral+uSlotOffset						// C000..C7FF - SSC/Disk][/etc
 											: pCxRomInternal+uSlotOffset;						// C000..C7FF - Internal ROM
 	}
 
 	for (loop = 0xC8; loop < 0xD0; loop++)
-	{
-		memdirty[loop] = 0;	// mem(cache) can't be dirty for ROM (but STA $Cnnn will set the dirty flag)
-		const UINT uRomOffset = (loop & 0x0f) * 0x100;
-		memshadow[loop] = (!SW_INTCXROM && !INTC8ROM)	? pCxRomPeripheral+uRomOffset			// C800..CFFF - Peripheral ROM (GH#486)
-														: pCxRomInternal+uRomOffset;			// C800..CFFF - Internal ROM
-	}
+		memwrite[loop] = NULL;
+
+	UpdatePagingForExpansionRom();
 
 	const int selectedrompage = (SW_ALTROM0 ? 1 : 0) | (SW_ALTROM1 ? 2 : 0);
 #ifdef _DEBUG
@@ -1192,69 +1170,49 @@ static void UpdatePaging(BOOL initialize)
 	for (loop = 0xD0; loop < 0xE0; loop++)
 	{
 		const int bankoffset = (SW_BANK2 ? 0 : 0x1000);
-		memshadow[loop] = SW_HIGHRAM ? SW_ALTZP	? memaux+(loop << 8)-bankoffset
-												: g_pMemMainLanguageCard+((loop-0xC0)<<8)-bankoffset
-									 : memrom+((loop-0xD0) * 0x100)+romoffset;
+		LPBYTE const pRam = SW_ALTZP	? memaux+(loop << 8)-bankoffset
+										: g_pMemMainLanguageCard+((loop-0xC0)<<8)-bankoffset;
 
-		memwrite[loop]  = SW_WRITERAM	? SW_HIGHRAM	? mem+(loop << 8)
-														: SW_ALTZP	? memaux+(loop << 8)-bankoffset
-																	: g_pMemMainLanguageCard+((loop-0xC0)<<8)-bankoffset
-										: NULL;
+		memread[loop]  = SW_HIGHRAM ? pRam : memrom+((loop-0xD0) * 0x100)+romoffset;
+		memwrite[loop] = SW_WRITERAM ? pRam : NULL;
 	}
 
 	for (loop = 0xE0; loop < 0x100; loop++)
 	{
-		memshadow[loop] = SW_HIGHRAM	? SW_ALTZP	? memaux+(loop << 8)
-													: g_pMemMainLanguageCard+((loop-0xC0)<<8)
-										: memrom+((loop-0xD0) * 0x100)+romoffset;
+		LPBYTE const pRam = SW_ALTZP	? memaux+(loop << 8)
+										: g_pMemMainLanguageCard+((loop-0xC0)<<8);
 
-		memwrite[loop]  = SW_WRITERAM	? SW_HIGHRAM	? mem+(loop << 8)
-														: SW_ALTZP	? memaux+(loop << 8)
-																	: g_pMemMainLanguageCard+((loop-0xC0)<<8)
-										: NULL;
+		memread[loop]  = SW_HIGHRAM ? pRam : memrom+((loop-0xD0) * 0x100)+romoffset;
+		memwrite[loop] = SW_WRITERAM ? pRam : NULL;
 	}
 
 	if (SW_80STORE)
 	{
 		for (loop = 0x04; loop < 0x08; loop++)
 		{
-			memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
+			memread[loop]  = SW_PAGE2	? memaux+(loop << 8)
 										: memmain+(loop << 8);
-			memwrite[loop]  = mem+(loop << 8);
+			memwrite[loop] = memread[loop];
 		}
 
 		if (SW_HIRES)
 		{
 			for (loop = 0x20; loop < 0x40; loop++)
 			{
-				memshadow[loop] = SW_PAGE2	? memaux+(loop << 8)
+				memread[loop]  = SW_PAGE2	? memaux+(loop << 8)
 											: memmain+(loop << 8);
-				memwrite[loop]  = mem+(loop << 8);
+				memwrite[loop] = memread[loop];
 			}
 		}
 	}
 
-	// MOVE MEMORY BACK AND FORTH AS NECESSARY BETWEEN THE SHADOW AREAS AND
-	// THE MAIN RAM IMAGE TO KEEP BOTH SETS OF MEMORY CONSISTENT WITH THE NEW
-	// PAGING SHADOW TABLE
-	//
-	// NB. the condition 'loop <= 1' is there because:
-	// . Page0 (ZP)    : memdirty[0] is set when the 6502 CPU does a ZP-write, but perhaps older versions didn't set this flag (eg. the asm version?).
-	// . Page1 (stack) : memdirty[1] is NOT set when the 6502 CPU writes to this page with JSR, etc.
-
 	for (loop = 0x00; loop < 0x100; loop++)
 	{
-		if (initialize || (oldshadow[loop] != memshadow[loop]))
-		{
-			if (!initialize &&
-				((*(memdirty+loop) & 1) || (loop <= 1)))
-			{
-				*(memdirty+loop) &= ~1;
-				memcpy(oldshadow[loop],mem+(loop << 8),256);
-			}
-
-			memcpy(mem+(loop << 8),memshadow[loop],256);
-		}
+		memreadaux[loop]  = (memread[loop]  >= memaux && memread[loop]  < memaux+_6502_MEM_LEN) ? 1 : 0;
+		memwriteaux[loop] = (memwrite[loop] >= memaux && memwrite[loop] < memaux+_6502_MEM_LEN) ? 1 : 0;
+		memreadram[loop]  = memreadaux[loop] ||
+							(memread[loop] >= memmain && memread[loop] < memmain+_6502_MEM_LEN) ||
+							(memread[loop] >= g_pMemMainLanguageCard && memread[loop] < g_pMemMainLanguageCard+LanguageCardSlot0::kMemBankSize) ? 1 : 0;
 	}
 }
 
@@ -1268,7 +1226,6 @@ void MemDestroy()
 {
 	ALIGNED_FREE(memaux);
 	ALIGNED_FREE(memmain);
-	ALIGNED_FREE(memimage);
 
 	delete [] memdirty;
 	delete [] memrom;
@@ -1295,15 +1252,13 @@ void MemDestroy()
 	memmain  = NULL;
 	memdirty = NULL;
 	memrom   = NULL;
-	memimage = NULL;
 
 	pCxRomInternal		= NULL;
 	pCxRomPeripheral	= NULL;
 
-	mem      = NULL;
-
-	memset(memwrite,  0, sizeof(memwrite));
-	memset(memshadow, 0, sizeof(memshadow));
+	memset(memwrite, 0, sizeof(memwrite));
+	memset(memread,  0, sizeof(memread));
+	memset(memreadram, 0, sizeof(memreadram));
 }
 
 //===========================================================================
@@ -1320,43 +1275,11 @@ bool MemCheckINTCXROM()
 
 //===========================================================================
 
-static void BackMainImage(void)
-{
-	for (UINT loop = 0; loop < 256; loop++)
-	{
-		if (memshadow[loop] && ((*(memdirty+loop) & 1) || (loop <= 1)))
-			memcpy(memshadow[loop], mem+(loop << 8), 256);
-
-		*(memdirty+loop) &= ~1;
-	}
-}
-
-//===========================================================================
-
-static LPBYTE MemGetPtrBANK1(const WORD offset, const LPBYTE pMemBase)
-{
-	if ((offset & 0xF000) != 0xC000)	// Requesting RAM at physical addr $Cxxx (ie. 4K RAM BANK1)
-		return NULL;
-
-	// NB. This works for memaux when set to any RWpages[] value, ie. RamWork III "just works"
-	const BYTE bank1page = (offset >> 8) & 0xF;
-	return (memshadow[0xD0+bank1page] == pMemBase+(0xC0+bank1page)*256)
-		? mem+offset+0x1000				// Return ptr to $Dxxx address - 'mem' has (a potentially dirty) 4K RAM BANK1 mapped in at $D000
-		: pMemBase+offset;				// Else return ptr to $Cxxx address
-}
-
-//-------------------------------------
+// NB. The read/write paging tables point straight into the backing-store, so it is always up to date.
+// . $Cxxx in memmain/memaux is the 4K RAM BANK1 (ie. the Language Card's $Dxxx when BANK2 is not selected)
 
 LPBYTE MemGetAuxPtr(const WORD offset)
 {
-	LPBYTE lpMem = MemGetPtrBANK1(offset, memaux);
-	if (lpMem)
-		return lpMem;
-
-	lpMem = (memshadow[(offset >> 8)] == (memaux+(offset & 0xFF00)))
-			? mem+offset				// Return 'mem' copy if possible, as page could be dirty
-			: memaux+offset;
-
 #ifdef RAMWORKS
 	// Video scanner (for 14M video modes) always fetches from 1st 64K aux bank (UTAIIe ref?)
 	if (((SW_PAGE2 && SW_80STORE) || GetVideo().VideoGetSW80COL()) &&
@@ -1366,54 +1289,34 @@ LPBYTE MemGetAuxPtr(const WORD offset)
 			)
 		)
 	{
-		lpMem = (memshadow[(offset >> 8)] == (RWpages[0]+(offset & 0xFF00)))
-			? mem+offset
-			: RWpages[0]+offset;
+		return RWpages[0]+offset;
 	}
 #endif
 
-	return lpMem;
+	return memaux+offset;
 }
 
 //-------------------------------------
 
-// if memshadow == memmain
-//	  so RD memmain
-//	  case: RD == WR
-//		so RD(mem),WR(mem)
-//		so 64K memmain could be incorrect
-//		*therefore mem is correct
-//	  case: RD != WR
-//		so RD(mem),WR(memaux)
-//		doesn't matter since RD != WR, then it's guaranteed that memaux is correct
-//		*therefore either mem or memmain is correct
-// else ; memshadow != memmain
-//	  so RD memaux (or ROM)
-//	  case: RD == WR
-//		so RD(mem),WR(mem)
-//		so 64K memaux could be incorrect
-//		*therefore memmain is correct
-//	  case: RD != WR
-//		so RD(mem),WR(memmain)
-//		doesn't matter since RD != WR, then it's guaranteed that memmain is correct
-//		*therefore memmain is correct
-//
-// *OR*
-//
-// Is the mem(cache) setup to read (via memshadow) from memmain?
-// . if yes, then return the mem(cache) address as writes (via memwrite) may've made the mem(cache) dirty.
-// . if no, then return memmain, as the mem(cache) isn't involved in memmain (any writes will go directly to this backing-store).
-//
-
 LPBYTE MemGetMainPtr(const WORD offset)
 {
-	LPBYTE lpMem = MemGetPtrBANK1(offset, memmain);
-	if (lpMem)
-		return lpMem;
+	return memmain+offset;
+}
 
-	return (memshadow[(offset >> 8)] == (memmain+(offset & 0xFF00)))
-			? mem+offset				// Return 'mem' copy if possible, as page could be dirty
-			: memmain+offset;
+//===========================================================================
+
+// Copy to/from the 6502's current view of memory (ie. via the read paging table), without any I/O side-effects.
+// NB. addr wraps at $FFFF
+void MemReadBlock(LPBYTE pDst, WORD addr, UINT uLen)
+{
+	while (uLen--)
+		*pDst++ = MemReadByte(addr++);
+}
+
+void MemWriteBlock(WORD addr, const BYTE* pSrc, UINT uLen)
+{
+	while (uLen--)
+		MemWriteByte(addr++, *pSrc++);
 }
 
 //===========================================================================
@@ -1423,8 +1326,6 @@ LPBYTE MemGetMainPtr(const WORD offset)
 // . Debugger : CmdMemorySave(), CmdMemoryLoad()
 LPBYTE MemGetBankPtr(const UINT nBank)
 {
-	BackMainImage();	// Flush any dirty pages to back-buffer
-
 #ifdef RAMWORKS
 	if (nBank > g_uMaxExPages)
 		return NULL;
@@ -1492,7 +1393,6 @@ void MemInitialize()
 	// ALLOCATE MEMORY FOR THE APPLE MEMORY IMAGE AND ASSOCIATED DATA STRUCTURES
 	memaux   = ALIGNED_ALLOC(_6502_MEM_LEN);
 	memmain  = ALIGNED_ALLOC(_6502_MEM_LEN);
-	memimage = ALIGNED_ALLOC(_6502_MEM_LEN);
 
 	memdirty = new BYTE[0x100];
 	memrom   = new BYTE[0x3000 * MaxRomPages];
@@ -1500,7 +1400,7 @@ void MemInitialize()
 	pCxRomInternal		= new BYTE[CxRomSize];
 	pCxRomPeripheral	= new BYTE[CxRomSize];
 
-	if (!memaux || !memdirty || !memimage || !memmain || !memrom || !pCxRomInternal || !pCxRomPeripheral)
+	if (!memaux || !memdirty || !memmain || !memrom || !pCxRomInternal || !pCxRomPeripheral)
 	{
 		GetFrame().FrameMessageBox(
 			TEXT("The emulator was unable to allocate the memory it ")
@@ -1817,7 +1717,7 @@ void MemInitializeCardSlotAndExpansionRomFromSnapshot(void)
 	_ASSERT(g_eExpansionRomType == eExpRomPeripheral);
 
 	memcpy(pCxRomPeripheral+0x800, ExpansionRom[uSlot], FIRMWARE_EXPANSION_SIZE);
-	// NB. Copied to /mem/ by UpdatePaging(TRUE)
+	// NB. Mapped in at $C800 by UpdatePaging(TRUE)
 }
 
 inline DWORD getRandomTime()
@@ -1834,8 +1734,9 @@ inline DWORD getRandomTime()
 void MemReset()
 {
 	// INITIALIZE THE PAGING TABLES
-	memset(memshadow, 0, 256*sizeof(LPBYTE));
+	memset(memread  , 0, 256*sizeof(LPBYTE));
 	memset(memwrite , 0, 256*sizeof(LPBYTE));
+	memset(memreadram, 0, sizeof(memreadram));
 
 	// INITIALIZE THE RAM IMAGES
 	memset(memaux , 0, 0x10000);
@@ -1971,15 +1872,12 @@ void MemReset()
 	memmain[ 0xBFFE ] = 0;
 	memmain[ 0xBFFF ] = 0;
 
-	// SET UP THE MEMORY IMAGE
-	mem = memimage;
-
-	// INITIALIZE PAGING, FILLING IN THE 64K MEMORY IMAGE
+	// INITIALIZE PAGING
 	ResetPaging(TRUE);		// Initialize=1, init memmode
 	MemAnnunciatorReset();
 
 	// INITIALIZE & RESET THE CPU
-	// . Do this after ROM has been copied back to mem[], so that PC is correctly init'ed from 6502's reset vector
+	// . Do this after ROM has been paged in, so that PC is correctly init'ed from 6502's reset vector
 	CpuInitialize();
 	//Sets Caps Lock = false (Pravets 8A/C only)
 
@@ -1993,7 +1891,7 @@ void MemReset()
 
 BYTE MemReadFloatingBus(const ULONG uExecutedCycles)
 {
-	return mem[ NTSC_VideoGetScannerAddress(uExecutedCycles) ];		// OK: This does the 2-cycle adjust for ANSI STORY (End Credits)
+	return MemReadByte( NTSC_VideoGetScannerAddress(uExecutedCycles) );		// OK: This does the 2-cycle adjust for ANSI STORY (End Credits)
 }
 
 //===========================================================================
@@ -2092,12 +1990,9 @@ BYTE __stdcall MemSetPaging(WORD programcounter, WORD address, BYTE write, BYTE
 		}
 	}
 
-	if (MemOptimizeForModeChanging(programcounter, address))
-		return write ? 0 : MemReadFloatingBus(nExecutedCycles);
-
 	// IF THE MEMORY PAGING MODE HAS CHANGED, UPDATE OUR MEMORY IMAGES AND
 	// WRITE TABLES.
-	if ((lastmemmode != memmode) || modechanging)
+	if (lastmemmode != memmode)
 	{
 		// NB. Must check MF_SLOTC3ROM too, as IoHandlerCardsIn() depends on both MF_INTCXROM|MF_SLOTC3ROM
 		if ((lastmemmode & (MF_INTCXROM|MF_SLOTC3ROM)) != (memmode & (MF_INTCXROM|MF_SLOTC3ROM)))
@@ -2110,7 +2005,6 @@ BYTE __stdcall MemSetPaging(WORD programcounter, WORD address, BYTE write, BYTE
 					// . Similar to $CFFF access
 					// . None of the peripheral cards can be driving the bus - so use the null ROM
 					memset(pCxRomPeripheral+0x800, 0, FIRMWARE_EXPANSION_SIZE);
-					memset(mem+FIRMWARE_EXPANSION_BEGIN, 0, FIRMWARE_EXPANSION_SIZE);
 					g_eExpansionRomType = eExpRomNull;
 					g_uPeripheralRomSlot = 0;
 				}
@@ -2119,7 +2013,6 @@ BYTE __stdcall MemSetPaging(WORD programcounter, WORD address, BYTE write, BYTE
 			else
 			{
 				// Enable Internal ROM
-				memcpy(mem+0xC800, pCxRomInternal+0x800, FIRMWARE_EXPANSION_SIZE);
 				g_eExpansionRomType = eExpRomInternal;
 				g_uPeripheralRomSlot = 0;
 				IoHandlerCardsOut();
@@ -2138,37 +2031,6 @@ BYTE __stdcall MemSetPaging(WORD programcounter, WORD address, BYTE write, BYTE
 
 //===========================================================================
 
-bool MemOptimizeForModeChanging(WORD programcounter, WORD address)
-{
-	if (IsAppleIIeOrAbove(GetApple2Type()))
-	{
-		// IF THE EMULATED PROGRAM HAS JUST UPDATED THE MEMORY WRITE MODE AND IS
-		// ABOUT TO UPDATE THE MEMORY READ MODE, HOLD OFF ON ANY PROCESSING UNTIL
-		// IT DOES SO.
-		//
-		// NB. A 6502 interrupt occurring between these memory write & read updates could lead to incorrect behaviour.
-		// - although any data-race is probably a bug in the 6502 code too.
-		if ((address >= 4) && (address <= 5) &&									// Now:  RAMWRTOFF or RAMWRTON
-			((*(LPDWORD)(mem+programcounter) & 0x00FFFEFF) == 0x00C0028D))		// Next: STA $C002(RAMRDOFF) or STA $C003(RAMRDON)
-		{
-				modechanging = 1;
-				return true;
-		}
-
-		if ((address >= 0x80) && (address <= 0x8F) && (programcounter < 0xC000) &&	// Now: LC
-			(((*(LPDWORD)(mem+programcounter) & 0x00FFFEFF) == 0x00C0048D) ||		// Next: STA $C004(RAMWRTOFF) or STA $C005(RAMWRTON)
-			 ((*(LPDWORD)(mem+programcounter) & 0x00FFFEFF) == 0x00C0028D)))		//    or STA $C002(RAMRDOFF)  or STA $C003(RAMRDON)
-		{
-				modechanging = 1;
-				return true;
-		}
-	}
-
-	return false;
-}
-
-//===========================================================================
-
 LPVOID MemGetSlotParameters(UINT uSlot)
 {
 	_ASSERT(uSlot < NUM_SLOTS);
@@ -2216,10 +2078,6 @@ void MemRemoveNoSlotClock(void)
 
 //===========================================================================
 
-// NB. Don't need to save 'modechanging', as this is just an optimisation to save calling UpdatePaging() twice.
-// . If we were to save the state when 'modechanging' is set, then on restoring the state, the 6502 code will immediately update the read memory mode.
-// . This will work correctly.
-
 #define SS_YAML_KEY_MEMORYMODE "Memory Mode"
 #define SS_YAML_KEY_LASTRAMWRITE "Last RAM Write"
 #define SS_YAML_KEY_IOSELECT "IO_SELECT"
@@ -2544,3 +2402,58 @@ void NoSlotClockLoadSnapshot(YamlLoadHelper& yamlLoadHelper)
 
 	g_NoSlotClock->LoadSnapshot(yamlLoadHelper);
 }
+
+//===========================================================================
+
+// NB. RAM itself is captured by Rewind.cpp via MemGetBankPtr()
+void MemSaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(memmode);
+	buffer.Save(GetLastRamWrite());
+	buffer.Save(IO_SELECT);
+	buffer.Save(INTC8ROM);
+	buffer.Save(g_eExpansionRomType);
+	buffer.Save(g_uPeripheralRomSlot);
+	buffer.Save(g_Annunciator);
+#ifdef RAMWORKS
+	buffer.Save(g_uActiveBank);
+#endif
+}
+
+void MemLoadRewind(RewindBuffer& buffer)
+{
+	const DWORD oldMemMode = memmode;
+
+	DWORD uMemMode;
+	BOOL lastRamWrite;
+	buffer.Load(uMemMode);
+	buffer.Load(lastRamWrite);
+	buffer.Load(IO_SELECT);
+	buffer.Load(INTC8ROM);
+	buffer.Load(g_eExpansionRomType);
+	buffer.Load(g_uPeripheralRomSlot);
+	buffer.Load(g_Annunciator);
+#ifdef RAMWORKS
+	buffer.Load(g_uActiveBank);
+	memaux = RWpages[g_uActiveBank];
+#endif
+
+	SetMemMode(uMemMode);
+	SetLastRamWrite(lastRamWrite);
+
+	// Re-apply the side-effects of the soft switches that aren't just paging
+	if (IsAppleIIeOrAbove(GetApple2Type()) && ((oldMemMode ^ memmode) & (MF_INTCXROM | MF_SLOTC3ROM)))
+	{
+		if (SW_INTCXROM)
+			IoHandlerCardsOut();
+		else
+			IoHandlerCardsIn();
+	}
+
+	if (g_eExpansionRomType == eExpRomPeripheral && ExpansionRom[g_uPeripheralRomSlot])
+		memcpy(pCxRomPeripheral+0x800, ExpansionRom[g_uPeripheralRomSlot], FIRMWARE_EXPANSION_SIZE);
+	else if (g_eExpansionRomType == eExpRomNull)
+		memset(pCxRomPeripheral+0x800, 0, FIRMWARE_EXPANSION_SIZE);
+
+	UpdatePaging(FALSE);	// Initialize=FALSE
+}
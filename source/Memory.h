@@ -51,10 +51,43 @@ typedef BYTE (__stdcall *iofunction)(WORD nPC, WORD nAddr, BYTE nWriteFlag, BYTE
 
 extern iofunction IORead[256];
 extern iofunction IOWrite[256];
+extern LPBYTE     memread[0x100];
 extern LPBYTE     memwrite[0x100];
-extern LPBYTE     mem;
+extern BYTE       memreadaux[0x100];
+extern BYTE       memwriteaux[0x100];
+extern BYTE       memreadram[0x100];
 extern LPBYTE     memdirty;
 
+// memdirty[] bits: a write to the page sets them all, then each is cleared by its own user
+#define MEMDIRTY_VIDEO		0x01	// NTSC scanline cache
+#define MEMDIRTY_BLOCKCACHE	0x02	// CPU block cache
+
+// The 6502's current view of memory (as paged in by the soft-switches), but without any I/O side-effects
+inline BYTE MemReadByte(const WORD addr)
+{
+	return *(memread[addr >> 8] + (addr & 0xFF));
+}
+
+inline WORD MemReadWord(const WORD addr)
+{
+	if ((addr & 0xFF) != 0xFF)
+		return *(LPWORD)(memread[addr >> 8] + (addr & 0xFF));
+
+	return MemReadByte(addr) | (MemReadByte((WORD)(addr+1)) << 8);	// straddles 2 pages
+}
+
+// Modify the byte that the 6502 currently reads at this address (eg. for the debugger)
+// . ROM & I/O pages are ignored: memread[] points straight at the ROM/firmware images, which must not be patched
+inline bool MemWriteByte(const WORD addr, const BYTE value)
+{
+	if (!memreadram[addr >> 8])
+		return false;
+
+	*(memread[addr >> 8] + (addr & 0xFF)) = value;
+	memdirty[addr >> 8] = 0xFF;
+	return true;
+}
+
 #ifdef RAMWORKS
 const UINT kMaxExMemoryBanks = 127;	// 127 * aux mem(64K) + main mem(64K) = 8MB
 #endif
@@ -69,9 +102,10 @@ LPBYTE  MemGetAuxPtr(const WORD);
 LPBYTE  MemGetMainPtr(const WORD);
 LPBYTE  MemGetBankPtr(const UINT nBank);
 LPBYTE  MemGetCxRomPeripheral();
+void    MemReadBlock(LPBYTE pDst, WORD addr, UINT uLen);
+void    MemWriteBlock(WORD addr, const BYTE* pSrc, UINT uLen);
 DWORD   GetMemMode(void);
 void    SetMemMode(DWORD memmode);
-bool	MemOptimizeForModeChanging(WORD programcounter, WORD address);
 bool    MemIsAddrCodeMemory(const USHORT addr);
 void    MemInitialize ();
 void    MemInitializeROM(void);
@@ -97,6 +131,8 @@ void    MemSaveSnapshotAux(class YamlSaveHelper& yamlSaveHelper);
 bool    MemLoadSnapshotAux(class YamlLoadHelper& yamlLoadHelper, UINT unitVersion);
 void    NoSlotClockSaveSnapshot(YamlSaveHelper& yamlSaveHelper);
 void    NoSlotClockLoadSnapshot(YamlLoadHelper& yamlLoadHelper);
+void    MemSaveRewind(class RewindBuffer& buffer);
+void    MemLoadRewind(class RewindBuffer& buffer);
 
 BYTE __stdcall IO_Null(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nCycles);
 
@@ -91,6 +91,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Riff.h"
 
 #include "AY8910.h"
+#include "AudioCapture.h"
 #include "SSI263.h"
 
 #define DBG_MB_SS_CARD 0	// From UI, select Mockingboard (not Phasor)
@@ -375,8 +376,8 @@ static UINT GetOpcodeCyclesForRead(BYTE reg)
 	bool indx = false;
 	bool indy = false;
 
-	const BYTE opcodeMinus3 = mem[(regs.pc-3)&0xffff];
-	const BYTE opcodeMinus2 = mem[(regs.pc-2)&0xffff];
+	const BYTE opcodeMinus3 = MemReadByte((regs.pc-3)&0xffff);
+	const BYTE opcodeMinus2 = MemReadByte((regs.pc-2)&0xffff);
 
 	if ( ((opcodeMinus2 & 0x0f) == 0x01) && ((opcodeMinus2 & 0x10) == 0x00) )	// ora (zp,x), and (zp,x), ..., sbc (zp,x)
 	{
@@ -442,14 +443,14 @@ static UINT GetOpcodeCyclesForRead(BYTE reg)
 
 	if (!abs16)
 	{
-		BYTE zp = mem[(regs.pc-1)&0xffff];
+		BYTE zp = MemReadByte((regs.pc-1)&0xffff);
 		if (indx) zp += regs.x;
-		addr16 = (mem[zp] | (mem[(zp+1)&0xff]<<8));
+		addr16 = (MemReadByte(zp) | (MemReadByte((zp+1)&0xff)<<8));
 		if (indy) addr16 += regs.y;
 	}
 	else
 	{
-		addr16 = mem[(regs.pc-2)&0xffff] | (mem[(regs.pc-1)&0xffff]<<8);
+		addr16 = MemReadByte((regs.pc-2)&0xffff) | (MemReadByte((regs.pc-1)&0xffff)<<8);
 		if (abs16y) addr16 += regs.y;
 		if (abs16x) addr16 += regs.x;
 	}
@@ -471,8 +472,8 @@ static UINT GetOpcodeCyclesForWrite(BYTE reg)
 	BYTE opcode = 0;
 	bool abs16 = false;
 
-	const BYTE opcodeMinus3 = mem[(regs.pc-3)&0xffff];
-	const BYTE opcodeMinus2 = mem[(regs.pc-2)&0xffff];
+	const BYTE opcodeMinus3 = MemReadByte((regs.pc-3)&0xffff);
+	const BYTE opcodeMinus2 = MemReadByte((regs.pc-2)&0xffff);
 
 	if ( (opcodeMinus3 == 0x8C) ||		// sty abs16
 		 (opcodeMinus3 == 0x8D) ||		// sta abs16
@@ -529,14 +530,14 @@ static UINT GetOpcodeCyclesForWrite(BYTE reg)
 
 	if (!abs16)
 	{
-		BYTE zp = mem[(regs.pc-1)&0xffff];
+		BYTE zp = MemReadByte((regs.pc-1)&0xffff);
 		if (opcode == 0x81) zp += regs.x;
-		addr16 = (mem[zp] | (mem[(zp+1)&0xff]<<8));
+		addr16 = (MemReadByte(zp) | (MemReadByte((zp+1)&0xff)<<8));
 		if (opcode == 0x91) addr16 += regs.y;
 	}
 	else
 	{
-		addr16 = mem[(regs.pc-2)&0xffff] | (mem[(regs.pc-1)&0xffff]<<8);
+		addr16 = MemReadByte((regs.pc-2)&0xffff) | (MemReadByte((regs.pc-1)&0xffff)<<8);
 		if (opcode == 0x99) addr16 += regs.y;
 		if (opcode == 0x9D || opcode == 0x9E) addr16 += regs.x;
 	}
@@ -561,7 +562,7 @@ static USHORT SetTimerSyncEvent(UINT id, BYTE reg, USHORT timerLatch)
 
 	SyncEvent* pSyncEvent = g_syncEvent[id];
 	if (pSyncEvent->m_active)
-		g_SynchronousEventMgr.Remove(id);
+		g_SynchronousEventMgr.Remove(pSyncEvent);
 
 	pSyncEvent->SetCycles(timerLatch + kExtraTimerCycles + opcodeCycleAdjust);
 	g_SynchronousEventMgr.Insert(pSyncEvent);
@@ -814,16 +815,91 @@ static BYTE SY6522_Read(BYTE nDevice, BYTE nReg)
 
 //#define DBG_MB_UPDATE
 static UINT64 g_uLastMBUpdateCycle = 0;
+static int g_nNumSamplesError = 0;
+
+// Fixed-block mode: the AY8910s are rendered in fixed-size blocks at a constant cadence of emulated time,
+// instead of at whatever rate the 6522 TIMER1 IRQ was programmed to (see MB_UpdateBlocks())
+static bool g_bMBFixedBlocks = false;
+static const int kMBBlockSamples = 256;		// 5.8ms @ 44.1KHz
+static double g_fMBBlockCycleRemainder = 0.0;
+
+// Pull mode (headless): the mixed samples are kept in a FIFO for MB_PullSamples(), instead of written to DirectSound
+static bool g_bMBPullMode = false;
+static short g_nMBPullBuffer[MAX_SAMPLES * g_nMB_NumChannels];
+static UINT g_nMBPullFrames = 0;
+
+static void MB_OutputSamples(const int nNumSamples);
+
+// Whilst capturing audio or pulling samples, they are only from emulated time (so also at full-speed), and there's
+// no correction for DirectSound's play cursor
+static bool MB_IsEmulatedTimeOnly(void)
+{
+	return AudioCapture_IsActive() || g_bMBPullMode;
+}
+
+// Whilst capturing audio or pulling samples, the AY8910s are always rendered in fixed blocks of emulated time
+static bool MB_IsFixedBlockMode(void)
+{
+	return g_bMBFixedBlocks || MB_IsEmulatedTimeOnly();
+}
+
+// Render all the whole blocks which are due up to the current cycle.
+// AY writes are recorded with cycle timestamps, so each block only consumes the writes made within it.
+static void MB_UpdateBlocks(void)
+{
+	if (g_uLastMBUpdateCycle == 0 || g_nCumulativeCycles < g_uLastMBUpdateCycle)
+	{
+		// Initial call after reset/power-cycle: start the block timeline from now
+		AY8910UpdateSetCycles();
+		g_uLastMBUpdateCycle = g_nCumulativeCycles;
+		g_fMBBlockCycleRemainder = 0.0;
+		return;
+	}
+
+	const double fBlockCycles = (double)kMBBlockSamples * g_fCurrentCLK6502 / SAMPLE_RATE;
+	const int kMaxBlocks = (MAX_SAMPLES / 4) / kMBBlockSamples;
+
+	for (int nBlocks = 0; ; nBlocks++)
+	{
+		const UINT nBlockCycles = (UINT)(fBlockCycles + g_fMBBlockCycleRemainder);
+		if (g_nCumulativeCycles - g_uLastMBUpdateCycle < nBlockCycles)
+			break;
+
+		if (nBlocks == kMaxBlocks)
+		{
+			// Too far behind (eg. after the debugger has run): drop the backlog
+			AY8910UpdateSetCycles();
+			g_uLastMBUpdateCycle = g_nCumulativeCycles;
+			break;
+		}
+
+		g_fMBBlockCycleRemainder += fBlockCycles - (double)nBlockCycles;
+		g_uLastMBUpdateCycle += nBlockCycles;
+
+		int nNumSamples = kMBBlockSamples;
+		if (!MB_IsEmulatedTimeOnly())
+		{
+			nNumSamples += g_nNumSamplesError;		// Apply correction
+			if (nNumSamples < kMBBlockSamples/2)
+				nNumSamples = kMBBlockSamples/2;
+			if (nNumSamples > kMBBlockSamples*2)
+				nNumSamples = kMBBlockSamples*2;
+		}
+
+		AY8910UpdateBlock(ppAYVoiceBuffer, NUM_AY8910, nNumSamples, nBlockCycles);
+		MB_OutputSamples(nNumSamples);
+	}
+}
 
 // Called by:
 // . MB_UpdateCycles()    - when g_nMBTimerDevice == {0,1,2,3}
-// . MB_PeriodicUpdate()  - when g_nMBTimerDevice == kTIMERDEVICE_INVALID
+// . MB_PeriodicUpdate()  - when g_nMBTimerDevice == kTIMERDEVICE_INVALID (or always, in fixed-block mode)
 static void MB_UpdateInt(void)
 {
-	if (!MockingboardVoice.bActive)
-		return;
+	if (g_bMBPullMode ? !ppAYVoiceBuffer[0] : !MockingboardVoice.bActive)
+		return;	// NB. Pull mode still needs the AY8910s, so not with -no-mb or -no-dsound
 
-	if (g_bFullSpeed)
+	if (g_bFullSpeed && !MB_IsEmulatedTimeOnly())
 	{
 		// Keep AY reg writes relative to the current 'frame'
 		// - Required for Ultima3:
@@ -832,6 +908,8 @@ static void MB_UpdateInt(void)
 		//   . U3 sets AY_ENABLE:=0xFF (as a side-effect, this sets g_bFullSpeed:=false)
 		//   o Without this, the write to AY_ENABLE gets ignored (since AY8910's /g_uLastCumulativeCycles/ was last set 50 frame ago)
 		AY8910UpdateSetCycles();
+		if (MB_IsFixedBlockMode())
+			g_uLastMBUpdateCycle = g_nCumulativeCycles;
 
 		// TODO:
 		// If any AY regs have changed then push them out to the AY chip
@@ -862,6 +940,12 @@ static void MB_UpdateInt(void)
 
 	//
 
+	if (MB_IsFixedBlockMode())
+	{
+		MB_UpdateBlocks();
+		return;
+	}
+
 	// For small timer periods, wait for a period of 500cy before updating DirectSound ring-buffer.
 	// NB. A timer period of less than 24cy will yield nNumSamplesPerPeriod=0.
 	const double kMinimumUpdateInterval = 500.0;	// Arbitary (500 cycles = 21 samples)
@@ -882,8 +966,7 @@ static void MB_UpdateInt(void)
 	const double nIrqFreq = g_fCurrentCLK6502 / updateInterval + 0.5;			// Round-up
 	const int nNumSamplesPerPeriod = (int) ((double)SAMPLE_RATE / nIrqFreq);	// Eg. For 60Hz this is 735
 
-	static int nNumSamplesError = 0;
-	int nNumSamples = nNumSamplesPerPeriod + nNumSamplesError;					// Apply correction
+	int nNumSamples = nNumSamplesPerPeriod + g_nNumSamplesError;				// Apply correction
 	if(nNumSamples <= 0)
 		nNumSamples = 0;
 	if(nNumSamples > 2*nNumSamplesPerPeriod)
@@ -896,10 +979,71 @@ static void MB_UpdateInt(void)
 		for(int nChip=0; nChip<NUM_AY8910; nChip++)
 			AY8910Update(nChip, &ppAYVoiceBuffer[nChip*NUM_VOICES_PER_AY8910], nNumSamples);
 
-	//
+	MB_OutputSamples(nNumSamples);
+}
+
+// Mix the AY voice buffers to g_nMixBuffer
+static void MB_MixVoices(const int nNumSamples)
+{
+	const double fAttenuation = g_bPhasorEnable ? 2.0/3.0 : 1.0;
+
+	for(int i=0; i<nNumSamples; i++)
+	{
+		// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
+		// L = Address.b7=0, R = Address.b7=1
+		int nDataL = 0, nDataR = 0;
+
+		for(UINT j=0; j<NUM_VOICES_PER_AY8910; j++)
+		{
+			// Slot4
+			nDataL += (int) ((double)ppAYVoiceBuffer[0*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+			nDataR += (int) ((double)ppAYVoiceBuffer[1*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+
+			// Slot5
+			nDataL += (int) ((double)ppAYVoiceBuffer[2*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+			nDataR += (int) ((double)ppAYVoiceBuffer[3*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+		}
+
+		// Cap the superpositioned output
+		if(nDataL < nWaveDataMin)
+			nDataL = nWaveDataMin;
+		else if(nDataL > nWaveDataMax)
+			nDataL = nWaveDataMax;
+
+		if(nDataR < nWaveDataMin)
+			nDataR = nWaveDataMin;
+		else if(nDataR > nWaveDataMax)
+			nDataR = nWaveDataMax;
+
+		g_nMixBuffer[i*g_nMB_NumChannels+0] = (short)nDataL;	// L
+		g_nMixBuffer[i*g_nMB_NumChannels+1] = (short)nDataR;	// R
+	}
+}
+
+// Mix the AY voice buffers & write them to the Mockingboard voice, and update the sample count correction
+static void MB_OutputSamples(const int nNumSamples)
+{
+	if(nNumSamples)
+	{
+		MB_MixVoices(nNumSamples);
+		AudioCapture_Submit(AUDIOCAPTURE_MOCKINGBOARD, &g_nMixBuffer[0], nNumSamples, g_nMB_NumChannels, SAMPLE_RATE);
+	}
+
+	if (g_bMBPullMode)
+	{
+		// If the FIFO isn't being pulled then drop the newest samples (like the speaker's buffer)
+		const UINT nSpace = MAX_SAMPLES - g_nMBPullFrames;
+		const UINT nFrames = ((UINT)nNumSamples < nSpace) ? (UINT)nNumSamples : nSpace;
+		memcpy(&g_nMBPullBuffer[g_nMBPullFrames * g_nMB_NumChannels], &g_nMixBuffer[0], nFrames * g_nMB_NumChannels * sizeof(short));
+		g_nMBPullFrames += nFrames;
+		return;
+	}
+
+	if(g_bFullSpeed)
+		return;		// Only when capturing audio: nothing is played at full-speed
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	HRESULT hr = MockingboardVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	HRESULT hr = DSGetCurrentPosition(&MockingboardVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if(FAILED(hr))
 		return;
 
@@ -924,7 +1068,7 @@ static void MB_UpdateInt(void)
 				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X xxx\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, dwByteOffset, nNumSamples);
 #endif
 				dwByteOffset = dwCurrentWriteCursor;
-				nNumSamplesError = 0;
+				g_nNumSamplesError = 0;
 			}
 		}
 		else
@@ -937,7 +1081,7 @@ static void MB_UpdateInt(void)
 				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X XXX\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, dwByteOffset, nNumSamples);
 #endif
 				dwByteOffset = dwCurrentWriteCursor;
-				nNumSamplesError = 0;
+				g_nNumSamplesError = 0;
 			}
 		}
 	}
@@ -949,15 +1093,15 @@ static void MB_UpdateInt(void)
 	// Calc correction factor so that play-buffer doesn't under/overflow
 	const int nErrorInc = SoundCore_GetErrorInc();
 	if(nBytesRemaining < g_dwDSBufferSize / 4)
-		nNumSamplesError += nErrorInc;				// < 0.25 of buffer remaining
+		g_nNumSamplesError += nErrorInc;				// < 0.25 of buffer remaining
 	else if(nBytesRemaining > g_dwDSBufferSize / 2)
-		nNumSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
+		g_nNumSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
 	else
-		nNumSamplesError = 0;						// Acceptable amount of data in buffer
+		g_nNumSamplesError = 0;					// Acceptable amount of data in buffer
 
 #ifdef DBG_MB_UPDATE
 	double fTicksSecs = (double)GetTickCount() / 1000.0;
-	LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X, NSE=%08X, Interval=%f\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor - dwCurrentPlayCursor, dwByteOffset, nNumSamples, nNumSamplesError, updateInterval);
+	LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X, NSE=%08X\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor - dwCurrentPlayCursor, dwByteOffset, nNumSamples, g_nNumSamplesError);
 #endif
 
 	if(nNumSamples == 0)
@@ -965,46 +1109,10 @@ static void MB_UpdateInt(void)
 
 	//
 
-	const double fAttenuation = g_bPhasorEnable ? 2.0/3.0 : 1.0;
-
-	for(int i=0; i<nNumSamples; i++)
-	{
-		// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
-		// L = Address.b7=0, R = Address.b7=1
-		int nDataL = 0, nDataR = 0;
-
-		for(UINT j=0; j<NUM_VOICES_PER_AY8910; j++)
-		{
-			// Slot4
-			nDataL += (int) ((double)ppAYVoiceBuffer[0*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-			nDataR += (int) ((double)ppAYVoiceBuffer[1*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-
-			// Slot5
-			nDataL += (int) ((double)ppAYVoiceBuffer[2*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-			nDataR += (int) ((double)ppAYVoiceBuffer[3*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-		}
-
-		// Cap the superpositioned output
-		if(nDataL < nWaveDataMin)
-			nDataL = nWaveDataMin;
-		else if(nDataL > nWaveDataMax)
-			nDataL = nWaveDataMax;
-
-		if(nDataR < nWaveDataMin)
-			nDataR = nWaveDataMin;
-		else if(nDataR > nWaveDataMax)
-			nDataR = nWaveDataMax;
-
-		g_nMixBuffer[i*g_nMB_NumChannels+0] = (short)nDataL;	// L
-		g_nMixBuffer[i*g_nMB_NumChannels+1] = (short)nDataR;	// R
-	}
-
-	//
-
 	DWORD dwDSLockedBufferSize0, dwDSLockedBufferSize1;
 	SHORT *pDSLockedBuffer0, *pDSLockedBuffer1;
 
-	hr = DSGetLock(MockingboardVoice.lpDSBvoice,
+	hr = DSGetLock(&MockingboardVoice,
 		dwByteOffset, (DWORD)nNumSamples * sizeof(short) * g_nMB_NumChannels,
 		&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 		&pDSLockedBuffer1, &dwDSLockedBufferSize1);
@@ -1016,8 +1124,8 @@ static void MB_UpdateInt(void)
 		memcpy(pDSLockedBuffer1, &g_nMixBuffer[dwDSLockedBufferSize0/sizeof(short)], dwDSLockedBufferSize1);
 
 	// Commit sound buffer
-	hr = MockingboardVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-											  (void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+	hr = DSUnlock(&MockingboardVoice, pDSLockedBuffer0, dwDSLockedBufferSize0,
+											  pDSLockedBuffer1, dwDSLockedBufferSize1);
 
 	dwByteOffset = (dwByteOffset + (DWORD)nNumSamples*sizeof(short)*g_nMB_NumChannels) % g_dwDSBufferSize;
 
@@ -1074,7 +1182,7 @@ static bool MB_DSInit()
 	if(!MockingboardVoice.nVolume)
 		MockingboardVoice.nVolume = DSBVOLUME_MAX;
 
-	hr = MockingboardVoice.lpDSBvoice->SetVolume(MockingboardVoice.nVolume);
+	hr = DSSetVolume(&MockingboardVoice, MockingboardVoice.nVolume);
 	LogFileOutput("MB_DSInit: SetVolume(), hr=0x%08X\n", hr);
 
 	//---------------------------------
@@ -1092,7 +1200,7 @@ static bool MB_DSInit()
 
 static void MB_DSUninit()
 {
-	if(MockingboardVoice.lpDSBvoice && MockingboardVoice.bActive)
+	if(MockingboardVoice.HasBuffer() && MockingboardVoice.bActive)
 		DSVoiceStop(&MockingboardVoice);
 
 	DSReleaseSoundBuffer(&MockingboardVoice);
@@ -1168,7 +1276,7 @@ void MB_InitializeForLoadingSnapshot()	// GH#609
 	if (g_bDisableDirectSound || g_bDisableDirectSoundMockingboard)
 		return;
 
-	_ASSERT(MockingboardVoice.lpDSBvoice);
+	_ASSERT(MockingboardVoice.HasBuffer());
 	DSVoiceStop(&MockingboardVoice);			// Reason: 'MB voice is playing' then loading a save-state where 'no MB present'
 
 	// NB. ssi263.Stop() already done by MB_Reset()
@@ -1195,7 +1303,7 @@ void MB_Destroy()
 	for (int id=0; id<kNumSyncEvents; id++)
 	{
 		if (g_syncEvent[id] && g_syncEvent[id]->m_active)
-			g_SynchronousEventMgr.Remove(id);
+			g_SynchronousEventMgr.Remove(g_syncEvent[id]);
 
 		delete g_syncEvent[id];
 		g_syncEvent[id] = NULL;
@@ -1217,12 +1325,13 @@ static void ResetState()
 	g_PhasorClockScaleFactor = 1;
 
 	g_uLastMBUpdateCycle = 0;
+	g_fMBBlockCycleRemainder = 0.0;
 	g_cyclesThisAudioFrame = 0;
 
 	for (int id = 0; id < kNumSyncEvents; id++)
 	{
 		if (g_syncEvent[id] && g_syncEvent[id]->m_active)
-			g_SynchronousEventMgr.Remove(id);
+			g_SynchronousEventMgr.Remove(g_syncEvent[id]);
 	}
 
 	for (UINT i=0; i<NUM_AY8910; i++)
@@ -1264,7 +1373,7 @@ static BYTE __stdcall MB_Read(WORD PC, WORD nAddr, BYTE bWrite, BYTE nValue, ULO
 	if(!IS_APPLE2 && MemCheckINTCXROM())
 	{
 		_ASSERT(0);	// Card ROM disabled, so IO_Cxxx() returns the internal ROM
-		return mem[nAddr];
+		return MemReadByte(nAddr);
 	}
 
 	if(g_SoundcardType == CT_Empty)
@@ -1348,22 +1457,22 @@ static BYTE __stdcall MB_Write(WORD PC, WORD nAddr, BYTE bWrite, BYTE nValue, UL
 #endif
 
 	// Support 6502/65C02 false-reads of 6522 (GH#52)
-	if ( ((mem[(PC-2)&0xffff] == 0x91) && GetMainCpu() == CPU_6502) ||	// sta (zp),y - 6502 only (no-PX variant only) (UTAIIe:4-23)
-		 (mem[(PC-3)&0xffff] == 0x99) ||	// sta abs16,y - 6502/65C02, but for 65C02 only the no-PX variant that does the false-read (UTAIIe:4-27)
-		 (mem[(PC-3)&0xffff] == 0x9D) )		// sta abs16,x - 6502/65C02, but for 65C02 only the no-PX variant that does the false-read (UTAIIe:4-27)
+	if ( ((MemReadByte((PC-2)&0xffff) == 0x91) && GetMainCpu() == CPU_6502) ||	// sta (zp),y - 6502 only (no-PX variant only) (UTAIIe:4-23)
+		 (MemReadByte((PC-3)&0xffff) == 0x99) ||	// sta abs16,y - 6502/65C02, but for 65C02 only the no-PX variant that does the false-read (UTAIIe:4-27)
+		 (MemReadByte((PC-3)&0xffff) == 0x9D) )		// sta abs16,x - 6502/65C02, but for 65C02 only the no-PX variant that does the false-read (UTAIIe:4-27)
 	{
 		WORD base;
 		WORD addr16;
-		if (mem[(PC-2)&0xffff] == 0x91)
+		if (MemReadByte((PC-2)&0xffff) == 0x91)
 		{
-			BYTE zp = mem[(PC-1)&0xffff];
-			base = (mem[zp] | (mem[(zp+1)&0xff]<<8));
+			BYTE zp = MemReadByte((PC-1)&0xffff);
+			base = (MemReadByte(zp) | (MemReadByte((zp+1)&0xff)<<8));
 			addr16 = base + regs.y;
 		}
 		else
 		{
-			base = mem[(PC-2)&0xffff] | (mem[(PC-1)&0xffff]<<8);
-			addr16 = base + ((mem[(PC-3)&0xffff] == 0x99) ? regs.y : regs.x);
+			base = MemReadByte((PC-2)&0xffff) | (MemReadByte((PC-1)&0xffff)<<8);
+			addr16 = base + ((MemReadByte((PC-3)&0xffff) == 0x99) ? regs.y : regs.x);
 		}
 
 		if (((base ^ addr16) >> 8) == 0)	// Only the no-PX variant does the false read (to the same I/O SELECT page)
@@ -1534,7 +1643,7 @@ void MB_Mute(void)
 
 	if(MockingboardVoice.bActive && !MockingboardVoice.bMute)
 	{
-		MockingboardVoice.lpDSBvoice->SetVolume(DSBVOLUME_MIN);
+		DSSetVolume(&MockingboardVoice, DSBVOLUME_MIN);
 		MockingboardVoice.bMute = true;
 	}
 
@@ -1551,7 +1660,7 @@ void MB_Unmute(void)
 
 	if(MockingboardVoice.bActive && MockingboardVoice.bMute)
 	{
-		MockingboardVoice.lpDSBvoice->SetVolume(MockingboardVoice.nVolume);
+		DSSetVolume(&MockingboardVoice, MockingboardVoice.nVolume);
 		MockingboardVoice.bMute = false;
 	}
 
@@ -1588,6 +1697,12 @@ void MB_PeriodicUpdate(UINT executedCycles)
 	for (UINT i=0; i<NUM_AY8910; i++)
 		g_MB[i].ssi263.PeriodicUpdate(executedCycles);
 
+	if (MB_IsFixedBlockMode())
+	{
+		MB_Update();	// Renders any blocks which are due, independent of the 6522 timers
+		return;
+	}
+
 	if (g_nMBTimerDevice != kTIMERDEVICE_INVALID)
 		return;
 
@@ -1684,7 +1799,8 @@ static int MB_SyncEventCallback(int id, int /*cycles*/, ULONG uExecutedCycles)
 	if ((id & 1) == 0)
 	{
 		_ASSERT(pMB->bTimer1Active);
-		MB_Update();
+		if (!MB_IsFixedBlockMode())
+			MB_Update();
 
 		UpdateIFR(pMB, 0, IxR_TIMER1);
 
@@ -1739,7 +1855,7 @@ void MB_SetVolume(DWORD dwVolume, DWORD dwVolumeMax)
 	MockingboardVoice.nVolume = NewVolume(dwVolume, dwVolumeMax);
 
 	if (MockingboardVoice.bActive && !MockingboardVoice.bMute)
-		MockingboardVoice.lpDSBvoice->SetVolume(MockingboardVoice.nVolume);
+		DSSetVolume(&MockingboardVoice, MockingboardVoice.nVolume);
 
 	//
 
@@ -1747,6 +1863,30 @@ void MB_SetVolume(DWORD dwVolume, DWORD dwVolumeMax)
 		g_MB[i].ssi263.SetVolume(dwVolume, dwVolumeMax);
 }
 
+void MB_SetFixedBlockUpdate(bool bEnable)
+{
+	g_bMBFixedBlocks = bEnable;
+	g_uLastMBUpdateCycle = 0;	// Restart the block timeline
+}
+
+void MB_SetPullMode(bool bPullMode)
+{
+	g_bMBPullMode = bPullMode;
+	g_nMBPullFrames = 0;
+	g_uLastMBUpdateCycle = 0;	// Restart the block timeline
+}
+
+// Headless: copy (and consume) up to nMaxFrames of stereo (interleaved L,R) 16-bit frames at 44.1KHz
+UINT MB_PullSamples(short* pBuffer, UINT nMaxFrames)
+{
+	const UINT nFrames = (g_nMBPullFrames < nMaxFrames) ? g_nMBPullFrames : nMaxFrames;
+	memcpy(pBuffer, g_nMBPullBuffer, nFrames * g_nMB_NumChannels * sizeof(short));
+	memmove(g_nMBPullBuffer, &g_nMBPullBuffer[nFrames * g_nMB_NumChannels], (g_nMBPullFrames - nFrames) * g_nMB_NumChannels * sizeof(short));
+	g_nMBPullFrames -= nFrames;
+
+	return nFrames;
+}
+
 //---------------------------------------------------------------------------
 
 // Called from class SSI263
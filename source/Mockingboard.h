@@ -30,6 +30,9 @@ SS_CARDTYPE MB_GetSoundcardType();
 bool    MB_IsActive();
 DWORD   MB_GetVolume();
 void    MB_SetVolume(DWORD dwVolume, DWORD dwVolumeMax);
+void    MB_SetFixedBlockUpdate(bool bEnable);
+void    MB_SetPullMode(bool bPullMode);
+UINT    MB_PullSamples(short* pBuffer, UINT nMaxFrames);
 void MB_Get6522IrqDescription(std::string& desc);
 
 UINT64 MB_GetLastCumulativeCycles(void);
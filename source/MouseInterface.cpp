@@ -151,7 +151,7 @@ CMouseInterface::~CMouseInterface()
 	delete [] m_pSlotRom;
 
 	if (m_syncEvent.m_active)
-		g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
+		g_SynchronousEventMgr.Remove(&m_syncEvent);
 }
 
 //===========================================================================
@@ -178,7 +178,7 @@ void CMouseInterface::InitializeIO(LPBYTE pCxRomPeripheral)
 	SetSlotRom();	// Pre: m_bActive == true
 	RegisterIoHandler(m_slot, &CMouseInterface::IORead, &CMouseInterface::IOWrite, NULL, NULL, this, NULL);
 
-	if (m_syncEvent.m_active) g_SynchronousEventMgr.Remove(m_syncEvent.m_id);
+	if (m_syncEvent.m_active) g_SynchronousEventMgr.Remove(&m_syncEvent);
 	m_syncEvent.m_cyclesRemaining = NTSC_GetCyclesUntilVBlank(0);
 	g_SynchronousEventMgr.Insert(&m_syncEvent);
 }
@@ -233,8 +233,6 @@ void CMouseInterface::SetSlotRom()
 
 	UINT uOffset = (m_by6821B << 7) & 0x0700;
 	memcpy(pCxRomPeripheral+m_slot*256, m_pSlotRom+uOffset, 256);
-	if (mem)
-		memcpy(mem+0xC000+m_slot*256, m_pSlotRom+uOffset, 256);
 }
 
 //===========================================================================
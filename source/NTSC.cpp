@@ -54,6 +54,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#define INLINE inline
 #endif
 
+// SSE2 is guaranteed for x64, and for x86 when built with /arch:SSE2 (the default since VS2012)
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define NTSC_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define NTSC_SSE2 0
+#endif
+
 	#define PI 3.1415926535898f
 	#define DEG_TO_RAD(x) (PI*(x)/180.f) // 2PI=360, PI=180,PI/2=90,PI/4=45
 	#define RAD_45  PI*0.25f
@@ -67,11 +75,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#define CYCLESTART (DEG_TO_RAD(45))
 
 
-// Globals (Public) ___________________________________________________
-	uint16_t g_nVideoClockVert = 0; // 9-bit: VC VB VA V5 V4 V3 V2 V1 V0 = 0 .. 262
-	uint16_t g_nVideoClockHorz = 0; // 6-bit:          H5 H4 H3 H2 H1 H0 = 0 .. 64, 25 >= visible (NB. final hpos is 2 cycles long, so a line is 65 cycles)
-
 // Globals (Private) __________________________________________________
+	// NB. The renderers' video clock: use NTSC_GetVideoClockVert/Horz() for the emulation thread's
+	static uint16_t g_nVideoClockVert = 0; // 9-bit: VC VB VA V5 V4 V3 V2 V1 V0 = 0 .. 262
+	static uint16_t g_nVideoClockHorz = 0; // 6-bit:          H5 H4 H3 H2 H1 H0 = 0 .. 64, 25 >= visible (NB. final hpos is 2 cycles long, so a line is 65 cycles)
+
 	static int g_nVideoCharSet = 0;
 	static int g_nVideoMixed   = 0;
 	static int g_nHiresPage    = 1;
@@ -118,6 +126,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static UpdatePixelFunc_t g_pFuncUpdateBnWPixel = 0; //updatePixelBnWMonitorSingleScanline;
 	static UpdatePixelFunc_t g_pFuncUpdateHuePixel = 0; //updatePixelHueMonitorSingleScanline;
 
+	// Same as calling g_pFuncUpdateXxxPixel() for each of the low 'count' bits, but a whole video word at a time
+	typedef void (*UpdatePixelsFunc_t)(uint16_t bits, UINT count);
+	static UpdatePixelsFunc_t g_pFuncUpdateBnWPixels = 0; //updatePixelsBnWMonitorSingleScanline;
+	static UpdatePixelsFunc_t g_pFuncUpdateHuePixels = 0; //updatePixelsHueMonitorSingleScanline;
+	#define NTSC_MAX_PIXELS_PER_WORD 14
+
 	static uint8_t  g_nTextFlashCounter = 0;
 	static uint16_t g_nTextFlashMask    = 0;
 
@@ -308,6 +322,112 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 	static csbits_t csbits;		// charset, optionally followed by alt charset
 
+	// Dirty-scanline tracking: a visible scanline's output is purely a function of VideoLineKey_t (for the NTSC renderers),
+	// so if it's unchanged since the scanline was last rendered then the framebuffer already holds the result - see updateScreen()
+	#define VIDEO_SCANNER_VISIBLE_BYTES (VIDEO_SCANNER_MAX_HORZ - VIDEO_SCANNER_HORZ_START)	// 40
+
+	// The bytes that the video scanner fetches for a visible scanline
+	// NB. Both the TEXT/LORES and HGR bytes, as a mixed-mode scanline (or a mid-scanline mode change) could use either
+	struct VideoLineFetch_t
+	{
+		uint8_t aTextMain [VIDEO_SCANNER_VISIBLE_BYTES];
+		uint8_t aTextAux  [VIDEO_SCANNER_VISIBLE_BYTES];
+		uint8_t aHiresMain[VIDEO_SCANNER_VISIBLE_BYTES];
+		uint8_t aHiresAux [VIDEO_SCANNER_VISIBLE_BYTES];
+	};
+
+	struct VideoLineKey_t
+	{
+		UpdateScreenFunc_t pFuncGraphics;
+		UpdateScreenFunc_t pFuncText;
+		bgra_t*  pVideoAddress;
+		int      nColorBurstPixels;
+		int      nColorPhase;
+		int      nSignalBits;
+		int      nLastColumnPixel;
+		int      nVideoMixed;
+		int      nVideoCharSet;
+		int      nTextFlashMask;
+		int      nPad;	// so that there are no padding bytes for memcmp()
+		VideoLineFetch_t bytes;
+	};
+
+	struct VideoLine_t
+	{
+		VideoLineKey_t key;
+		bool bValid;
+		int  nColorBurstPixelsEnd;		// g_nColorBurstPixels at the end of the scanline
+		UINT uContentSerial;			// changes whenever this scanline's pixels change
+		UINT uPrevLineContentSerial;	// the previous scanline's uContentSerial when this one was rendered (TV modes blend with it)
+	};
+
+	enum VideoLineState_e
+	{
+		VLS_NONE,				// not at the start of a visible scanline (or tracking was cancelled)
+		VLS_SKIP,				// unchanged scanline: only the video scanner is advanced
+		VLS_RENDER,				// changed scanline: rendered, and cached at the end if nothing changed mid-scanline
+		VLS_RENDER_UNTRACKED	// rendered, but something changed mid-scanline so can't be cached
+	};
+
+	static bool g_bVideoLineCache = true;
+	static VideoLine_t g_aVideoLines[VIDEO_SCANNER_Y_DISPLAY];
+	static VideoLineKey_t g_videoLineKey;					// key for the current scanline
+	static VideoLineState_e g_videoLineState = VLS_NONE;
+	static uint16_t g_nVideoLineVert = 0;					// the current scanline
+	static uint8_t g_aVideoLinePages[4];					// memdirty[] pages for the current scanline's bytes
+	static UINT g_uVideoLineContentSerial = 0;
+	static UINT64 g_uVideoLinesSkipped = 0;
+	static UINT64 g_uVideoLinesRendered = 0;
+
+	// Render thread (optional): the emulation thread records the video cycles, the video mode changes and the bytes fetched by the
+	// video scanner into chunks, and the render thread replays these through the same renderers - see recordVideoUpdateCycles()
+	enum VideoRenderCmd_e
+	{
+		VRC_UPDATE,		// arg0 = cycles
+		VRC_MODE,		// arg0 = video mode flags, arg1 = alt charset
+		VRC_TEXTMODE,	// arg0 = cols
+		VRC_RESYNC		// arg0 = vert, arg1 = horz
+	};
+
+	struct VideoRenderCmd_t
+	{
+		VideoRenderCmd_e cmd;
+		uint32_t arg0;
+		uint32_t arg1;
+	};
+
+	// A chunk never spans the start of a video frame (or a resync), so each of its visible video cycles is only fetched once
+	struct VideoRenderChunk_t
+	{
+		std::vector<VideoRenderCmd_t> cmds;
+		UINT uCycles;
+		VideoLineFetch_t aFetch[VIDEO_SCANNER_Y_DISPLAY];
+	};
+
+	#define VIDEO_RENDER_NUM_CHUNKS 4
+	static const UINT kVideoRenderChunkCycles = VIDEO_SCANNER_MAX_HORZ * 16;	// ~1ms: submit at the end of the scanline that reaches this
+
+	static bool g_bVideoRenderThread = false;			// enabled (but only runs for the NTSC renderers)
+	static HANDLE g_hVideoRenderThread = NULL;
+	static HANDLE g_hVideoRenderWork = NULL;			// chunk queued (or exit)
+	static HANDLE g_hVideoRenderDone = NULL;			// chunk rendered
+	static volatile bool g_bVideoRenderExit = false;
+	static VideoRenderChunk_t g_aVideoRenderChunks[VIDEO_RENDER_NUM_CHUNKS];
+	static UINT g_uVideoRenderHead = 0;					// emulation thread: chunk being recorded
+	static UINT g_uVideoRenderTail = 0;					// render thread: next chunk to render
+	static volatile LONG g_nVideoRenderQueued = 0;
+	static VideoLineFetch_t* g_pVideoFetch = NULL;		// render thread: the fetched bytes of the chunk being rendered
+
+	// When the render thread is running, g_nVideoClockVert/Horz (& all the renderer state) belong to it, and lag behind the emulation thread's:
+	static uint16_t g_nVideoScannerVert = 0;
+	static uint16_t g_nVideoScannerHorz = 0;
+	static int g_nVideoScannerPage = 1;
+	static uint32_t g_uVideoScannerModeFlags = 0;		// last video mode for the renderers
+	static int g_nVideoScannerTextCols = 40;
+	static bool g_bVideoScannerStale = false;			// video mode or clock changes weren't recorded (eg. during full-speed)
+	static UINT g_uVideoCaptureCycles = 0;				// full-speed: cycles left of the video frame being recorded
+	static DWORD g_dwVideoCaptureTime = 0;
+
 // Prototypes
 	INLINE void      updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable );
 	INLINE void      updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable );
@@ -318,6 +438,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	INLINE void      updateVideoScannerAddress();
 	INLINE uint16_t  getVideoScannerAddressTXT();
 	INLINE uint16_t  getVideoScannerAddressHGR();
+	INLINE uint8_t*  getVideoMainPtrTXT(uint16_t addr);
+	INLINE uint8_t*  getVideoAuxPtrTXT(uint16_t addr);
+	INLINE uint8_t*  getVideoMainPtrHGR(uint16_t addr);
+	INLINE uint8_t*  getVideoAuxPtrHGR(uint16_t addr);
 
 	static void initChromaPhaseTables();
 	static real initFilterChroma   (real z);
@@ -349,6 +473,16 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static void updateScreenDoubleHires80Simplified(long cycles6502);
 	static void updateScreenDoubleHires80RGB(long cycles6502);
 
+	static void disturbVideoLine(void);
+	static void cancelVideoLine(void);
+	static void invalidateVideoLines(void);
+
+	static void recordVideoCmd(VideoRenderCmd_e cmd, uint32_t arg0, uint32_t arg1=0);
+	static void flushVideoRender(void);
+	static void updateVideoRenderThread(void);
+	static void stopVideoRenderThread(void);
+	static void syncVideoScannerClock(void);
+
 //===========================================================================
 static void set_csbits()
 {
@@ -575,6 +709,162 @@ inline void updateFramebufferMonitorDoubleScanline( uint16_t signal, bgra_t *pTa
 }
 #endif
 
+//===========================================================================
+// Video word (up to 14 pixels) at a time versions of the above:
+// . getScanlineColors() does the serial part (12-bit signal shift register & color-phase), ie. just table lookups
+// . updateFramebufferXxxPixels() then does the scanline blending & writes, 4 pixels at a time with SSE2
+// The output is identical to calling updateFramebufferXxx() + updateColorPhase() per pixel.
+
+// NB. phaseStride=0 for the B&W tables (only 1 table), and NTSC_NUM_SEQUENCES for the Hue tables (1 per color-phase)
+inline void getScanlineColors( uint16_t bits, const UINT count, const bgra_t *pTable, const UINT phaseStride, uint32_t *pColors )
+{
+	uint16_t signal = g_nSignalBitsNTSC;
+	UINT phase = g_nColorPhaseNTSC;
+
+	for (UINT i = 0; i < count; i++, bits >>= 1)
+	{
+		signal = ((signal << 1) | (bits & 1)) & 0xFFF; // 12-bit
+		pColors[i] = *(const uint32_t*) &pTable[ phase*phaseStride + signal ];
+		phase = (phase + 1) & 3;
+	}
+
+	g_nSignalBitsNTSC = signal;
+	g_nColorPhaseNTSC = phase;
+}
+
+#if NTSC_SSE2
+inline __m128i blend50( const __m128i a, const __m128i b )
+{
+	const __m128i mask = _mm_set1_epi32(0x00fefefe);
+	return _mm_add_epi32( _mm_srli_epi32(_mm_and_si128(a, mask), 1), _mm_srli_epi32(_mm_and_si128(b, mask), 1) );
+}
+#endif
+
+//===========================================================================
+inline void updateFramebufferTVSingleScanlinePixels( const uint32_t *pColors, const UINT count )
+{
+	uint32_t *pLine0Curr = getScanlineCurrent();
+	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
+	const uint32_t *pLine2Prev = getScanlinePrevious();
+	UINT i = 0;
+
+#if NTSC_SSE2
+	const __m128i mask = _mm_set1_epi32(0x00fefefe);
+	const __m128i alpha = _mm_set1_epi32((int)ALPHA32_MASK);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i color0 = _mm_loadu_si128((const __m128i*)&pColors[i]);
+		const __m128i color2 = _mm_loadu_si128((const __m128i*)&pLine2Prev[i]);
+		const __m128i color1 = _mm_srli_epi32(_mm_and_si128(blend50(color0, color2), mask), 1);
+		_mm_storeu_si128((__m128i*)&pLine1Prev[i], _mm_or_si128(color1, alpha));
+		_mm_storeu_si128((__m128i*)&pLine0Curr[i], color0);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const uint32_t color0 = pColors[i];
+		uint32_t color1 = ((color0 & 0x00fefefe) >> 1) + ((pLine2Prev[i] & 0x00fefefe) >> 1); // 50% Blend
+		color1 = (color1 & 0x00fefefe) >> 1;	// ... then 50% brightness for inbetween line
+		pLine1Prev[i] = color1 | ALPHA32_MASK;
+		pLine0Curr[i] = color0;
+	}
+
+	// GH#650: Draw to final inbetween scanline to avoid residue from other video modes (eg. Amber->TV B&W)
+	if (g_nVideoClockVert == (VIDEO_SCANNER_Y_DISPLAY-1))
+	{
+		uint32_t *pLine1Next = getScanlineNextInbetween();
+		for (i = 0; i < count; i++)
+			pLine1Next[i] = ((pColors[i] & 0x00fcfcfc) >> 2) | ALPHA32_MASK;	// 25% of current
+	}
+
+	g_pVideoAddress += count;
+}
+
+//===========================================================================
+inline void updateFramebufferTVDoubleScanlinePixels( const uint32_t *pColors, const UINT count )
+{
+	uint32_t *pLine0Curr = getScanlineCurrent();
+	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
+	const uint32_t *pLine2Prev = getScanlinePrevious();
+	UINT i = 0;
+
+#if NTSC_SSE2
+	const __m128i alpha = _mm_set1_epi32((int)ALPHA32_MASK);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i color0 = _mm_loadu_si128((const __m128i*)&pColors[i]);
+		const __m128i color2 = _mm_loadu_si128((const __m128i*)&pLine2Prev[i]);
+		_mm_storeu_si128((__m128i*)&pLine1Prev[i], _mm_or_si128(blend50(color0, color2), alpha));
+		_mm_storeu_si128((__m128i*)&pLine0Curr[i], color0);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const uint32_t color0 = pColors[i];
+		const uint32_t color1 = ((color0 & 0x00fefefe) >> 1) + ((pLine2Prev[i] & 0x00fefefe) >> 1); // 50% Blend
+		pLine1Prev[i] = color1 | ALPHA32_MASK;
+		pLine0Curr[i] = color0;
+	}
+
+	// GH#650: Draw to final inbetween scanline to avoid residue from other video modes (eg. Amber->TV B&W)
+	if (g_nVideoClockVert == (VIDEO_SCANNER_Y_DISPLAY-1))
+	{
+		uint32_t *pLine1Next = getScanlineNextInbetween();
+		for (i = 0; i < count; i++)
+			pLine1Next[i] = ((pColors[i] & 0x00fefefe) >> 1) | ALPHA32_MASK;	// 50% of current
+	}
+
+	g_pVideoAddress += count;
+}
+
+//===========================================================================
+inline void updateFramebufferMonitorSingleScanlinePixels( const uint32_t *pColors, const UINT count )
+{
+	uint32_t *pLine0Curr = getScanlineCurrent();
+	uint32_t *pLine1Next = getScanlineNextInbetween();
+	UINT i = 0;
+
+#if NTSC_SSE2
+	const __m128i alpha = _mm_set1_epi32((int)ALPHA32_MASK);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)&pLine1Next[i], alpha);	// No blending (GH#631)
+		_mm_storeu_si128((__m128i*)&pLine0Curr[i], _mm_loadu_si128((const __m128i*)&pColors[i]));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		pLine1Next[i] = 0 | ALPHA32_MASK;	// No blending (GH#631)
+		pLine0Curr[i] = pColors[i];
+	}
+
+	g_pVideoAddress += count;
+}
+
+//===========================================================================
+inline void updateFramebufferMonitorDoubleScanlinePixels( const uint32_t *pColors, const UINT count )
+{
+	uint32_t *pLine0Curr = getScanlineCurrent();
+	uint32_t *pLine1Next = getScanlineNextInbetween();
+	UINT i = 0;
+
+#if NTSC_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i color0 = _mm_loadu_si128((const __m128i*)&pColors[i]);
+		_mm_storeu_si128((__m128i*)&pLine1Next[i], color0);
+		_mm_storeu_si128((__m128i*)&pLine0Curr[i], color0);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		pLine1Next[i] = pColors[i];
+		pLine0Curr[i] = pColors[i];
+	}
+
+	g_pVideoAddress += count;
+}
+
 //===========================================================================
 inline bool GetColorBurst( void )
 {
@@ -585,13 +875,7 @@ inline bool GetColorBurst( void )
 
 void update7MonoPixels( uint16_t bits )
 {
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-	g_pFuncUpdateBnWPixel(bits & 1);
+	g_pFuncUpdateBnWPixels(bits, 7);
 }
 
 //===========================================================================
@@ -601,55 +885,11 @@ void update7MonoPixels( uint16_t bits )
 inline void updatePixels(uint16_t bits)
 {
 	if (!GetColorBurst())
-	{ 
-		/* #1 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #2 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #3 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #4 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #5 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #6 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		/* #7 of 7 */
-		g_pFuncUpdateBnWPixel(bits & 1); bits >>= 1;
-		g_pFuncUpdateBnWPixel(bits & 1);
-        g_nLastColumnPixelNTSC = bits & 1;
-	}
+		g_pFuncUpdateBnWPixels(bits, NTSC_MAX_PIXELS_PER_WORD);
 	else
-	{
-		/* #1 of 7 */                                // abcd efgh ijkl mnop
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0abc defg hijk lmno
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 00ab cdef ghi jklmn
-		/* #2 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 000a bcde fghi jklm
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 abcd efgh ijkl
-		/* #3 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0abc defg hijk
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 00ab cdef ghij
-		/* #4 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 000a bcde fghi
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 abcd efgh
-		/* #5 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 0abc defg
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 00ab cdef
-		/* #6 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 000a bcde
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 0000 abcd
-		/* #7 of 7 */
-		g_pFuncUpdateHuePixel(bits & 1); bits >>= 1; // 0000 0000 0000 0abc
-		g_pFuncUpdateHuePixel(bits & 1);           
-        g_nLastColumnPixelNTSC = bits & 1;
-	}
+		g_pFuncUpdateHuePixels(bits, NTSC_MAX_PIXELS_PER_WORD);
+
+	g_nLastColumnPixelNTSC = (bits >> (NTSC_MAX_PIXELS_PER_WORD-1)) & 1;
 }
 
 //===========================================================================
@@ -746,18 +986,61 @@ inline void updateVideoScannerAddress()
 }
 
 //===========================================================================
+INLINE uint16_t getVideoScannerAddressTXT(uint16_t vert, uint16_t horz, int textPage)
+{
+	return (g_aClockVertOffsetsTXT[vert/8] + 
+		g_pHorzClockOffset         [vert/64][horz] + (textPage  *  0x400));
+}
+
 INLINE uint16_t getVideoScannerAddressTXT()
 {
-	return (g_aClockVertOffsetsTXT[g_nVideoClockVert/8] + 
-		g_pHorzClockOffset         [g_nVideoClockVert/64][g_nVideoClockHorz] + (g_nTextPage  *  0x400));
+	return getVideoScannerAddressTXT(g_nVideoClockVert, g_nVideoClockHorz, g_nTextPage);
 }
 
 //===========================================================================
-INLINE uint16_t getVideoScannerAddressHGR()
+INLINE uint16_t getVideoScannerAddressHGR(uint16_t vert, uint16_t horz, int hiresPage)
 {
 	// NB. For both A2 and //e use APPLE_IIE_HORZ_CLOCK_OFFSET - see VideoGetScannerAddress() where only TEXT mode adds $1000
-	return (g_aClockVertOffsetsHGR[g_nVideoClockVert  ] + 
-		APPLE_IIE_HORZ_CLOCK_OFFSET[g_nVideoClockVert/64][g_nVideoClockHorz] + (g_nHiresPage * 0x2000));
+	return (g_aClockVertOffsetsHGR[vert  ] + 
+		APPLE_IIE_HORZ_CLOCK_OFFSET[vert/64][horz] + (hiresPage * 0x2000));
+}
+
+INLINE uint16_t getVideoScannerAddressHGR()
+{
+	return getVideoScannerAddressHGR(g_nVideoClockVert, g_nVideoClockHorz, g_nHiresPage);
+}
+
+//===========================================================================
+
+// The byte fetched by the video scanner at g_nVideoClockVert/Horz (which must be visible):
+// . from memory, or on the render thread, the byte as it was when the emulation thread recorded this video cycle
+INLINE uint8_t* getVideoMainPtrTXT(uint16_t addr)
+{
+	return g_pVideoFetch ? &g_pVideoFetch[g_nVideoClockVert].aTextMain[g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START] : MemGetMainPtr(addr);
+}
+
+INLINE uint8_t* getVideoAuxPtrTXT(uint16_t addr)
+{
+	return g_pVideoFetch ? &g_pVideoFetch[g_nVideoClockVert].aTextAux[g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START] : MemGetAuxPtr(addr);
+}
+
+INLINE uint8_t* getVideoMainPtrHGR(uint16_t addr)
+{
+	return g_pVideoFetch ? &g_pVideoFetch[g_nVideoClockVert].aHiresMain[g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START] : MemGetMainPtr(addr);
+}
+
+INLINE uint8_t* getVideoAuxPtrHGR(uint16_t addr)
+{
+	return g_pVideoFetch ? &g_pVideoFetch[g_nVideoClockVert].aHiresAux[g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START] : MemGetAuxPtr(addr);
+}
+
+//===========================================================================
+
+// Apple IIe, Technical Notes, #3: Double High-Resolution Graphics
+// 80STORE must be OFF to display page 2
+INLINE int getVideoPage(uint32_t uVideoModeFlags)
+{
+	return ((uVideoModeFlags & VF_PAGE2) && !(uVideoModeFlags & VF_80STORE)) ? 2 : 1;
 }
 
 
@@ -1106,6 +1389,70 @@ static void updatePixelHueMonitorDoubleScanline (uint16_t compositeSignal)
 	updateColorPhase();
 }
 
+//===========================================================================
+static void updatePixelsBnWMonitorSingleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aBnWMonitorCustom, 0, colors);
+	updateFramebufferMonitorSingleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsBnWMonitorDoubleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aBnWMonitorCustom, 0, colors);
+	updateFramebufferMonitorDoubleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsBnWColorTVSingleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aBnWColorTVCustom, 0, colors);
+	updateFramebufferTVSingleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsBnWColorTVDoubleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aBnWColorTVCustom, 0, colors);
+	updateFramebufferTVDoubleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsHueColorTVSingleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aHueColorTV[0], NTSC_NUM_SEQUENCES, colors);
+	updateFramebufferTVSingleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsHueColorTVDoubleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aHueColorTV[0], NTSC_NUM_SEQUENCES, colors);
+	updateFramebufferTVDoubleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsHueMonitorSingleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aHueMonitor[0], NTSC_NUM_SEQUENCES, colors);
+	updateFramebufferMonitorSingleScanlinePixels(colors, count);
+}
+
+//===========================================================================
+static void updatePixelsHueMonitorDoubleScanline (uint16_t bits, UINT count)
+{
+	uint32_t colors[NTSC_MAX_PIXELS_PER_WORD];
+	getScanlineColors(bits, count, g_aHueMonitor[0], NTSC_NUM_SEQUENCES, colors);
+	updateFramebufferMonitorDoubleScanlinePixels(colors, count);
+}
+
 //===========================================================================
 void updateScreenDoubleHires40 (long cycles6502) // wsUpdateVideoHires0
 {
@@ -1127,7 +1474,7 @@ void updateScreenDoubleHires40 (long cycles6502) // wsUpdateVideoHires0
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
+				uint8_t *pMain = getVideoMainPtrHGR(addr);
 				uint8_t  m     = pMain[0];
 				uint16_t bits  = g_aPixelDoubleMaskHGR[m & 0x7F]; // Optimization: hgrbits second 128 entries are mirror of first 128
 				updatePixels( bits );
@@ -1245,8 +1592,8 @@ void updateScreenDoubleHires80 (long cycles6502 ) // wsUpdateVideoDblHires
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t  *pMain = MemGetMainPtr(addr);
-				uint8_t  *pAux  = MemGetAuxPtr (addr);
+				uint8_t  *pMain = getVideoMainPtrHGR(addr);
+				uint8_t  *pAux  = getVideoAuxPtrHGR (addr);
 
 				uint8_t m = pMain[0];
 				uint8_t a = pAux [0];
@@ -1282,7 +1629,7 @@ void updateScreenDoubleLores40 (long cycles6502) // wsUpdateVideo7MLores
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
+				uint8_t *pMain = getVideoMainPtrTXT(addr);
 				uint8_t  m     = pMain[0];
 				uint16_t lo    = getLoResBits( m ); 
 				uint16_t bits  = g_aPixelDoubleMaskHGR[(0xFF & lo >> ((1 - (g_nVideoClockHorz & 1)) * 2)) & 0x7F]; // Optimization: hgrbits
@@ -1345,8 +1692,8 @@ void updateScreenDoubleLores80 (long cycles6502) // wsUpdateVideoDblLores
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
-				uint8_t *pAux  = MemGetAuxPtr (addr);
+				uint8_t *pMain = getVideoMainPtrTXT(addr);
+				uint8_t *pAux  = getVideoAuxPtrTXT (addr);
 
 				uint8_t m = pMain[0];
 				uint8_t a = pAux [0];
@@ -1474,7 +1821,7 @@ void updateScreenSingleHires40 (long cycles6502)
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
+				uint8_t *pMain = getVideoMainPtrHGR(addr);
 				uint8_t  m     = pMain[0];
 				uint16_t bits  = g_aPixelDoubleMaskHGR[m & 0x7F]; // Optimization: hgrbits second 128 entries are mirror of first 128
 				if (m & 0x80)
@@ -1544,7 +1891,7 @@ void updateScreenSingleLores40 (long cycles6502)
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
+				uint8_t *pMain = getVideoMainPtrTXT(addr);
 				uint8_t  m     = pMain[0];
 				uint16_t lo    = getLoResBits( m ); 
 				uint16_t bits  = lo >> ((1 - (g_nVideoClockHorz & 1)) * 2);
@@ -1571,7 +1918,7 @@ void updateScreenText40 (long cycles6502)
 		{
 			if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
+				uint8_t *pMain = getVideoMainPtrTXT(addr);
 				uint8_t  m     = pMain[0];
 				uint8_t  c     = getCharSetBits(m);
 				uint16_t bits  = g_aPixelDoubleMaskHGR[c & 0x7F]; // Optimization: hgrbits second 128 entries are mirror of first 128
@@ -1636,8 +1983,8 @@ void updateScreenText80 (long cycles6502)
 		{
 			if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
-				uint8_t *pMain = MemGetMainPtr(addr);
-				uint8_t *pAux  = MemGetAuxPtr (addr);
+				uint8_t *pMain = getVideoMainPtrTXT(addr);
+				uint8_t *pAux  = getVideoAuxPtrTXT (addr);
 
 				uint8_t m = pMain[0];
 				uint8_t a = pAux [0];
@@ -1737,43 +2084,61 @@ uint32_t*NTSC_VideoGetChromaTable( bool bHueTypeMonochrome, bool bMonitorTypeCol
 }
 
 //===========================================================================
+static void videoClockResync(uint16_t vert, uint16_t horz)
+{
+	cancelVideoLine();
+	g_nVideoClockVert = vert;
+	g_nVideoClockHorz = horz;
+}
+
 void NTSC_VideoClockResync(const DWORD dwCyclesThisFrame)
 {
-	g_nVideoClockVert = (uint16_t)(dwCyclesThisFrame / VIDEO_SCANNER_MAX_HORZ) % g_videoScannerMaxVert;
-	g_nVideoClockHorz = (uint16_t)(dwCyclesThisFrame % VIDEO_SCANNER_MAX_HORZ);
+	const uint16_t vert = (uint16_t)(dwCyclesThisFrame / VIDEO_SCANNER_MAX_HORZ) % g_videoScannerMaxVert;
+	const uint16_t horz = (uint16_t)(dwCyclesThisFrame % VIDEO_SCANNER_MAX_HORZ);
+
+	if (g_hVideoRenderThread)
+	{
+		if (vert == g_nVideoScannerVert && horz == g_nVideoScannerHorz)
+			return;
+
+		g_nVideoScannerVert = vert;
+		g_nVideoScannerHorz = horz;
+		recordVideoCmd(VRC_RESYNC, vert, horz);
+		return;
+	}
+
+	videoClockResync(vert, horz);
 }
 
 //===========================================================================
 uint16_t NTSC_VideoGetScannerAddress ( const ULONG uExecutedCycles )
 {
-	if (g_bFullSpeed)
+	if (NTSC_IsVideoClockStale())
 	{
 		// Ensure that NTSC video-scanner gets updated during full-speed, so video-dependent Apple II code doesn't hang
 		NTSC_VideoClockResync( CpuGetCyclesThisVideoFrame(uExecutedCycles) );
 	}
 
-	const uint16_t currVideoClockVert = g_nVideoClockVert;
-	const uint16_t currVideoClockHorz = g_nVideoClockHorz;
+	uint16_t vert = NTSC_GetVideoClockVert();
+	uint16_t horz = NTSC_GetVideoClockHorz();
+	const int textPage  = g_hVideoRenderThread ? g_nVideoScannerPage : g_nTextPage;
+	const int hiresPage = g_hVideoRenderThread ? g_nVideoScannerPage : g_nHiresPage;
 
 	// Required for ANSI STORY (end credits) vert scrolling mid-scanline mixed mode: DGR80, TEXT80, DGR80
-	g_nVideoClockHorz -= 1;
-	if ((SHORT)g_nVideoClockHorz < 0)
+	if (horz == 0)
 	{
-		g_nVideoClockHorz += VIDEO_SCANNER_MAX_HORZ;
-		g_nVideoClockVert -= 1;
-		if ((SHORT)g_nVideoClockVert < 0)
-			g_nVideoClockVert = g_videoScannerMaxVert-1;
+		horz = VIDEO_SCANNER_MAX_HORZ;
+		vert = (vert == 0) ? g_videoScannerMaxVert : vert;
+		vert -= 1;
 	}
+	horz -= 1;
 
 	uint16_t addr;
 	bool bHires = (GetVideo().GetVideoMode() & VF_HIRES) && !(GetVideo().GetVideoMode() & VF_TEXT); // SW_HIRES && !SW_TEXT
 	if( bHires )
-		addr = getVideoScannerAddressHGR();
+		addr = getVideoScannerAddressHGR(vert, horz, hiresPage);
 	else
-		addr = getVideoScannerAddressTXT();
-
-	g_nVideoClockVert = currVideoClockVert;
-	g_nVideoClockHorz = currVideoClockHorz;
+		addr = getVideoScannerAddressTXT(vert, horz, textPage);
 
 	return addr;
 }
@@ -1785,8 +2150,10 @@ uint16_t NTSC_VideoGetScannerAddressForDebugger(void)
 }
 
 //===========================================================================
-void NTSC_SetVideoTextMode( int cols )
+static void setVideoTextMode( int cols )
 {
+	disturbVideoLine();
+
 	if (GetVideo().GetVideoType() == VT_COLOR_VIDEOCARD_RGB)
 	{
 		if (cols == 40)
@@ -1800,36 +2167,30 @@ void NTSC_SetVideoTextMode( int cols )
 		g_pFuncUpdateTextScreen = updateScreenText80;
 }
 
-//===========================================================================
-void NTSC_SetVideoMode( uint32_t uVideoModeFlags, bool bDelay/*=false*/ )
+void NTSC_SetVideoTextMode( int cols )
 {
-	if (bDelay && !g_bFullSpeed)
+	if (g_hVideoRenderThread)
 	{
-		// (GH#670) NB. if g_bFullSpeed then NTSC_VideoUpdateCycles() won't be called on the next 6502 opcode.
-		//  - Instead it's called when !g_bFullSpeed (eg. drive motor off), then the stale g_uNewVideoModeFlags will get used for NTSC_SetVideoMode()!
-		g_bDelayVideoMode = true;
-		g_uNewVideoModeFlags = uVideoModeFlags;
+		g_nVideoScannerTextCols = cols;
+		recordVideoCmd(VRC_TEXTMODE, cols);
 		return;
 	}
 
+	setVideoTextMode(cols);
+}
+
+//===========================================================================
+static void setVideoMode( uint32_t uVideoModeFlags, int nVideoCharSet )
+{
+	disturbVideoLine();
 
 	g_nVideoMixed   = uVideoModeFlags & VF_MIXED;
-	g_nVideoCharSet = GetVideo().VideoGetSWAltCharSet() ? 1 : 0;
+	g_nVideoCharSet = nVideoCharSet;
 
 	RGB_DisableTextFB();
 
-	g_nTextPage  = 1;
-	g_nHiresPage = 1;
-	if (uVideoModeFlags & VF_PAGE2)
-	{
-		// Apple IIe, Technical Notes, #3: Double High-Resolution Graphics
-		// 80STORE must be OFF to display page 2
-		if (0 == (uVideoModeFlags & VF_80STORE))
-		{
-			g_nTextPage  = 2;
-			g_nHiresPage = 2;
-		}
-	}
+	g_nTextPage  = getVideoPage(uVideoModeFlags);
+	g_nHiresPage = getVideoPage(uVideoModeFlags);
 
 	if (GetVideo().GetVideoRefreshRate() == VR_50HZ && g_pVideoAddress)	// GH#763 / NB. g_pVideoAddress==NULL when called via VideoResetState()
 	{
@@ -1986,10 +2347,39 @@ void NTSC_SetVideoMode( uint32_t uVideoModeFlags, bool bDelay/*=false*/ )
 	}
 }
 
+void NTSC_SetVideoMode( uint32_t uVideoModeFlags, bool bDelay/*=false*/ )
+{
+	if (bDelay && (!g_bFullSpeed || g_uVideoCaptureCycles))
+	{
+		// (GH#670) NB. if g_bFullSpeed then NTSC_VideoUpdateCycles() won't be called on the next 6502 opcode.
+		//  - Instead it's called when !g_bFullSpeed (eg. drive motor off), then the stale g_uNewVideoModeFlags will get used for NTSC_SetVideoMode()!
+		g_bDelayVideoMode = true;
+		g_uNewVideoModeFlags = uVideoModeFlags;
+		return;
+	}
+
+	const int nVideoCharSet = GetVideo().VideoGetSWAltCharSet() ? 1 : 0;
+
+	if (g_hVideoRenderThread)
+	{
+		g_uVideoScannerModeFlags = uVideoModeFlags;
+		g_nVideoScannerPage = getVideoPage(uVideoModeFlags);
+		recordVideoCmd(VRC_MODE, uVideoModeFlags, nVideoCharSet);
+		return;
+	}
+
+	setVideoMode(uVideoModeFlags, nVideoCharSet);
+}
+
 //===========================================================================
 
 void NTSC_SetVideoStyle(void)
 {
+	flushVideoRender();
+
+	disturbVideoLine();
+	invalidateVideoLines();
+
 	const bool half = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
 	const VideoRefreshRate_e refresh = GetVideo().GetVideoRefreshRate();
 	uint8_t r, g, b;
@@ -2005,11 +2395,15 @@ void NTSC_SetVideoStyle(void)
 			{
 				g_pFuncUpdateBnWPixel = updatePixelBnWColorTVSingleScanline;
 				g_pFuncUpdateHuePixel = updatePixelHueColorTVSingleScanline;
+				g_pFuncUpdateBnWPixels = updatePixelsBnWColorTVSingleScanline;
+				g_pFuncUpdateHuePixels = updatePixelsHueColorTVSingleScanline;
 			}
 			else
 			{
 				g_pFuncUpdateBnWPixel = updatePixelBnWColorTVDoubleScanline;
 				g_pFuncUpdateHuePixel = updatePixelHueColorTVDoubleScanline;
+				g_pFuncUpdateBnWPixels = updatePixelsBnWColorTVDoubleScanline;
+				g_pFuncUpdateHuePixels = updatePixelsHueColorTVDoubleScanline;
 			}
 			break;
 
@@ -2023,11 +2417,15 @@ void NTSC_SetVideoStyle(void)
 			{
 				g_pFuncUpdateBnWPixel = updatePixelBnWMonitorSingleScanline;
 				g_pFuncUpdateHuePixel = updatePixelHueMonitorSingleScanline;
+				g_pFuncUpdateBnWPixels = updatePixelsBnWMonitorSingleScanline;
+				g_pFuncUpdateHuePixels = updatePixelsHueMonitorSingleScanline;
 			}
 			else
 			{
 				g_pFuncUpdateBnWPixel = updatePixelBnWMonitorDoubleScanline;
 				g_pFuncUpdateHuePixel = updatePixelHueMonitorDoubleScanline;
+				g_pFuncUpdateBnWPixels = updatePixelsBnWMonitorDoubleScanline;
+				g_pFuncUpdateHuePixels = updatePixelsHueMonitorDoubleScanline;
 			}
 			break;
 
@@ -2037,9 +2435,15 @@ void NTSC_SetVideoStyle(void)
 			b = 0xFF;
 			updateMonochromeTables( r, g, b ); // Custom Monochrome color
 			if (half)
+			{
 				g_pFuncUpdateBnWPixel = g_pFuncUpdateHuePixel = updatePixelBnWColorTVSingleScanline;
+				g_pFuncUpdateBnWPixels = g_pFuncUpdateHuePixels = updatePixelsBnWColorTVSingleScanline;
+			}
 			else
+			{
 				g_pFuncUpdateBnWPixel = g_pFuncUpdateHuePixel = updatePixelBnWColorTVDoubleScanline;
+				g_pFuncUpdateBnWPixels = g_pFuncUpdateHuePixels = updatePixelsBnWColorTVDoubleScanline;
+			}
 			break;
 
 		case VT_MONO_AMBER:
@@ -2074,11 +2478,19 @@ void NTSC_SetVideoStyle(void)
 _mono:
 			updateMonochromeTables( r, g, b ); // Custom Monochrome color
 			if (half)
+			{
 				g_pFuncUpdateBnWPixel = g_pFuncUpdateHuePixel = updatePixelBnWMonitorSingleScanline;
+				g_pFuncUpdateBnWPixels = g_pFuncUpdateHuePixels = updatePixelsBnWMonitorSingleScanline;
+			}
 			else
+			{
 				g_pFuncUpdateBnWPixel = g_pFuncUpdateHuePixel = updatePixelBnWMonitorDoubleScanline;
+				g_pFuncUpdateBnWPixels = g_pFuncUpdateHuePixels = updatePixelsBnWMonitorDoubleScanline;
+			}
 			break;
 		}
+
+	updateVideoRenderThread();
 }
 
 //===========================================================================
@@ -2087,15 +2499,22 @@ static void GenerateBaseColors(baseColors_t pBaseNtscColors);
 
 void NTSC_Destroy(void)
 {
+	stopVideoRenderThread();
+
 	// After a VM restart, this will point to an old FrameBuffer
 	// - if it's now unmapped then this can cause a crash in NTSC_SetVideoMode()!
 	g_pVideoAddress = 0;
 	g_kFrameBufferWidth = 0;
 	memset(g_pScanLines, 0, sizeof(g_pScanLines));
+
+	cancelVideoLine();
+	invalidateVideoLines();
 }
 
 void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 {
+	stopVideoRenderThread();	// Restarted by NTSC_SetVideoStyle() for the new framebuffer
+
 	make_csbits();
 	GenerateVideoTables();
 	initPixelDoubleMasks();
@@ -2114,6 +2533,9 @@ void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 
 	g_pVideoAddress = g_pScanLines[0];
 
+	cancelVideoLine();
+	invalidateVideoLines();
+
 	g_pFuncUpdateTextScreen     = updateScreenText40;
 	g_pFuncUpdateGraphicsScreen = updateScreenText40;
 
@@ -2188,8 +2610,14 @@ void NTSC_VideoReinitialize( DWORD cyclesThisFrame, bool bInitVideoScannerAddres
 		cyclesThisFrame %= g_videoScanner6502Cycles;
 	}
 
+	flushVideoRender();
+
+	cancelVideoLine();
+	invalidateVideoLines();
+
 	g_nVideoClockVert = (uint16_t) (cyclesThisFrame / VIDEO_SCANNER_MAX_HORZ);
 	g_nVideoClockHorz = cyclesThisFrame % VIDEO_SCANNER_MAX_HORZ;
+	syncVideoScannerClock();
 
 	if (bInitVideoScannerAddress)		// GH#611
 		updateVideoScannerAddress();	// Pre-condition: g_nVideoClockVert
@@ -2198,6 +2626,11 @@ void NTSC_VideoReinitialize( DWORD cyclesThisFrame, bool bInitVideoScannerAddres
 //===========================================================================
 void NTSC_VideoInitAppleType ()
 {
+	flushVideoRender();
+
+	disturbVideoLine();
+	invalidateVideoLines();
+
 	int model = GetApple2Type();
 
 	// anything other than low bit set means not II/II+ (TC: include Pravets machines too?)
@@ -2212,6 +2645,10 @@ void NTSC_VideoInitAppleType ()
 //===========================================================================
 void NTSC_VideoInitChroma()
 {
+	flushVideoRender();
+
+	disturbVideoLine();
+	invalidateVideoLines();
 	initChromaPhaseTables();
 }
 
@@ -2225,6 +2662,229 @@ void NTSC_VideoInitChroma()
 
 //===========================================================================
 
+// Only the NTSC renderers: the RGB & Simplified renderers also depend on the RGB card's state
+static bool isVideoLineCacheable(void)
+{
+	const UpdateScreenFunc_t pFunc = g_pFuncUpdateGraphicsScreen;
+	const bool bGraphics = pFunc == updateScreenText40 || pFunc == updateScreenText80 ||
+		pFunc == updateScreenSingleLores40 || pFunc == updateScreenDoubleLores40 || pFunc == updateScreenDoubleLores80 ||
+		pFunc == updateScreenSingleHires40 || pFunc == updateScreenDoubleHires40 || pFunc == updateScreenDoubleHires80;
+	const bool bText = g_pFuncUpdateTextScreen == updateScreenText40 || g_pFuncUpdateTextScreen == updateScreenText80;
+	return bGraphics && bText;
+}
+
+// Pre: g_nVideoClockHorz == 0
+// NB. Both the TEXT/LORES and HGR bytes are captured, as a mixed-mode scanline could use either
+static void getVideoLineKey(VideoLineKey_t& key)
+{
+	memset(&key, 0, sizeof(key));
+	key.pFuncGraphics     = g_pFuncUpdateGraphicsScreen;
+	key.pFuncText         = g_pFuncUpdateTextScreen;
+	key.pVideoAddress     = g_pVideoAddress;
+	key.nColorBurstPixels = g_nColorBurstPixels;
+	key.nColorPhase       = g_nColorPhaseNTSC;
+	key.nSignalBits       = g_nSignalBitsNTSC;
+	key.nLastColumnPixel  = g_nLastColumnPixelNTSC;
+	key.nVideoMixed       = g_nVideoMixed;
+	key.nVideoCharSet     = g_nVideoCharSet;
+	key.nTextFlashMask    = g_nTextFlashMask;
+
+	const uint16_t horz = g_nVideoClockHorz;
+	for (UINT i = 0; i < VIDEO_SCANNER_VISIBLE_BYTES; i++)
+	{
+		g_nVideoClockHorz = VIDEO_SCANNER_HORZ_START + i;
+		const uint16_t addrTXT = getVideoScannerAddressTXT();
+		const uint16_t addrHGR = getVideoScannerAddressHGR();
+		key.bytes.aTextMain[i]  = *getVideoMainPtrTXT(addrTXT);
+		key.bytes.aTextAux[i]   = *getVideoAuxPtrTXT(addrTXT);
+		key.bytes.aHiresMain[i] = *getVideoMainPtrHGR(addrHGR);
+		key.bytes.aHiresAux[i]  = *getVideoAuxPtrHGR(addrHGR);
+
+		if (i == 0 || i == VIDEO_SCANNER_VISIBLE_BYTES-1)
+		{
+			g_aVideoLinePages[i ? 1 : 0] = addrTXT >> 8;
+			g_aVideoLinePages[i ? 3 : 2] = addrHGR >> 8;
+		}
+	}
+	g_nVideoClockHorz = horz;
+}
+
+// Swap the current scanline's bytes in memory with those in 'key'
+static void swapVideoLineBytes(VideoLineKey_t& key)
+{
+	const uint16_t horz = g_nVideoClockHorz;
+	for (UINT i = 0; i < VIDEO_SCANNER_VISIBLE_BYTES; i++)
+	{
+		g_nVideoClockHorz = VIDEO_SCANNER_HORZ_START + i;
+		const uint16_t addrTXT = getVideoScannerAddressTXT();
+		const uint16_t addrHGR = getVideoScannerAddressHGR();
+		std::swap(*getVideoMainPtrTXT(addrTXT), key.bytes.aTextMain[i]);
+		std::swap(*getVideoAuxPtrTXT(addrTXT),  key.bytes.aTextAux[i]);
+		std::swap(*getVideoMainPtrHGR(addrHGR), key.bytes.aHiresMain[i]);
+		std::swap(*getVideoAuxPtrHGR(addrHGR),  key.bytes.aHiresAux[i]);
+	}
+	g_nVideoClockHorz = horz;
+}
+
+static void invalidateVideoLine(uint16_t vert)
+{
+	g_aVideoLines[vert].bValid = false;
+	g_aVideoLines[vert].uContentSerial = ++g_uVideoLineContentSerial;
+}
+
+static void invalidateVideoLines(void)
+{
+	for (UINT i = 0; i < VIDEO_SCANNER_Y_DISPLAY; i++)
+		invalidateVideoLine(i);
+}
+
+// Has the CPU written to any of the current scanline's pages since the scanline started?
+// NB. Not on the render thread: the scanline's bytes were recorded before it was rendered (and one split across chunks isn't cached - see renderVideoChunk())
+static bool isVideoLineMemDirty(void)
+{
+	if (g_pVideoFetch)
+		return false;
+
+	return ((memdirty[g_aVideoLinePages[0]] | memdirty[g_aVideoLinePages[1]] | memdirty[g_aVideoLinePages[2]] | memdirty[g_aVideoLinePages[3]]) & MEMDIRTY_VIDEO) != 0;
+}
+
+// Pre: g_nVideoClockHorz == 0 && g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY
+static void beginVideoLine(void)
+{
+	g_nVideoLineVert = g_nVideoClockVert;
+	getVideoLineKey(g_videoLineKey);
+
+	if (!g_pVideoFetch)
+	{
+		for (UINT i = 0; i < 4; i++)
+			memdirty[g_aVideoLinePages[i]] &= ~MEMDIRTY_VIDEO;
+	}
+
+	const VideoLine_t& line = g_aVideoLines[g_nVideoLineVert];
+	const UINT uPrevLineContentSerial = g_nVideoLineVert ? g_aVideoLines[g_nVideoLineVert-1].uContentSerial : 0;
+
+	if (line.bValid && line.uPrevLineContentSerial == uPrevLineContentSerial && memcmp(&line.key, &g_videoLineKey, sizeof(VideoLineKey_t)) == 0)
+		g_videoLineState = VLS_SKIP;
+	else
+		g_videoLineState = VLS_RENDER;
+}
+
+// Post: g_nVideoClockHorz == 0 (and next scanline)
+static void endVideoLine(void)
+{
+	VideoLine_t& line = g_aVideoLines[g_nVideoLineVert];
+
+	if (g_videoLineState == VLS_SKIP)
+	{
+		g_nColorBurstPixels = line.nColorBurstPixelsEnd;
+		g_nVideoClockHorz = VIDEO_SCANNER_MAX_HORZ-1;
+		updateVideoScannerHorzEOLSimple();
+		g_uVideoLinesSkipped++;
+	}
+	else if (g_videoLineState == VLS_RENDER && !isVideoLineMemDirty())
+	{
+		if (!line.bValid || memcmp(&line.key, &g_videoLineKey, sizeof(VideoLineKey_t)) != 0)
+			line.uContentSerial = ++g_uVideoLineContentSerial;
+		line.key = g_videoLineKey;
+		line.bValid = true;
+		line.nColorBurstPixelsEnd = g_nColorBurstPixels;
+		line.uPrevLineContentSerial = g_nVideoLineVert ? g_aVideoLines[g_nVideoLineVert-1].uContentSerial : 0;
+		g_uVideoLinesRendered++;
+	}
+	else
+	{
+		invalidateVideoLine(g_nVideoLineVert);
+		g_uVideoLinesRendered++;
+	}
+
+	g_videoLineState = VLS_NONE;
+}
+
+// Something that the current scanline is rendered from is about to change mid-scanline:
+// . if skipping, then render what's been skipped so far (from the bytes as they were), and render the rest as usual
+static void disturbVideoLine(void)
+{
+	if (g_videoLineState == VLS_SKIP)
+	{
+		const uint16_t horz = g_nVideoClockHorz;
+		VideoLineKey_t key = g_videoLineKey;
+		swapVideoLineBytes(key);
+		g_nVideoClockHorz = 0;
+		g_pFuncUpdateGraphicsScreen(horz);	// NB. horz < VIDEO_SCANNER_MAX_HORZ, so doesn't reach the end of the scanline
+		swapVideoLineBytes(key);
+		g_videoLineState = VLS_RENDER_UNTRACKED;
+	}
+	else if (g_videoLineState == VLS_RENDER)
+	{
+		g_videoLineState = VLS_RENDER_UNTRACKED;
+	}
+}
+
+// The video scanner is being moved (or the framebuffer redrawn from the start of the scanline)
+static void cancelVideoLine(void)
+{
+	if (g_videoLineState == VLS_RENDER || g_videoLineState == VLS_RENDER_UNTRACKED)
+		invalidateVideoLine(g_nVideoLineVert);	// partially rendered
+	g_videoLineState = VLS_NONE;
+}
+
+// Drop-in for g_pFuncUpdateGraphicsScreen(), but skipping visible scanlines that are unchanged since they were last rendered
+static void updateScreen(int cycles)
+{
+	if (!g_bVideoLineCache)
+	{
+		g_pFuncUpdateGraphicsScreen(cycles);
+		return;
+	}
+
+	while (cycles > 0)
+	{
+		const int cyclesToEndOfLine = VIDEO_SCANNER_MAX_HORZ - g_nVideoClockHorz;
+		const int cyclesThisLine = cycles < cyclesToEndOfLine ? cycles : cyclesToEndOfLine;
+
+		if (g_nVideoClockVert >= VIDEO_SCANNER_Y_DISPLAY)
+		{
+			// Not visible: up to the start of the next video frame
+			const int cyclesToLine0 = VIDEO_SCANNER_MAX_HORZ * (g_videoScannerMaxVert - g_nVideoClockVert - 1) + cyclesToEndOfLine;
+			const int cyclesNotVisible = cycles < cyclesToLine0 ? cycles : cyclesToLine0;
+			g_pFuncUpdateGraphicsScreen(cyclesNotVisible);
+			cycles -= cyclesNotVisible;
+			continue;
+		}
+
+		if (g_nVideoClockHorz == 0 && g_videoLineState == VLS_NONE && isVideoLineCacheable())
+			beginVideoLine();
+
+		if (g_videoLineState == VLS_NONE)
+		{
+			// Mid-scanline, or not cacheable
+			invalidateVideoLine(g_nVideoClockVert);
+			g_pFuncUpdateGraphicsScreen(cyclesThisLine);
+		}
+		else
+		{
+			if (g_videoLineState != VLS_RENDER_UNTRACKED && isVideoLineMemDirty())
+				disturbVideoLine();
+
+			if (g_videoLineState == VLS_SKIP)
+			{
+				if (cyclesThisLine < cyclesToEndOfLine)
+					g_nVideoClockHorz += cyclesThisLine;
+				else
+					endVideoLine();
+			}
+			else
+			{
+				g_pFuncUpdateGraphicsScreen(cyclesThisLine);
+				if (cyclesThisLine == cyclesToEndOfLine)
+					endVideoLine();
+			}
+		}
+
+		cycles -= cyclesThisLine;
+	}
+}
+
 // Pre: cyclesLeftToUpdate = [0...g_videoScanner6502Cycles]
 // .  2-14: After one emulated 6502/65C02 opcode (optionally with IRQ)
 // . ~1000: After 1ms of Z80 emulation
@@ -2237,12 +2897,12 @@ static void VideoUpdateCycles( int cyclesLeftToUpdate )
 	{
 		const int cyclesToLine160 = VIDEO_SCANNER_MAX_HORZ * (VIDEO_SCANNER_Y_MIXED - g_nVideoClockVert - 1) + cyclesToEndOfLine;
 		int cycles = cyclesLeftToUpdate < cyclesToLine160 ? cyclesLeftToUpdate : cyclesToLine160;
-		g_pFuncUpdateGraphicsScreen(cycles);						// lines [currV...159]
+		updateScreen(cycles);						// lines [currV...159]
 		cyclesLeftToUpdate -= cycles;
 
 		const int cyclesFromLine160ToLine261 = g_videoScanner6502Cycles - (VIDEO_SCANNER_MAX_HORZ * VIDEO_SCANNER_Y_MIXED);
 		cycles = cyclesLeftToUpdate < cyclesFromLine160ToLine261 ? cyclesLeftToUpdate : cyclesFromLine160ToLine261;
-		g_pFuncUpdateGraphicsScreen(cycles);						// lines [160..191..261]
+		updateScreen(cycles);						// lines [160..191..261]
 		cyclesLeftToUpdate -= cycles;
 
 		// Any remaining cyclesLeftToUpdate: lines [0...currV)
@@ -2251,19 +2911,296 @@ static void VideoUpdateCycles( int cyclesLeftToUpdate )
 	{
 		const int cyclesToLine262 = VIDEO_SCANNER_MAX_HORZ * (g_videoScannerMaxVert - g_nVideoClockVert - 1) + cyclesToEndOfLine;
 		int cycles = cyclesLeftToUpdate < cyclesToLine262 ? cyclesLeftToUpdate : cyclesToLine262;
-		g_pFuncUpdateGraphicsScreen(cycles);						// lines [currV...261]
+		updateScreen(cycles);						// lines [currV...261]
 		cyclesLeftToUpdate -= cycles;
 
 		const int cyclesFromLine0ToLine159 = VIDEO_SCANNER_MAX_HORZ * VIDEO_SCANNER_Y_MIXED;
 		cycles = cyclesLeftToUpdate < cyclesFromLine0ToLine159 ? cyclesLeftToUpdate : cyclesFromLine0ToLine159;
-		g_pFuncUpdateGraphicsScreen(cycles);					// lines [0..159]
+		updateScreen(cycles);					// lines [0..159]
 		cyclesLeftToUpdate -= cycles;
 
 		// Any remaining cyclesLeftToUpdate: lines [160...currV)
 	}
 
 	if (cyclesLeftToUpdate)
-		g_pFuncUpdateGraphicsScreen(cyclesLeftToUpdate);
+		updateScreen(cyclesLeftToUpdate);
+}
+
+//===========================================================================
+
+// Render thread
+
+static bool isVideoRecording(void)
+{
+	// NB. During full-speed, only the captured video frames are recorded (see NTSC_VideoCaptureAtFullSpeed())
+	return !g_bFullSpeed || g_uVideoCaptureCycles;
+}
+
+static void clearVideoRenderChunk(VideoRenderChunk_t& chunk)
+{
+	chunk.cmds.clear();
+	chunk.uCycles = 0;
+}
+
+static void submitVideoRenderChunk(void)
+{
+	if (g_aVideoRenderChunks[g_uVideoRenderHead].cmds.empty())
+		return;
+
+	g_uVideoRenderHead = (g_uVideoRenderHead + 1) % VIDEO_RENDER_NUM_CHUNKS;
+	InterlockedIncrement(&g_nVideoRenderQueued);
+	SetEvent(g_hVideoRenderWork);
+
+	// Wait for the render thread to finish with the next chunk
+	while (g_nVideoRenderQueued == VIDEO_RENDER_NUM_CHUNKS)
+		WaitForSingleObject(g_hVideoRenderDone, INFINITE);
+
+	clearVideoRenderChunk(g_aVideoRenderChunks[g_uVideoRenderHead]);
+}
+
+static void appendVideoCmd(VideoRenderCmd_e cmd, uint32_t arg0, uint32_t arg1=0)
+{
+	std::vector<VideoRenderCmd_t>& cmds = g_aVideoRenderChunks[g_uVideoRenderHead].cmds;
+
+	if (!cmds.empty() && cmds.back().cmd == cmd && (cmd == VRC_UPDATE || cmd == VRC_RESYNC))
+	{
+		if (cmd == VRC_UPDATE)
+		{
+			cmds.back().arg0 += arg0;
+		}
+		else
+		{
+			cmds.back().arg0 = arg0;
+			cmds.back().arg1 = arg1;
+		}
+		return;
+	}
+
+	const VideoRenderCmd_t renderCmd = { cmd, arg0, arg1 };
+	cmds.push_back(renderCmd);
+}
+
+// Re-record the scanner's state, after changes to it weren't recorded
+static void syncVideoRecord(void)
+{
+	if (!g_bVideoScannerStale)
+		return;
+
+	g_bVideoScannerStale = false;
+
+	if (g_aVideoRenderChunks[g_uVideoRenderHead].uCycles)
+		submitVideoRenderChunk();
+
+	appendVideoCmd(VRC_RESYNC, g_nVideoScannerVert, g_nVideoScannerHorz);
+	appendVideoCmd(VRC_MODE, g_uVideoScannerModeFlags, GetVideo().VideoGetSWAltCharSet() ? 1 : 0);
+	appendVideoCmd(VRC_TEXTMODE, g_nVideoScannerTextCols);
+}
+
+static void recordVideoCmd(VideoRenderCmd_e cmd, uint32_t arg0, uint32_t arg1/*=0*/)
+{
+	if (!isVideoRecording())
+	{
+		g_bVideoScannerStale = true;
+		return;
+	}
+
+	if (g_bVideoScannerStale)
+	{
+		syncVideoRecord();	// NB. the scanner's state already includes this cmd
+		return;
+	}
+
+	// A resync can go back to scanlines whose bytes have already been fetched for this chunk
+	if (cmd == VRC_RESYNC && g_aVideoRenderChunks[g_uVideoRenderHead].uCycles)
+		submitVideoRenderChunk();
+
+	appendVideoCmd(cmd, arg0, arg1);
+}
+
+static void advanceVideoScannerClock(int cycles)
+{
+	const UINT cycle = (g_nVideoScannerVert * VIDEO_SCANNER_MAX_HORZ + g_nVideoScannerHorz + cycles) % g_videoScanner6502Cycles;
+	g_nVideoScannerVert = (uint16_t)(cycle / VIDEO_SCANNER_MAX_HORZ);
+	g_nVideoScannerHorz = (uint16_t)(cycle % VIDEO_SCANNER_MAX_HORZ);
+}
+
+// Record the video cycles, and the bytes that the video scanner fetches during them, for the render thread to replay.
+// NB. The emulated memory will have changed by the time the chunk is rendered, so the renderers read the fetched bytes instead.
+static void recordVideoUpdateCycles(int cyclesLeftToUpdate)
+{
+	if (!isVideoRecording())
+	{
+		advanceVideoScannerClock(cyclesLeftToUpdate);
+		g_bVideoScannerStale = true;
+		return;
+	}
+
+	syncVideoRecord();
+
+	const UINT uCycles = cyclesLeftToUpdate;
+
+	while (cyclesLeftToUpdate)
+	{
+		VideoRenderChunk_t& chunk = g_aVideoRenderChunks[g_uVideoRenderHead];
+		const int cyclesToEndOfLine = VIDEO_SCANNER_MAX_HORZ - g_nVideoScannerHorz;
+		const int cyclesThisLine = cyclesLeftToUpdate < cyclesToEndOfLine ? cyclesLeftToUpdate : cyclesToEndOfLine;
+
+		if (g_nVideoScannerVert < VIDEO_SCANNER_Y_DISPLAY)
+		{
+			VideoLineFetch_t& fetch = chunk.aFetch[g_nVideoScannerVert];
+			const int horzEnd = g_nVideoScannerHorz + cyclesThisLine;
+			for (int horz = MAX(g_nVideoScannerHorz, VIDEO_SCANNER_HORZ_START); horz < horzEnd; horz++)
+			{
+				const uint16_t addrTXT = getVideoScannerAddressTXT(g_nVideoScannerVert, horz, g_nVideoScannerPage);
+				const uint16_t addrHGR = getVideoScannerAddressHGR(g_nVideoScannerVert, horz, g_nVideoScannerPage);
+				const int x = horz - VIDEO_SCANNER_HORZ_START;
+				fetch.aTextMain[x]  = *MemGetMainPtr(addrTXT);
+				fetch.aTextAux[x]   = *MemGetAuxPtr(addrTXT);
+				fetch.aHiresMain[x] = *MemGetMainPtr(addrHGR);
+				fetch.aHiresAux[x]  = *MemGetAuxPtr(addrHGR);
+			}
+		}
+
+		appendVideoCmd(VRC_UPDATE, cyclesThisLine);
+		chunk.uCycles += cyclesThisLine;
+		cyclesLeftToUpdate -= cyclesThisLine;
+
+		g_nVideoScannerHorz += cyclesThisLine;
+		if (g_nVideoScannerHorz == VIDEO_SCANNER_MAX_HORZ)
+		{
+			g_nVideoScannerHorz = 0;
+			if (++g_nVideoScannerVert == g_videoScannerMaxVert)
+				g_nVideoScannerVert = 0;
+
+			if (g_nVideoScannerVert == 0 || chunk.uCycles >= kVideoRenderChunkCycles)
+				submitVideoRenderChunk();
+		}
+	}
+
+	if (g_uVideoCaptureCycles)
+	{
+		g_uVideoCaptureCycles = (uCycles < g_uVideoCaptureCycles) ? g_uVideoCaptureCycles - uCycles : 0;
+		if (!g_uVideoCaptureCycles)
+			submitVideoRenderChunk();	// Captured a whole video frame
+	}
+}
+
+static void renderVideoChunk(VideoRenderChunk_t& chunk)
+{
+	g_pVideoFetch = chunk.aFetch;
+
+	for (size_t i = 0; i < chunk.cmds.size(); i++)
+	{
+		const VideoRenderCmd_t& cmd = chunk.cmds[i];
+		switch (cmd.cmd)
+		{
+		case VRC_UPDATE:	VideoUpdateCycles(cmd.arg0); break;
+		case VRC_MODE:		setVideoMode(cmd.arg0, cmd.arg1); break;
+		case VRC_TEXTMODE:	setVideoTextMode(cmd.arg0); break;
+		case VRC_RESYNC:	videoClockResync(cmd.arg0, cmd.arg1); break;
+		}
+	}
+
+	// A scanline that continues into the next chunk can't be cached, as the rest of its bytes are fetched into that chunk
+	disturbVideoLine();
+
+	g_pVideoFetch = NULL;
+}
+
+static DWORD WINAPI VideoRenderThread(LPVOID lpParameter)
+{
+	while (true)
+	{
+		WaitForSingleObject(g_hVideoRenderWork, INFINITE);
+
+		while (g_nVideoRenderQueued)
+		{
+			renderVideoChunk(g_aVideoRenderChunks[g_uVideoRenderTail]);
+			g_uVideoRenderTail = (g_uVideoRenderTail + 1) % VIDEO_RENDER_NUM_CHUNKS;
+			InterlockedDecrement(&g_nVideoRenderQueued);
+			SetEvent(g_hVideoRenderDone);
+		}
+
+		if (g_bVideoRenderExit)
+			break;
+	}
+
+	return 0;
+}
+
+static void flushVideoRender(void)
+{
+	if (!g_hVideoRenderThread)
+		return;
+
+	syncVideoRecord();
+	submitVideoRenderChunk();
+
+	while (g_nVideoRenderQueued)
+		WaitForSingleObject(g_hVideoRenderDone, INFINITE);
+}
+
+static void syncVideoScannerClock(void)
+{
+	g_nVideoScannerVert = g_nVideoClockVert;
+	g_nVideoScannerHorz = g_nVideoClockHorz;
+}
+
+static void startVideoRenderThread(void)
+{
+	syncVideoScannerClock();
+	g_nVideoScannerPage = g_nTextPage;
+	g_uVideoScannerModeFlags = GetVideo().GetVideoMode();
+	g_nVideoScannerTextCols = (g_pFuncUpdateTextScreen == updateScreenText80) ? 80 : 40;
+	g_bVideoScannerStale = false;
+	g_uVideoCaptureCycles = 0;
+
+	g_uVideoRenderHead = g_uVideoRenderTail = 0;
+	g_nVideoRenderQueued = 0;
+	for (UINT i = 0; i < VIDEO_RENDER_NUM_CHUNKS; i++)
+		clearVideoRenderChunk(g_aVideoRenderChunks[i]);
+
+	g_bVideoRenderExit = false;
+	g_hVideoRenderWork = CreateEvent(NULL, FALSE, FALSE, NULL);	// auto-reset
+	g_hVideoRenderDone = CreateEvent(NULL, FALSE, FALSE, NULL);	// auto-reset
+
+	DWORD dwThreadId;
+	g_hVideoRenderThread = CreateThread(NULL,			// lpThreadAttributes
+										0,				// dwStackSize
+										VideoRenderThread,
+										NULL,			// lpParameter
+										0,				// dwCreationFlags : 0 = Run immediately
+										&dwThreadId);	// lpThreadId
+	_ASSERT(g_hVideoRenderThread);
+}
+
+static void stopVideoRenderThread(void)
+{
+	if (!g_hVideoRenderThread)
+		return;
+
+	flushVideoRender();
+
+	g_bVideoRenderExit = true;
+	SetEvent(g_hVideoRenderWork);
+	WaitForSingleObject(g_hVideoRenderThread, INFINITE);
+
+	CloseHandle(g_hVideoRenderThread);
+	CloseHandle(g_hVideoRenderWork);
+	CloseHandle(g_hVideoRenderDone);
+	g_hVideoRenderThread = g_hVideoRenderWork = g_hVideoRenderDone = NULL;
+}
+
+// The RGB & Simplified renderers read the emulated memory via RGB.cpp (and depend on the RGB card's state), so they always render inline
+static void updateVideoRenderThread(void)
+{
+	const VideoType_e type = GetVideo().GetVideoType();
+	const bool bRun = g_bVideoRenderThread && g_kFrameBufferWidth && type != VT_COLOR_IDEALIZED && type != VT_COLOR_VIDEOCARD_RGB;
+
+	if (bRun && !g_hVideoRenderThread)
+		startVideoRenderThread();
+	else if (!bRun && g_hVideoRenderThread)
+		stopVideoRenderThread();
 }
 
 //===========================================================================
@@ -2276,9 +3213,11 @@ void NTSC_VideoUpdateCycles( UINT cycles6502 )
 
 	_ASSERT(cycles6502 && cycles6502 < g_videoScanner6502Cycles);	// Use NTSC_VideoRedrawWholeScreen() instead
 
+	void (*pFuncUpdateCycles)(int) = g_hVideoRenderThread ? recordVideoUpdateCycles : VideoUpdateCycles;
+
 	if (g_bDelayVideoMode)
 	{
-		VideoUpdateCycles(1);	// Video mode change is delayed by 1 cycle
+		pFuncUpdateCycles(1);	// Video mode change is delayed by 1 cycle
 
 		g_bDelayVideoMode = false;
 		NTSC_SetVideoMode(g_uNewVideoModeFlags);
@@ -2288,12 +3227,14 @@ void NTSC_VideoUpdateCycles( UINT cycles6502 )
 			return;
 	}
 
-	VideoUpdateCycles(cycles6502);
+	pFuncUpdateCycles(cycles6502);
 }
 
 //===========================================================================
 void NTSC_VideoRedrawWholeScreen( void )
 {
+	flushVideoRender();	// Then redraw inline: the render thread is idle
+
 #ifdef _DEBUG
 	const uint16_t currVideoClockVert = g_nVideoClockVert;
 	const uint16_t currVideoClockHorz = g_nVideoClockHorz;
@@ -2303,6 +3244,7 @@ void NTSC_VideoRedrawWholeScreen( void )
 	// . The V/H pos will have been recalc'ed, so won't be continuous from previous (whole screen) update
 	// . So the redraw must start at H-pos=0 & with the usual reinit for the start of a new line
 	const uint16_t horz = g_nVideoClockHorz;
+	cancelVideoLine();
 	g_nVideoClockHorz = 0;
 	updateVideoScannerAddress();
 
@@ -2485,6 +3427,11 @@ static void GenerateBaseColors(baseColors_t pBaseNtscColors)
 
 void NTSC_SetRefreshRate(VideoRefreshRate_e rate)
 {
+	flushVideoRender();
+
+	cancelVideoLine();
+	invalidateVideoLines();
+
 	if (rate == VR_50HZ)
 	{
 		g_videoScannerMaxVert = VIDEO_SCANNER_MAX_VERT_PAL;
@@ -2497,6 +3444,8 @@ void NTSC_SetRefreshRate(VideoRefreshRate_e rate)
 	}
 
 	GenerateVideoTables();
+
+	syncVideoScannerClock();
 }
 
 UINT NTSC_GetCyclesPerFrame(void)
@@ -2521,11 +3470,11 @@ UINT NTSC_GetCyclesUntilVBlank(int cycles)
 {
 	const UINT cyclesPerFrames = NTSC_GetCyclesPerFrame();
 
-	if (g_bFullSpeed)
+	if (NTSC_IsVideoClockStale())
 		return cyclesPerFrames;	// g_nVideoClockVert/Horz not correct & accuracy isn't important: so just wait a frame's worth of cycles
 
 	const UINT cycleVBl = VIDEO_SCANNER_Y_DISPLAY * VIDEO_SCANNER_MAX_HORZ;
-	const UINT cycleCurrentPos = (g_nVideoClockVert * VIDEO_SCANNER_MAX_HORZ + g_nVideoClockHorz + cycles) % cyclesPerFrames;
+	const UINT cycleCurrentPos = (NTSC_GetVideoClockVert() * VIDEO_SCANNER_MAX_HORZ + NTSC_GetVideoClockHorz() + cycles) % cyclesPerFrames;
 
 	return (cycleCurrentPos < cycleVBl) ?
 		(cycleVBl - cycleCurrentPos) :
@@ -2534,5 +3483,80 @@ UINT NTSC_GetCyclesUntilVBlank(int cycles)
 
 bool NTSC_IsVisible(void)
 {
-	return (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY) && (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START);
+	return (NTSC_GetVideoClockVert() < VIDEO_SCANNER_Y_DISPLAY) && (NTSC_GetVideoClockHorz() >= VIDEO_SCANNER_HORZ_START);
+}
+
+//===========================================================================
+
+// Dirty-scanline tracking (default: enabled)
+void NTSC_SetVideoLineCache(bool enable)
+{
+	flushVideoRender();
+
+	cancelVideoLine();
+	invalidateVideoLines();
+	g_bVideoLineCache = enable;
+}
+
+void NTSC_GetVideoLineCacheStats(UINT64& linesSkipped, UINT64& linesRendered)
+{
+	linesSkipped = g_uVideoLinesSkipped;
+	linesRendered = g_uVideoLinesRendered;
+}
+
+//===========================================================================
+
+// Render thread (default: disabled)
+void NTSC_SetVideoRenderThread(bool enable)
+{
+	g_bVideoRenderThread = enable;
+	updateVideoRenderThread();
+}
+
+bool NTSC_IsVideoRenderThread(void)
+{
+	return g_hVideoRenderThread != NULL;
+}
+
+// Wait until everything recorded so far has been rendered to the framebuffer
+void NTSC_VideoWaitForRender(void)
+{
+	flushVideoRender();
+}
+
+// During full-speed, record a whole video frame at a time for the render thread (instead of redrawing the whole screen from the current memory)
+// . Returns true while capturing, ie. NTSC_VideoUpdateCycles() needs calling
+bool NTSC_VideoCaptureAtFullSpeed(DWORD dwCyclesThisFrame)
+{
+	if (!g_hVideoRenderThread)
+		return false;
+
+	if (g_uVideoCaptureCycles)
+		return true;
+
+	const DWORD dwTime = GetTickCount();
+	if (g_nVideoRenderQueued || dwTime - g_dwVideoCaptureTime <= 16)	// Only capture every realtime ~17ms, and when the render thread has caught up
+		return false;
+
+	g_dwVideoCaptureTime = dwTime;
+	NTSC_VideoClockResync(dwCyclesThisFrame);
+	g_uVideoCaptureCycles = g_videoScanner6502Cycles;
+	return true;
+}
+
+// During full-speed the video clock isn't updated (except when capturing a video frame), so it needs resync'ing before use
+bool NTSC_IsVideoClockStale(void)
+{
+	return g_bFullSpeed && !g_uVideoCaptureCycles;
+}
+
+// The emulation thread's video clock: the renderer's clock lags behind it when the render thread is running
+uint16_t NTSC_GetVideoClockVert(void)
+{
+	return g_hVideoRenderThread ? g_nVideoScannerVert : g_nVideoClockVert;
+}
+
+uint16_t NTSC_GetVideoClockHorz(void)
+{
+	return g_hVideoRenderThread ? g_nVideoScannerHorz : g_nVideoClockHorz;
 }
@@ -3,8 +3,6 @@
 #include "Video.h"	// NB. needed by GCC (for fwd enum declaration)
 
 // Globals (Public)
-extern uint16_t g_nVideoClockVert;
-extern uint16_t g_nVideoClockHorz;
 extern uint32_t g_nChromaSize;
 
 // Prototypes (Public) ________________________________________________
@@ -29,3 +27,12 @@ UINT NTSC_GetCyclesPerLine(void);
 UINT NTSC_GetVideoLines(void);
 UINT NTSC_GetCyclesUntilVBlank(int cycles);
 bool NTSC_IsVisible(void);
+void NTSC_SetVideoLineCache(bool enable);
+void NTSC_GetVideoLineCacheStats(UINT64& linesSkipped, UINT64& linesRendered);
+void NTSC_SetVideoRenderThread(bool enable);
+bool NTSC_IsVideoRenderThread(void);
+void NTSC_VideoWaitForRender(void);
+bool NTSC_VideoCaptureAtFullSpeed(DWORD dwCyclesThisFrame);
+bool NTSC_IsVideoClockStale(void);
+uint16_t NTSC_GetVideoClockVert(void);
+uint16_t NTSC_GetVideoClockHorz(void);
@@ -117,5 +117,8 @@ void Clock_Util_ConvertTimeToProdos( tm *pTime, unsigned char *pProDosBytes4_ )
 void Clock_Generic_UpdateProDos()
 {
 	tm* pTime = Clock_Util_GetTime();
-	Clock_Util_ConvertTimeToProdos( pTime, &mem[ 0xBF90 ] ); // ProDos date/time buffer
+	BYTE aProDosTime[4];
+	MemReadBlock( aProDosTime, 0xBF90, sizeof(aProDosTime) ); // ProDos date/time buffer
+	Clock_Util_ConvertTimeToProdos( pTime, aProDosTime );
+	MemWriteBlock( 0xBF90, aProDosTime, sizeof(aProDosTime) );
 }
@@ -0,0 +1,323 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Rewind buffer of in-memory snapshots
+ *
+ * Unlike a save-state, nothing is written to disk or parsed: every N video frames the machine state is
+ * copied into a ring, and restoring a snapshot is a few memcpy()s.
+ *
+ * RAM (main, aux & RamWorks banks, via MemGetBankPtr()) is stored as 256-byte pages:
+ * . a keyframe holds all pages
+ * . the other snapshots only hold the pages that changed since the previous snapshot
+ * So restoring snapshot n applies its keyframe, then each delta up to n.
+ *
+ * The rest of the state is a small blob from each module's XxxSaveRewind(): CPU, soft switches, keyboard,
+ * paddles, speaker, video mode and the Disk II controllers & head positions.
+ * Not rewound: the other slot cards' state (eg. Mockingboard, SSC, mouse), the II/II+ slot-0 language card's RAM,
+ * and data already written to disk images.
+ *
+ * Used by:
+ * . Ctrl+F11: go back to the previous snapshot
+ * . Debugger: BACK (reverse-step): restore the nearest snapshot, then re-execute forward
+ */
+
+#include "StdAfx.h"
+
+#include "Rewind.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Joystick.h"
+#include "Keyboard.h"
+#include "Memory.h"
+#include "Mockingboard.h"
+#include "NTSC.h"
+#include "Speaker.h"
+#include "Debugger/DebugDefs.h"
+
+static const UINT kPageSize = 256;
+static const UINT kPagesPerBank = _6502_MEM_LEN / kPageSize;
+static const UINT kKeyframeInterval = 16;	// Snapshots
+
+static UINT g_uRewindInterval = 30;			// Video frames between snapshots (~0.5s)
+static UINT g_uRewindCapacity = 120;		// Snapshots (~60s)
+
+struct RewindSnapshot
+{
+	UINT64 cycles;
+	bool keyframe;
+	std::vector<BYTE> state;		// Blob from the XxxSaveRewind() functions
+	std::vector<UINT> pages;		// Page index: bank * kPagesPerBank + page
+	std::vector<BYTE> pageData;		// kPageSize bytes per page
+};
+
+static std::vector<RewindSnapshot> g_rewindRing;	// Oldest first. NB. g_rewindRing[0] is always a keyframe
+static std::vector<BYTE> g_rewindShadow;			// RAM at the newest snapshot
+static UINT g_uRewindBanks = 0;
+static UINT g_uRewindFrames = 0;					// Video frames since the last snapshot
+static UINT g_uSinceKeyframe = 0;
+
+//===========================================================================
+
+void Rewind_SetInterval(UINT frames)
+{
+	g_uRewindInterval = frames;
+	Rewind_Reset();
+}
+
+void Rewind_SetCapacity(UINT snapshots)
+{
+	g_uRewindCapacity = snapshots;
+	Rewind_Reset();
+}
+
+void Rewind_Reset(void)
+{
+	g_rewindRing.clear();
+	g_rewindShadow.clear();
+	g_uRewindBanks = 0;
+	g_uRewindFrames = 0;
+	g_uSinceKeyframe = 0;
+}
+
+UINT Rewind_GetCount(void)
+{
+	return g_rewindRing.size();
+}
+
+//===========================================================================
+
+static UINT GetNumBanks(void)
+{
+	UINT uBanks = 0;
+	while (MemGetBankPtr(uBanks))
+		uBanks++;
+	return uBanks;
+}
+
+static void SaveMachineState(std::vector<BYTE>& state)
+{
+	RewindBuffer buffer(state);
+	CpuSaveRewind(buffer);
+	MemSaveRewind(buffer);
+	KeybSaveRewind(buffer);
+	JoySaveRewind(buffer);
+	SpkrSaveRewind(buffer);
+	GetVideo().VideoSaveRewind(buffer);
+	GetCardMgr().GetDisk2CardMgr().SaveRewind(buffer);
+}
+
+// Pre: RAM has been restored
+static void LoadMachineState(std::vector<BYTE>& state)
+{
+	RewindBuffer buffer(state);
+	CpuLoadRewind(buffer);
+	MemLoadRewind(buffer);
+	KeybLoadRewind(buffer);
+	JoyLoadRewind(buffer);
+	SpkrLoadRewind(buffer);
+	GetVideo().VideoLoadRewind(buffer);
+	GetCardMgr().GetDisk2CardMgr().LoadRewind(buffer);
+
+	MB_SetCumulativeCycles();	// Not rewound, so just re-sync with the CPU's cycle count
+}
+
+static void Rewind_Capture(void)
+{
+	const UINT uBanks = GetNumBanks();
+	if (uBanks != g_uRewindBanks)	// eg. RamWorks size changed
+	{
+		Rewind_Reset();
+		g_uRewindBanks = uBanks;
+		g_rewindShadow.resize(uBanks * _6502_MEM_LEN);
+	}
+
+	g_rewindRing.push_back(RewindSnapshot());
+	RewindSnapshot& snapshot = g_rewindRing.back();
+
+	snapshot.cycles = g_nCumulativeCycles;
+	snapshot.keyframe = (g_rewindRing.size() == 1) || (g_uSinceKeyframe >= kKeyframeInterval);
+	if (snapshot.keyframe)
+		g_uSinceKeyframe = 0;
+	g_uSinceKeyframe++;
+
+	for (UINT bank = 0; bank < uBanks; bank++)
+	{
+		const BYTE* pBank = MemGetBankPtr(bank);
+
+		for (UINT page = 0; page < kPagesPerBank; page++)
+		{
+			const UINT uPage = bank * kPagesPerBank + page;
+			const BYTE* pPage = pBank + page * kPageSize;
+			BYTE* pShadow = &g_rewindShadow[uPage * kPageSize];
+
+			if (!snapshot.keyframe && memcmp(pPage, pShadow, kPageSize) == 0)
+				continue;
+
+			memcpy(pShadow, pPage, kPageSize);
+			snapshot.pages.push_back(uPage);
+			snapshot.pageData.insert(snapshot.pageData.end(), pPage, pPage + kPageSize);
+		}
+	}
+
+	SaveMachineState(snapshot.state);
+
+	// Discard the oldest keyframe and its deltas, once there's a newer keyframe to take over
+	if (g_rewindRing.size() > g_uRewindCapacity)
+	{
+		for (UINT i = 1; i < g_rewindRing.size(); i++)
+		{
+			if (g_rewindRing[i].keyframe)
+			{
+				g_rewindRing.erase(g_rewindRing.begin(), g_rewindRing.begin() + i);
+				break;
+			}
+		}
+	}
+}
+
+// Restore snapshot n, and discard the newer snapshots (as the machine is about to take a different path)
+static void Rewind_Restore(const UINT n)
+{
+	_ASSERT(n < g_rewindRing.size());
+
+	UINT key = n;
+	while (!g_rewindRing[key].keyframe)
+		key--;
+
+	for (UINT i = key; i <= n; i++)
+	{
+		const RewindSnapshot& snapshot = g_rewindRing[i];
+		for (UINT p = 0; p < snapshot.pages.size(); p++)
+			memcpy(&g_rewindShadow[snapshot.pages[p] * kPageSize], &snapshot.pageData[p * kPageSize], kPageSize);
+	}
+
+	for (UINT bank = 0; bank < g_uRewindBanks; bank++)
+		memcpy(MemGetBankPtr(bank), &g_rewindShadow[bank * _6502_MEM_LEN], _6502_MEM_LEN);
+
+	CpuBlockCacheFlush();	// RAM was restored without setting memdirty[]
+
+	LoadMachineState(g_rewindRing[n].state);
+
+	g_rewindRing.erase(g_rewindRing.begin() + n + 1, g_rewindRing.end());
+	g_uSinceKeyframe = n - key + 1;
+	g_uRewindFrames = 0;
+}
+
+//===========================================================================
+
+// Called by ContinueExecution() at the end of each video frame
+void Rewind_OnVideoFrame(void)
+{
+	if (!g_uRewindInterval || !g_uRewindCapacity)
+		return;
+
+	if (++g_uRewindFrames < g_uRewindInterval)
+		return;
+
+	g_uRewindFrames = 0;
+
+	if (GetActiveCpu() == CPU_Z80)	// Z80 card's state isn't rewound
+		return;
+
+	Rewind_Capture();
+}
+
+bool Rewind_Back(void)
+{
+	// Skip a snapshot that was only just taken (or just restored), so that repeated presses keep going back
+	const UINT64 uMinAge = (UINT64)g_uRewindInterval * NTSC_GetCyclesPerFrame() / 2;
+
+	for (int i = (int)g_rewindRing.size() - 1; i >= 0; i--)
+	{
+		if (g_rewindRing[i].cycles + uMinAge <= g_nCumulativeCycles)
+		{
+			Rewind_Restore(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Re-execute 1 opcode at a time from the restored snapshot up to uEndCycle, recording the cycles at each opcode boundary
+static void Rewind_ReExecute(const UINT64 uEndCycle, std::vector<UINT64>& boundaries)
+{
+	boundaries.clear();
+	while (g_nCumulativeCycles < uEndCycle)
+	{
+		boundaries.push_back(g_nCumulativeCycles);
+		CoreRunCycles(0);	// 1 opcode
+	}
+}
+
+// Pre: g_nAppMode == MODE_DEBUG
+// . Re-execution is one opcode at a time, so device updates are at a finer granularity than the original (1ms) execution.
+//   Software that depends on devices that aren't rewound (eg. Mockingboard timers) may take a different path.
+// . Each snapshot is only re-executed up to the next (newer) one, so the total re-execution is the history
+//   that's stepped back over, plus one snapshot interval.
+bool Rewind_StepBack(UINT nOpcodes)
+{
+	if (nOpcodes == 0)
+		return true;
+
+	// Find the newest snapshot before now
+	int n = (int)g_rewindRing.size() - 1;
+	while (n >= 0 && g_rewindRing[n].cycles >= g_nCumulativeCycles)
+		n--;
+
+	if (n < 0)
+		return false;
+
+	CpuSetReExecution(true);
+
+	// Walk back a snapshot at a time until the target opcode is within one: [snapshot n, uEndCycle)
+	UINT64 uEndCycle = g_nCumulativeCycles;
+	std::vector<UINT64> boundaries;	// Cycles at each opcode boundary of the current snapshot's interval
+
+	for (; ; n--)
+	{
+		const UINT64 uStartCycle = g_rewindRing[n].cycles;	// NB. Rewind_Restore() discards the newer snapshots
+
+		Rewind_Restore(n);
+		Rewind_ReExecute(uEndCycle, boundaries);
+
+		if (boundaries.size() >= nOpcodes || n == 0)
+			break;
+
+		nOpcodes -= boundaries.size();
+		uEndCycle = uStartCycle;
+	}
+
+	const UINT64 uTarget = (boundaries.size() >= nOpcodes) ? boundaries[boundaries.size() - nOpcodes]
+						 : !boundaries.empty() ? boundaries[0]	// Not enough history: go back as far as possible
+						 : g_rewindRing[n].cycles;
+
+	Rewind_Restore(n);
+	while (g_nCumulativeCycles < uTarget)
+		CoreRunCycles(0);
+
+	CpuSetReExecution(false);
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Rewind (see Rewind.cpp):
+// . a ring of in-memory snapshots, taken every N video frames
+// . RAM is stored as 256-byte pages that changed since the previous snapshot (with a full keyframe every few snapshots)
+// . everything else (CPU, soft switches, devices) is a small binary blob, written/read by each module's XxxSaveRewind()/XxxLoadRewind()
+
+class RewindBuffer
+{
+public:
+	RewindBuffer(std::vector<BYTE>& data) : m_data(data), m_pos(0) {}
+
+	template <class T>
+	void Save(const T& value)
+	{
+		const BYTE* p = (const BYTE*) &value;
+		m_data.insert(m_data.end(), p, p + sizeof(T));
+	}
+
+	template <class T>
+	void Load(T& value)
+	{
+		_ASSERT(m_pos + sizeof(T) <= m_data.size());
+		memcpy(&value, &m_data[m_pos], sizeof(T));
+		m_pos += sizeof(T);
+	}
+
+private:
+	std::vector<BYTE>& m_data;
+	size_t m_pos;
+};
+
+void Rewind_SetInterval(UINT frames);		// 0 = disabled
+void Rewind_SetCapacity(UINT snapshots);
+void Rewind_Reset(void);
+void Rewind_OnVideoFrame(void);				// Pre: at an opcode boundary
+bool Rewind_Back(void);						// Restore the previous snapshot
+bool Rewind_StepBack(UINT nOpcodes);		// Debugger: restore the nearest snapshot, then re-execute to nOpcodes before now
+UINT Rewind_GetCount(void);
@@ -92,6 +92,8 @@ int RiffInitWriteFile(const char* pszFile, unsigned int sample_rate, unsigned in
 	dwDataOffset = SetFilePointer(g_hRiffFile, 0, NULL, FILE_CURRENT);
 	WriteFile(g_hRiffFile, &temp32, 4, &dwNumberOfBytesWritten, NULL);
 
+	g_dwTotalNumberOfBytesWritten = SetFilePointer(g_hRiffFile, 0, NULL, FILE_CURRENT);	// Header size
+
 	return 0;
 }
 
@@ -114,7 +116,9 @@ int RiffFinishWriteFile()
 	SetFilePointer(g_hRiffFile, dwDataOffset, NULL, FILE_BEGIN);
 	WriteFile(g_hRiffFile, &temp32, 4, &dwNumberOfBytesWritten, NULL);
 
-	return CloseHandle(g_hRiffFile);
+	BOOL bRes = CloseHandle(g_hRiffFile);
+	g_hRiffFile = INVALID_HANDLE_VALUE;
+	return bRes;
 }
 
 int RiffPutSamples(const short* buf, unsigned int uSamples)
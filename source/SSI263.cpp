@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "StdAfx.h"
 
+#include "AudioCapture.h"
 #include "Core.h"
 #include "CPU.h"
 #include "Log.h"
@@ -366,7 +367,7 @@ void SSI263::Play(unsigned int nPhoneme)
 
 void SSI263::Stop(void)
 {
-	if (SSI263SingleVoice.lpDSBvoice && SSI263SingleVoice.bActive)
+	if (SSI263SingleVoice.HasBuffer() && SSI263SingleVoice.bActive)
 		DSVoiceStop(&SSI263SingleVoice);
 }
 
@@ -383,6 +384,12 @@ void SSI263::Update(void)
 	if (!SSI263SingleVoice.bActive)
 		return;
 
+	if (AudioCapture_IsActive())	// NB. including at full-speed, so phonemes aren't short-circuited
+	{
+		UpdateForCapture();
+		return;
+	}
+
 	if (g_bFullSpeed)	// ie. only true when IsPhonemeActive() is true
 	{
 		if (m_phonemeLengthRemaining)
@@ -420,7 +427,7 @@ void SSI263::Update(void)
 	//-------------
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	HRESULT hr = SSI263SingleVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	HRESULT hr = DSGetCurrentPosition(&SSI263SingleVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if (FAILED(hr))
 		return;
 
@@ -562,64 +569,14 @@ void SSI263::Update(void)
 
 	//-------------
 
-	bool bSpeechIRQ = false;
-
-	{
-		const BYTE DUR = m_durationPhoneme >> DURATION_SHIFT;
-		const BYTE numSamplesToAvg = (DUR <= 1) ? 1 :
-									 (DUR == 2) ? 2 :
-												  4;
-
-		short* pMixBuffer = &m_mixBufferSSI263[0];
-		int zeroSize = nNumSamples;
-
-		if (m_phonemeLengthRemaining && !prefillBufferOnInit)
-		{
-			UINT samplesWritten = 0;
-			while (samplesWritten < (UINT)nNumSamples)
-			{
-				m_currSampleSum += (int)*m_pPhonemeData;
-				m_currNumSamples++;
-
-				m_pPhonemeData++;
-				m_phonemeLengthRemaining--;
-
-				if (m_currNumSamples == numSamplesToAvg)
-				{
-					*pMixBuffer++ = (short)(m_currSampleSum / numSamplesToAvg);
-					samplesWritten++;
-					m_currSampleSum = 0;
-					m_currNumSamples = 0;
-				}
-
-				m_currSampleMod4 = (m_currSampleMod4 + 1) & 3;
-				if (DUR == 1 && m_currSampleMod4 == 3 && m_phonemeLengthRemaining)
-				{
-					m_pPhonemeData++;
-					m_phonemeLengthRemaining--;
-				}
-
-				if (!m_phonemeLengthRemaining)
-				{
-					bSpeechIRQ = true;
-					break;
-				}
-			}
-
-			zeroSize = nNumSamples - samplesWritten;
-			_ASSERT(zeroSize >= 0);
-		}
-
-		if (zeroSize)
-			memset(pMixBuffer, 0, zeroSize * sizeof(short));
-	}
+	const bool bSpeechIRQ = GenerateSamples(nNumSamples, prefillBufferOnInit);
 
 	//
 
 	DWORD dwDSLockedBufferSize0, dwDSLockedBufferSize1;
 	short *pDSLockedBuffer0, *pDSLockedBuffer1;
 
-	hr = DSGetLock(SSI263SingleVoice.lpDSBvoice,
+	hr = DSGetLock(&SSI263SingleVoice,
 		m_byteOffset, (DWORD)nNumSamples * sizeof(short) * m_kNumChannels,
 		&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 		&pDSLockedBuffer1, &dwDSLockedBufferSize1);
@@ -631,8 +588,8 @@ void SSI263::Update(void)
 		memcpy(pDSLockedBuffer1, &m_mixBufferSSI263[dwDSLockedBufferSize0/sizeof(short)], dwDSLockedBufferSize1);
 
 	// Commit sound buffer
-	hr = SSI263SingleVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-											  (void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+	hr = DSUnlock(&SSI263SingleVoice, pDSLockedBuffer0, dwDSLockedBufferSize0,
+											  pDSLockedBuffer1, dwDSLockedBufferSize1);
 	if (FAILED(hr))
 		return;
 
@@ -651,6 +608,96 @@ void SSI263::Update(void)
 
 //-----------------------------------------------------------------------------
 
+// Generate nNumSamples of the active phoneme (or silence) into m_mixBufferSSI263
+// . returns true if the phoneme completed
+bool SSI263::GenerateSamples(const int nNumSamples, const bool prefill)
+{
+	bool bSpeechIRQ = false;
+
+	const BYTE DUR = m_durationPhoneme >> DURATION_SHIFT;
+	const BYTE numSamplesToAvg = (DUR <= 1) ? 1 :
+								 (DUR == 2) ? 2 :
+											  4;
+
+	short* pMixBuffer = &m_mixBufferSSI263[0];
+	int zeroSize = nNumSamples;
+
+	if (m_phonemeLengthRemaining && !prefill)
+	{
+		UINT samplesWritten = 0;
+		while (samplesWritten < (UINT)nNumSamples)
+		{
+			m_currSampleSum += (int)*m_pPhonemeData;
+			m_currNumSamples++;
+
+			m_pPhonemeData++;
+			m_phonemeLengthRemaining--;
+
+			if (m_currNumSamples == numSamplesToAvg)
+			{
+				*pMixBuffer++ = (short)(m_currSampleSum / numSamplesToAvg);
+				samplesWritten++;
+				m_currSampleSum = 0;
+				m_currNumSamples = 0;
+			}
+
+			m_currSampleMod4 = (m_currSampleMod4 + 1) & 3;
+			if (DUR == 1 && m_currSampleMod4 == 3 && m_phonemeLengthRemaining)
+			{
+				m_pPhonemeData++;
+				m_phonemeLengthRemaining--;
+			}
+
+			if (!m_phonemeLengthRemaining)
+			{
+				bSpeechIRQ = true;
+				break;
+			}
+		}
+
+		zeroSize = nNumSamples - samplesWritten;
+		_ASSERT(zeroSize >= 0);
+	}
+
+	if (zeroSize)
+		memset(pMixBuffer, 0, zeroSize * sizeof(short));
+
+	return bSpeechIRQ;
+}
+
+// Whilst capturing audio: samples are generated from emulated time only (ie. no ring-buffer
+// drift-correction), and only submitted to the capture (not played).
+void SSI263::UpdateForCapture(void)
+{
+	const UINT64 uCycle = MB_GetLastCumulativeCycles();
+	if (m_lastUpdateCycle == 0 || uCycle < m_lastUpdateCycle)
+	{
+		m_lastUpdateCycle = uCycle;
+		m_captureSampleRemainder = 0.0;
+		return;
+	}
+
+	const double kMinimumUpdateInterval = 500.0;	// Same as Update()
+	if ((double)(uCycle - m_lastUpdateCycle) < kMinimumUpdateInterval)
+		return;
+
+	const double fNumSamples = (double)(uCycle - m_lastUpdateCycle) * SAMPLE_RATE_SSI263 / g_fCurrentCLK6502 + m_captureSampleRemainder;
+	int nNumSamples = (int)fNumSamples;
+	m_captureSampleRemainder = fNumSamples - (double)nNumSamples;
+	m_lastUpdateCycle = uCycle;
+
+	if (nNumSamples > m_kDSBufferByteSize / sizeof(short))
+		nNumSamples = m_kDSBufferByteSize / sizeof(short);	// Clamp to prevent buffer overflow
+
+	const bool bSpeechIRQ = GenerateSamples(nNumSamples, false);
+	AudioCapture_Submit(AUDIOCAPTURE_SSI263 + m_device, &m_mixBufferSSI263[0], nNumSamples, m_kNumChannels, SAMPLE_RATE_SSI263);
+
+	if (bSpeechIRQ && !m_phonemePlaybackAndDebugger)
+		UpdateIRQ();
+}
+
+//-----------------------------------------------------------------------------
+
 // The primary way for phonemes to generate IRQ is via the ring-buffer in Update(),
 // but when single-stepping (eg. timing-sensitive SSI263 detection code), then this secondary method is used.
 void SSI263::UpdateAccurateLength(void)
@@ -774,7 +821,7 @@ bool SSI263::DSInit(void)
 	if (!SSI263SingleVoice.nVolume)
 		SSI263SingleVoice.nVolume = DSBVOLUME_MAX;
 
-	hr = SSI263SingleVoice.lpDSBvoice->SetVolume(SSI263SingleVoice.nVolume);
+	hr = DSSetVolume(&SSI263SingleVoice, SSI263SingleVoice.nVolume);
 	LogFileOutput("SSI263::DSInit: SetVolume(), hr=0x%08X\n", hr);
 
 	return true;
@@ -801,7 +848,7 @@ void SSI263::Mute(void)
 {
 	if (SSI263SingleVoice.bActive && !SSI263SingleVoice.bMute)
 	{
-		SSI263SingleVoice.lpDSBvoice->SetVolume(DSBVOLUME_MIN);
+		DSSetVolume(&SSI263SingleVoice, DSBVOLUME_MIN);
 		SSI263SingleVoice.bMute = true;
 	}
 }
@@ -810,7 +857,7 @@ void SSI263::Unmute(void)
 {
 	if (SSI263SingleVoice.bActive && SSI263SingleVoice.bMute)
 	{
-		SSI263SingleVoice.lpDSBvoice->SetVolume(SSI263SingleVoice.nVolume);
+		DSSetVolume(&SSI263SingleVoice, SSI263SingleVoice.nVolume);
 		SSI263SingleVoice.bMute = false;
 	}
 }
@@ -822,7 +869,7 @@ void SSI263::SetVolume(DWORD dwVolume, DWORD dwVolumeMax)
 	SSI263SingleVoice.nVolume = NewVolume(dwVolume, dwVolumeMax);
 
 	if (SSI263SingleVoice.bActive && !SSI263SingleVoice.bMute)
-		SSI263SingleVoice.lpDSBvoice->SetVolume(SSI263SingleVoice.nVolume);
+		DSSetVolume(&SSI263SingleVoice, SSI263SingleVoice.nVolume);
 }
 
 //-----------------------------------------------------------------------------
@@ -38,6 +38,7 @@ public:
 		//
 
 		m_numSamplesError = 0;
+		m_captureSampleRemainder = 0.0;
 		m_byteOffset = (DWORD)-1;
 		m_currSampleSum = 0;
 		m_currNumSamples = 0;
@@ -91,6 +92,8 @@ private:
 	void Stop(void);
 	void UpdateIRQ(void);
 	void UpdateAccurateLength(void);
+	bool GenerateSamples(const int nNumSamples, const bool prefill);
+	void UpdateForCapture(void);
 
 	static const BYTE m_Votrax2SSI263[/*64*/];
 
@@ -123,6 +126,7 @@ private:
 	//
 
 	int m_numSamplesError;
+	double m_captureSampleRemainder;	// fraction of a sample (when capturing audio)
 	DWORD m_byteOffset;
 	int m_currSampleSum;
 	int m_currNumSamples;
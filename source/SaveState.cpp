@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "MouseInterface.h"
 #include "ParallelPrinter.h"
 #include "Pravets.h"
+#include "Rewind.h"
 #include "SAM.h"
 #include "SerialComms.h"
 #include "SNESMAX.h"
@@ -535,6 +536,7 @@ static void Snapshot_LoadState_v2(void)
 
 		MemUpdatePaging(TRUE);
 
+		Rewind_Reset();	// Older snapshots are of a different machine state
 		DebugReset();
 		if (g_nAppMode == MODE_DEBUG)
 			DebugDisplay(TRUE);
@@ -32,6 +32,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Core.h"
 #include "Interface.h"
 #include "Log.h"
+#include "SoundMixer.h"
+#include "AudioCapture.h"
 #include "Speaker.h"
 
 //-----------------------------------------------------------------------------
@@ -124,12 +126,12 @@ static const char *DirectSound_ErrorText (HRESULT error)
 
 //-----------------------------------------------------------------------------
 
-HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
+static HRESULT DSLockBuffer(LPDIRECTSOUNDBUFFER pDSBuffer, DWORD dwOffset, DWORD dwBytes,
 					  SHORT** ppDSLockedBuffer0, DWORD* pdwDSLockedBufferSize0,
 					  SHORT** ppDSLockedBuffer1, DWORD* pdwDSLockedBufferSize1)
 {
 	DWORD nStatus;
-	HRESULT hr = pVoice->GetStatus(&nStatus);
+	HRESULT hr = pDSBuffer->GetStatus(&nStatus);
 	if(hr != DS_OK)
 		return hr;
 
@@ -137,7 +139,7 @@ HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
 	{
 		do
 		{
-			hr = pVoice->Restore();
+			hr = pDSBuffer->Restore();
 			if(hr == DSERR_BUFFERLOST)
 				Sleep(10);
 		}
@@ -147,7 +149,7 @@ HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
 	// Get write only pointer(s) to sound buffer
 	if(dwBytes == 0)
 	{
-		if(FAILED(hr = pVoice->Lock(0, 0,
+		if(FAILED(hr = pDSBuffer->Lock(0, 0,
 								(void**)ppDSLockedBuffer0, pdwDSLockedBufferSize0,
 								(void**)ppDSLockedBuffer1, pdwDSLockedBufferSize1,
 								DSBLOCK_ENTIREBUFFER)))
@@ -155,7 +157,7 @@ HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
 	}
 	else
 	{
-		if(FAILED(hr = pVoice->Lock(dwOffset, dwBytes,
+		if(FAILED(hr = pDSBuffer->Lock(dwOffset, dwBytes,
 								(void**)ppDSLockedBuffer0, pdwDSLockedBufferSize0,
 								(void**)ppDSLockedBuffer1, pdwDSLockedBufferSize1,
 								0)))
@@ -165,12 +167,73 @@ HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
 	return hr;
 }
 
-//-----------------------------------------------------------------------------
+HRESULT DSGetLock(PVOICE pVoice, DWORD dwOffset, DWORD dwBytes,
+					  SHORT** ppDSLockedBuffer0, DWORD* pdwDSLockedBufferSize0,
+					  SHORT** ppDSLockedBuffer1, DWORD* pdwDSLockedBufferSize1)
+{
+	if(pVoice->pMixerVoice)
+	{
+		SoundMixer_Lock(pVoice->pMixerVoice, dwOffset, dwBytes,
+						ppDSLockedBuffer0, pdwDSLockedBufferSize0,
+						ppDSLockedBuffer1, pdwDSLockedBufferSize1);
+		return DS_OK;
+	}
 
-HRESULT DSGetSoundBuffer(VOICE* pVoice, DWORD dwFlags, DWORD dwBufferSize, DWORD nSampleRate, int nChannels, const char* pszDevName)
+	return DSLockBuffer(pVoice->lpDSBvoice, dwOffset, dwBytes,
+						ppDSLockedBuffer0, pdwDSLockedBufferSize0,
+						ppDSLockedBuffer1, pdwDSLockedBufferSize1);
+}
+
+HRESULT DSUnlock(PVOICE pVoice, SHORT* pDSLockedBuffer0, DWORD dwDSLockedBufferSize0,
+					  SHORT* pDSLockedBuffer1, DWORD dwDSLockedBufferSize1)
 {
-	pVoice->name = pszDevName;
+	if(pVoice->pMixerVoice)
+	{
+		SoundMixer_Unlock(pVoice->pMixerVoice);
+		return DS_OK;
+	}
+
+	return pVoice->lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
+										(void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+}
+
+HRESULT DSGetCurrentPosition(PVOICE pVoice, DWORD* pdwCurrentPlayCursor, DWORD* pdwCurrentWriteCursor)
+{
+	if(pVoice->pMixerVoice)
+	{
+		SoundMixer_GetCurrentPosition(pVoice->pMixerVoice, pdwCurrentPlayCursor, pdwCurrentWriteCursor);
+		return DS_OK;
+	}
+
+	return pVoice->lpDSBvoice->GetCurrentPosition(pdwCurrentPlayCursor, pdwCurrentWriteCursor);
+}
+
+HRESULT DSSetVolume(PVOICE pVoice, LONG nVolume)
+{
+	if(pVoice->pMixerVoice)
+	{
+		SoundMixer_SetVolume(pVoice->pMixerVoice, nVolume);
+		return DS_OK;
+	}
+
+	return pVoice->lpDSBvoice->SetVolume(nVolume);
+}
+
+HRESULT DSGetVolume(PVOICE pVoice, LONG* pnVolume)
+{
+	if(pVoice->pMixerVoice)
+	{
+		*pnVolume = SoundMixer_GetVolume(pVoice->pMixerVoice);
+		return DS_OK;
+	}
+
+	return pVoice->lpDSBvoice->GetVolume(pnVolume);
+}
+
+//-----------------------------------------------------------------------------
 
+static HRESULT DSCreateSoundBuffer(LPDIRECTSOUNDBUFFER* ppDSBuffer, DWORD dwFlags, DWORD dwBufferSize, DWORD nSampleRate, int nChannels)
+{
 	WAVEFORMATEX wavfmt;
 	DSBUFFERDESC dsbdesc;
 
@@ -187,13 +250,30 @@ HRESULT DSGetSoundBuffer(VOICE* pVoice, DWORD dwFlags, DWORD dwBufferSize, DWORD
 	dsbdesc.lpwfxFormat = &wavfmt;
 	dsbdesc.dwFlags = dwFlags | DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_STICKYFOCUS;
 
-	// Are buffers released when g_lpDS OR pVoice->lpDSBvoice is released?
+	// Are buffers released when g_lpDS OR the sound buffer is released?
 	// . From DirectX doc:
 	//   "Buffer objects are owned by the device object that created them. When the
 	//    device object is released, all buffers created by that object are also released..."
-	HRESULT hr = g_lpDS->CreateSoundBuffer(&dsbdesc, &pVoice->lpDSBvoice, NULL);
-	if(FAILED(hr))
-		return hr;
+	return g_lpDS->CreateSoundBuffer(&dsbdesc, ppDSBuffer, NULL);
+}
+
+HRESULT DSGetSoundBuffer(VOICE* pVoice, DWORD dwFlags, DWORD dwBufferSize, DWORD nSampleRate, int nChannels, const char* pszDevName)
+{
+	pVoice->name = pszDevName;
+
+	HRESULT hr = DS_OK;
+	if(SoundMixer_IsEnabled())
+	{
+		pVoice->pMixerVoice = SoundMixer_CreateVoice(dwBufferSize, nSampleRate, nChannels);
+		if(!pVoice->pMixerVoice)
+			return DSERR_OUTOFMEMORY;
+	}
+	else
+	{
+		hr = DSCreateSoundBuffer(&pVoice->lpDSBvoice, dwFlags, dwBufferSize, nSampleRate, nChannels);
+		if(FAILED(hr))
+			return hr;
+	}
 
 	//
 
@@ -224,6 +304,9 @@ void DSReleaseSoundBuffer(VOICE* pVoice)
 	}
 
 	SAFE_RELEASE(pVoice->lpDSBvoice);
+
+	SoundMixer_ReleaseVoice(pVoice->pMixerVoice);
+	pVoice->pMixerVoice = NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -233,8 +316,12 @@ bool DSVoiceStop(PVOICE Voice)
 #ifdef NO_DIRECT_X
 	return false;
 #else
-	_ASSERT(Voice->lpDSBvoice);
-	HRESULT hr = Voice->lpDSBvoice->Stop();
+	_ASSERT(Voice->HasBuffer());
+	HRESULT hr = DS_OK;
+	if(Voice->pMixerVoice)
+		SoundMixer_Play(Voice->pMixerVoice, false);
+	else
+		hr = Voice->lpDSBvoice->Stop();
 	if(FAILED(hr))
 	{
 		if(g_fh) fprintf(g_fh, "%s: DSStop failed (%08X)\n", Voice->name.c_str(), hr);
@@ -259,7 +346,7 @@ bool DSZeroVoiceBuffer(PVOICE Voice, DWORD dwBufferSize)
 	if (!DSVoiceStop(Voice))
 		return false;
 
-	HRESULT hr = DSGetLock(Voice->lpDSBvoice, 0, 0, &pDSLockedBuffer, &dwDSLockedBufferSize, NULL, 0);
+	HRESULT hr = DSGetLock(Voice, 0, 0, &pDSLockedBuffer, &dwDSLockedBufferSize, NULL, 0);
 	if(FAILED(hr))
 	{
 		if(g_fh) fprintf(g_fh, "%s: DSGetLock failed (%08X)\n", Voice->name.c_str(), hr);
@@ -269,14 +356,17 @@ bool DSZeroVoiceBuffer(PVOICE Voice, DWORD dwBufferSize)
 	_ASSERT(dwDSLockedBufferSize == dwBufferSize);
 	memset(pDSLockedBuffer, 0x00, dwDSLockedBufferSize);
 
-	hr = Voice->lpDSBvoice->Unlock((void*)pDSLockedBuffer, dwDSLockedBufferSize, NULL, 0);
+	hr = DSUnlock(Voice, pDSLockedBuffer, dwDSLockedBufferSize, NULL, 0);
 	if(FAILED(hr))
 	{
 		if(g_fh) fprintf(g_fh, "%s: DSUnlock failed (%08X)\n", Voice->name.c_str(), hr);
 		return false;
 	}
 
-	hr = Voice->lpDSBvoice->Play(0,0,DSBPLAY_LOOPING);
+	if(Voice->pMixerVoice)
+		SoundMixer_Play(Voice->pMixerVoice, true);
+	else
+		hr = Voice->lpDSBvoice->Play(0,0,DSBPLAY_LOOPING);
 	if(FAILED(hr))
 	{
 		if(g_fh) fprintf(g_fh, "%s: DSPlay failed (%08X)\n", Voice->name.c_str(), hr);
@@ -296,7 +386,7 @@ bool DSZeroVoiceWritableBuffer(PVOICE Voice, DWORD dwBufferSize)
 	SHORT *pDSLockedBuffer0, *pDSLockedBuffer1;
 
 
-	HRESULT hr = DSGetLock(Voice->lpDSBvoice,
+	HRESULT hr = DSGetLock(Voice,
 							0, dwBufferSize,
 							&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 							&pDSLockedBuffer1, &dwDSLockedBufferSize1);
@@ -310,8 +400,8 @@ bool DSZeroVoiceWritableBuffer(PVOICE Voice, DWORD dwBufferSize)
 	if(pDSLockedBuffer1)
 		memset(pDSLockedBuffer1, 0x00, dwDSLockedBufferSize1);
 
-	hr = Voice->lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-									(void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+	hr = DSUnlock(Voice, pDSLockedBuffer0, dwDSLockedBufferSize0,
+							pDSLockedBuffer1, dwDSLockedBufferSize1);
 	if(FAILED(hr))
 	{
 		if(g_fh) fprintf(g_fh, "%s: DSUnlock failed (%08X)\n", Voice->name.c_str(), hr);
@@ -430,7 +520,7 @@ static VOID CALLBACK SoundCore_TimerFunc(HWND hwnd, UINT uMsg, UINT_PTR idEvent,
 	}
 
 	g_pSpeakerVoice->nFadeVolume = nFadeVolume;
-	g_pSpeakerVoice->lpDSBvoice->SetVolume(nFadeVolume);
+	DSSetVolume(g_pSpeakerVoice, nFadeVolume);
 #endif
 }
 
@@ -453,18 +543,18 @@ void SoundCore_SetFade(eFADE FadeType)
 			// . See SoundCore_TweakVolumes() - could be this?
 			if((g_pVoices[i]->bIsSpeaker) && (g_nAppMode != MODE_LOGO) && (nLastMode != MODE_LOGO))
 			{
-				g_pVoices[i]->lpDSBvoice->GetVolume(&g_pVoices[i]->nFadeVolume);
+				DSGetVolume(g_pVoices[i], &g_pVoices[i]->nFadeVolume);
 				g_FadeType = FadeType;
 				SoundCore_StartTimer();
 			}
 			else if(FadeType == FADE_OUT)
 			{
-				g_pVoices[i]->lpDSBvoice->SetVolume(DSBVOLUME_MIN);
+				DSSetVolume(g_pVoices[i], DSBVOLUME_MIN);
 				g_pVoices[i]->bMute = true;
 			}
 			else // FADE_IN
 			{
-				g_pVoices[i]->lpDSBvoice->SetVolume(g_pVoices[i]->nVolume);
+				DSSetVolume(g_pVoices[i], g_pVoices[i]->nVolume);
 				g_pVoices[i]->bMute = false;
 			}
 		}
@@ -475,7 +565,7 @@ void SoundCore_SetFade(eFADE FadeType)
 			(g_pSpeakerVoice && g_pSpeakerVoice->bActive) )
 		{
 			g_FadeType = FADE_NONE;			// TimerFunc will call StopTimer()
-			g_pSpeakerVoice->lpDSBvoice->SetVolume(g_pSpeakerVoice->nVolume);
+			DSSetVolume(g_pSpeakerVoice, g_pSpeakerVoice->nVolume);
 		}
 	}
 
@@ -491,11 +581,116 @@ void SoundCore_TweakVolumes()
 {
 	for (UINT i=0; i<g_uNumVoices; i++)
 	{
-		g_pVoices[i]->lpDSBvoice->SetVolume(g_pVoices[i]->nVolume-1);
-		g_pVoices[i]->lpDSBvoice->SetVolume(g_pVoices[i]->nVolume);
+		DSSetVolume(g_pVoices[i], g_pVoices[i]->nVolume-1);
+		DSSetVolume(g_pVoices[i], g_pVoices[i]->nVolume);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Sound mixer's output to a single DirectSound buffer (see SoundMixer.cpp)
+// . only called from the mixer thread (once started)
+
+class DSoundMixerSink : public SoundMixerSink
+{
+public:
+	DSoundMixerSink(void) : m_lpDSBuffer(NULL), m_dwByteOffset(0) {}
+	virtual ~DSoundMixerSink(void) {}
+
+	bool Init(void);
+	void Uninit(void);
+
+	virtual UINT GetFramesWanted(void);
+	virtual void Write(const short* pFrames, UINT uNumFrames);
+
+private:
+	static const DWORD kFrameSize = SOUNDMIXER_NUM_CHANNELS * sizeof(short);
+	static const DWORD kBufferSize = 8192 * kFrameSize;		// ~186ms
+	static const DWORD kTargetQueued = kBufferSize / 4;		// ~46ms of latency
+
+	LPDIRECTSOUNDBUFFER m_lpDSBuffer;
+	DWORD m_dwByteOffset;
+};
+
+bool DSoundMixerSink::Init(void)
+{
+	HRESULT hr = DSCreateSoundBuffer(&m_lpDSBuffer, 0, kBufferSize, SOUNDMIXER_SAMPLE_RATE, SOUNDMIXER_NUM_CHANNELS);
+	if(FAILED(hr))
+	{
+		if(g_fh) fprintf(g_fh, "Mixer: DSCreateSoundBuffer failed (%08X)\n", hr);
+		return false;
+	}
+
+	DWORD dwDSLockedBufferSize = 0;
+	SHORT* pDSLockedBuffer;
+	hr = DSLockBuffer(m_lpDSBuffer, 0, 0, &pDSLockedBuffer, &dwDSLockedBufferSize, NULL, 0);
+	if(FAILED(hr))
+		return false;
+
+	memset(pDSLockedBuffer, 0x00, dwDSLockedBufferSize);
+	m_lpDSBuffer->Unlock((void*)pDSLockedBuffer, dwDSLockedBufferSize, NULL, 0);
+
+	hr = m_lpDSBuffer->Play(0,0,DSBPLAY_LOOPING);
+	if(FAILED(hr))
+	{
+		if(g_fh) fprintf(g_fh, "Mixer: DSPlay failed (%08X)\n", hr);
+		return false;
+	}
+
+	DWORD dwCurrentPlayCursor;
+	m_lpDSBuffer->GetCurrentPosition(&dwCurrentPlayCursor, &m_dwByteOffset);
+	return true;
+}
+
+void DSoundMixerSink::Uninit(void)
+{
+	if(m_lpDSBuffer)
+		m_lpDSBuffer->Stop();
+
+	SAFE_RELEASE(m_lpDSBuffer);
+}
+
+UINT DSoundMixerSink::GetFramesWanted(void)
+{
+	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
+	if(FAILED(m_lpDSBuffer->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor)))
+		return 0;
+
+	DWORD dwBytesQueued = (m_dwByteOffset - dwCurrentPlayCursor + kBufferSize) % kBufferSize;
+	const DWORD dwWriteAhead = (dwCurrentWriteCursor - dwCurrentPlayCursor + kBufferSize) % kBufferSize;
+	if(dwBytesQueued < dwWriteAhead)
+	{
+		// Underrun: play cursor has passed our write position, so restart at the write cursor
+		m_dwByteOffset = dwCurrentWriteCursor;
+		dwBytesQueued = dwWriteAhead;
 	}
+
+	return (dwBytesQueued < kTargetQueued) ? (kTargetQueued - dwBytesQueued) / kFrameSize : 0;
 }
 
+void DSoundMixerSink::Write(const short* pFrames, UINT uNumFrames)
+{
+	DWORD dwDSLockedBufferSize0=0, dwDSLockedBufferSize1=0;
+	SHORT *pDSLockedBuffer0, *pDSLockedBuffer1;
+
+	const DWORD dwBytes = uNumFrames * kFrameSize;
+	if(FAILED(DSLockBuffer(m_lpDSBuffer, m_dwByteOffset, dwBytes,
+							&pDSLockedBuffer0, &dwDSLockedBufferSize0,
+							&pDSLockedBuffer1, &dwDSLockedBufferSize1)))
+		return;
+
+	memcpy(pDSLockedBuffer0, pFrames, dwDSLockedBufferSize0);
+	if(pDSLockedBuffer1)
+		memcpy(pDSLockedBuffer1, (const BYTE*)pFrames + dwDSLockedBufferSize0, dwDSLockedBufferSize1);
+
+	m_lpDSBuffer->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
+						 (void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+
+	m_dwByteOffset = (m_dwByteOffset + dwBytes) % kBufferSize;
+}
+
+static DSoundMixerSink g_dsoundMixerSink;
+
 //-----------------------------------------------------------------------------
 
 static UINT g_uDSInitRefCount = 0;
@@ -508,6 +703,18 @@ bool DSInit()
 		return true;		// Already initialised successfully
 	}
 
+	const SoundMixerSink_e mixerSinkType = SoundMixer_GetSinkType();
+	if(mixerSinkType == MIXER_SINK_NULL || mixerSinkType == MIXER_SINK_WAV)
+	{
+		// No sound device needed: all voices are mixed to the null or .wav sink
+		if(!SoundMixer_Start(NULL))
+			return false;
+
+		g_bDSAvailable = true;
+		g_uDSInitRefCount = 1;
+		return true;
+	}
+
 	num_sound_devices = 0;
 	HRESULT hr = DirectSoundEnumerate((LPDSENUMCALLBACK)DSEnumProc, NULL);
 	if(FAILED(hr))
@@ -557,6 +764,16 @@ bool DSInit()
 		// Not fatal: so continue...
 	}
 
+	if(mixerSinkType == MIXER_SINK_DSOUND)
+	{
+		if(!g_dsoundMixerSink.Init() || !SoundMixer_Start(&g_dsoundMixerSink))
+		{
+			// Not fatal: fall back to a DirectSound buffer per voice
+			if(g_fh) fprintf(g_fh, "Mixer: failed to start\n");
+			g_dsoundMixerSink.Uninit();
+		}
+	}
+
 	g_bDSAvailable = true;
 
 	g_uDSInitRefCount = 1;
@@ -585,6 +802,10 @@ void DSUninit()
 
 	_ASSERT(g_uNumVoices == 0);
 
+	SoundMixer_Stop();
+	AudioCapture_Stop();
+	g_dsoundMixerSink.Uninit();
+
 	SAFE_RELEASE(g_lpDS);
 	g_bDSAvailable = false;
 
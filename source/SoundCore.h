@@ -8,10 +8,13 @@
 //#define RIFF_SPKR
 //#define RIFF_MB
 
+struct MixerVoice;
+
 struct VOICE
 {
 	LPDIRECTSOUNDBUFFER lpDSBvoice;
 	LPDIRECTSOUNDNOTIFY lpDSNotify;
+	MixerVoice* pMixerVoice;	// Used instead of lpDSBvoice when the sound mixer is enabled
 	bool bActive;			// Playback is active
 	bool bMute;
 	LONG nVolume;			// Current volume (as used by DirectSound)
@@ -25,6 +28,7 @@ struct VOICE
 	{
 		lpDSBvoice = NULL;
 		lpDSNotify = NULL;
+		pMixerVoice = NULL;
 		bActive = false;
 		bMute = false;
 		nVolume = 0;
@@ -34,13 +38,24 @@ struct VOICE
 		bRecentlyActive = false;
 		name = "";
 	}
+
+	bool HasBuffer(void) const
+	{
+		return lpDSBvoice != NULL || pMixerVoice != NULL;
+	}
 };
 
 typedef VOICE* PVOICE;
 
-HRESULT DSGetLock(LPDIRECTSOUNDBUFFER pVoice, DWORD dwOffset, DWORD dwBytes,
+// These take either a DirectSound buffer or a mixer voice (see SoundMixer.cpp)
+HRESULT DSGetLock(PVOICE pVoice, DWORD dwOffset, DWORD dwBytes,
 					  SHORT** ppDSLockedBuffer0, DWORD* pdwDSLockedBufferSize0,
 					  SHORT** ppDSLockedBuffer1, DWORD* pdwDSLockedBufferSize1);
+HRESULT DSUnlock(PVOICE pVoice, SHORT* pDSLockedBuffer0, DWORD dwDSLockedBufferSize0,
+					  SHORT* pDSLockedBuffer1, DWORD dwDSLockedBufferSize1);
+HRESULT DSGetCurrentPosition(PVOICE pVoice, DWORD* pdwCurrentPlayCursor, DWORD* pdwCurrentWriteCursor);
+HRESULT DSSetVolume(PVOICE pVoice, LONG nVolume);
+HRESULT DSGetVolume(PVOICE pVoice, LONG* pnVolume);
 
 HRESULT DSGetSoundBuffer(VOICE* pVoice, DWORD dwFlags, DWORD dwBufferSize, DWORD nSampleRate, int nChannels, const char* pszDevName);
 void DSReleaseSoundBuffer(VOICE* pVoice);
@@ -0,0 +1,435 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Software audio mixer
+ *
+ * Each sound source (speaker, Mockingboard, SSI263) writes to its voice exactly as it would to a
+ * looping DirectSound buffer: it reads the play/write cursors, then locks/writes/unlocks ahead
+ * of the write cursor. With the mixer enabled, that buffer is a single-producer/single-consumer
+ * ring in memory:
+ * . the emulation thread is the only producer (Lock/Unlock never block or call into the OS)
+ * . the mixer thread is the only consumer: it advances each voice's play cursor in real time,
+ *   resamples to 44.1kHz stereo, applies the voice's volume, mixes and writes to the output sink.
+ * Since the cursors behave like DirectSound's, each source's existing drift-correction is unchanged.
+ *
+ * Output sinks: a single DirectSound buffer (see SoundCore.cpp), null or .wav file.
+ * The mixer and the null/.wav sinks make no DirectSound calls.
+ */
+
+#include "StdAfx.h"
+
+#include "SoundMixer.h"
+#include "Log.h"
+#include "Riff.h"
+
+//-----------------------------------------------------------------------------
+
+struct MixerVoice
+{
+	short* pBuffer;
+	DWORD dwBufferSize;		// Bytes
+	UINT nChannels;
+	UINT nFrameSize;		// Bytes
+	UINT nNumFrames;
+	double fStep;			// Source frames per output frame
+	DWORD dwGuardSize;		// Bytes between play & write cursors (what the mixer may read in one pass)
+	double fPlayFrame;		// Mixer thread only
+
+	volatile LONG nPlayCursor;	// Bytes: written by mixer thread only
+	volatile LONG bPlaying;
+	volatile LONG nVolume;		// DirectSound units
+	volatile LONG nGain;		// Linear gain (16.16 fixed-point)
+
+	bool bInUse;
+};
+
+static const UINT kMaxVoices = 8;
+static MixerVoice g_voices[kMaxVoices];
+static CRITICAL_SECTION g_voicesCriticalSection;	// Create/Release vs. a mix pass (never taken in the emulation's 1ms slice)
+
+static const UINT kMixPeriodMs = 5;
+static const UINT kMaxMixFrames = 1024;				// Per mix pass (~23ms)
+static int g_mixAccum[kMaxMixFrames * SOUNDMIXER_NUM_CHANNELS];
+static short g_mixBuffer[kMaxMixFrames * SOUNDMIXER_NUM_CHANNELS];
+
+static SoundMixerSink_e g_sinkType = MIXER_SINK_NONE;
+static std::string g_wavFilename;
+static SoundMixerSink* g_pSink = NULL;
+static bool g_bOwnSink = false;
+
+static HANDLE g_hMixerThread = NULL;
+static HANDLE g_hMixerStopEvent = NULL;
+
+//-----------------------------------------------------------------------------
+
+// Real-time paced sink: consumes frames at the output sample rate, but outputs nothing
+class NullSink : public SoundMixerSink
+{
+public:
+	NullSink(void)
+	{
+		QueryPerformanceFrequency(&m_freq);
+		QueryPerformanceCounter(&m_start);
+		m_framesWritten = 0;
+	}
+	virtual ~NullSink(void) {}
+
+	virtual UINT GetFramesWanted(void)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		const UINT64 framesDue = (UINT64)(now.QuadPart - m_start.QuadPart) * SOUNDMIXER_SAMPLE_RATE / m_freq.QuadPart;
+		if (framesDue <= m_framesWritten)
+			return 0;
+
+		// If the mixer thread was starved (eg. host suspended) then don't try to catch up more than 0.1s
+		const UINT64 maxFrames = SOUNDMIXER_SAMPLE_RATE / 10;
+		if (framesDue - m_framesWritten > maxFrames)
+			m_framesWritten = framesDue - maxFrames;
+
+		return (UINT)(framesDue - m_framesWritten);
+	}
+
+	virtual void Write(const short* pFrames, UINT uNumFrames)
+	{
+		m_framesWritten += uNumFrames;
+	}
+
+private:
+	LARGE_INTEGER m_freq;
+	LARGE_INTEGER m_start;
+	UINT64 m_framesWritten;
+};
+
+class WavSink : public NullSink
+{
+public:
+	WavSink(const std::string& filename)
+	{
+		m_bOpen = RiffInitWriteFile(filename.c_str(), SOUNDMIXER_SAMPLE_RATE, SOUNDMIXER_NUM_CHANNELS) == 0;
+		if (!m_bOpen)
+			LogFileOutput("SoundMixer: failed to create .wav file: %s\n", filename.c_str());
+	}
+	virtual ~WavSink(void)
+	{
+		if (m_bOpen)
+			RiffFinishWriteFile();
+	}
+
+	virtual void Write(const short* pFrames, UINT uNumFrames)
+	{
+		if (m_bOpen)
+			RiffPutSamples(pFrames, uNumFrames);
+		NullSink::Write(pFrames, uNumFrames);
+	}
+
+private:
+	bool m_bOpen;
+};
+
+//-----------------------------------------------------------------------------
+
+void SoundMixer_SetSinkType(SoundMixerSink_e sinkType, const std::string& wavFilename /*= ""*/)
+{
+	g_sinkType = sinkType;
+	g_wavFilename = wavFilename;
+}
+
+SoundMixerSink_e SoundMixer_GetSinkType(void)
+{
+	return g_sinkType;
+}
+
+bool SoundMixer_IsEnabled(void)
+{
+	return g_pSink != NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static void SoundMixer_MixFrames(const UINT uNumFrames)
+{
+	memset(g_mixAccum, 0, uNumFrames * SOUNDMIXER_NUM_CHANNELS * sizeof(g_mixAccum[0]));
+
+	for (UINT v = 0; v < kMaxVoices; v++)
+	{
+		MixerVoice& voice = g_voices[v];
+		if (!voice.bInUse || !voice.bPlaying)
+			continue;
+
+		MemoryBarrier();	// Acquire: see producer's samples published by SoundMixer_Unlock()
+
+		const int gain = voice.nGain;
+		const UINT numFrames = voice.nNumFrames;
+		double pos = voice.fPlayFrame;
+
+		if (gain)
+		{
+			int* pAccum = g_mixAccum;
+			for (UINT i = 0; i < uNumFrames; i++, pos += voice.fStep)
+			{
+				UINT f0 = (UINT)pos;
+				const int frac = (int)((pos - f0) * 256.0);	// 8-bit fraction for linear interpolation
+				f0 %= numFrames;
+				const UINT f1 = (f0 + 1) % numFrames;
+
+				const short* p0 = &voice.pBuffer[f0 * voice.nChannels];
+				const short* p1 = &voice.pBuffer[f1 * voice.nChannels];
+
+				const int left = p0[0] + (((p1[0] - p0[0]) * frac) >> 8);
+				const int right = (voice.nChannels == 1) ? left : p0[1] + (((p1[1] - p0[1]) * frac) >> 8);
+
+				*pAccum++ += (int)(((INT64)left * gain) >> 16);
+				*pAccum++ += (int)(((INT64)right * gain) >> 16);
+			}
+		}
+		else
+		{
+			pos += voice.fStep * uNumFrames;
+		}
+
+		voice.fPlayFrame = fmod(pos, (double)numFrames);
+		InterlockedExchange(&voice.nPlayCursor, (LONG)((UINT)voice.fPlayFrame * voice.nFrameSize));
+	}
+
+	for (UINT i = 0; i < uNumFrames * SOUNDMIXER_NUM_CHANNELS; i++)
+	{
+		int sample = g_mixAccum[i];
+		if (sample > 32767) sample = 32767;
+		else if (sample < -32768) sample = -32768;
+		g_mixBuffer[i] = (short)sample;
+	}
+}
+
+static DWORD WINAPI SoundMixer_Thread(LPVOID lpParameter)
+{
+	while (WaitForSingleObject(g_hMixerStopEvent, kMixPeriodMs) == WAIT_TIMEOUT)
+	{
+		UINT uNumFrames = g_pSink->GetFramesWanted();
+		while (uNumFrames)
+		{
+			const UINT uFrames = uNumFrames < kMaxMixFrames ? uNumFrames : kMaxMixFrames;
+
+			EnterCriticalSection(&g_voicesCriticalSection);
+			SoundMixer_MixFrames(uFrames);
+			LeaveCriticalSection(&g_voicesCriticalSection);
+
+			g_pSink->Write(g_mixBuffer, uFrames);
+			uNumFrames -= uFrames;
+		}
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SoundMixer_Start(SoundMixerSink* pSink)
+{
+	_ASSERT(g_pSink == NULL);
+	if (g_pSink)
+		return true;
+
+	if (pSink)
+	{
+		g_pSink = pSink;
+		g_bOwnSink = false;
+	}
+	else
+	{
+		g_pSink = (g_sinkType == MIXER_SINK_WAV) ? new WavSink(g_wavFilename) : new NullSink;
+		g_bOwnSink = true;
+	}
+
+	InitializeCriticalSection(&g_voicesCriticalSection);
+	for (UINT v = 0; v < kMaxVoices; v++)
+		g_voices[v].bInUse = false;
+
+	g_hMixerStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);	// Manual-reset, initially non-signaled
+
+	DWORD dwThreadId;
+	g_hMixerThread = CreateThread(NULL,				// lpThreadAttributes
+									0,				// dwStackSize
+									SoundMixer_Thread,
+									NULL,			// lpParameter
+									0,				// dwCreationFlags : 0 = Run immediately
+									&dwThreadId);	// lpThreadId
+
+	if (g_hMixerStopEvent == NULL || g_hMixerThread == NULL)
+	{
+		LogFileOutput("SoundMixer_Start: failed to create mixer thread\n");
+		SoundMixer_Stop();
+		return false;
+	}
+
+	SetThreadPriority(g_hMixerThread, THREAD_PRIORITY_TIME_CRITICAL);
+
+	LogFileOutput("SoundMixer_Start: sink=%d\n", pSink ? MIXER_SINK_DSOUND : g_sinkType);
+	return true;
+}
+
+void SoundMixer_Stop(void)
+{
+	if (g_pSink == NULL)
+		return;
+
+	if (g_hMixerThread)
+	{
+		SetEvent(g_hMixerStopEvent);
+		WaitForSingleObject(g_hMixerThread, INFINITE);
+		CloseHandle(g_hMixerThread);
+		g_hMixerThread = NULL;
+	}
+
+	if (g_hMixerStopEvent)
+	{
+		CloseHandle(g_hMixerStopEvent);
+		g_hMixerStopEvent = NULL;
+	}
+
+	for (UINT v = 0; v < kMaxVoices; v++)
+		_ASSERT(!g_voices[v].bInUse);
+
+	DeleteCriticalSection(&g_voicesCriticalSection);
+
+	if (g_bOwnSink)
+		delete g_pSink;
+	g_pSink = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+MixerVoice* SoundMixer_CreateVoice(DWORD dwBufferSize, DWORD nSampleRate, int nChannels)
+{
+	_ASSERT(g_pSink);
+	_ASSERT(nChannels == 1 || nChannels == 2);
+
+	MixerVoice* pVoice = NULL;
+
+	EnterCriticalSection(&g_voicesCriticalSection);
+
+	for (UINT v = 0; v < kMaxVoices; v++)
+	{
+		if (g_voices[v].bInUse)
+			continue;
+
+		pVoice = &g_voices[v];
+		pVoice->nChannels = nChannels;
+		pVoice->nFrameSize = nChannels * sizeof(short);
+		pVoice->nNumFrames = dwBufferSize / pVoice->nFrameSize;
+		pVoice->dwBufferSize = pVoice->nNumFrames * pVoice->nFrameSize;
+		pVoice->pBuffer = new short[pVoice->nNumFrames * nChannels];
+		memset(pVoice->pBuffer, 0, pVoice->dwBufferSize);
+		pVoice->fStep = (double)nSampleRate / SOUNDMIXER_SAMPLE_RATE;
+		pVoice->dwGuardSize = ((UINT)(kMaxMixFrames * pVoice->fStep) + 2) * pVoice->nFrameSize;
+		_ASSERT(pVoice->dwGuardSize < pVoice->dwBufferSize / 4);
+		pVoice->fPlayFrame = 0.0;
+		pVoice->nPlayCursor = 0;
+		pVoice->bPlaying = FALSE;
+		pVoice->nVolume = DSBVOLUME_MAX;
+		pVoice->nGain = 1 << 16;
+		pVoice->bInUse = true;
+		break;
+	}
+
+	LeaveCriticalSection(&g_voicesCriticalSection);
+
+	_ASSERT(pVoice);
+	return pVoice;
+}
+
+void SoundMixer_ReleaseVoice(MixerVoice* pVoice)
+{
+	if (!pVoice)
+		return;
+
+	EnterCriticalSection(&g_voicesCriticalSection);
+
+	pVoice->bInUse = false;
+	pVoice->bPlaying = FALSE;
+	delete [] pVoice->pBuffer;
+	pVoice->pBuffer = NULL;
+
+	LeaveCriticalSection(&g_voicesCriticalSection);
+}
+
+//-----------------------------------------------------------------------------
+
+void SoundMixer_GetCurrentPosition(MixerVoice* pVoice, DWORD* pdwPlayCursor, DWORD* pdwWriteCursor)
+{
+	const DWORD dwPlayCursor = (DWORD) pVoice->nPlayCursor;
+	*pdwPlayCursor = dwPlayCursor;
+	*pdwWriteCursor = (dwPlayCursor + pVoice->dwGuardSize) % pVoice->dwBufferSize;
+}
+
+// Like IDirectSoundBuffer::Lock(): dwBytes=0 => entire buffer
+void SoundMixer_Lock(MixerVoice* pVoice, DWORD dwOffset, DWORD dwBytes,
+					 SHORT** ppLockedBuffer0, DWORD* pdwLockedBufferSize0,
+					 SHORT** ppLockedBuffer1, DWORD* pdwLockedBufferSize1)
+{
+	if (dwBytes == 0 || dwBytes > pVoice->dwBufferSize)
+	{
+		dwOffset = 0;
+		dwBytes = pVoice->dwBufferSize;
+	}
+
+	dwOffset %= pVoice->dwBufferSize;
+	const DWORD dwBytesToEnd = pVoice->dwBufferSize - dwOffset;
+
+	*ppLockedBuffer0 = (SHORT*) ((BYTE*)pVoice->pBuffer + dwOffset);
+	*pdwLockedBufferSize0 = dwBytes < dwBytesToEnd ? dwBytes : dwBytesToEnd;
+
+	if (ppLockedBuffer1)
+	{
+		const DWORD dwBytesWrapped = dwBytes - *pdwLockedBufferSize0;
+		*ppLockedBuffer1 = dwBytesWrapped ? pVoice->pBuffer : NULL;
+		*pdwLockedBufferSize1 = dwBytesWrapped;
+	}
+}
+
+void SoundMixer_Unlock(MixerVoice* pVoice)
+{
+	MemoryBarrier();	// Release: publish the samples written since SoundMixer_Lock()
+}
+
+void SoundMixer_Play(MixerVoice* pVoice, bool bPlay)
+{
+	InterlockedExchange(&pVoice->bPlaying, bPlay ? TRUE : FALSE);
+}
+
+void SoundMixer_SetVolume(MixerVoice* pVoice, LONG nVolume)
+{
+	if (nVolume > DSBVOLUME_MAX) nVolume = DSBVOLUME_MAX;
+	if (nVolume < DSBVOLUME_MIN) nVolume = DSBVOLUME_MIN;
+
+	// DirectSound volume is attenuation in 1/100 dB
+	const LONG nGain = (nVolume == DSBVOLUME_MIN) ? 0 : (LONG)(pow(10.0, nVolume / 2000.0) * (1 << 16));
+
+	InterlockedExchange(&pVoice->nVolume, nVolume);
+	InterlockedExchange(&pVoice->nGain, nGain);
+}
+
+LONG SoundMixer_GetVolume(MixerVoice* pVoice)
+{
+	return pVoice->nVolume;
+}
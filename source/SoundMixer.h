@@ -0,0 +1,45 @@
+#pragma once
+
+// Optional software mixer (see SoundMixer.cpp):
+// . each sound source's voice is a ring-buffer in memory (with DirectSound-like play/write cursors)
+// . a mixer thread resamples & mixes all voices to a single output sink
+
+enum SoundMixerSink_e
+{
+	MIXER_SINK_NONE = 0,	// Mixer not used: each voice has its own DirectSound buffer
+	MIXER_SINK_DSOUND,		// Mix to a single DirectSound buffer
+	MIXER_SINK_NULL,		// Mix & discard (real-time paced)
+	MIXER_SINK_WAV,			// Mix & write to a .wav file (real-time paced)
+};
+
+class SoundMixerSink
+{
+public:
+	virtual ~SoundMixerSink(void) {}
+	virtual UINT GetFramesWanted(void) = 0;								// Number of stereo frames that can be written now
+	virtual void Write(const short* pFrames, UINT uNumFrames) = 0;		// Interleaved L/R
+};
+
+struct MixerVoice;
+
+const UINT SOUNDMIXER_SAMPLE_RATE = 44100;
+const UINT SOUNDMIXER_NUM_CHANNELS = 2;
+
+void SoundMixer_SetSinkType(SoundMixerSink_e sinkType, const std::string& wavFilename = "");
+SoundMixerSink_e SoundMixer_GetSinkType(void);
+bool SoundMixer_IsEnabled(void);
+
+bool SoundMixer_Start(SoundMixerSink* pSink);	// pSink=NULL => use NULL/WAV sink (from sink type)
+void SoundMixer_Stop(void);
+
+MixerVoice* SoundMixer_CreateVoice(DWORD dwBufferSize, DWORD nSampleRate, int nChannels);
+void SoundMixer_ReleaseVoice(MixerVoice* pVoice);
+
+void SoundMixer_GetCurrentPosition(MixerVoice* pVoice, DWORD* pdwPlayCursor, DWORD* pdwWriteCursor);
+void SoundMixer_Lock(MixerVoice* pVoice, DWORD dwOffset, DWORD dwBytes,
+					 SHORT** ppLockedBuffer0, DWORD* pdwLockedBufferSize0,
+					 SHORT** ppLockedBuffer1, DWORD* pdwLockedBufferSize1);
+void SoundMixer_Unlock(MixerVoice* pVoice);
+void SoundMixer_Play(MixerVoice* pVoice, bool bPlay);
+void SoundMixer_SetVolume(MixerVoice* pVoice, LONG nVolume);	// DirectSound units (1/100 dB)
+LONG SoundMixer_GetVolume(MixerVoice* pVoice);
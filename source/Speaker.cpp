@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "StdAfx.h"
 
 #include "Speaker.h"
+#include "AudioCapture.h"
 #include "Core.h"
 #include "CPU.h"
 #include "Interface.h"
@@ -37,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "SoundCore.h"
 #include "YamlHelper.h"
 #include "Riff.h"
+#include "Rewind.h"
 
 #include "Debugger/Debug.h"	// For DWORD extbench
 
@@ -83,10 +85,12 @@ static unsigned __int64 g_nSpkrLastCycle = 0;
 static bool g_bSpkrToggleFlag = false;
 static VOICE SpeakerVoice;
 static bool g_bSpkrAvailable = false;
+static bool g_bSpkrPullMode = false;		// Headless: samples are pulled via Spkr_PullSamples() instead of submitted to DirectSound
 
 //-----------------------------------------------------------------------------
 
 // Forward refs:
+static void    UpdateSpkr();
 static ULONG   Spkr_SubmitWaveBuffer_FullSpeed(short* pSpeakerBuffer, ULONG nNumSamples);
 static ULONG   Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples);
 static void    Spkr_SetActive(bool bActive);
@@ -94,6 +98,20 @@ static void    Spkr_DSUninit();
 
 //=============================================================================
 
+// Whilst capturing audio (or pulling samples), always render as for normal speed, so that the samples are the same at full-speed
+static bool SpkrRenderAsNormalSpeed(void)
+{
+	return !g_bFullSpeed || AudioCapture_IsActive() || g_bSpkrPullMode;
+}
+
+// Pull mode renders samples even when there's no wave output (SOUND_NONE or no DirectSound)
+static bool SpkrIsRendering(void)
+{
+	return soundtype == SOUND_WAVE || g_bSpkrPullMode;
+}
+
+//=============================================================================
+
 static void DisplayBenchmarkResults ()
 {
   DWORD totaltime = GetTickCount()-extbench;
@@ -167,6 +185,201 @@ inline short DCFilter(short sample_in)
 	return (((int)sample_in) * (g_uDCFilterState--)) / 32768;	// scale & divide by 32768 (NB. Don't ">>15" as undefined behaviour)
 }
 
+//=============================================================================
+//
+// Band-limited speaker synthesis (BLEP)
+//
+// SpkrToggle() just records each speaker toggle as a cycle-timestamped edge.
+// When the speaker is updated, each edge adds its level change - shaped by a band-limited
+// impulse (Blackman-windowed sinc, at 1 cycle resolution) - into a delta buffer, and the
+// delta buffer is then integrated in a single pass to give the samples at SPKR_SAMPLE_RATE.
+// . unlike the per-sample fill (and 1MHz remainder averaging) this doesn't alias, and its cost
+//   depends on the number of toggles rather than the number of samples between them
+// . the kernel is causal, so the output lags by kBlepWidth/2 samples (~0.2ms)
+// . -no-spkr-blep selects the original per-sample path (eg. for A/B comparison with LOG_PERF_TIMINGS)
+//
+
+static bool g_bSpkrBlep = true;
+
+static const UINT kBlepWidth = 16;		// Samples
+static std::vector<float> g_blepKernel;	// [phase][kBlepWidth]: one phase per cycle of a sample. Each phase sums to 1.0 (ie. a unit step once integrated)
+static UINT g_nBlepKernelPhases = 0;
+
+struct SpkrEdge
+{
+	unsigned __int64 cycle;
+	short level;			// Level after the edge: set lazily, as SAM writes g_nSpeakerData after calling SpkrToggle()
+	bool bResetDCFilter;
+};
+
+static const UINT kMaxSpkrEdges = 1024;
+static SpkrEdge g_spkrEdges[kMaxSpkrEdges];
+static UINT g_nSpkrNumEdges = 0;
+
+static float g_blepDelta[SPKR_SAMPLE_RATE + kBlepWidth];	// [0] is the next output sample
+static float g_fBlepLevel = 0.0f;						// Integrator
+static short g_nBlepLevel = SPKR_DATA_INIT;				// Level after the last edge added to g_blepDelta[]
+static UINT g_nBlepTail = 0;							// Number of g_blepDelta[] entries that may be non-zero
+static unsigned __int64 g_nBlepCycle = 0;				// Cycle of g_blepDelta[0]
+static UINT g_nClksPerSpkrSample = 23;
+
+static void InitBlepKernel(const UINT nPhases)
+{
+	const double PI = 3.14159265358979323846;
+	const double fCutoff = 0.9;		// Fraction of Nyquist
+
+	g_blepKernel.resize(nPhases * kBlepWidth);
+	g_nBlepKernelPhases = nPhases;
+
+	for (UINT p = 0; p < nPhases; p++)
+	{
+		const double centre = (double)(kBlepWidth / 2) + ((double)p + 0.5) / nPhases - 0.5;
+		double h[kBlepWidth];
+		double sum = 0.0;
+
+		for (UINT k = 0; k < kBlepWidth; k++)
+		{
+			const double x = (double)k - centre;
+			const double sinc = (x == 0.0) ? 1.0 : sin(PI * fCutoff * x) / (PI * fCutoff * x);
+			const double n = (x + kBlepWidth / 2) / kBlepWidth;	// Window position: 0.0 to 1.0
+			const double window = (n <= 0.0 || n >= 1.0) ? 0.0 : 0.42 - 0.5 * cos(2.0 * PI * n) + 0.08 * cos(4.0 * PI * n);
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		for (UINT k = 0; k < kBlepWidth; k++)
+			g_blepKernel[p * kBlepWidth + k] = (float)(h[k] / sum);
+	}
+}
+
+// NB. Call after SetClksPerSpkrSample()
+static void InitBlepState(void)
+{
+	g_nClksPerSpkrSample = (UINT) g_fClksPerSpkrSample;
+	if (g_nBlepKernelPhases != g_nClksPerSpkrSample)
+		InitBlepKernel(g_nClksPerSpkrSample);
+	g_nSpkrNumEdges = 0;
+	memset(g_blepDelta, 0, sizeof(g_blepDelta));
+	g_nBlepTail = 0;
+	g_nBlepLevel = g_nSpeakerData;
+	g_fBlepLevel = (float) g_nSpeakerData;
+	g_nBlepCycle = g_nCumulativeCycles;
+}
+
+// Integrate g_blepDelta[nFrom..nTo) to the speaker buffer
+static void BlepOutput(UINT nFrom, UINT nTo)
+{
+	float fLevel = g_fBlepLevel;
+
+	for (UINT i = nFrom; i < nTo; i++)
+	{
+		fLevel += g_blepDelta[i];
+
+		int nSample = (int) fLevel;		// Clamp, as band-limited edges overshoot
+		if (nSample > 32767) nSample = 32767;
+		else if (nSample < -32768) nSample = -32768;
+
+		if (g_nBufferIdx < SPKR_SAMPLE_RATE-1)
+			g_pSpeakerBuffer[g_nBufferIdx++] = DCFilter((short)nSample);
+	}
+
+	g_fBlepLevel = fLevel;
+}
+
+static void UpdateSpkrBlep(void)
+{
+	const unsigned __int64 nCycleDiff = g_nCumulativeCycles - g_nBlepCycle;
+	const UINT nClks = g_nClksPerSpkrSample;
+
+	if (nCycleDiff / nClks > SPKR_SAMPLE_RATE)
+	{
+		// Not updated for over a second (eg. after full-speed or debugger): restart from the current level
+		InitBlepState();
+		return;
+	}
+
+	const UINT nNumSamples = (UINT) (nCycleDiff / nClks);
+
+	if (g_nSpkrNumEdges)
+		g_spkrEdges[g_nSpkrNumEdges-1].level = g_nSpeakerData;
+
+	UINT nFrom = 0;
+	for (UINT e = 0; e < g_nSpkrNumEdges; e++)
+	{
+		const SpkrEdge& edge = g_spkrEdges[e];
+		const UINT nEdgeCycle = (UINT) (edge.cycle - g_nBlepCycle);
+		const UINT nSample = nEdgeCycle / nClks;			// <= nNumSamples
+		const UINT nPhase = nEdgeCycle % nClks;
+
+		const float fDelta = (float) (edge.level - g_nBlepLevel);
+		g_nBlepLevel = edge.level;
+
+		const float* pKernel = &g_blepKernel[nPhase * kBlepWidth];
+		float* pDelta = &g_blepDelta[nSample];
+		for (UINT k = 0; k < kBlepWidth; k++)
+			pDelta[k] += fDelta * pKernel[k];
+
+		if (g_nBlepTail < nSample + kBlepWidth)
+			g_nBlepTail = nSample + kBlepWidth;
+
+		if (edge.bResetDCFilter)
+		{
+			if (g_uDCFilterState >= 32768 + (nSample - nFrom))
+			{
+				// Full gain up to this edge, so no need to split the output pass here
+				ResetDCFilter();
+				g_uDCFilterState += nSample - nFrom;
+			}
+			else
+			{
+				BlepOutput(nFrom, nSample);
+				ResetDCFilter();
+				nFrom = nSample;
+			}
+		}
+	}
+
+	g_nSpkrNumEdges = 0;
+
+	BlepOutput(nFrom, nNumSamples);
+
+	// Shift the delta buffer's tail down to [0]
+	if (g_nBlepTail > nNumSamples)
+	{
+		memmove(g_blepDelta, &g_blepDelta[nNumSamples], (g_nBlepTail - nNumSamples) * sizeof(float));
+		memset(&g_blepDelta[g_nBlepTail - nNumSamples], 0, nNumSamples * sizeof(float));
+		g_nBlepTail -= nNumSamples;
+	}
+	else
+	{
+		memset(g_blepDelta, 0, g_nBlepTail * sizeof(float));
+		g_nBlepTail = 0;
+		g_fBlepLevel = (float) g_nBlepLevel;	// Settled: so remove any accumulated rounding error
+	}
+
+	g_nBlepCycle += (unsigned __int64)nNumSamples * nClks;
+}
+
+static void SpkrAddEdge(void)
+{
+	if (g_nSpkrNumEdges == kMaxSpkrEdges)
+		UpdateSpkr();
+
+	if (g_nSpkrNumEdges)
+		g_spkrEdges[g_nSpkrNumEdges-1].level = g_nSpeakerData;
+
+	SpkrEdge& edge = g_spkrEdges[g_nSpkrNumEdges++];
+	edge.cycle = g_nCumulativeCycles;
+	edge.level = g_nSpeakerData;
+	// When full-speed: Don't ResetDCFilter(), otherwise get occasional clicks when speaker toggled
+	edge.bResetDCFilter = SpkrRenderAsNormalSpeed();
+}
+
+void Spkr_SetBandLimited(bool bEnable)
+{
+	g_bSpkrBlep = bEnable;
+}
+
 //=============================================================================
 
 static void SetClksPerSpkrSample()
@@ -195,6 +408,8 @@ static void InitRemainderBuffer()
 	memset(g_pRemainderBuffer, 0, g_nRemainderBufferSize);
 
 	g_nRemainderBufferIdx = 0;
+
+	InitBlepState();
 }
 
 //
@@ -209,14 +424,22 @@ void SpkrDestroy ()
 
 	//
 
-	if(soundtype == SOUND_WAVE)
-	{
-		delete [] g_pSpeakerBuffer;
-		delete [] g_pRemainderBuffer;
-		
-		g_pSpeakerBuffer = NULL;
-		g_pRemainderBuffer = NULL;
-	}
+	delete [] g_pSpeakerBuffer;
+	delete [] g_pRemainderBuffer;
+
+	g_pSpeakerBuffer = NULL;
+	g_pRemainderBuffer = NULL;
+}
+
+//=============================================================================
+
+static void InitSpeakerBuffers(void)
+{
+	InitRemainderBuffer();
+
+	if (!g_pSpeakerBuffer)
+		g_pSpeakerBuffer = new short [SPKR_SAMPLE_RATE];	// Buffer can hold a max of 1 seconds worth of samples
+	g_nBufferIdx = 0;
 }
 
 //=============================================================================
@@ -259,12 +482,8 @@ void SpkrInitialize ()
 
 	//
 
-	if (soundtype == SOUND_WAVE)
-	{
-		InitRemainderBuffer();
-
-		g_pSpeakerBuffer = new short [SPKR_SAMPLE_RATE];	// Buffer can hold a max of 1 seconds worth of samples
-	}
+	if (SpkrIsRendering())
+		InitSpeakerBuffers();
 }
 
 //=============================================================================
@@ -272,7 +491,7 @@ void SpkrInitialize ()
 // NB. Called when /g_fCurrentCLK6502/ changes
 void SpkrReinitialize ()
 {
-	if (soundtype == SOUND_WAVE)
+	if (SpkrIsRendering())
 	{
 		InitRemainderBuffer();
 	}
@@ -301,6 +520,8 @@ void SpkrSetEmulationType (SoundType_e newtype)
   soundtype = newtype;
   if (soundtype != SOUND_NONE)
     SpkrInitialize();
+  else if (g_bSpkrPullMode)
+    InitSpeakerBuffers();
 }
 
 //=============================================================================
@@ -343,7 +564,16 @@ static void UpdateRemainderBuffer(ULONG* pnCycleDiff)
 
 static void UpdateSpkr()
 {
-  if(!g_bFullSpeed || SoundCore_GetTimerState())
+  const UINT nBufferIdx = g_nBufferIdx;
+
+  if(g_bSpkrBlep)
+  {
+	  if(SpkrRenderAsNormalSpeed() || SoundCore_GetTimerState())
+		  UpdateSpkrBlep();
+	  else
+		  InitBlepState();
+  }
+  else if(SpkrRenderAsNormalSpeed() || SoundCore_GetTimerState())
   {
 	  ULONG nCycleDiff = (ULONG) (g_nCumulativeCycles - g_nSpkrLastCycle);
 
@@ -360,6 +590,9 @@ static void UpdateSpkr()
   }
 
   g_nSpkrLastCycle = g_nCumulativeCycles;
+
+  if (g_nBufferIdx > nBufferIdx)
+	  AudioCapture_Submit(AUDIOCAPTURE_SPEAKER, &g_pSpeakerBuffer[nBufferIdx], g_nBufferIdx - nBufferIdx, 1, g_fCurrentCLK6502 / g_nClksPerSpkrSample);	// NB. not SPKR_SAMPLE_RATE, as a sample is a whole # of cycles
 }
 
 //=============================================================================
@@ -383,18 +616,26 @@ BYTE __stdcall SpkrToggle (WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
     extbench = 0;
   }
 
-  if (soundtype == SOUND_WAVE)
+  if (SpkrIsRendering())
   {
 	  CpuCalcCycles(nExecutedCycles);
 
-	  UpdateSpkr();
+#ifdef LOG_PERF_TIMINGS
+	  extern UINT64 g_timeSpeakerToggle;
+	  PerfMarker perfMarker(g_timeSpeakerToggle);
+#endif
+
+	  if (g_bSpkrBlep)
+		  SpkrAddEdge();	// NB. The DC filter is reset when this edge is rendered
+	  else
+		  UpdateSpkr();
 
       short speakerDriveLevel = SPKR_DATA_INIT;
       if (g_bQuieterSpeaker)	// quieten the speaker if 8 bit DAC in use
         speakerDriveLevel /= 4;	// NB. Don't shift -ve number right: undefined behaviour (MSDN says: implementation-dependent)
 
       // When full-speed: Don't ResetDCFilter(), otherwise get occasional clicks when speaker toggled
-      if (!g_bFullSpeed)
+      if (SpkrRenderAsNormalSpeed() && !g_bSpkrBlep)
         ResetDCFilter();
 
       if (g_nSpeakerData == speakerDriveLevel)
@@ -437,9 +678,13 @@ void SpkrUpdate (DWORD totalcycles)
 
   //
 
-  if (soundtype == SOUND_WAVE)
+  if (SpkrIsRendering())
   {
 	  UpdateSpkr();
+
+	  if (g_bSpkrPullMode)
+		  return;	// Samples are left in g_pSpeakerBuffer for Spkr_PullSamples()
+
 	  ULONG nSamplesUsed;
 
 	  if(g_bFullSpeed)
@@ -447,6 +692,9 @@ void SpkrUpdate (DWORD totalcycles)
 	  else
 		  nSamplesUsed = Spkr_SubmitWaveBuffer(g_pSpeakerBuffer, g_nBufferIdx);
 
+	  if(g_bFullSpeed && AudioCapture_IsActive())
+		  nSamplesUsed = g_nBufferIdx;	// All samples are captured, so don't let unplayed ones accumulate
+
 	  _ASSERT(nSamplesUsed <= g_nBufferIdx);
 	  memmove(g_pSpeakerBuffer, &g_pSpeakerBuffer[nSamplesUsed], g_nBufferIdx-nSamplesUsed);	// FIXME-TC: _Size * 2
 	  g_nBufferIdx -= nSamplesUsed;
@@ -471,6 +719,30 @@ void SpkrUpdate_Timer()
 
 //=============================================================================
 
+void Spkr_SetPullMode(bool bPullMode)
+{
+	g_bSpkrPullMode = bPullMode;
+
+	if (SpkrIsRendering())
+		InitSpeakerBuffers();	// Pull mode: allocated even if SOUND_NONE. NB. Drops any samples not yet submitted or pulled
+}
+
+// Headless: copy (and consume) up to nMaxSamples of mono 16-bit samples at SPKR_SAMPLE_RATE
+UINT Spkr_PullSamples(short* pBuffer, UINT nMaxSamples)
+{
+	if (!g_pSpeakerBuffer)
+		return 0;
+
+	const UINT nSamples = (g_nBufferIdx < nMaxSamples) ? g_nBufferIdx : nMaxSamples;
+	memcpy(pBuffer, g_pSpeakerBuffer, nSamples * sizeof(short));
+	memmove(g_pSpeakerBuffer, &g_pSpeakerBuffer[nSamples], (g_nBufferIdx - nSamples) * sizeof(short));
+	g_nBufferIdx -= nSamples;
+
+	return nSamples;
+}
+
+//=============================================================================
+
 static DWORD dwByteOffset = (DWORD)-1;
 static int nNumSamplesError = 0;
 static int nDbgSpkrCnt = 0;
@@ -504,7 +776,7 @@ static ULONG Spkr_SubmitWaveBuffer_FullSpeed(short* pSpeakerBuffer, ULONG nNumSa
 	//bool bBufferError = false;
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	HRESULT hr = SpeakerVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	HRESULT hr = DSGetCurrentPosition(&SpeakerVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if(FAILED(hr))
 		return nNumSamples;
 
@@ -576,7 +848,7 @@ static ULONG Spkr_SubmitWaveBuffer_FullSpeed(short* pSpeakerBuffer, ULONG nNumSa
 
 	if(nNumSamplesToUse >= 128)	// Limit the buffer unlock/locking to a minimum
 	{
-		hr = DSGetLock(SpeakerVoice.lpDSBvoice,
+		hr = DSGetLock(&SpeakerVoice,
 			dwByteOffset, (DWORD)nNumSamplesToUse * sizeof(short),
 			&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 			&pDSLockedBuffer1, &dwDSLockedBufferSize1);
@@ -647,8 +919,8 @@ static ULONG Spkr_SubmitWaveBuffer_FullSpeed(short* pSpeakerBuffer, ULONG nNumSa
 		}
 
 		// Commit sound buffer
-		hr = SpeakerVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-											(void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+		hr = DSUnlock(&SpeakerVoice, pDSLockedBuffer0, dwDSLockedBufferSize0,
+											pDSLockedBuffer1, dwDSLockedBufferSize1);
 		if(FAILED(hr))
 			return nNumSamples;
 
@@ -689,7 +961,7 @@ static ULONG Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples)
 	bool bBufferError = false;
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	HRESULT hr = SpeakerVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	HRESULT hr = DSGetCurrentPosition(&SpeakerVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if (FAILED(hr))
 	{
 		LogFileOutput("Spkr_SubmitWaveBuffer: GetCurrentPosition failed (%08X)\n", hr);
@@ -778,7 +1050,7 @@ static ULONG Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples)
 	{
 		//sprintf(szDbg, "[Submit]    C=%08X, PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X +++\n", nDbgSpkrCnt, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, dwByteOffset, nNumSamplesToUse); OutputDebugString(szDbg);
 
-		hr = DSGetLock(SpeakerVoice.lpDSBvoice,
+		hr = DSGetLock(&SpeakerVoice,
 			dwByteOffset, (DWORD)nNumSamplesToUse * sizeof(short),
 			&pDSLockedBuffer0, &dwDSLockedBufferSize0,
 			&pDSLockedBuffer1, &dwDSLockedBufferSize1);
@@ -802,8 +1074,8 @@ static ULONG Spkr_SubmitWaveBuffer(short* pSpeakerBuffer, ULONG nNumSamples)
 		}
 
 		// Commit sound buffer
-		hr = SpeakerVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-											(void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+		hr = DSUnlock(&SpeakerVoice, pDSLockedBuffer0, dwDSLockedBufferSize0,
+											pDSLockedBuffer1, dwDSLockedBufferSize1);
 		if (FAILED(hr))
 		{
 			LogFileOutput("Spkr_SubmitWaveBuffer: Unlock failed (%08X)\n", hr);
@@ -823,7 +1095,7 @@ void Spkr_Mute()
 {
 	if(SpeakerVoice.bActive && !SpeakerVoice.bMute)
 	{
-		HRESULT hr = SpeakerVoice.lpDSBvoice->SetVolume(DSBVOLUME_MIN);
+		HRESULT hr = DSSetVolume(&SpeakerVoice, DSBVOLUME_MIN);
 		LogFileOutput("Spkr_Mute: SetVolume(%d) res = %08X\n", DSBVOLUME_MIN, hr);
 		SpeakerVoice.bMute = true;
 	}
@@ -834,7 +1106,7 @@ void Spkr_Unmute()
 {
 	if(SpeakerVoice.bActive && SpeakerVoice.bMute)
 	{
-		HRESULT hr = SpeakerVoice.lpDSBvoice->SetVolume(SpeakerVoice.nVolume);
+		HRESULT hr = DSSetVolume(&SpeakerVoice, SpeakerVoice.nVolume);
 		LogFileOutput("Spkr_Unmute: SetVolume(%d) res = %08X\n", SpeakerVoice.nVolume, hr);
 		SpeakerVoice.bMute = false;
 	}
@@ -884,7 +1156,7 @@ void SpkrSetVolume(DWORD dwVolume, DWORD dwVolumeMax)
 
 	if (SpeakerVoice.bActive && !SpeakerVoice.bMute)
 	{
-		HRESULT hr = SpeakerVoice.lpDSBvoice->SetVolume(SpeakerVoice.nVolume);
+		HRESULT hr = DSSetVolume(&SpeakerVoice, SpeakerVoice.nVolume);
 		LogFileOutput("SpkrSetVolume: SetVolume(%d) res = %08X\n", SpeakerVoice.nVolume, hr);
 	}
 }
@@ -924,13 +1196,13 @@ bool Spkr_DSInit()
 	if(!SpeakerVoice.nVolume)
 		SpeakerVoice.nVolume = DSBVOLUME_MAX;
 
-	hr = SpeakerVoice.lpDSBvoice->SetVolume(SpeakerVoice.nVolume);
+	hr = DSSetVolume(&SpeakerVoice, SpeakerVoice.nVolume);
 	LogFileOutput("Spkr_DSInit: SetVolume(%d) res = %08X\n", SpeakerVoice.nVolume, hr);
 
 	//
 
 	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	hr = SpeakerVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	hr = DSGetCurrentPosition(&SpeakerVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 	if (FAILED(hr))
 		LogFileOutput("Spkr_DSInit: GetCurrentPosition failed (%08X)\n", hr);
 	if (SUCCEEDED(hr) && (dwCurrentPlayCursor == dwCurrentWriteCursor))
@@ -939,7 +1211,7 @@ bool Spkr_DSInit()
 		// . Not required for my Win98SE/WinXP PC with PCI "Soundblaster Live!"
 		Sleep(200);
 
-		hr = SpeakerVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+		hr = DSGetCurrentPosition(&SpeakerVoice, &dwCurrentPlayCursor, &dwCurrentWriteCursor);
 		LogFileOutput("Spkr_DSInit: GetCurrentPosition kludge (%08X)\n", hr);
 		char szDbg[100];
 		sprintf(szDbg, "[DSInit] PC=%08X, WC=%08X, Diff=%08X\n", dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor); OutputDebugString(szDbg);
@@ -950,7 +1222,7 @@ bool Spkr_DSInit()
 
 static void Spkr_DSUninit()
 {
-	if(SpeakerVoice.lpDSBvoice && SpeakerVoice.bActive)
+	if(SpeakerVoice.HasBuffer() && SpeakerVoice.bActive)
 		DSVoiceStop(&SpeakerVoice);
 
 	DSReleaseSoundBuffer(&SpeakerVoice);
@@ -979,5 +1251,25 @@ void SpkrLoadSnapshot(YamlLoadHelper& yamlLoadHelper)
 
 	g_nSpkrLastCycle = yamlLoadHelper.LoadUint64(SS_YAML_KEY_LASTCYCLE);
 
+	InitBlepState();
+	g_nBlepCycle = g_nSpkrLastCycle;
+
 	yamlLoadHelper.PopMap();
 }
+
+//===========================================================================
+
+void SpkrSaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(g_nSpeakerData);
+}
+
+// Audio isn't rewound: just restore the speaker's level and restart the sample stream at the restored cycle
+void SpkrLoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(g_nSpeakerData);
+
+	g_nSpkrLastCycle = g_nCumulativeCycles;
+	g_nSpkrQuietCycleCount = g_nCumulativeCycles;
+	InitBlepState();
+}
@@ -30,7 +30,12 @@ void    Spkr_Mute();
 void    Spkr_Unmute();
 bool    Spkr_IsActive();
 bool    Spkr_DSInit();
+void    Spkr_SetPullMode(bool bPullMode);
+void    Spkr_SetBandLimited(bool bEnable);
+UINT    Spkr_PullSamples(short* pBuffer, UINT nMaxSamples);
 void    SpkrSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    SpkrLoadSnapshot(class YamlLoadHelper& yamlLoadHelper);
+void    SpkrSaveRewind(class RewindBuffer& buffer);
+void    SpkrLoadRewind(class RewindBuffer& buffer);
 
 BYTE __stdcall SpkrToggle (WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
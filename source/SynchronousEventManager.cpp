@@ -23,16 +23,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* Description: Synchronous Event Manager
  *
- * This manager class maintains a linked-list of ordered timer-based event,
- * where only the head of the list needs updating after every opcode.
+ * This manager class maintains a min-heap of timer-based events, ordered by the absolute cycle
+ * that each event expires on. So finding the next event is O(1), and insert/remove are O(log n).
+ * Only the head of the heap needs checking after every opcode.
  *
- * The Nth event in the list will expire in: event[1] + ... + event[N] cycles time.
- * (So each event has a cycle delta expiry time relative to the previous event.)
+ * The manager keeps its own absolute cycle count (advanced by Update(), so in step with g_nCumulativeCycles),
+ * and an event's expiry cycle is fixed when it's inserted: now + event.m_cyclesRemaining.
  *
  * A synchronous event is used for a deterministic event that will occur in N cycles' time,
  * eg. 6522 timer & Mousecard VBlank. (As opposed to async events, like SSC Rx/Tx interrupts.)
  *
- * Events that are active in the list can be removed before they expire,
+ * Events that are active in the heap can be removed before they expire,
  * eg. 6522 timer when the interval changes.
  *
  * Author: Various
@@ -43,92 +44,133 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "SynchronousEventManager.h"
 
-void SynchronousEventManager::Insert(SyncEvent* pNewEvent)
+void SynchronousEventManager::Reset(void)
 {
-	pNewEvent->m_active = true;	// add always succeeds
+	for (UINT i = 0; i < m_heap.size(); i++)
+		m_heap[i]->m_active = false;
+
+	m_heap.clear();
+	m_cycleNow = 0;
+	m_insertOrder = 0;
+}
+
+int SynchronousEventManager::GetCyclesUntilNextEvent(void) const
+{
+	if (m_heap.empty())
+		return kNoEventCycles;
+
+	const INT64 cycles = (INT64)(m_heap[0]->m_cycleExpire - m_cycleNow);
+	return cycles > kNoEventCycles ? kNoEventCycles : (int)cycles;
+}
+
+// Events that expire on the same cycle are ordered by insertion (ie. first-in, first-out)
+bool SynchronousEventManager::IsEarlier(const SyncEvent* pEventA, const SyncEvent* pEventB)
+{
+	if (pEventA->m_cycleExpire != pEventB->m_cycleExpire)
+		return pEventA->m_cycleExpire < pEventB->m_cycleExpire;
+
+	return pEventA->m_insertOrder < pEventB->m_insertOrder;
+}
+
+void SynchronousEventManager::SiftUp(UINT index)
+{
+	SyncEvent* pEvent = m_heap[index];
 
-	if (!m_syncEventHead)
+	while (index > 0)
 	{
-		m_syncEventHead = pNewEvent;
-		return;
+		const UINT parent = (index - 1) / 2;
+		if (!IsEarlier(pEvent, m_heap[parent]))
+			break;
+
+		m_heap[index] = m_heap[parent];
+		m_heap[index]->m_heapIndex = index;
+		index = parent;
 	}
 
-	// walk list to find where to insert new event
+	m_heap[index] = pEvent;
+	pEvent->m_heapIndex = index;
+}
 
-	SyncEvent* pPrevEvent = NULL;
-	SyncEvent* pCurrEvent = m_syncEventHead;
-	int newEventExtraCycles = pNewEvent->m_cyclesRemaining;
+void SynchronousEventManager::SiftDown(UINT index)
+{
+	SyncEvent* pEvent = m_heap[index];
+	const UINT size = m_heap.size();
 
-	while (pCurrEvent)
+	while (1)
 	{
-		if (newEventExtraCycles >= pCurrEvent->m_cyclesRemaining)
-		{
-			newEventExtraCycles -= pCurrEvent->m_cyclesRemaining;
+		UINT child = index * 2 + 1;
+		if (child >= size)
+			break;
 
-			pPrevEvent = pCurrEvent;
-			pCurrEvent = pCurrEvent->m_next;
+		if (child + 1 < size && IsEarlier(m_heap[child + 1], m_heap[child]))
+			child++;
 
-			if (!pCurrEvent)	// end of list
-			{
-				pPrevEvent->m_next = pNewEvent;
-				pNewEvent->m_cyclesRemaining = newEventExtraCycles;
-			}
+		if (!IsEarlier(m_heap[child], pEvent))
+			break;
 
-			continue;
-		}
+		m_heap[index] = m_heap[child];
+		m_heap[index]->m_heapIndex = index;
+		index = child;
+	}
 
-		// insert new event
-		if (!pPrevEvent)
-			m_syncEventHead = pNewEvent;
-		else
-			pPrevEvent->m_next = pNewEvent;
-		pNewEvent->m_next = pCurrEvent;
+	m_heap[index] = pEvent;
+	pEvent->m_heapIndex = index;
+}
 
-		pNewEvent->m_cyclesRemaining = newEventExtraCycles;
+void SynchronousEventManager::Insert(SyncEvent* pNewEvent)
+{
+	_ASSERT(!pNewEvent->m_active);
+	pNewEvent->m_active = true;	// add always succeeds
 
-		// update cycles for next event
-		if (pCurrEvent)
-		{
-			pCurrEvent->m_cyclesRemaining -= newEventExtraCycles;
-			_ASSERT(pCurrEvent->m_cyclesRemaining >= 0);
-		}
+	pNewEvent->m_cycleExpire = m_cycleNow + pNewEvent->m_cyclesRemaining;
+	pNewEvent->m_insertOrder = m_insertOrder++;
 
-		return;
-	}
+	m_heap.push_back(pNewEvent);
+	SiftUp(m_heap.size() - 1);
 }
 
-bool SynchronousEventManager::Remove(int id)
+void SynchronousEventManager::RemoveAt(UINT index)
 {
-	SyncEvent* pPrevEvent = NULL;
-	SyncEvent* pCurrEvent = m_syncEventHead;
+	SyncEvent* pEvent = m_heap[index];
+	pEvent->m_active = false;
 
-	while (pCurrEvent)
-	{
-		if (pCurrEvent->m_id != id)
-		{
-			pPrevEvent = pCurrEvent;
-			pCurrEvent = pCurrEvent->m_next;
-			continue;
-		}
+	SyncEvent* pLastEvent = m_heap.back();
+	m_heap.pop_back();
+
+	if (pLastEvent == pEvent)
+		return;	// was the last entry
 
-		// remove event
-		if (!pPrevEvent)
-			m_syncEventHead = pCurrEvent->m_next;
-		else
-			pPrevEvent->m_next = pCurrEvent->m_next;
+	// Move the last entry into the hole, then restore the heap order
+	m_heap[index] = pLastEvent;
+	pLastEvent->m_heapIndex = index;
 
-		int oldEventExtraCycles = pCurrEvent->m_cyclesRemaining;
-		pPrevEvent = pCurrEvent;
-		pCurrEvent = pCurrEvent->m_next;
+	if (index > 0 && IsEarlier(pLastEvent, m_heap[(index - 1) / 2]))
+		SiftUp(index);
+	else
+		SiftDown(index);
+}
 
-		pPrevEvent->m_active = false;
-		pPrevEvent->m_next = NULL;
+bool SynchronousEventManager::Remove(SyncEvent* pEvent)
+{
+	if (!pEvent->m_active || pEvent->m_heapIndex >= m_heap.size() || m_heap[pEvent->m_heapIndex] != pEvent)
+	{
+		_ASSERT(0);
+		return false;
+	}
 
-		// update cycles for next event
-		if (pCurrEvent)
-			pCurrEvent->m_cyclesRemaining += oldEventExtraCycles;
+	RemoveAt(pEvent->m_heapIndex);
+	return true;
+}
 
-		return true;
+bool SynchronousEventManager::Remove(int id)
+{
+	for (UINT i = 0; i < m_heap.size(); i++)
+	{
+		if (m_heap[i]->m_id == id)
+		{
+			RemoveAt(i);
+			return true;
+		}
 	}
 
 	_ASSERT(0);
@@ -137,31 +179,44 @@ bool SynchronousEventManager::Remove(int id)
 
 extern bool g_irqOnLastOpcodeCycle;
 
-void SynchronousEventManager::Update(int cycles, ULONG uExecutedCycles)
+// Fire all events that have expired, in expiry order
+// . The 1st event's callback gets the opcode's cycles; each subsequent event's callback gets the cycles since the previous event expired
+// . Periodic events (callback returns non-zero) are re-inserted relative to now, after all the callbacks have run
+void SynchronousEventManager::UpdateExpired(int cycles, ULONG uExecutedCycles)
 {
-	SyncEvent* pCurrEvent = m_syncEventHead;
+	const UINT kMaxExpired = 32;
+	SyncEvent* expired[kMaxExpired];
+	UINT numExpired = 0;
 
-	if (!pCurrEvent)
-		return;
-
-	pCurrEvent->m_cyclesRemaining -= cycles;
-	if (pCurrEvent->m_cyclesRemaining <= 0)
+	while (!m_heap.empty() && IsExpired(m_heap[0]))
 	{
-		if (pCurrEvent->m_cyclesRemaining == 0)
+		SyncEvent* pCurrEvent = m_heap[0];
+
+		if (pCurrEvent->m_cycleExpire == m_cycleNow)
 			g_irqOnLastOpcodeCycle = true;		// IRQ occurs on last cycle of opcode
 
-		int cyclesUnderflowed = -pCurrEvent->m_cyclesRemaining;
+		const int cyclesUnderflowed = (int)(m_cycleNow - pCurrEvent->m_cycleExpire);
 
+		RemoveAt(0);
 		pCurrEvent->m_cyclesRemaining = pCurrEvent->m_callback(pCurrEvent->m_id, cycles, uExecutedCycles);
-		m_syncEventHead = pCurrEvent->m_next;	// unlink this event
-
-		pCurrEvent->m_active = false;
-		pCurrEvent->m_next = NULL;
-
-		// Always Update even if cyclesUnderflowed=0, as next event may have cycleRemaining=0 (ie. the 2 events fire at the same time)
-		Update(cyclesUnderflowed, uExecutedCycles);	// update (potential) next event with underflow cycles
 
 		if (pCurrEvent->m_cyclesRemaining)
-			Insert(pCurrEvent);	// re-add event
+		{
+			if (numExpired == kMaxExpired)
+			{
+				_ASSERT(0);	// too many simultaneous periodic events: re-add now (ie. out of order for any events that also fire on this cycle)
+				Insert(pCurrEvent);
+			}
+			else
+			{
+				expired[numExpired++] = pCurrEvent;
+			}
+		}
+
+		cycles = cyclesUnderflowed;	// next event (if any) gets the underflow cycles
 	}
+
+	// Re-add periodic events, last-expired first
+	while (numExpired)
+		Insert(expired[--numExpired]);
 }
@@ -5,20 +5,45 @@ class SyncEvent;
 class SynchronousEventManager
 {
 public:
-	SynchronousEventManager() : m_syncEventHead(NULL)
-	{}
+	SynchronousEventManager() : m_cycleNow(0), m_insertOrder(0)
+	{
+		m_heap.reserve(kInitialHeapSize);
+	}
 	~SynchronousEventManager(){}
 
-	SyncEvent* GetHead(void) { return m_syncEventHead; }
-	void SetHead(SyncEvent* head) { m_syncEventHead = head; }
+	bool IsEmpty(void) const { return m_heap.empty(); }
+
+	// O(1): #cycles until the earliest event expires (<=0 if it's due), or kNoEventCycles if there are no events
+	int GetCyclesUntilNextEvent(void) const;
+	static const int kNoEventCycles = 0x7FFFFFFF;
 
 	void Insert(SyncEvent* pNewEvent);
 	bool Remove(int id);
-	void Update(int cycles, ULONG uExecutedCycles);
-	void Reset(void) { m_syncEventHead = NULL; }
+	bool Remove(SyncEvent* pEvent);
+
+	// Called after every opcode (so needs to be cheap when no event has expired)
+	void Update(int cycles, ULONG uExecutedCycles)
+	{
+		m_cycleNow += cycles;
+		if (!m_heap.empty() && IsExpired(m_heap[0]))
+			UpdateExpired(cycles, uExecutedCycles);
+	}
+
+	void Reset(void);
 
 private:
-	SyncEvent* m_syncEventHead;
+	bool IsExpired(const SyncEvent* pEvent) const;
+	void UpdateExpired(int cycles, ULONG uExecutedCycles);
+	static bool IsEarlier(const SyncEvent* pEventA, const SyncEvent* pEventB);
+	void SiftUp(UINT index);
+	void SiftDown(UINT index);
+	void RemoveAt(UINT index);
+
+	static const UINT kInitialHeapSize = 16;
+
+	std::vector<SyncEvent*> m_heap;	// min-heap, ordered by absolute expiry cycle
+	UINT64 m_cycleNow;				// absolute cycle count (advanced by Update())
+	UINT64 m_insertOrder;			// events that expire on the same cycle fire in the order they were inserted
 };
 
 //
@@ -33,7 +58,9 @@ public:
 		m_cyclesRemaining(initCycles),
 		m_active(false),
 		m_callback(callback),
-		m_next(NULL)
+		m_cycleExpire(0),
+		m_insertOrder(0),
+		m_heapIndex(0)
 	{}
 	~SyncEvent(){}
 
@@ -43,8 +70,19 @@ public:
 	}
 
 	int m_id;
-	int m_cyclesRemaining;
+	int m_cyclesRemaining;	// #cycles from Insert() until the event expires
 	bool m_active;
 	syncEventCB m_callback;
-	SyncEvent* m_next;
+
+	// Owned by SynchronousEventManager
+	UINT64 m_cycleExpire;	// absolute cycle that the event expires on
+	UINT64 m_insertOrder;
+	UINT m_heapIndex;
 };
+
+//
+
+inline bool SynchronousEventManager::IsExpired(const SyncEvent* pEvent) const
+{
+	return pEvent->m_cycleExpire <= m_cycleNow;
+}
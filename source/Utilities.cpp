@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "MouseInterface.h"
 #include "ParallelPrinter.h"
 #include "Registry.h"
+#include "Rewind.h"
 #include "Riff.h"
 #include "SaveState.h"
 #include "SerialComms.h"
@@ -564,6 +565,8 @@ void ResetMachineState()
 
 	SoundCore_SetFade(FADE_NONE);
 	LogFileTimeUntilFirstKeyReadReset();
+
+	Rewind_Reset();
 }
 
 
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Registry.h"
 #include "NTSC.h"
 #include "RGBMonitor.h"
+#include "Rewind.h"
 #include "YamlHelper.h"
 
 #define  SW_80COL         (g_uVideoMode & VF_80COL)
@@ -273,6 +274,26 @@ void Video::VideoLoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
 	yamlLoadHelper.PopMap();
 }
 
+//===========================================================================
+
+void Video::VideoSaveRewind(RewindBuffer& buffer)
+{
+	buffer.Save(g_nAltCharSetOffset);
+	buffer.Save(g_uVideoMode);
+	buffer.Save(g_dwCyclesThisFrame);
+}
+
+void Video::VideoLoadRewind(RewindBuffer& buffer)
+{
+	buffer.Load(g_nAltCharSetOffset);
+	buffer.Load(g_uVideoMode);
+	buffer.Load(g_dwCyclesThisFrame);
+
+	NTSC_VideoClockResync(g_dwCyclesThisFrame);
+	NTSC_SetVideoTextMode( g_uVideoMode &  VF_80COL ? 80 : 40 );
+	NTSC_SetVideoMode( g_uVideoMode );	// Pre-condition: g_nVideoClockHorz (derived from g_dwCyclesThisFrame)
+}
+
 //===========================================================================
 //
 // References to Jim Sather's books are given as eg:
@@ -413,25 +434,25 @@ WORD Video::VideoGetScannerAddress(DWORD nCycles, VideoScanner_e videoScannerAdd
 // Called when *outside* of CpuExecute()
 bool Video::VideoGetVblBarEx(const DWORD dwCyclesThisFrame)
 {
-	if (g_bFullSpeed)
+	if (NTSC_IsVideoClockStale())
 	{
 		// Ensure that NTSC video-scanner gets updated during full-speed, so video screen can be redrawn during Apple II VBL
 		NTSC_VideoClockResync(dwCyclesThisFrame);
 	}
 
-	return g_nVideoClockVert < kVDisplayableScanLines;
+	return NTSC_GetVideoClockVert() < kVDisplayableScanLines;
 }
 
 // Called when *inside* CpuExecute()
 bool Video::VideoGetVblBar(const DWORD uExecutedCycles)
 {
-	if (g_bFullSpeed)
+	if (NTSC_IsVideoClockStale())
 	{
 		// Ensure that NTSC video-scanner gets updated during full-speed, so video-dependent Apple II code doesn't hang
 		NTSC_VideoClockResync(CpuGetCyclesThisVideoFrame(uExecutedCycles));
 	}
 
-	return g_nVideoClockVert < kVDisplayableScanLines;
+	return NTSC_GetVideoClockVert() < kVDisplayableScanLines;
 }
 
 //===========================================================================
@@ -473,6 +494,8 @@ void Video::Video_SetBitmapHeader(WinBmpHeader_t *pBmp, int nWidth, int nHeight,
 
 void Video::Video_MakeScreenShot(FILE *pFile, const VideoScreenShot_e ScreenShotType)
 {
+	NTSC_VideoWaitForRender();
+
 	WinBmpHeader_t *pBmp = &g_tBmpHeader;
 
 	Video_SetBitmapHeader(
@@ -231,6 +231,8 @@ public:
 
 	void VideoSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 	void VideoLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
+	void VideoSaveRewind(class RewindBuffer& buffer);
+	void VideoLoadRewind(class RewindBuffer& buffer);
 
 	enum VideoScreenShot_e
 	{
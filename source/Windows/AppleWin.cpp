@@ -30,16 +30,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "Windows/AppleWin.h"
 #include "Windows/HookFilter.h"
+#include "AudioCapture.h"
+#include "Benchmark.h"
 #include "Interface.h"
 #include "Utilities.h"
 #include "CmdLine.h"
 #include "Debug.h"
+#include "DiskImage.h"
 #include "Log.h"
 #include "Memory.h"
 #include "Mockingboard.h"
 #include "MouseInterface.h"
 #include "ParallelPrinter.h"
 #include "Registry.h"
+#include "Rewind.h"
 #include "Riff.h"
 #include "SaveState.h"
 #include "SoundCore.h"
@@ -160,7 +164,8 @@ static void ContinueExecution(void)
 		{
 			// NB. For MODE_STEPPING: GetKeyState() is slow, so only call periodically
 			// . 0x3FFF is roughly the number of cycles in a video frame, which seems a reasonable rate to call GetKeyState()
-			if ((g_uModeStepping_Cycles & 0x3FFF) == 0)
+			// . GO in batches: ~1ms of cycles per call, so just call it every time
+			if (IsDebugSteppingBatched() || (g_uModeStepping_Cycles & 0x3FFF) == 0)
 				g_uModeStepping_LastGetKey_ScrollLock = GetKeyState(VK_SCROLL) < 0;
 
 			bScrollLock_FullSpeed = g_uModeStepping_LastGetKey_ScrollLock;
@@ -169,6 +174,7 @@ static void ContinueExecution(void)
 
 	const bool bWasFullSpeed = g_bFullSpeed;
 	g_bFullSpeed =	 (g_dwSpeed == SPEED_MAX) || 
+					 AudioCapture_IsActive() ||		// Capture is sample-exact at any speed
 					 bScrollLock_FullSpeed ||
 					 (GetCardMgr().GetDisk2CardMgr().IsConditionForFullSpeed() && !Spkr_IsActive() && !MB_IsActive()) ||
 					 IsDebugSteppingAtFullSpeed();
@@ -210,10 +216,10 @@ static void ContinueExecution(void)
 	const UINT uCyclesToExecuteWithFeedback = (nCyclesWithFeedback >= 0) ? nCyclesWithFeedback
 																		 : 0;
 
-	const DWORD uCyclesToExecute = (g_nAppMode == MODE_RUNNING)		? uCyclesToExecuteWithFeedback
-												/* MODE_STEPPING */ : 0;
+	const DWORD uCyclesToExecute = (g_nAppMode == MODE_RUNNING || IsDebugSteppingBatched())	? uCyclesToExecuteWithFeedback
+																		/* MODE_STEPPING */ : 0;
 
-	const bool bVideoUpdate = !g_bFullSpeed;
+	const bool bVideoUpdate = !g_bFullSpeed || NTSC_VideoCaptureAtFullSpeed(g_dwCyclesThisFrame);
 	const DWORD uActualCyclesExecuted = CpuExecute(uCyclesToExecute, bVideoUpdate);
 	g_dwCyclesThisFrame += uActualCyclesExecuted;
 
@@ -221,6 +227,7 @@ static void ContinueExecution(void)
 	JoyUpdateButtonLatch(nExecutionPeriodUsec);	// Button latch time is independent of CPU clock frequency
 	PrintUpdate(uActualCyclesExecuted);
 	MB_PeriodicUpdate(uActualCyclesExecuted);
+	ImageUpdateDeferredWrites();
 
 	//
 
@@ -258,6 +265,8 @@ static void ContinueExecution(void)
 			GetFrame().VideoRedrawScreenDuringFullSpeed(g_dwCyclesThisFrame);
 		else
 			GetFrame().VideoPresentScreen(); // Just copy the output of our Apple framebuffer to the system Back Buffer
+
+		Rewind_OnVideoFrame();
 	}
 
 #ifdef LOG_PERF_TIMINGS
@@ -556,7 +565,7 @@ int APIENTRY WinMain(HINSTANCE passinstance, HINSTANCE, LPSTR lpCmdLine, int)
 					LogFileOutput("Main: CMouseInterface::dtor\n");
 				}
 
-				_ASSERT(g_SynchronousEventMgr.GetHead() == NULL);
+				_ASSERT(g_SynchronousEventMgr.IsEmpty());
 				g_SynchronousEventMgr.Reset();
 			}
 
@@ -797,6 +806,8 @@ static void RepeatInitialization(void)
 		MemInitialize();
 		LogFileOutput("Main: MemInitialize()\n");
 
+		Rewind_Reset();	// H/w config may have changed
+
 		// Show About dialog after creating main window (need g_hFrameWindow)
 		if (bShowAboutDlg)
 		{
@@ -871,6 +882,12 @@ static void RepeatInitialization(void)
 			g_cmdLine.bShutdown = true;
 		}
 
+		if (Benchmark_IsRequested() && !g_cmdLine.bShutdown)
+		{
+			Benchmark_RunFromCmdLine();
+			g_cmdLine.bShutdown = true;
+		}
+
 		if (g_cmdLine.bShutdown)
 		{
 			PostMessage(GetFrame().g_hFrameWindow, WM_DESTROY, 0, 0);	// Close everything down
@@ -1,12 +1,14 @@
 #include "StdAfx.h"
 
 #include "Windows/Win32Frame.h"
+#include "Benchmark.h"
 #include "Interface.h"
 #include "Core.h"
 #include "CPU.h"
 #include "Joystick.h"
 #include "Log.h"
 #include "Memory.h"
+#include "NTSC.h"
 #include "CardManager.h"
 #include "Debugger/Debug.h"
 #include "../resource/resource.h"
@@ -159,173 +161,33 @@ void Win32Frame::Benchmark(void)
 {
 	_ASSERT(g_nAppMode == MODE_BENCHMARK);
 	Sleep(500);
-	Video& video = GetVideo();
-
-	// PREPARE TWO DIFFERENT FRAME BUFFERS, EACH OF WHICH HAVE HALF OF THE
-	// BYTES SET TO 0x14 AND THE OTHER HALF SET TO 0xAA
-	int     loop;
-	LPDWORD mem32 = (LPDWORD)mem;
-	for (loop = 4096; loop < 6144; loop++)
-		*(mem32 + loop) = ((loop & 1) ^ ((loop & 0x40) >> 6)) ? 0x14141414
-		: 0xAAAAAAAA;
-	for (loop = 6144; loop < 8192; loop++)
-		*(mem32 + loop) = ((loop & 1) ^ ((loop & 0x40) >> 6)) ? 0xAAAAAAAA
-		: 0x14141414;
-
-	// SEE HOW MANY TEXT FRAMES PER SECOND WE CAN PRODUCE WITH NOTHING ELSE
-	// GOING ON, CHANGING HALF OF THE BYTES IN THE VIDEO BUFFER EACH FRAME TO
-	// SIMULATE THE ACTIVITY OF AN AVERAGE GAME
-	DWORD totaltextfps = 0;
-
-	video.SetVideoMode(VF_TEXT);
-	memset(mem + 0x400, 0x14, 0x400);
-	VideoRedrawScreen();
-	DWORD milliseconds = GetTickCount();
-	while (GetTickCount() == milliseconds);
-	milliseconds = GetTickCount();
-	DWORD cycle = 0;
-	do {
-		if (cycle & 1)
-			memset(mem + 0x400, 0x14, 0x400);
-		else
-			memcpy(mem + 0x400, mem + ((cycle & 2) ? 0x4000 : 0x6000), 0x400);
-		VideoPresentScreen();
-		if (cycle++ >= 3)
-			cycle = 0;
-		totaltextfps++;
-	} while (GetTickCount() - milliseconds < 1000);
-
-	// SEE HOW MANY HIRES FRAMES PER SECOND WE CAN PRODUCE WITH NOTHING ELSE
-	// GOING ON, CHANGING HALF OF THE BYTES IN THE VIDEO BUFFER EACH FRAME TO
-	// SIMULATE THE ACTIVITY OF AN AVERAGE GAME
-	DWORD totalhiresfps = 0;
-	video.SetVideoMode(VF_HIRES);
-	memset(mem + 0x2000, 0x14, 0x2000);
-	VideoRedrawScreen();
-	milliseconds = GetTickCount();
-	while (GetTickCount() == milliseconds);
-	milliseconds = GetTickCount();
-	cycle = 0;
-	do {
-		if (cycle & 1)
-			memset(mem + 0x2000, 0x14, 0x2000);
-		else
-			memcpy(mem + 0x2000, mem + ((cycle & 2) ? 0x4000 : 0x6000), 0x2000);
-		VideoPresentScreen();
-		if (cycle++ >= 3)
-			cycle = 0;
-		totalhiresfps++;
-	} while (GetTickCount() - milliseconds < 1000);
-
-	// DETERMINE HOW MANY 65C02 CLOCK CYCLES WE CAN EMULATE PER SECOND WITH
-	// NOTHING ELSE GOING ON
-	DWORD totalmhz10[2] = { 0,0 };	// bVideoUpdate & !bVideoUpdate
-	for (UINT i = 0; i < 2; i++)
-	{
-		CpuSetupBenchmark();
-		milliseconds = GetTickCount();
-		while (GetTickCount() == milliseconds);
-		milliseconds = GetTickCount();
-		do {
-			CpuExecute(100000, i == 0 ? true : false);
-			totalmhz10[i]++;
-		} while (GetTickCount() - milliseconds < 1000);
-	}
-
-	// IF THE PROGRAM COUNTER IS NOT IN THE EXPECTED RANGE AT THE END OF THE
-	// CPU BENCHMARK, REPORT AN ERROR AND OPTIONALLY TRACK IT DOWN
-	if ((regs.pc < 0x300) || (regs.pc > 0x400))
-		if (FrameMessageBox(
-			TEXT("The emulator has detected a problem while running ")
-			TEXT("the CPU benchmark.  Would you like to gather more ")
-			TEXT("information?"),
-			TEXT("Benchmarks"),
-			MB_ICONQUESTION | MB_YESNO | MB_SETFOREGROUND) == IDYES) {
-			BOOL error = 0;
-			WORD lastpc = 0x300;
-			int  loop = 0;
-			while ((loop < 10000) && !error) {
-				CpuSetupBenchmark();
-				CpuExecute(loop, true);
-				if ((regs.pc < 0x300) || (regs.pc > 0x400))
-					error = 1;
-				else {
-					lastpc = regs.pc;
-					++loop;
-				}
-			}
-			if (error) {
-				TCHAR outstr[256];
-				wsprintf(outstr,
-					TEXT("The emulator experienced an error %u clock cycles ")
-					TEXT("into the CPU benchmark.  Prior to the error, the ")
-					TEXT("program counter was at $%04X.  After the error, it ")
-					TEXT("had jumped to $%04X."),
-					(unsigned)loop,
-					(unsigned)lastpc,
-					(unsigned)regs.pc);
-				FrameMessageBox(
-					outstr,
-					TEXT("Benchmarks"),
-					MB_ICONINFORMATION | MB_SETFOREGROUND);
-			}
-			else
-				FrameMessageBox(
-					TEXT("The emulator was unable to locate the exact ")
-					TEXT("point of the error.  This probably means that ")
-					TEXT("the problem is external to the emulator, ")
-					TEXT("happening asynchronously, such as a problem in ")
-					TEXT("a timer interrupt handler."),
-					TEXT("Benchmarks"),
-					MB_ICONINFORMATION | MB_SETFOREGROUND);
-		}
 
-	// DO A REALISTIC TEST OF HOW MANY FRAMES PER SECOND WE CAN PRODUCE
-	// WITH FULL EMULATION OF THE CPU, JOYSTICK, AND DISK HAPPENING AT
-	// THE SAME TIME
-	DWORD realisticfps = 0;
-	memset(mem + 0x2000, 0xAA, 0x2000);
-	VideoRedrawScreen();
-	milliseconds = GetTickCount();
-	while (GetTickCount() == milliseconds);
-	milliseconds = GetTickCount();
-	cycle = 0;
-	do {
-		if (realisticfps < 10) {
-			int cycles = 100000;
-			while (cycles > 0) {
-				DWORD executedcycles = CpuExecute(103, true);
-				cycles -= executedcycles;
-				GetCardMgr().GetDisk2CardMgr().UpdateDriveState(executedcycles);
-				JoyUpdateButtonLatch(executedcycles);
-			}
-		}
-		if (cycle & 1)
-			memset(mem + 0x2000, 0xAA, 0x2000);
-		else
-			memcpy(mem + 0x2000, mem + ((cycle & 2) ? 0x4000 : 0x6000), 0x2000);
-		VideoRedrawScreen();
-		if (cycle++ >= 3)
-			cycle = 0;
-		realisticfps++;
-	} while (GetTickCount() - milliseconds < 1000);
+	// Same scenarios as the -benchmark cmd line switch (see Benchmark.cpp)
+	std::vector<BenchmarkResult> results;
+	Benchmark_Run(results);
 
 	// DISPLAY THE RESULTS
 	DisplayLogo();
-	TCHAR outstr[256];
-	wsprintf(outstr,
-		TEXT("Pure Video FPS:\t%u hires, %u text\n")
-		TEXT("Pure CPU MHz:\t%u.%u%s (video update)\n")
-		TEXT("Pure CPU MHz:\t%u.%u%s (full-speed)\n\n")
-		TEXT("EXPECTED AVERAGE VIDEO GAME\n")
-		TEXT("PERFORMANCE: %u FPS"),
-		(unsigned)totalhiresfps,
-		(unsigned)totaltextfps,
-		(unsigned)(totalmhz10[0] / 10), (unsigned)(totalmhz10[0] % 10), (LPCTSTR)(IS_APPLE2 ? TEXT(" (6502)") : TEXT("")),
-		(unsigned)(totalmhz10[1] / 10), (unsigned)(totalmhz10[1] % 10), (LPCTSTR)(IS_APPLE2 ? TEXT(" (6502)") : TEXT("")),
-		(unsigned)realisticfps);
+	std::string strResults;
+	for (UINT i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		char szLine[256];
+
+		if (!result.IsOK())
+			StringCbPrintf(szLine, sizeof(szLine), "%s:\t%s\n", result.name.c_str(), result.status.c_str());
+		else if (result.uCycles)
+			StringCbPrintf(szLine, sizeof(szLine), "%s:\t%.1f MHz\n", result.name.c_str(), result.GetMedianMHz());
+		else if (result.uFrames)
+			StringCbPrintf(szLine, sizeof(szLine), "%s:\t%.0f FPS\n", result.name.c_str(), result.uFrames / result.GetMedianSecs());
+		else
+			StringCbPrintf(szLine, sizeof(szLine), "%s:\t%.1f ms\n", result.name.c_str(), result.GetMedianSecs() * 1.e3);
+
+		strResults += szLine;
+	}
+
 	FrameMessageBox(
-		outstr,
+		strResults.c_str(),
 		TEXT("Benchmarks"),
 		MB_ICONINFORMATION | MB_SETFOREGROUND);
 }
@@ -448,6 +310,8 @@ void Win32Frame::DisplayLogo(void)
 
 void Win32Frame::VideoPresentScreen(void)
 {
+	NTSC_VideoWaitForRender();	// The render thread may still be rendering to the framebuffer
+
 	HDC hFrameDC = FrameGetDC();
 
 	if (hFrameDC)
@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "Windows/Win32Frame.h"
 #include "Windows/AppleWin.h"
+#include "DiskImage.h"
 #include "Interface.h"
 #include "Keyboard.h"
 #include "Log.h"
@@ -41,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "ParallelPrinter.h"
 #include "Pravets.h"
 #include "Registry.h"
+#include "Rewind.h"
 #include "SaveState.h"
 #include "SerialComms.h"
 #include "SoundCore.h"
@@ -574,7 +576,7 @@ void Win32Frame::FrameDrawDiskStatus()
 //===========================================================================
 void Win32Frame::FrameDrawDiskStatus( HDC passdc )
 {
-	if (mem == NULL)
+	if (memread[0] == NULL)
 		return;
 
 	if (g_nAppMode == MODE_LOGO)
@@ -599,14 +601,14 @@ void Win32Frame::FrameDrawDiskStatus( HDC passdc )
 	int nDisk2Track = disk2Card.GetTrack(DRIVE_2);
 
 	// Probe known OS's for Track/Sector
-	int  isProDOS = mem[ 0xBF00 ] == 0x4C;
+	int  isProDOS = MemReadByte( 0xBF00 ) == 0x4C;
 	bool isValid  = true;
 
 	// Try DOS3.3 Sector
 	if ( !isProDOS )
 	{
-		int nDOS33track  = mem[ 0xB7EC ];
-		int nDOS33sector = mem[ 0xB7ED ];
+		int nDOS33track  = MemReadByte( 0xB7EC );
+		int nDOS33sector = MemReadByte( 0xB7ED );
 
 		if ((nDOS33track  >= 0 && nDOS33track  < 40)
 		&&  (nDOS33sector >= 0 && nDOS33sector < 16))
@@ -967,7 +969,6 @@ LRESULT Win32Frame::WndProc(
       PrintDestroy();
       if (GetCardMgr().IsSSCInstalled())
 		GetCardMgr().GetSSC()->CommDestroy();
-      CpuDestroy();
       MemDestroy();
       SpkrDestroy();
       Destroy();
@@ -1175,6 +1176,11 @@ LRESULT Win32Frame::WndProc(
 			}
 			SoundCore_SetFade(FADE_IN);
 		}
+		else if (wparam == VK_F11 && KeybGetCtrlStatus())	// Rewind (Ctrl+F11)
+		{
+			if ((g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_PAUSED) && Rewind_Back())
+				VideoRedrawScreen();
+		}
 		else if (wparam == VK_F12)					// Load state (F12 or Ctrl+F12)
 		{
 			SoundCore_SetFade(FADE_OUT);
@@ -1197,6 +1203,7 @@ LRESULT Win32Frame::WndProc(
 					g_nAppMode = MODE_PAUSED;
 					SoundCore_SetFade(FADE_OUT);
 					RevealCursor();
+					ImageUpdateDeferredWrites(true);	// Don't wait for the quiet period: the user may copy the image while paused
 					break;
 				case MODE_PAUSED:
 					g_nAppMode = MODE_RUNNING;
@@ -11,9 +11,11 @@ enum AppMode_e g_nAppMode = MODE_RUNNING;
 SynchronousEventManager g_SynchronousEventMgr;
 
 // From Memory.cpp
+LPBYTE         memread[0x100];		// TODO: Init
 LPBYTE         memwrite[0x100];		// TODO: Init
-LPBYTE         mem          = NULL;	// TODO: Init
+BYTE           memreadram[0x100];
 LPBYTE         memdirty     = NULL;	// TODO: Init
+static LPBYTE  mem          = NULL;	// Flat 64K, paged in by init()
 iofunction		IORead[256] = {0};	// TODO: Init
 iofunction		IOWrite[256] = {0};	// TODO: Init
 
@@ -26,6 +28,11 @@ regsrec regs;
 
 bool g_irqOnLastOpcodeCycle = false;
 
+// From CPU.cpp
+static volatile LONG g_bmIRQ = 0;
+static volatile LONG g_bmNMI = 0;
+static volatile LONG g_bNmiFlank = FALSE;
+
 static eCpuType g_ActiveCPU = CPU_65C02;
 
 eCpuType GetActiveCpu(void)
@@ -52,6 +59,7 @@ static __forceinline void DoIrqProfiling(DWORD uCycles)
 
 static __forceinline void CheckSynchronousInterruptSources(UINT cycles, ULONG uExecutedCycles)
 {
+	g_SynchronousEventMgr.Update(cycles, uExecutedCycles);
 }
 
 static __forceinline bool NMI(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn, BOOL& flagv, BOOL& flagz)
@@ -59,9 +67,23 @@ static __forceinline bool NMI(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 	return false;
 }
 
+// IrqStress_test: take (but don't vector) an IRQ, recording when it was taken
+static volatile LONG g_irqTestTakeIRQ = FALSE;
+static volatile LONG g_irqTestTaken = FALSE;
+static WORD g_irqTestTakenPC = 0;
+static WORD g_irqTestTakenCount = 0;
+
 static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn, BOOL& flagv, BOOL& flagz)
 {
-	return false;
+	if (!g_irqTestTakeIRQ || !g_bmIRQ || (regs.ps & AF_INTERRUPT))
+		return false;
+
+	regs.ps |= AF_INTERRUPT;
+	g_irqTestTakenPC = regs.pc;
+	g_irqTestTakenCount = mem[0x10] | (mem[0x11] << 8);
+	g_irqTestTaken = TRUE;
+	uExecutedCycles += 7;
+	return true;
 }
 
 // From z80.cpp
@@ -79,10 +101,17 @@ void NTSC_VideoUpdateCycles( long cycles6502 )
 
 #include "../../source/CPU/cpu_general.inl"
 #include "../../source/CPU/cpu_instructions.inl"
+#include "../../source/CPU/cpu_blockcache.inl"
+#include "../../source/CPU/cpu_batch.inl"
+#include "../../source/CPU/cpu_interrupts.inl"
 
 #define READ _READ_WITH_IO_F8xx
 #define WRITE(a) _WRITE_WITH_IO_F8xx(a)
 #define HEATMAP_X(pc)
+#define HEATMAP_R(address) ((void)0)
+#define HEATMAP_W(address) ((void)0)
+#define BATCH_X(cpu, uExecutedCycles, uTotalCycles, uBatchOpcodes) Batch_Begin(cpu, uExecutedCycles, uTotalCycles, uBatchOpcodes)
+#define BREAKPOINT_X() false
 
 #include "../../source/CPU/cpu6502.h"  // MOS 6502
 
@@ -99,6 +128,10 @@ void NTSC_VideoUpdateCycles( long cycles6502 )
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef HEATMAP_R
+#undef HEATMAP_W
+#undef BATCH_X
+#undef BREAKPOINT_X
 
 //-------------------------------------
 
@@ -108,7 +141,10 @@ void init(void)
 	mem = (LPBYTE)calloc(64, 1024);
 
 	for (UINT i=0; i<256; i++)
-		memwrite[i] = mem+i*256;
+	{
+		memread[i] = memwrite[i] = mem+i*256;
+		memreadram[i] = 1;
+	}
 
 	memdirty = new BYTE[256];
 }
@@ -136,6 +172,12 @@ DWORD TestCpu65C02(DWORD uTotalCycles)
 	return Cpu65C02(uTotalCycles, true);
 }
 
+// Full-speed: runs batches of opcodes
+DWORD TestCpu(bool is6502, DWORD uTotalCycles, bool bVideoUpdate)
+{
+	return is6502 ? Cpu6502(uTotalCycles, bVideoUpdate) : Cpu65C02(uTotalCycles, bVideoUpdate);
+}
+
 //-------------------------------------
 
 int GH264_test(void)
@@ -1261,9 +1303,17 @@ int GH321_test()
 
 //-------------------------------------
 
+const UINT kMaxSyncEventsFired = 8;
+int g_syncEventsFired[kMaxSyncEventsFired];
+UINT g_numSyncEventsFired = 0;
+int g_syncEventPeriod = 0;	// for id==2
+
 int testCB(int id, int cycles, ULONG uExecutedCycles)
 {
-	return 0;
+	if (g_numSyncEventsFired < kMaxSyncEventsFired)
+		g_syncEventsFired[g_numSyncEventsFired++] = id;
+
+	return (id == 2) ? g_syncEventPeriod : 0;
 }
 
 int SyncEvents_test(void)
@@ -1273,21 +1323,22 @@ int SyncEvents_test(void)
 	SyncEvent syncEvent2(2, 0x30, testCB);
 	SyncEvent syncEvent3(3, 0x40, testCB);
 
+	g_SynchronousEventMgr.Reset();
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != SynchronousEventManager::kNoEventCycles) return 1;
+
 	g_SynchronousEventMgr.Insert(&syncEvent0);
 	g_SynchronousEventMgr.Insert(&syncEvent1);
 	g_SynchronousEventMgr.Insert(&syncEvent2);
 	g_SynchronousEventMgr.Insert(&syncEvent3);
-	// id0 -> id1 -> id2 -> id3
-	if (syncEvent0.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent1.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent2.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent3.m_cyclesRemaining != 0x10) return 1;
+	// id0 (0x10), id1 (0x20), id2 (0x30), id3 (0x40)
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x10) return 1;
 
 	g_SynchronousEventMgr.Remove(1);
 	g_SynchronousEventMgr.Remove(3);
 	g_SynchronousEventMgr.Remove(0);
-	if (syncEvent2.m_cyclesRemaining != 0x30) return 1;
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x30) return 1;
 	g_SynchronousEventMgr.Remove(2);
+	if (!g_SynchronousEventMgr.IsEmpty()) return 1;
 
 	//
 
@@ -1300,23 +1351,456 @@ int SyncEvents_test(void)
 	g_SynchronousEventMgr.Insert(&syncEvent1);
 	g_SynchronousEventMgr.Insert(&syncEvent2);
 	g_SynchronousEventMgr.Insert(&syncEvent3);
-	// id3 -> id2 -> id1 -> id0
-	if (syncEvent0.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent1.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent2.m_cyclesRemaining != 0x10) return 1;
-	if (syncEvent3.m_cyclesRemaining != 0x10) return 1;
+	// id3 (0x10), id2 (0x20), id1 (0x30), id0 (0x40)
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x10) return 1;
 
-	g_SynchronousEventMgr.Remove(3);
-	g_SynchronousEventMgr.Remove(0);
-	g_SynchronousEventMgr.Remove(1);
-	if (syncEvent2.m_cyclesRemaining != 0x20) return 1;
-	g_SynchronousEventMgr.Remove(2);
+	g_SynchronousEventMgr.Remove(&syncEvent3);
+	g_SynchronousEventMgr.Remove(&syncEvent0);
+	g_SynchronousEventMgr.Remove(&syncEvent1);
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x20) return 1;
+	g_SynchronousEventMgr.Remove(&syncEvent2);
+	if (!g_SynchronousEventMgr.IsEmpty()) return 1;
+
+	//
+	// Expiry: absolute cycle, order & underflow
 
+	g_numSyncEventsFired = 0;
+	g_syncEventPeriod = 0x18;
+	syncEvent0.m_cyclesRemaining = 0x20;
+	syncEvent1.m_cyclesRemaining = 0x20;	// same cycle as id0, so fires after id0
+	syncEvent2.m_cyclesRemaining = 0x10;	// periodic
+	syncEvent3.m_cyclesRemaining = 0x30;
+
+	g_SynchronousEventMgr.Insert(&syncEvent0);
+	g_SynchronousEventMgr.Insert(&syncEvent1);
+	g_SynchronousEventMgr.Insert(&syncEvent2);
+	g_SynchronousEventMgr.Insert(&syncEvent3);
+
+	g_irqOnLastOpcodeCycle = false;
+	g_SynchronousEventMgr.Update(0x0F, 0);
+	if (g_numSyncEventsFired != 0 || g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 1) return 1;
+
+	g_SynchronousEventMgr.Update(1, 0);	// cycle 0x10: id2 (then re-added for cycle 0x28)
+	if (g_numSyncEventsFired != 1 || g_syncEventsFired[0] != 2) return 1;
+	if (!g_irqOnLastOpcodeCycle) return 1;
+	if (!syncEvent2.m_active || g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x10) return 1;
+
+	g_irqOnLastOpcodeCycle = false;
+	g_SynchronousEventMgr.Update(0x12, 0);	// cycle 0x22: id0, id1 (both underflowed by 2 cycles)
+	if (g_numSyncEventsFired != 3 || g_syncEventsFired[1] != 0 || g_syncEventsFired[2] != 1) return 1;
+	if (g_irqOnLastOpcodeCycle) return 1;
+	if (syncEvent0.m_active || syncEvent1.m_active) return 1;
+	if (g_SynchronousEventMgr.GetCyclesUntilNextEvent() != 0x06) return 1;	// id2 at 0x28
+
+	g_syncEventPeriod = 0;
+	g_SynchronousEventMgr.Update(0x10, 0);	// cycle 0x32: id2, id3
+	if (g_numSyncEventsFired != 5 || g_syncEventsFired[3] != 2 || g_syncEventsFired[4] != 3) return 1;
+	if (!g_SynchronousEventMgr.IsEmpty()) return 1;
+
+	g_SynchronousEventMgr.Reset();
 	return 0;
 }
 
 //-------------------------------------
 
+const BYTE g_batchTestCode[] =
+{
+	0xA2, 0xC0,			// $300: LDX #$C0
+	0xA9, 0x00,			// $302: LDA #$00
+	0x18,				// $304: CLC
+	0x69, 0x03,			// $305: ADC #$03
+	0x9D, 0x00, 0x20,	// $307: STA $2000,X
+	0xE8,				// $30A: INX
+	0xD0, 0xF7,			// $30B: BNE $304
+	0x8D, 0x10, 0xC0,	// $30D: STA $C010	; reschedules the sync-event
+	0xAD, 0x10, 0xC0,	// $310: LDA $C010
+	0x4C, 0x00, 0x03,	// $313: JMP $300
+};
+
+const UINT kMaxBatchLog = 256;
+struct BatchLog
+{
+	ULONG cycles[kMaxBatchLog];	// sync-event: uExecutedCycles when fired; I/O: uExecutedCycles + cycles until next event
+	UINT num;
+};
+
+static BatchLog g_batchEventLog;
+static BatchLog g_batchIoLog;
+static SyncEvent g_batchSyncEvent(0, 0, NULL);
+
+static void BatchLog_Add(BatchLog& log, ULONG cycles)
+{
+	if (log.num < kMaxBatchLog)
+		log.cycles[log.num++] = cycles;
+}
+
+static int Batch_SyncEventCB(int id, int cycles, ULONG uExecutedCycles)
+{
+	BatchLog_Add(g_batchEventLog, uExecutedCycles);
+	return 0x100;
+}
+
+static BYTE __stdcall Batch_IO(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nExecutedCycles)
+{
+	// Only correct if the sync-events have been updated up to this opcode
+	BatchLog_Add(g_batchIoLog, nExecutedCycles + g_SynchronousEventMgr.GetCyclesUntilNextEvent());
+
+	if (write)
+	{
+		g_SynchronousEventMgr.Remove(&g_batchSyncEvent);
+		g_batchSyncEvent.SetCycles(0x30);
+		g_SynchronousEventMgr.Insert(&g_batchSyncEvent);
+	}
+
+	return 0x5A;
+}
+
+static DWORD Batch_Run(bool is6502, DWORD uTotalCycles, bool bVideoUpdate, bool bIrqMasked)
+{
+	reset();
+	if (bIrqMasked)
+		regs.ps = AF_INTERRUPT;	// and IRQ asserted: only blocks are batched
+	memcpy(mem+regs.pc, g_batchTestCode, sizeof(g_batchTestCode));
+	memdirty[regs.pc >> 8] = 0xFF;	// as if written by _WRITE
+	memset(mem+0x2000, 0, 0x100);
+	memset(&g_batchEventLog, 0, sizeof(g_batchEventLog));
+	memset(&g_batchIoLog, 0, sizeof(g_batchIoLog));
+
+	g_SynchronousEventMgr.Reset();
+	g_batchSyncEvent.m_callback = Batch_SyncEventCB;
+	g_batchSyncEvent.SetCycles(0x1F);
+	g_SynchronousEventMgr.Insert(&g_batchSyncEvent);
+
+	return TestCpu(is6502, uTotalCycles, bVideoUpdate);
+}
+
+int Batch_test(void)
+{
+	IORead[1] = IOWrite[1] = Batch_IO;
+	memwrite[0xC0] = NULL;	// so that _WRITE calls IOWrite[]
+
+	for (UINT i=0; i<4; i++)
+	{
+		const bool is6502 = (i & 1) == 0;
+		const bool bIrqMasked = (i & 2) != 0;
+		g_bmIRQ = bIrqMasked ? 1<<IS_MOUSE : 0;
+
+		const DWORD cycleCounts[] = {0, 1, 5, 17, 100, 1000, 12345};
+		for (UINT j=0; j<sizeof(cycleCounts)/sizeof(cycleCounts[0]); j++)
+		{
+			// Same result (cycles, regs, mem, sync-event & I/O timing) for per-opcode vs batched execution
+			const DWORD cycles = Batch_Run(is6502, cycleCounts[j], true, bIrqMasked);
+			const regsrec regsExpected = regs;
+			BYTE memExpected[0x100];
+			memcpy(memExpected, mem+0x2000, 0x100);
+			const BatchLog eventLogExpected = g_batchEventLog;
+			const BatchLog ioLogExpected = g_batchIoLog;
+
+			if (Batch_Run(is6502, cycleCounts[j], false, bIrqMasked) != cycles) return 1;
+			if (regs.a != regsExpected.a || regs.x != regsExpected.x || regs.pc != regsExpected.pc || regs.ps != regsExpected.ps) return 1;
+			if (memcmp(memExpected, mem+0x2000, 0x100) != 0) return 1;
+			if (memcmp(&eventLogExpected, &g_batchEventLog, sizeof(BatchLog)) != 0) return 1;
+			if (memcmp(&ioLogExpected, &g_batchIoLog, sizeof(BatchLog)) != 0) return 1;
+		}
+
+		if (g_batchEventLog.num < 8 || g_batchIoLog.num < 8) return 1;	// 12345 cycles: sanity check that both were exercised
+	}
+
+	g_bmIRQ = 0;
+
+	g_SynchronousEventMgr.Reset();
+	g_batchSyncEvent.SetCycles(0x1F);
+	g_SynchronousEventMgr.Insert(&g_batchSyncEvent);
+	reset();
+	UINT uBatchOpcodes = 0;
+	if (Batch_Begin(CPU_65C02, 50, 100, uBatchOpcodes) != 50+0x1F) return 1;	// ends on the opcode that reaches the sync-event
+	if (Batch_End(50) != 50) return 1;
+
+	// No batch while an unmasked IRQ is asserted (as IRQ() must see it on the next opcode)
+	g_bmIRQ = 1;
+	if (Batch_Begin(CPU_65C02, 50, 100, uBatchOpcodes) != 50) return 1;
+	Batch_End(50);
+
+	// ... and only the block at PC while it's masked
+	regs.ps = AF_INTERRUPT;
+	if (Batch_Begin(CPU_65C02, 50, 100, uBatchOpcodes) != 50+0x1F || uBatchOpcodes != 7) return 1;
+	Batch_End(50);
+	regs.pc = 0x30D;	// STA $C010
+	if (Batch_Begin(CPU_65C02, 50, 100, uBatchOpcodes) != 50) return 1;
+	Batch_End(50);
+	g_bmIRQ = 0;
+
+	IORead[1] = IOWrite[1] = NULL;
+	memwrite[0xC0] = mem+0xC000;
+	g_SynchronousEventMgr.Reset();
+	return 0;
+}
+
+//-------------------------------------
+
+int BlockCache_test(void)
+{
+	for (UINT i=0; i<2; i++)
+	{
+		const bool is6502 = (i == 0);
+		const eCpuType cpu = is6502 ? CPU_6502 : CPU_65C02;
+
+		reset();
+		memcpy(mem+regs.pc, g_batchTestCode, sizeof(g_batchTestCode));
+		memdirty[0x03] = 0xFF;	// as if written by _WRITE
+
+		if (BlockCache_GetOpcodes(0x300, cpu) != 7) return 1;	// ends with BNE
+		if (BlockCache_GetOpcodes(0x304, cpu) != 5) return 1;
+		if (BlockCache_GetOpcodes(0x30D, cpu) != 1) return 1;	// STA $C010
+		if (BlockCache_GetOpcodes(0x313, cpu) != 1) return 1;	// JMP
+
+		// Self-modifying code: STA $2000,X -> STA $C000 (I/O)
+		mem[0x307] = 0x8D;
+		mem[0x309] = 0xC0;
+		if (BlockCache_GetOpcodes(0x304, cpu) != 5) return 1;	// stale, as memdirty not set
+		memdirty[0x03] = 0xFF;
+		if (BlockCache_GetOpcodes(0x304, cpu) != 2) return 1;	// STA $C000 isn't part of the block
+		if (BlockCache_GetOpcodes(0x307, cpu) != 1) return 1;
+
+		// CLI ends a block, as it may unmask an IRQ
+		mem[0x307] = 0x58;
+		memdirty[0x03] = 0xFF;
+		if (BlockCache_GetOpcodes(0x304, cpu) != 3) return 1;
+
+		// Paging change (eg. to aux memory)
+		BYTE* pPage = new BYTE[256];
+		memcpy(pPage, mem+0x300, 256);
+		pPage[0x07] = 0x9D;
+		pPage[0x09] = 0x20;
+		memread[0x03] = pPage;
+		if (BlockCache_GetOpcodes(0x304, cpu) != 5) return 1;
+		memread[0x03] = mem+0x300;
+		if (BlockCache_GetOpcodes(0x304, cpu) != 3) return 1;
+		delete [] pPage;
+
+		// Memory loaded without setting memdirty (eg. save-state)
+		memcpy(mem+0x300, g_batchTestCode, sizeof(g_batchTestCode));
+		CpuBlockCacheFlush();
+		if (BlockCache_GetOpcodes(0x304, cpu) != 5) return 1;
+
+		// 6502: $F800-FFFF may be IO_F8xx
+		mem[0x308] = 0x00;
+		mem[0x309] = 0xF8;
+		memdirty[0x03] = 0xFF;
+		if (BlockCache_GetOpcodes(0x304, cpu) != (is6502 ? 2 : 5)) return 1;
+
+		// A block ends at the end of its page: the next page's opcodes (eg. CLI) aren't in it
+		memset(mem+0x300, 0xEA, 0x100);	// NOP
+		memdirty[0x03] = 0xFF;
+		mem[0x400] = 0x58;				// $400: CLI
+		memdirty[0x04] = 0xFF;
+		if (BlockCache_GetOpcodes(0x3FD, cpu) != 3) return 1;	// $3FD-3FF: NOP
+		mem[0x3FD] = 0xAD;				// $3FD: LDA $2000
+		mem[0x3FE] = 0x00;
+		mem[0x3FF] = 0x20;
+		memdirty[0x03] = 0xFF;
+		if (BlockCache_GetOpcodes(0x3FD, cpu) != 1) return 1;
+		if (BlockCache_GetOpcodes(0x400, cpu) != 1) return 1;
+
+		// Zero page & stack aren't cached
+		memcpy(mem+0x80, g_batchTestCode, sizeof(g_batchTestCode));
+		if (BlockCache_GetOpcodes(0x80, cpu) != 1) return 1;
+	}
+
+	return 0;
+}
+
+//-------------------------------------
+
+static volatile LONG g_irqStressStop = 0;
+static volatile LONG g_irqStressErrors = 0;
+
+static DWORD WINAPI IrqStress_Thread(LPVOID lpParameter)
+{
+	const eIRQSRC device = (eIRQSRC)(UINT_PTR)lpParameter;
+
+	while (!g_irqStressStop)
+	{
+		CpuIrqAssert(device);
+		if (!(g_bmIRQ & (1<<device)))
+			InterlockedIncrement(&g_irqStressErrors);
+		CpuIrqDeassert(device);
+
+		CpuNmiAssert(device);
+		CpuNmiDeassert(device);
+	}
+
+	return 0;
+}
+
+static volatile LONG g_irqAssertCount = 0;	// Loop count that the CPU had reached just after the IRQ was asserted
+
+static WORD IrqBatchExit_GetCount(void)
+{
+	volatile BYTE* pCount = mem+0x10;
+	return pCount[0] | (pCount[1] << 8);
+}
+
+static DWORD WINAPI IrqBatchExit_Thread(LPVOID lpParameter)
+{
+	// Wait until the CPU is well into its batch
+	while (IrqBatchExit_GetCount() < 0x100)
+		;
+
+	CpuIrqAssert(IS_SSC);
+	g_irqAssertCount = IrqBatchExit_GetCount();
+	return 0;
+}
+
+// No IRQ is held, so the CPU runs a single batch up to uTotalCycles, until another thread asserts an IRQ mid-batch:
+// g_bBatchExit must end the batch after the current opcode, and the IRQ is then taken
+static int IrqBatchExit_test(void)
+{
+	const BYTE code[] =
+	{
+		0xE6, 0x10,			// $300: INC $10
+		0xD0, 0xFC,			// $302: BNE $300
+		0xE6, 0x11,			// $304: INC $11
+		0x4C, 0x00, 0x03,	// $306: JMP $300
+	};
+
+	// Allow for the latency of the CPU thread seeing g_bBatchExit (8 cycles per loop, so 1000 loops is 8us at 1GHz)
+	const short kMaxLoopsAfterAssert = 1000;
+
+	g_irqTestTakeIRQ = TRUE;
+
+	int res = 0;
+	for (UINT i=0; i<20 && !res; i++)
+	{
+		CpuIrqReset();
+		reset();
+		memcpy(mem+regs.pc, code, sizeof(code));
+		memdirty[regs.pc >> 8] = 0xFF;	// as if written by _WRITE
+		mem[0x10] = mem[0x11] = 0;
+		g_SynchronousEventMgr.Reset();	// so no sync-event limits the batch
+		g_irqTestTaken = FALSE;
+
+		HANDLE hThread = CreateThread(NULL, 0, IrqBatchExit_Thread, NULL, 0, NULL);
+
+		// Each call is a single batch (unless the IRQ ends it)
+		const DWORD kTotalCycles = 10*1000*1000;
+		for (UINT n=0; n<100 && !g_irqTestTaken; n++)
+		{
+			if (TestCpu(i & 1, kTotalCycles, false) != kTotalCycles && !g_irqTestTaken)
+				res = 1;
+		}
+
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+
+		if (!g_irqTestTaken) res = 1;
+		if (g_irqTestTakenPC != 0x300 && g_irqTestTakenPC != 0x302 && g_irqTestTakenPC != 0x304 && g_irqTestTakenPC != 0x306) res = 1;
+		if ((short)(g_irqTestTakenCount - (WORD)g_irqAssertCount) > kMaxLoopsAfterAssert) res = 1;
+	}
+
+	g_irqTestTakeIRQ = FALSE;
+	return res;
+}
+
+int IrqStress_test(void)
+{
+	// Assert & deassert IRQs/NMIs from several threads, while the CPU runs
+	CpuIrqReset();
+	CpuNmiReset();
+	g_irqStressStop = 0;
+	g_irqStressErrors = 0;
+
+	// Held for the whole test: a lost update (eg. a non-atomic read-modify-write on another thread) would clear it
+	CpuIrqAssert(IS_MOUSE);
+
+	const eIRQSRC devices[] = {IS_6522, IS_SPEECH, IS_SSC};
+	const UINT kNumThreads = sizeof(devices)/sizeof(devices[0]);
+	HANDLE hThreads[kNumThreads];
+	for (UINT i=0; i<kNumThreads; i++)
+		hThreads[i] = CreateThread(NULL, 0, IrqStress_Thread, (LPVOID)(UINT_PTR)devices[i], 0, NULL);
+
+	const BYTE code[] =
+	{
+		0xA2, 0x00,			// $300: LDX #$00
+		0xE8,				// $302: INX
+		0xD0, 0xFD,			// $303: BNE $302
+		0x4C, 0x00, 0x03,	// $305: JMP $300
+	};
+
+	int res = 0;
+	for (UINT i=0; i<1000 && !res; i++)
+	{
+		reset();
+		memcpy(mem+regs.pc, code, sizeof(code));
+		TestCpu(i & 1, 10000, false);
+		if (!(g_bmIRQ & (1<<IS_MOUSE))) res = 1;
+	}
+
+	g_irqStressStop = 1;
+	WaitForMultipleObjects(kNumThreads, hThreads, TRUE, INFINITE);
+	for (UINT i=0; i<kNumThreads; i++)
+		CloseHandle(hThreads[i]);
+
+	if (res || g_irqStressErrors) return 1;
+	if (g_bmIRQ != (1<<IS_MOUSE)) return 1;
+	if (g_bmNMI != 0) return 1;
+
+	CpuIrqDeassert(IS_MOUSE);
+	if (g_bmIRQ != 0) return 1;
+
+	CpuNmiReset();
+
+	res = IrqBatchExit_test();
+	CpuIrqReset();
+	return res;
+}
+
+//-------------------------------------
+
+int MemWriteByte_test(void)
+{
+	// Page a ROM image in at $D000-$FFFF (like UpdatePaging() with !SW_HIGHRAM)
+	const UINT kRomSize = 0x3000;
+	BYTE* memrom = new BYTE[kRomSize];
+	for (UINT i=0; i<kRomSize; i++)
+		memrom[i] = (BYTE) (i ^ (i >> 8));
+
+	BYTE* memromExpected = new BYTE[kRomSize];
+	memcpy(memromExpected, memrom, kRomSize);
+
+	for (UINT i=0xD0; i<0x100; i++)
+	{
+		memread[i] = memrom + (i-0xD0)*256;
+		memwrite[i] = NULL;
+		memreadram[i] = 0;
+	}
+
+	int res = 0;
+
+	// Debugger-style patches of ROM must be ignored (and not modify the ROM image)
+	if (MemWriteByte(0xD000, 0xEA)) res = 1;
+	if (MemWriteByte(0xFFFC, 0x00)) res = 1;
+	if (MemWriteByte(0xFFFF, 0x4C)) res = 1;
+	if (memcmp(memrom, memromExpected, kRomSize) != 0) res = 1;
+	if (MemReadByte(0xFFFF) != memromExpected[0x2FFF]) res = 1;
+
+	// ... but RAM is modified
+	if (!MemWriteByte(0x0300, 0xEA) || mem[0x0300] != 0xEA) res = 1;
+	if (MemReadByte(0x0300) != 0xEA) res = 1;
+
+	for (UINT i=0xD0; i<0x100; i++)
+	{
+		memread[i] = memwrite[i] = mem+i*256;
+		memreadram[i] = 1;
+	}
+
+	delete [] memrom;
+	delete [] memromExpected;
+	return res;
+}
+
+//-------------------------------------
+
 int _tmain(int argc, _TCHAR* argv[])
 {
 	int res = 1;
@@ -1344,5 +1828,17 @@ int _tmain(int argc, _TCHAR* argv[])
 	res = SyncEvents_test();
 	if (res) return res;
 
+	res = Batch_test();
+	if (res) return res;
+
+	res = BlockCache_test();
+	if (res) return res;
+
+	res = IrqStress_test();
+	if (res) return res;
+
+	res = MemWriteByte_test();
+	if (res) return res;
+
 	return 0;
 }
@@ -40,8 +40,9 @@ eCpuType GetMainCpu(void)
 }
 
 // From Memory.cpp
-LPBYTE         mem          = NULL;	// TODO: Init
+LPBYTE         memread[0x100];		// TODO: Init
 LPBYTE         memdirty     = NULL;	// TODO: Init
+static LPBYTE  mem          = NULL;	// Flat 64K, paged in by init()
 
 //-------------------------------------
 
@@ -91,6 +92,9 @@ bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable
 void init(void)
 {
 	mem = (LPBYTE)VirtualAlloc(NULL,128*1024,MEM_COMMIT,PAGE_READWRITE);	// alloc >64K to test wrap-around at 64K boundary
+
+	for (UINT i=0; i<256; i++)
+		memread[i] = mem+i*256;
 }
 
 void reset(void)